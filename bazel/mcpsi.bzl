@@ -54,6 +54,21 @@ def mcpsi_cc_library(
         **kargs
     )
 
+def mcpsi_cc_bench(
+        linkopts = [],
+        copts = [],
+        deps = [],
+        **kargs):
+    # JSON report: `bazel run ... -- --benchmark_format=json`
+    cc_binary(
+        linkopts = linkopts + ["-lm"],
+        copts = _mcpsi_copts() + copts,
+        deps = deps + [
+            "@com_github_google_benchmark//:benchmark_main",
+        ],
+        **kargs
+    )
+
 def mcpsi_cmake_external(**attrs):
     if "generate_args" not in attrs:
         attrs["generate_args"] = ["-GNinja"]
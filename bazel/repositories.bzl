@@ -69,6 +69,17 @@ def _rules_pkg():
         sha256 = "8f9ee2dc10c1ae514ee599a8b42ed99fa262b757058f65ad3c384289ff70c4b8",
     )
 
+def _com_github_google_benchmark():
+    maybe(
+        http_archive,
+        name = "com_github_google_benchmark",
+        type = "tar.gz",
+        strip_prefix = "benchmark-1.8.3",
+        sha256 = "6bc180a57d23d4d9515519f92b0c83d61b05b5bab188961f36ac7b06b0d9e9ce",
+        urls = [
+            "https://github.com/google/benchmark/archive/refs/tags/v1.8.3.tar.gz",
+        ],
+    )
 
 def mcpsi_deps():
     _yacl()
@@ -77,4 +88,5 @@ def mcpsi_deps():
     _rules_pkg()
     _gmp()
     _boost()
+    _com_github_google_benchmark()
 
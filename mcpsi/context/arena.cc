@@ -0,0 +1,123 @@
+#include "mcpsi/context/arena.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <new>
+
+#include "yacl/base/exception.h"
+
+namespace mcpsi {
+
+namespace {
+
+constexpr size_t kPageSize = 4096;
+
+size_t RoundUp(size_t val, size_t align) {
+  return (val + align - 1) / align * align;
+}
+
+// fault the pages in (one write per page)
+void Touch(uint8_t* data, size_t size) {
+  for (size_t i = 0; i < size; i += kPageSize) {
+    data[i] = 0;
+  }
+}
+
+}  // namespace
+
+// register string
+const std::string Arena::id = std::string("Arena");
+
+Arena::~Arena() {
+  for (const auto& block : blocks_) {
+    if (block.mapped) {
+      ::munmap(block.data, block.size);
+    } else {
+      ::operator delete(block.data, std::align_val_t(kAlign));
+    }
+  }
+}
+
+void* Arena::AllocBytes(size_t bytes) {
+  bytes = RoundUp(bytes, kAlign);
+  // first fit from the bump pointer on, the skipped tails are reused once
+  // the scope is rewound
+  while (block_ < blocks_.size()) {
+    if (offset_ + bytes <= blocks_[block_].size) {
+      auto* ret = blocks_[block_].data + offset_;
+      offset_ += bytes;
+      return ret;
+    }
+    ++block_;
+    offset_ = 0;
+  }
+  Grow(bytes);
+  offset_ = bytes;
+  return blocks_[block_].data;
+}
+
+void Arena::Grow(size_t bytes, bool populate) {
+  size_t size = std::max(bytes, kMinBlock);
+  if (!blocks_.empty()) {
+    // geometric growth, O(log) blocks for any workload
+    size = std::max(size, 2 * blocks_.back().size);
+  }
+
+  Block block;
+  if (size >= kHugePage) {
+    size = RoundUp(size, kHugePage);
+    // over-map by a huge page to align the block on a huge page
+    const size_t len = size + kHugePage;
+    auto* raw = ::mmap(nullptr, len, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    YACL_ENFORCE(raw != MAP_FAILED, "arena cannot map {} bytes", len);
+    auto* base = static_cast<uint8_t*>(raw);
+    auto* data = reinterpret_cast<uint8_t*>(
+        RoundUp(reinterpret_cast<uintptr_t>(base), kHugePage));
+    const size_t head = data - base;
+    if (head != 0) {
+      ::munmap(base, head);
+    }
+    if (len - head - size != 0) {
+      ::munmap(data + size, len - head - size);
+    }
+#ifdef MADV_HUGEPAGE
+    // best effort, e.g. THP could be disabled
+    ::madvise(data, size, MADV_HUGEPAGE);
+#endif
+    block = Block{data, size, true};
+  } else {
+    auto* data =
+        static_cast<uint8_t*>(::operator new(size, std::align_val_t(kAlign)));
+    block = Block{data, size, false};
+  }
+
+  if (populate) {
+    Touch(block.data, block.size);
+  }
+  blocks_.push_back(block);
+}
+
+void Arena::Reserve(size_t bytes) {
+  bytes = RoundUp(bytes, kAlign);
+  // the block that the next allocation of `bytes` bytes would land in
+  size_t offset = offset_;
+  for (size_t i = block_; i < blocks_.size(); ++i, offset = 0) {
+    if (offset + bytes <= blocks_[i].size) {
+      Touch(blocks_[i].data + offset, bytes);
+      return;
+    }
+  }
+  Grow(bytes, true);
+}
+
+size_t Arena::Capacity() const {
+  size_t ret = 0;
+  for (const auto& block : blocks_) {
+    ret += block.size;
+  }
+  return ret;
+}
+
+}  // namespace mcpsi
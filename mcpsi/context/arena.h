@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "mcpsi/context/state.h"
+
+namespace mcpsi {
+
+// Monotonic arena of uninitialized storage for the temporaries of operators,
+// one per context (see Context::GetArena).
+// > Alloc bumps a pointer, the storage is released as a whole when the
+//   enclosing Scope ends (scopes nest, e.g. MulAA inside InvA)
+// > blocks are kept across scopes, so a steady workload neither allocates
+//   nor faults pages once it is warm (or once Reserve is called offline)
+// > large blocks are mapped on (transparent) huge pages
+// NOTE: NOT thread-safe, allocate in the caller && let the workers of
+// parallel_for write into the spans
+class Arena : public State {
+ private:
+  struct Position {
+    size_t block;
+    size_t offset;
+  };
+
+ public:
+  static const std::string id;
+  static constexpr StateSlot slot = StateSlot::kArena;
+
+  // alignment of every allocation (a cache line)
+  static constexpr size_t kAlign = 64;
+  // size of the first block
+  static constexpr size_t kMinBlock = size_t{1} << 16;
+  // blocks of (at least) one huge page are mapped on huge pages
+  static constexpr size_t kHugePage = size_t{1} << 21;
+
+  // releases all allocations since its construction
+  class Scope {
+   public:
+    explicit Scope(Arena* arena) : arena_(arena), pos_(arena->Tell()) {}
+    ~Scope() { arena_->Rewind(pos_); }
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    Arena* arena_;
+    Position pos_;
+  };
+
+  Arena() = default;
+  ~Arena();
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  // uninitialized storage of `num` elements, valid until the enclosing Scope
+  // ends
+  template <typename T>
+  absl::Span<T> Alloc(size_t num) {
+    static_assert(std::is_trivially_copyable_v<T> &&
+                  std::is_trivially_destructible_v<T>);
+    static_assert(alignof(T) <= kAlign);
+    if (num == 0) {
+      return absl::Span<T>();
+    }
+    return absl::MakeSpan(static_cast<T*>(AllocBytes(num * sizeof(T))), num);
+  }
+
+  // make sure the next `bytes` bytes are backed by faulted-in pages, e.g.
+  // before the online phase
+  void Reserve(size_t bytes);
+
+  // bytes of all blocks
+  size_t Capacity() const;
+
+ private:
+  struct Block {
+    uint8_t* data;
+    size_t size;
+    // mapped (huge pages) or from operator new
+    bool mapped;
+  };
+
+  std::vector<Block> blocks_;
+  // bump pointer, i.e. blocks_[block_] + offset_
+  size_t block_{0};
+  size_t offset_{0};
+
+  void* AllocBytes(size_t bytes);
+  // append a block of at least `bytes` bytes
+  void Grow(size_t bytes, bool populate = false);
+
+  Position Tell() const { return {block_, offset_}; }
+  void Rewind(const Position& pos) {
+    block_ = pos.block;
+    offset_ = pos.offset;
+  }
+};
+
+}  // namespace mcpsi
@@ -2,6 +2,7 @@
 
 #include <memory>
 
+#include "mcpsi/context/arena.h"
 #include "mcpsi/context/state.h"
 #include "yacl/link/link.h"
 
@@ -15,14 +16,20 @@ class Context {
   Context(std::shared_ptr<yacl::link::Context> lctx) : lctx_(lctx) {
     states_ = std::make_unique<StateContainer>();
     AddState<Connection>(*lctx_);
+    AddState<Arena>();
+    conn_ = GetStateRaw<Connection>();
+    arena_ = GetStateRaw<Arena>();
     rank_ = lctx_->Rank();
   }
 
   std::shared_ptr<Connection> GetConnection() { return GetState<Connection>(); }
 
-  uint32_t NextRank() { return GetState<Connection>()->NextRank(); }
+  uint32_t NextRank() { return conn_->NextRank(); }
 
-  uint32_t GetRank() { return GetState<Connection>()->Rank(); }
+  uint32_t GetRank() { return rank_; }
+
+  // storage for the temporaries of operators (see Arena)
+  Arena* GetArena() { return arena_; }
 
   template <typename StateTy>
   void AddState(std::shared_ptr<StateTy> state) {
@@ -39,8 +46,16 @@ class Context {
     return states_->template GetState<StateTy>();
   }
 
+  // non-owning handle (no refcount), for hot paths
+  template <typename StateTy>
+  StateTy* GetStateRaw() {
+    return states_->template GetStateRaw<StateTy>();
+  }
+
  private:
   std::shared_ptr<yacl::link::Context> lctx_{nullptr};
+  Connection* conn_{nullptr};
+  Arena* arena_{nullptr};
   uint32_t rank_;
 };
 
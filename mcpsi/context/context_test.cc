@@ -1,6 +1,8 @@
 #include "context.h"
 
+#include <algorithm>
 #include <future>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "mcpsi/context/register.h"
@@ -42,6 +44,36 @@ TEST(ContextTest, LinkWork) {
   EXPECT_EQ(s_b, r_b);
 };
 
+TEST(ContextTest, WanLinkWork) {
+  NetworkConfig config;
+  config.latency_ms = 50;
+  config.bandwidth_mbps = 100;
+  auto context = MockContext(2, config);
+  uint128_t s_a = yc::SecureRandU128();
+
+  auto begin = std::chrono::steady_clock::now();
+  auto rank0 = std::async([&] {
+    auto lctx = context[0]->GetConnection();
+    lctx->SendAsync(lctx->NextRank(), yacl::SerializeUint128(s_a), "s_a");
+    auto buff = lctx->Recv(lctx->NextRank(), "s_b");
+    return yacl::DeserializeUint128(buff);
+  });
+
+  auto rank1 = std::async([&] {
+    auto lctx = context[1]->GetConnection();
+    auto buff = lctx->Recv(lctx->NextRank(), "s_a");
+    lctx->SendAsync(lctx->NextRank(), buff, "s_b");
+    return yacl::DeserializeUint128(buff);
+  });
+
+  EXPECT_EQ(rank0.get(), s_a);
+  EXPECT_EQ(rank1.get(), s_a);
+  auto elapse = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - begin);
+  // one round trip
+  EXPECT_GE(elapse.count(), 2 * config.latency_ms);
+};
+
 TEST(ContextTest, PrgWork) {
   auto context = MockContext(2);
 
@@ -60,4 +92,85 @@ TEST(ContextTest, PrgWork) {
   EXPECT_EQ(r_a, r_b);
 };
 
+TEST(ContextTest, StateWork) {
+  auto context = MockContext(2)[0];
+  EXPECT_ANY_THROW(context->GetStateRaw<Prg>());
+
+  context->AddState<Prg>(1);
+  auto prg = context->GetState<Prg>();
+  EXPECT_EQ(prg.get(), context->GetStateRaw<Prg>());
+  // the first state of a slot is kept
+  context->AddState<Prg>(2);
+  EXPECT_EQ(prg.get(), context->GetStateRaw<Prg>());
+  EXPECT_EQ(prg->Seed(), uint128_t(1));
+
+  // lookups from worker threads
+  std::vector<std::future<Prg*>> workers;
+  for (size_t i = 0; i < 4; ++i) {
+    workers.emplace_back(std::async(std::launch::async, [&] {
+      return context->GetStateRaw<Prg>();
+    }));
+  }
+  for (auto& worker : workers) {
+    EXPECT_EQ(worker.get(), prg.get());
+  }
+};
+
+TEST(ContextTest, CoinWork) {
+  auto context = MockContext(2);
+  // several batches, including the refills riding on the last openings
+  const size_t num = 3 * Connection::kCoinBatch + 1;
+
+  auto draw = [&](size_t rank) {
+    auto conn = context[rank]->GetConnection();
+    std::vector<uint128_t> coins(num);
+    for (auto& coin : coins) {
+      coin = conn->DrawCoin();
+    }
+    return coins;
+  };
+  auto rank0 = std::async([&] { return draw(0); });
+  auto rank1 = std::async([&] { return draw(1); });
+
+  auto coins0 = rank0.get();
+  auto coins1 = rank1.get();
+
+  EXPECT_EQ(coins0, coins1);
+  std::sort(coins0.begin(), coins0.end());
+  EXPECT_EQ(std::unique(coins0.begin(), coins0.end()), coins0.end());
+};
+
+TEST(ContextTest, ArenaWork) {
+  auto context = MockContext(2)[0];
+  auto arena = context->GetArena();
+  EXPECT_EQ(arena, context->GetStateRaw<Arena>());
+
+  uint64_t* first = nullptr;
+  for (size_t round = 0; round < 2; ++round) {
+    Arena::Scope scope(arena);
+    auto a = arena->Alloc<uint64_t>(1000);
+    auto b = arena->Alloc<uint8_t>(3);
+    auto c = arena->Alloc<uint64_t>(Arena::kHugePage);
+    EXPECT_EQ(a.size(), 1000);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(b.data()) % Arena::kAlign, 0);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(c.data()) % Arena::kAlign, 0);
+    std::fill(c.begin(), c.end(), round);
+    // the storage is reused once the scope is rewound
+    if (round == 0) {
+      first = a.data();
+    } else {
+      EXPECT_EQ(first, a.data());
+    }
+  }
+  const auto capacity = arena->Capacity();
+  EXPECT_GE(capacity, Arena::kHugePage * sizeof(uint64_t));
+  {
+    Arena::Scope scope(arena);
+    arena->Reserve(1024);
+    EXPECT_TRUE(arena->Alloc<uint64_t>(0).empty());
+    arena->Alloc<uint64_t>(Arena::kHugePage);
+  }
+  EXPECT_EQ(capacity, arena->Capacity());
+};
+
 };  // namespace mcpsi
@@ -0,0 +1,79 @@
+#include "mcpsi/context/network.h"
+
+#include <thread>
+
+#include "yacl/base/exception.h"
+
+namespace mcpsi {
+
+namespace {
+using Duration = std::chrono::duration<double, std::milli>;
+}  // namespace
+
+NetworkModel::NetworkModel(const NetworkConfig& config, size_t world_size)
+    : config_(config), world_size_(world_size), rng_(std::random_device()()) {
+  YACL_ENFORCE(config_.latency_ms >= 0.0);
+  YACL_ENFORCE(config_.bandwidth_mbps >= 0.0);
+  YACL_ENFORCE(config_.jitter_ms >= 0.0);
+  auto now = Clock::now();
+  link_free_.resize(world_size_ * world_size_, now);
+  last_arrival_.resize(world_size_ * world_size_, now);
+}
+
+NetworkModel::Clock::duration NetworkModel::Jitter() {
+  if (config_.jitter_ms == 0.0) {
+    return Clock::duration::zero();
+  }
+  std::uniform_real_distribution<double> dist(-config_.jitter_ms,
+                                              config_.jitter_ms);
+  return std::chrono::duration_cast<Clock::duration>(Duration(dist(rng_)));
+}
+
+void NetworkModel::OnSend(size_t src, size_t dst, const std::string& tag,
+                          size_t bytes) {
+  YACL_ENFORCE(src < world_size_ && dst < world_size_);
+  const size_t link = src * world_size_ + dst;
+  std::lock_guard<std::mutex> lock(mutex_);
+
+  auto start = std::max(Clock::now(), link_free_[link]);
+  auto transfer = Clock::duration::zero();
+  if (config_.bandwidth_mbps > 0.0) {
+    // bits / (Mbit/s) --> ms
+    double ms = bytes * 8.0 / (config_.bandwidth_mbps * 1000.0);
+    transfer = std::chrono::duration_cast<Clock::duration>(Duration(ms));
+  }
+  link_free_[link] = start + transfer;
+
+  auto delay = std::chrono::duration_cast<Clock::duration>(
+                   Duration(config_.latency_ms)) +
+               Jitter();
+  auto arrival = std::max(link_free_[link] + delay, link_free_[link]);
+  // FIFO link, no reordering
+  arrival = std::max(arrival, last_arrival_[link]);
+  last_arrival_[link] = arrival;
+
+  in_flight_[std::make_tuple(src, dst, tag)].push_back(arrival);
+  cv_.notify_all();
+}
+
+void NetworkModel::OnRecv(size_t src, size_t dst, const std::string& tag) {
+  YACL_ENFORCE(src < world_size_ && dst < world_size_);
+  auto key = std::make_tuple(src, dst, tag);
+  Clock::time_point arrival;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [&] {
+      auto iter = in_flight_.find(key);
+      return iter != in_flight_.end() && !iter->second.empty();
+    });
+    auto iter = in_flight_.find(key);
+    arrival = iter->second.front();
+    iter->second.pop_front();
+    if (iter->second.empty()) {
+      in_flight_.erase(iter);
+    }
+  }
+  std::this_thread::sleep_until(arrival);
+}
+
+}  // namespace mcpsi
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace mcpsi {
+
+// WAN setting for in-memory links
+struct NetworkConfig {
+  // one-way latency (ms)
+  double latency_ms{0.0};
+  // bandwidth (Mbit/s), 0 for unlimited
+  double bandwidth_mbps{0.0};
+  // uniform jitter in [-jitter_ms, +jitter_ms] (ms)
+  double jitter_ms{0.0};
+
+  bool Enabled() const {
+    return latency_ms > 0.0 || bandwidth_mbps > 0.0 || jitter_ms > 0.0;
+  }
+};
+
+// Emulate latency / bandwidth / jitter between parties running in the same
+// process. All parties must share the same NetworkModel instance, since the
+// arrival time of each message is decided by the sender and waited by the
+// receiver.
+//
+// Each (src, dst) pair is a FIFO link: a message occupies the link for
+// `bytes / bandwidth`, then arrives after `latency + jitter` (but never before
+// the previous message on the same link).
+class NetworkModel {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  NetworkModel(const NetworkConfig& config, size_t world_size);
+
+  NetworkConfig GetConfig() const { return config_; }
+
+  // sender side, record the arrival time of the message
+  // NOTE: `tag` should be unique among links sharing this model (e.g. prefixed
+  // with the link id), while the bandwidth is shared among them
+  void OnSend(size_t src, size_t dst, const std::string& tag, size_t bytes);
+
+  // receiver side, block until the message arrives
+  void OnRecv(size_t src, size_t dst, const std::string& tag);
+
+ private:
+  Clock::duration Jitter();
+
+  NetworkConfig config_;
+  size_t world_size_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::mt19937_64 rng_;
+
+  // the time when link (src, dst) becomes free
+  std::vector<Clock::time_point> link_free_;
+  // the arrival time of the latest message on link (src, dst)
+  std::vector<Clock::time_point> last_arrival_;
+  // arrival time of in-flight messages, indexed by (src, dst, tag)
+  std::map<std::tuple<size_t, size_t, std::string>,
+           std::deque<Clock::time_point>>
+      in_flight_;
+};
+
+}  // namespace mcpsi
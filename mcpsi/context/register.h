@@ -3,26 +3,49 @@
 #include "mcpsi/context/context.h"
 #include "mcpsi/context/state.h"
 #include "mcpsi/cr/cr.h"
+#include "mcpsi/cr/dealer_cr.h"
 #include "mcpsi/cr/fake_cr.h"
+#include "mcpsi/cr/payload_cr.h"
 #include "mcpsi/cr/true_cr.h"
+#include "mcpsi/ss/payload.h"
 #include "mcpsi/ss/protocol.h"
 
 namespace mcpsi {
 
-void inline SetupContext(std::shared_ptr<Context> ctx, bool CR_mode = false) {
+// source of the correlated randomness
+// > kFake   : the shared Prg, to benchmark the online phase
+// > kTrue   : OT && VOLE (TrueCorrelation)
+// > kDealer : a trusted dealer (DealerCorrelation), the DealerLink should be
+//             added to the context before
+enum class CrMode { kFake, kTrue, kDealer };
+
+// key --> SPDZ key (share), nullptr for a fresh one
+// dy_key --> DY-PRF key (a-share under `key`), nullptr for a fresh one
+//
+// A given key lets several contexts (e.g. sub-contexts on spawned links) share
+// the same MAC key, so that their a-shares could be combined together. A given
+// dy_key keeps the PRF outputs stable across runs (see oprf_store.h).
+void inline SetupContext(std::shared_ptr<Context> ctx, CrMode mode,
+                         const PTy* key, const ATy* dy_key = nullptr) {
   // Generate a same seed
-  uint128_t seed = ctx->GetState<Connection>()->SyncSeed();
+  uint128_t seed = ctx->GetState<Connection>()->DrawCoin();
   // Shared Prg, all parities own a same Prg (with same seed)
   ctx->AddState<Prg>(seed);
   // Create Basic Protocol
   ctx->AddState<Protocol>(ctx);
+  if (key != nullptr) {
+    ctx->GetState<Protocol>()->SetKey(*key);
+  }
   // Get SPDZ key
-  auto key = ctx->GetState<Protocol>()->GetKey();
+  auto spdz_key = ctx->GetState<Protocol>()->GetKey();
   // Create Correlated Randomness Generator
   std::shared_ptr<Correlation> cr = nullptr;
-  if (CR_mode) {
+  if (mode == CrMode::kTrue) {
     auto true_cr = std::make_shared<TrueCorrelation>(ctx);
     cr = std::static_pointer_cast<Correlation>(true_cr);
+  } else if (mode == CrMode::kDealer) {
+    auto dealer_cr = std::make_shared<DealerCorrelation>(ctx);
+    cr = std::static_pointer_cast<Correlation>(dealer_cr);
   } else {
     auto fake_cr = std::make_shared<FakeCorrelation>(ctx);
     cr = std::static_pointer_cast<Correlation>(fake_cr);
@@ -32,13 +55,129 @@ void inline SetupContext(std::shared_ptr<Context> ctx, bool CR_mode = false) {
   // 1. ctx->AddState<Correlation>(ctx,key);
   // 2. ctx->GetState<Correlation>()->OneTimeSetup();
   // Set SPDZ key
-  ctx->GetState<Correlation>()->SetKey(key);
+  ctx->GetState<Correlation>()->SetKey(spdz_key);
   ctx->GetState<Correlation>()->OneTimeSetup();
-  auto dy_key = ctx->GetState<Correlation>()->GetDyKey();
+  if (dy_key != nullptr) {
+    YACL_ENFORCE(key != nullptr, "persisted dy_key needs its SPDZ key");
+    ctx->GetState<Correlation>()->SetDyKey(*dy_key);
+  }
+  auto prf_key = ctx->GetState<Correlation>()->GetDyKey();
   // strange !!!
   // But Prf setup need "RandA" (which need correlated randomness)
   // TODO: fix it
-  ctx->GetState<Protocol>()->SetupPrf(dy_key);
+  ctx->GetState<Protocol>()->SetupPrf(prf_key);
+}
+
+// CR_mode --> true (kTrue) / fake (kFake) correlated randomness
+void inline SetupContext(std::shared_ptr<Context> ctx, bool CR_mode,
+                         const PTy* key, const ATy* dy_key = nullptr) {
+  SetupContext(ctx, CR_mode ? CrMode::kTrue : CrMode::kFake, key, dy_key);
+}
+
+void inline SetupContext(std::shared_ptr<Context> ctx, CrMode mode) {
+  SetupContext(ctx, mode, nullptr);
+}
+
+void inline SetupContext(std::shared_ptr<Context> ctx, bool CR_mode = false) {
+  SetupContext(ctx, CR_mode, nullptr);
+}
+
+// sub-contexts (e.g. on spawned links) of a set-up context, sharing its SPDZ
+// && DY-PRF keys, so that their a-shares (&& PRF outputs) could be combined
+// together. The real correlated randomness of each one is bootstrapped from
+// fresh base OTs / base VOLEs of the parent (TrueCorrelation::DrawBase), i.e.
+// there is a single one-time setup for all of them.
+void inline SetupSubContexts(std::shared_ptr<Context> parent,
+                             std::vector<std::shared_ptr<Context>>& subs) {
+  auto key = parent->GetState<Protocol>()->GetKey();
+  auto cr = parent->GetState<Correlation>();
+  auto dy_key = cr->GetDyKey();
+  auto true_cr = std::dynamic_pointer_cast<TrueCorrelation>(cr);
+  if (true_cr == nullptr) {
+    YACL_ENFORCE(std::dynamic_pointer_cast<FakeCorrelation>(cr) != nullptr,
+                 "sub-contexts of a dealer context are not supported");
+    for (auto& sub : subs) {
+      SetupContext(sub, CrMode::kFake, &key, &dy_key);
+    }
+    return;
+  }
+  // the parent serves the bases in the same order for all parties
+  std::vector<SnapshotPayload> bases;
+  for (size_t i = 0; i < subs.size(); ++i) {
+    bases.emplace_back(true_cr->DrawBase());
+  }
+  std::vector<std::future<void>> tasks;
+  for (size_t i = 0; i < subs.size(); ++i) {
+    tasks.emplace_back(std::async(std::launch::async, [&, i] {
+      auto& sub = subs[i];
+      uint128_t seed = sub->GetState<Connection>()->DrawCoin();
+      sub->AddState<Prg>(seed);
+      sub->AddState<Protocol>(sub);
+      sub->GetState<Protocol>()->SetKey(key);
+      auto sub_cr = std::make_shared<TrueCorrelation>(sub);
+      sub->AddState<Correlation>(std::static_pointer_cast<Correlation>(sub_cr));
+      sub_cr->SetupFromBase(bases[i]);
+      sub->GetState<Protocol>()->SetupPrf(sub_cr->GetDyKey());
+    }));
+  }
+  for (auto& task : tasks) {
+    task.get();
+  }
+}
+
+// payload SPDZ instance (over PayTy) on a set-up context, CR_mode should be
+// the same as the one of SetupContext (the true one reuses its OT adapters)
+void inline SetupPayloadContext(std::shared_ptr<Context> ctx,
+                                bool CR_mode = false) {
+  ctx->AddState<PayloadProtocol>(ctx);
+  ctx->AddState<PayloadCorrelation>(ctx, CR_mode);
+  auto key = ctx->GetState<PayloadProtocol>()->GetKey();
+  ctx->GetState<PayloadCorrelation>()->SetKey(key);
+}
+
+// payload instances of sub-contexts (see SetupSubContexts), sharing the
+// payload SPDZ key of the parent, so that their a-shares could be combined
+void inline SetupPayloadSubContexts(std::shared_ptr<Context> parent,
+                                    std::vector<std::shared_ptr<Context>>& subs,
+                                    bool CR_mode = false) {
+  auto key = parent->GetState<PayloadProtocol>()->GetKey();
+  for (auto& sub : subs) {
+    sub->AddState<PayloadProtocol>(sub);
+    sub->GetState<PayloadProtocol>()->SetKey(key);
+    sub->AddState<PayloadCorrelation>(sub, CR_mode);
+    sub->GetState<PayloadCorrelation>()->SetKey(key);
+  }
+}
+
+// warm start (real correlated randomness only): set up from the snapshot of
+// the last run, or from scratch if there is no matching one. Either way a new
+// snapshot is sealed for the next run, since a snapshot is loaded only once
+// (see snapshot.h). The keys of the last run are kept.
+void inline SetupContext(std::shared_ptr<Context> ctx,
+                         SetupSnapshot& snapshot) {
+  uint128_t seed = ctx->GetState<Connection>()->DrawCoin();
+  ctx->AddState<Prg>(seed);
+  ctx->AddState<Protocol>(ctx);
+  auto true_cr = std::make_shared<TrueCorrelation>(ctx);
+  ctx->AddState<Correlation>(std::static_pointer_cast<Correlation>(true_cr));
+  if (true_cr->LoadSnapshot(snapshot)) {
+    ctx->GetState<Protocol>()->SetKey(true_cr->GetKey());
+  } else {
+    true_cr->SetKey(ctx->GetState<Protocol>()->GetKey());
+    true_cr->OneTimeSetup();
+  }
+  true_cr->SaveSnapshot(snapshot);
+  ctx->GetState<Protocol>()->SetupPrf(true_cr->GetDyKey());
+}
+
+// draw a fresh DY-PRF key on a set-up context, the SPDZ key && the other
+// OT / VOLE adapters are kept (e.g. key epochs of a long-running service)
+// NOTE: cached DyBeaver correlations are bound to the old key
+void inline RotateDyKey(std::shared_ptr<Context> ctx) {
+  auto prot = ctx->GetState<Protocol>();
+  auto dy_key = prot->RandA(1)[0];
+  ctx->GetState<Correlation>()->SetDyKey(dy_key);
+  prot->SetupPrf(dy_key);
 }
 
 void inline MockSetupContext(std::vector<std::shared_ptr<Context>>& ctxs) {
@@ -1,11 +1,66 @@
 #include "mcpsi/context/state.h"
 
+#include <array>
+#include <cstring>
+
 namespace mcpsi {
+
+namespace {
+
+// size of a commitment (sm3)
+constexpr size_t kCommitSize = 32;
+
+}  // namespace
+
 // register string
 const std::string Prg::id = std::string("Prg");
 // register string
 const std::string Connection::id = std::string("Connection");
 
+std::string Connection::NetTag(std::string_view tag) const {
+  // links spawned from the same root share the model, prefix with link id
+  return fmt::format("{}:{}", Id(), tag);
+}
+
+void Connection::SendAsync(size_t dst_rank, yacl::ByteContainerView value,
+                           std::string_view tag) {
+  if (net_) {
+    net_->OnSend(rank_, dst_rank, NetTag(tag), value.size());
+  }
+  yacl::link::Context::SendAsync(dst_rank, value, tag);
+}
+
+void Connection::SendAsync(size_t dst_rank, yacl::Buffer&& value,
+                           std::string_view tag) {
+  if (net_) {
+    net_->OnSend(rank_, dst_rank, NetTag(tag), value.size());
+  }
+  yacl::link::Context::SendAsync(dst_rank, std::move(value), tag);
+}
+
+void Connection::Send(size_t dst_rank, yacl::ByteContainerView value,
+                      std::string_view tag) {
+  if (net_) {
+    net_->OnSend(rank_, dst_rank, NetTag(tag), value.size());
+  }
+  yacl::link::Context::Send(dst_rank, value, tag);
+}
+
+std::shared_ptr<Connection> Connection::SpawnConnection() {
+  auto ret = std::make_shared<Connection>(*Spawn());
+  ret->SetNetworkModel(net_);
+  spawned_.emplace_back(ret);
+  return ret;
+}
+
+yacl::Buffer Connection::Recv(size_t src_rank, std::string_view tag) {
+  auto ret = yacl::link::Context::Recv(src_rank, tag);
+  if (net_) {
+    net_->OnRecv(src_rank, rank_, NetTag(tag));
+  }
+  return ret;
+}
+
 yacl::Buffer Connection::_Exchange_Buffer(yacl::ByteContainerView bv) {
   yacl::Buffer ret;
   if (rank_ == 0) {
@@ -43,6 +98,74 @@ yacl::Buffer Connection::_ExchangeWithCommit_Buffer(
   return remote_buff;
 }
 
+Connection::CoinBatch Connection::GenCoins() {
+  CoinBatch batch;
+  batch.seeds.resize(kCoinBatch);
+  batch.nonces.resize(kCoinBatch);
+  batch.commits = yacl::Buffer(kCoinBatch * kCommitSize);
+  for (size_t i = 0; i < kCoinBatch; ++i) {
+    batch.seeds[i] = yacl::crypto::SecureRandU128();
+    batch.nonces[i] = yacl::crypto::SecureRandU128();
+    // commitment = hash( seed || nonce )
+    const std::array<uint128_t, 2> opening = {batch.seeds[i], batch.nonces[i]};
+    auto commitment = yacl::crypto::Sm3(
+        yacl::ByteContainerView(opening.data(), sizeof(opening)));
+    memcpy(batch.commits.data<uint8_t>() + i * kCommitSize, commitment.data(),
+           kCommitSize);
+  }
+  return batch;
+}
+
+uint128_t Connection::DrawCoin() {
+  // the first batch costs an extra exchange, the later ones ride on the
+  // opening of the last coin of the previous batch
+  if (coins_.seeds.empty()) {
+    coins_ = GenCoins();
+    coins_.remote_commits =
+        _Exchange_Buffer(yacl::ByteContainerView(coins_.commits));
+    YACL_ENFORCE(static_cast<uint64_t>(coins_.remote_commits.size()) ==
+                 kCoinBatch * kCommitSize);
+  }
+
+  const size_t idx = coin_idx_++;
+  const bool last = (idx + 1 == kCoinBatch);
+  CoinBatch next;
+  constexpr size_t kOpenSize = 2 * sizeof(uint128_t);
+  yacl::Buffer msg(kOpenSize + (last ? kCoinBatch * kCommitSize : 0));
+  const std::array<uint128_t, 2> opening = {coins_.seeds[idx],
+                                            coins_.nonces[idx]};
+  memcpy(msg.data(), opening.data(), kOpenSize);
+  if (last) {
+    next = GenCoins();
+    memcpy(msg.data<uint8_t>() + kOpenSize, next.commits.data(),
+           kCoinBatch * kCommitSize);
+  }
+
+  auto remote_msg = _Exchange_Buffer(yacl::ByteContainerView(msg));
+  YACL_ENFORCE(static_cast<uint64_t>(remote_msg.size()) ==
+               static_cast<uint64_t>(msg.size()));
+
+  auto check_commitment = yacl::crypto::Sm3(
+      yacl::ByteContainerView(remote_msg.data(), kOpenSize));
+  YACL_ENFORCE(memcmp(check_commitment.data(),
+                      coins_.remote_commits.data<uint8_t>() + idx * kCommitSize,
+                      kCommitSize) == 0,
+               "invalid opening of the public coin");
+
+  uint128_t remote_seed;
+  memcpy(&remote_seed, remote_msg.data(), sizeof(remote_seed));
+  const uint128_t coin = coins_.seeds[idx] ^ remote_seed;
+
+  if (last) {
+    next.remote_commits = yacl::Buffer(kCoinBatch * kCommitSize);
+    memcpy(next.remote_commits.data(),
+           remote_msg.data<uint8_t>() + kOpenSize, kCoinBatch * kCommitSize);
+    coins_ = std::move(next);
+    coin_idx_ = 0;
+  }
+  return coin;
+}
+
 template <typename T>
 T Connection::_Exchange_T(T val) {
   auto ret_buf = _Exchange_Buffer(yacl::ByteContainerView(&val, sizeof(val)));
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <array>
+#include <atomic>
 #include <cstddef>
-#include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <type_traits>
+#include <vector>
 
+#include "mcpsi/context/network.h"
 #include "mcpsi/utils/config.h"
 #include "yacl/crypto/base/hash/hash_utils.h"
 #include "yacl/crypto/tools/prg.h"
@@ -19,29 +24,76 @@ class State {
   virtual ~State() = default;
 };
 
+// slot of each kind of state, i.e. StateTy::slot (see StateContainer)
+// NOTE: a state should be added && got by the type owning the slot, e.g.
+// AddState<Correlation>(fake_cr) rather than AddState<FakeCorrelation>
+enum class StateSlot : size_t {
+  kConnection = 0,
+  kPrg,
+  kProtocol,
+  kCorrelation,
+  kPayloadProtocol,
+  kPayloadCorrelation,
+  kDealerLink,
+  kArena,
+  kNum,
+};
+
+// states indexed by their (compile-time) slots
+// > lookups are O(1) && lock-free, GetStateRaw does not touch the refcount
+// > a slot is written once (the first AddState wins, as std::map::emplace),
+//   so the container could be shared by worker threads once it is set up
 class StateContainer final {
  private:
-  std::map<std::string, std::shared_ptr<State>> map_;
+  static constexpr size_t kSlotNum = static_cast<size_t>(StateSlot::kNum);
+
+  // owners of the states, written before the slot is published
+  std::array<std::shared_ptr<State>, kSlotNum> owners_;
+  std::array<std::atomic<State*>, kSlotNum> slots_{};
+  // serializes AddState
+  std::mutex mutex_;
+
+  template <typename StateTy>
+  static constexpr size_t Index() {
+    static_assert(std::is_base_of_v<State, StateTy>);
+    constexpr auto index = static_cast<size_t>(StateTy::slot);
+    static_assert(index < kSlotNum, "invalid state slot");
+    return index;
+  }
 
  public:
-  StateContainer() : map_() {}
+  StateContainer() = default;
 
   template <typename StateTy>
   void AddState(std::shared_ptr<StateTy> state) {
-    map_.emplace(StateTy::id, state);
+    constexpr size_t index = Index<StateTy>();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (owners_[index] != nullptr) {
+      return;
+    }
+    owners_[index] = state;
+    slots_[index].store(state.get(), std::memory_order_release);
   }
 
   template <typename StateTy, typename... Args>
   void AddState(Args&&... args) {
-    map_.emplace(StateTy::id,
-                 std::make_shared<StateTy>(std::forward<Args>(args)...));
+    AddState<StateTy>(std::make_shared<StateTy>(std::forward<Args>(args)...));
   }
 
+  // non-owning handle, valid as long as the container
   template <typename StateTy>
-  std::shared_ptr<StateTy> GetState() {
-    auto iter = map_.find(StateTy::id);
-    YACL_ENFORCE(iter != map_.end(), "State id: {} NOT found !!!", StateTy::id);
-    return std::dynamic_pointer_cast<StateTy>(iter->second);
+  StateTy* GetStateRaw() const {
+    constexpr size_t index = Index<StateTy>();
+    auto* state = slots_[index].load(std::memory_order_acquire);
+    YACL_ENFORCE(state != nullptr, "State id: {} NOT found !!!", StateTy::id);
+    return static_cast<StateTy*>(state);
+  }
+
+  template <typename StateTy>
+  std::shared_ptr<StateTy> GetState() const {
+    auto* state = GetStateRaw<StateTy>();
+    // aliasing constructor, no dynamic_cast
+    return std::shared_ptr<StateTy>(owners_[Index<StateTy>()], state);
   }
 };
 
@@ -49,6 +101,7 @@ class StateContainer final {
 class Prg : public State, public yacl::crypto::Prg<uint8_t> {
  public:
   static const std::string id;
+  static constexpr StateSlot slot = StateSlot::kPrg;
 
   template <typename... Args>
   Prg(Args&&... args)
@@ -59,16 +112,55 @@ class Prg : public State, public yacl::crypto::Prg<uint8_t> {
 class Connection : public State, public yacl::link::Context {
  public:
   static const std::string id;
+  static constexpr StateSlot slot = StateSlot::kConnection;
 
   template <typename... Args>
   Connection(Args&&... args)
       : yacl::link::Context(std::forward<Args>(args)...) {}
 
+  // WAN emulation (only for in-memory links)
+  // NOTE: only the traffic through Connection is emulated, a raw
+  // yacl::link::Context (e.g. `Spawn()`, or the yacl OT extension on a
+  // spawned Connection) bypasses it
+  void SetNetworkModel(std::shared_ptr<NetworkModel> net) { net_ = net; }
+  std::shared_ptr<NetworkModel> GetNetworkModel() const { return net_; }
+
+  // spawn a link sharing the NetworkModel (if any) of this one
+  std::shared_ptr<Connection> SpawnConnection();
+
+  // links created by SpawnConnection (kept alive), e.g. to sum up the stats
+  const std::vector<std::shared_ptr<Connection>>& Spawned() const {
+    return spawned_;
+  }
+
+  // hide yacl::link::Context::Send/SendAsync/Recv to inject WAN delay
+  void SendAsync(size_t dst_rank, yacl::ByteContainerView value,
+                 std::string_view tag);
+
+  void SendAsync(size_t dst_rank, yacl::Buffer&& value, std::string_view tag);
+
+  void Send(size_t dst_rank, yacl::ByteContainerView value,
+            std::string_view tag);
+
+  yacl::Buffer Recv(size_t src_rank, std::string_view tag);
+
   uint128_t SyncSeed() {
     auto seed = yacl::crypto::SecureRandU128();
     return seed ^ ExchangeWithCommit(seed);
   }
 
+  // public coin, i.e. SyncSeed over pre-committed seeds: one exchange per
+  // coin instead of two
+  // > both parties commit to a batch of kCoinBatch seeds, each coin opens
+  //   the next seed of both parties (in the order of draws)
+  // > the commitments of the next batch ride on the opening of the last coin
+  //   of the current one, only the first batch costs an extra exchange
+  // NOTE: a coin still costs one round trip on the link, it can not be opened
+  // before the values it checks are fixed
+  uint128_t DrawCoin();
+
+  static constexpr size_t kCoinBatch = 128;
+
   uint256_t Exchange(uint256_t val);
 
   uint128_t Exchange(uint128_t val);
@@ -86,6 +178,24 @@ class Connection : public State, public yacl::link::Context {
   yacl::Buffer ExchangeWithCommit(yacl::ByteContainerView bv);
 
  private:
+  std::shared_ptr<NetworkModel> net_{nullptr};
+  std::vector<std::shared_ptr<Connection>> spawned_;
+
+  // own seeds (&& the nonces of their commitments), commitments of both
+  // parties
+  struct CoinBatch {
+    std::vector<uint128_t> seeds;
+    std::vector<uint128_t> nonces;
+    yacl::Buffer commits;
+    yacl::Buffer remote_commits;
+  };
+  CoinBatch coins_;
+  size_t coin_idx_{0};
+
+  static CoinBatch GenCoins();
+
+  std::string NetTag(std::string_view tag) const;
+
   template <typename T>
   T _ExchangeWithCommit_T(T val);
 
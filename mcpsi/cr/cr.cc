@@ -1,50 +1,134 @@
 #include "mcpsi/cr/cr.h"
 
+#include <algorithm>
+
 namespace mcpsi {
 
+namespace {
+
+// take the last `num` tuples of `cache`
+// NOTE: all cached tuples share the mask [t], which serves one scalar only,
+// so the rest of the cache (&& [t]) is dropped after the first take
+ScalarDyBeaverTy TakeScalarDyBeaver(ScalarDyBeaverTy& cache, size_t num) {
+  const size_t remain = cache.a.size();
+  YACL_ENFORCE(num <= remain);
+  ScalarDyBeaverTy ret;
+  for (auto [from, to] : {std::make_pair(&cache.a, &ret.a),
+                          std::make_pair(&cache.b, &ret.b),
+                          std::make_pair(&cache.c, &ret.c),
+                          std::make_pair(&cache.r, &ret.r),
+                          std::make_pair(&cache.s, &ret.s)}) {
+    to->assign(from->end() - num, from->end());
+  }
+  ret.k = cache.k;
+  ret.t = cache.t;
+  cache = ScalarDyBeaverTy();
+  return ret;
+}
+
+// move the last `out.size()` tuples of `cache` into `out`
+void TakeTail(std::vector<internal::ATy>& cache,
+              absl::Span<internal::ATy> out) {
+  const size_t num = out.size();
+  const size_t remain = cache.size();
+  YACL_ENFORCE(num <= remain);
+  std::copy(cache.end() - num, cache.end(), out.begin());
+  cache.resize(remain - num);
+}
+
+}  // namespace
+
 // register string
 const std::string Correlation::id = std::string("Correlation");
 
 BeaverTy Correlation::BeaverTriple(size_t num) {
+  BeaverTy ret(num);
+  FillBeaverTriple(absl::MakeSpan(ret.a), absl::MakeSpan(ret.b),
+                   absl::MakeSpan(ret.c));
+  return ret;
+}
+
+void Correlation::FillBeaverTriple(absl::Span<internal::ATy> a,
+                                   absl::Span<internal::ATy> b,
+                                   absl::Span<internal::ATy> c) {
+  const size_t num = a.size();
+  YACL_ENFORCE(num == b.size() && num == c.size());
   if (cache_.BeaverCacheSize() >= num) {
-    return cache_.BeaverTriple(num);
+    cache_.BeaverTriple(a, b, c);
+    return;
   }
   SPDLOG_DEBUG("Miss match");
-  std::vector<internal::ATy> a(num);
-  std::vector<internal::ATy> b(num);
-  std::vector<internal::ATy> c(num);
-  BeaverTriple(absl::MakeSpan(a), absl::MakeSpan(b), absl::MakeSpan(c));
-  return BeaverTy(std::move(a), std::move(b), std::move(c));
+  BeaverTriple(a, b, c);
 }
 
 DyBeaverGetTy Correlation::DyBeaverTripleGet(size_t num) {
+  DyBeaverGetTy ret(num);
+  ret.k = FillDyBeaverTripleGet(absl::MakeSpan(ret.a), absl::MakeSpan(ret.b),
+                                absl::MakeSpan(ret.c), absl::MakeSpan(ret.r));
+  return ret;
+}
+
+internal::ATy Correlation::FillDyBeaverTripleGet(absl::Span<internal::ATy> a,
+                                                 absl::Span<internal::ATy> b,
+                                                 absl::Span<internal::ATy> c,
+                                                 absl::Span<internal::ATy> r) {
+  const size_t num = a.size();
+  YACL_ENFORCE(num == b.size() && num == c.size() && num == r.size());
   if (cache_.DyBeaverGetCacheSize() >= num) {
-    return cache_.DyBeaverTripleGet(num);
+    return cache_.DyBeaverTripleGet(a, b, c, r);
   }
   SPDLOG_DEBUG("Miss match");
-  std::vector<internal::ATy> a(num);
-  std::vector<internal::ATy> b(num);
-  std::vector<internal::ATy> c(num);
-  std::vector<internal::ATy> r(num);
-  DyBeaverTripleGet(absl::MakeSpan(a), absl::MakeSpan(b), absl::MakeSpan(c),
-                    absl::MakeSpan(r));
-  return DyBeaverGetTy(std::move(a), std::move(b), std::move(c), std::move(r),
-                       dy_key_);
+  DyBeaverTripleGet(a, b, c, r);
+  return dy_key_;
 }
 
 DyBeaverSetTy Correlation::DyBeaverTripleSet(size_t num) {
+  DyBeaverSetTy ret(num);
+  ret.k = FillDyBeaverTripleSet(absl::MakeSpan(ret.a), absl::MakeSpan(ret.b),
+                                absl::MakeSpan(ret.c), absl::MakeSpan(ret.r));
+  return ret;
+}
+
+internal::ATy Correlation::FillDyBeaverTripleSet(absl::Span<internal::ATy> a,
+                                                 absl::Span<internal::ATy> b,
+                                                 absl::Span<internal::ATy> c,
+                                                 absl::Span<internal::ATy> r) {
+  const size_t num = a.size();
+  YACL_ENFORCE(num == b.size() && num == c.size() && num == r.size());
   if (cache_.DyBeaverSetCacheSize() >= num) {
-    return cache_.DyBeaverTripleSet(num);
+    return cache_.DyBeaverTripleSet(a, b, c, r);
+  }
+  SPDLOG_DEBUG("Miss match");
+  DyBeaverTripleSet(a, b, c, r);
+  return dy_key_;
+}
+
+ScalarDyBeaverTy Correlation::ScalarDyBeaverTripleSet(size_t num) {
+  if (cache_.ScalarDyBeaverSetCacheSize() >= num) {
+    return cache_.ScalarDyBeaverTripleSet(num);
+  }
+  SPDLOG_DEBUG("Miss match");
+  ScalarDyBeaverTy ret(num);
+  RandomAuth(absl::MakeSpan(&ret.t, 1));
+  ScalarDyBeaverTripleSet(ret.t, absl::MakeSpan(ret.a), absl::MakeSpan(ret.b),
+                          absl::MakeSpan(ret.c), absl::MakeSpan(ret.r),
+                          absl::MakeSpan(ret.s));
+  ret.k = dy_key_;
+  return ret;
+}
+
+ScalarDyBeaverTy Correlation::ScalarDyBeaverTripleGet(size_t num) {
+  if (cache_.ScalarDyBeaverGetCacheSize() >= num) {
+    return cache_.ScalarDyBeaverTripleGet(num);
   }
   SPDLOG_DEBUG("Miss match");
-  std::vector<internal::ATy> a(num);
-  std::vector<internal::ATy> b(num);
-  std::vector<internal::ATy> c(num);
-  std::vector<internal::ATy> r(num);
-  DyBeaverTripleSet(absl::MakeSpan(a), absl::MakeSpan(b), absl::MakeSpan(c),
-                    absl::MakeSpan(r));
-  return DyBeaverSetTy(std::move(a), std::move(b), std::move(c), std::move(r),
-                       dy_key_);
+  ScalarDyBeaverTy ret(num);
+  RandomAuth(absl::MakeSpan(&ret.t, 1));
+  ScalarDyBeaverTripleGet(ret.t, absl::MakeSpan(ret.a), absl::MakeSpan(ret.b),
+                          absl::MakeSpan(ret.c), absl::MakeSpan(ret.r),
+                          absl::MakeSpan(ret.s));
+  ret.k = dy_key_;
+  return ret;
 }
 
 AuthTy Correlation::RandomSet(size_t num) {
@@ -114,7 +198,9 @@ void Correlation::force_cache(size_t beaver_num, size_t dy_beaver_set_num,
                               size_t dy_beaver_get_num, size_t rand_set_num,
                               size_t rand_get_num,
                               const std::vector<uint64_t>& shuffle_set_shape,
-                              const std::vector<uint64_t>& shuffle_get_shape) {
+                              const std::vector<uint64_t>& shuffle_get_shape,
+                              size_t scalar_dy_beaver_set_num,
+                              size_t scalar_dy_beaver_get_num) {
   // cache_ = CorrelationCache(); // RESET IT
   // beaver
   if (beaver_num != 0) {
@@ -181,6 +267,42 @@ void Correlation::force_cache(size_t beaver_num, size_t dy_beaver_set_num,
       SPDLOG_DEBUG("DY-BEAVER SET NUM is zero, skip it");
     }
   }
+  // scalar dy-beaver
+  {
+    auto gen_set = [&]() {
+      if (scalar_dy_beaver_set_num == 0) {
+        SPDLOG_DEBUG("SCALAR DY-BEAVER SET NUM is zero, skip it");
+        return;
+      }
+      auto& cache = cache_.scalar_dy_beaver_set_cache;
+      cache = ScalarDyBeaverTy(scalar_dy_beaver_set_num);
+      RandomAuth(absl::MakeSpan(&cache.t, 1));
+      ScalarDyBeaverTripleSet(cache.t, absl::MakeSpan(cache.a),
+                              absl::MakeSpan(cache.b), absl::MakeSpan(cache.c),
+                              absl::MakeSpan(cache.r), absl::MakeSpan(cache.s));
+      cache.k = dy_key_;
+    };
+    auto gen_get = [&]() {
+      if (scalar_dy_beaver_get_num == 0) {
+        SPDLOG_DEBUG("SCALAR DY-BEAVER GET NUM is zero, skip it");
+        return;
+      }
+      auto& cache = cache_.scalar_dy_beaver_get_cache;
+      cache = ScalarDyBeaverTy(scalar_dy_beaver_get_num);
+      RandomAuth(absl::MakeSpan(&cache.t, 1));
+      ScalarDyBeaverTripleGet(cache.t, absl::MakeSpan(cache.a),
+                              absl::MakeSpan(cache.b), absl::MakeSpan(cache.c),
+                              absl::MakeSpan(cache.r), absl::MakeSpan(cache.s));
+      cache.k = dy_key_;
+    };
+    if (ctx_->GetRank() == 0) {
+      gen_set();
+      gen_get();
+    } else {
+      gen_get();
+      gen_set();
+    }
+  }
   // random
   {
     cache_.random_set_cache = AuthTy(rand_set_num);
@@ -238,65 +360,60 @@ void Correlation::force_cache(size_t beaver_num, size_t dy_beaver_set_num,
 }
 
 BeaverTy CorrelationCache::BeaverTriple(size_t num) {
-  const size_t remain = BeaverCacheSize();
-  YACL_ENFORCE(num <= remain);
-  // copy
-  std::vector<internal::ATy> a(beaver_cache.a.end() - num,
-                               beaver_cache.a.end());
-  std::vector<internal::ATy> b(beaver_cache.b.end() - num,
-                               beaver_cache.b.end());
-  std::vector<internal::ATy> c(beaver_cache.c.end() - num,
-                               beaver_cache.c.end());
-  // resize
-  beaver_cache.a.resize(remain - num);
-  beaver_cache.b.resize(remain - num);
-  beaver_cache.c.resize(remain - num);
+  BeaverTy ret(num);
+  BeaverTriple(absl::MakeSpan(ret.a), absl::MakeSpan(ret.b),
+               absl::MakeSpan(ret.c));
+  return ret;
+}
 
-  return BeaverTy(std::move(a), std::move(b), std::move(c));
+void CorrelationCache::BeaverTriple(absl::Span<internal::ATy> a,
+                                    absl::Span<internal::ATy> b,
+                                    absl::Span<internal::ATy> c) {
+  TakeTail(beaver_cache.a, a);
+  TakeTail(beaver_cache.b, b);
+  TakeTail(beaver_cache.c, c);
 }
 
 DyBeaverSetTy CorrelationCache::DyBeaverTripleSet(size_t num) {
-  const size_t remain = DyBeaverSetCacheSize();
-  YACL_ENFORCE(num <= remain);
-  // copy
-  std::vector<internal::ATy> a(dy_beaver_set_cache.a.end() - num,
-                               dy_beaver_set_cache.a.end());
-  std::vector<internal::ATy> b(dy_beaver_set_cache.b.end() - num,
-                               dy_beaver_set_cache.b.end());
-  std::vector<internal::ATy> c(dy_beaver_set_cache.c.end() - num,
-                               dy_beaver_set_cache.c.end());
-  std::vector<internal::ATy> r(dy_beaver_set_cache.r.end() - num,
-                               dy_beaver_set_cache.r.end());
-  // resize
-  dy_beaver_set_cache.a.resize(remain - num);
-  dy_beaver_set_cache.b.resize(remain - num);
-  dy_beaver_set_cache.c.resize(remain - num);
-  dy_beaver_set_cache.r.resize(remain - num);
+  DyBeaverSetTy ret(num);
+  ret.k = DyBeaverTripleSet(absl::MakeSpan(ret.a), absl::MakeSpan(ret.b),
+                            absl::MakeSpan(ret.c), absl::MakeSpan(ret.r));
+  return ret;
+}
 
-  return DyBeaverSetTy(std::move(a), std::move(b), std::move(c), std::move(r),
-                       dy_beaver_set_cache.k);
+internal::ATy CorrelationCache::DyBeaverTripleSet(
+    absl::Span<internal::ATy> a, absl::Span<internal::ATy> b,
+    absl::Span<internal::ATy> c, absl::Span<internal::ATy> r) {
+  TakeTail(dy_beaver_set_cache.a, a);
+  TakeTail(dy_beaver_set_cache.b, b);
+  TakeTail(dy_beaver_set_cache.c, c);
+  TakeTail(dy_beaver_set_cache.r, r);
+  return dy_beaver_set_cache.k;
 }
 
 DyBeaverGetTy CorrelationCache::DyBeaverTripleGet(size_t num) {
-  const size_t remain = DyBeaverGetCacheSize();
-  YACL_ENFORCE(num <= remain);
-  // copy
-  std::vector<internal::ATy> a(dy_beaver_get_cache.a.end() - num,
-                               dy_beaver_get_cache.a.end());
-  std::vector<internal::ATy> b(dy_beaver_get_cache.b.end() - num,
-                               dy_beaver_get_cache.b.end());
-  std::vector<internal::ATy> c(dy_beaver_get_cache.c.end() - num,
-                               dy_beaver_get_cache.c.end());
-  std::vector<internal::ATy> r(dy_beaver_get_cache.r.end() - num,
-                               dy_beaver_get_cache.r.end());
-  // resize
-  dy_beaver_get_cache.a.resize(remain - num);
-  dy_beaver_get_cache.b.resize(remain - num);
-  dy_beaver_get_cache.c.resize(remain - num);
-  dy_beaver_get_cache.r.resize(remain - num);
+  DyBeaverGetTy ret(num);
+  ret.k = DyBeaverTripleGet(absl::MakeSpan(ret.a), absl::MakeSpan(ret.b),
+                            absl::MakeSpan(ret.c), absl::MakeSpan(ret.r));
+  return ret;
+}
+
+internal::ATy CorrelationCache::DyBeaverTripleGet(
+    absl::Span<internal::ATy> a, absl::Span<internal::ATy> b,
+    absl::Span<internal::ATy> c, absl::Span<internal::ATy> r) {
+  TakeTail(dy_beaver_get_cache.a, a);
+  TakeTail(dy_beaver_get_cache.b, b);
+  TakeTail(dy_beaver_get_cache.c, c);
+  TakeTail(dy_beaver_get_cache.r, r);
+  return dy_beaver_get_cache.k;
+}
+
+ScalarDyBeaverTy CorrelationCache::ScalarDyBeaverTripleSet(size_t num) {
+  return TakeScalarDyBeaver(scalar_dy_beaver_set_cache, num);
+}
 
-  return DyBeaverGetTy(std::move(a), std::move(b), std::move(c), std::move(r),
-                       dy_beaver_get_cache.k);
+ScalarDyBeaverTy CorrelationCache::ScalarDyBeaverTripleGet(size_t num) {
+  return TakeScalarDyBeaver(scalar_dy_beaver_get_cache, num);
 }
 
 AuthTy CorrelationCache::RandomSet(size_t num) {
@@ -82,6 +82,32 @@ struct DyBeaverGetTy {
   }
 };
 
+// DyBeaver tuple for the fair (scalar) DY-exponent
+// > a, b, c, r, k : the same as DyBeaverSetTy / DyBeaverGetTy
+// > t             : random mask (A-share), fresh for each generation
+// > s             : [a * t]
+struct ScalarDyBeaverTy {
+  // half beaver triple
+  std::vector<internal::ATy> a;
+  std::vector<internal::ATy> b;
+  std::vector<internal::ATy> c;
+  // DyExp randomness
+  std::vector<internal::ATy> r;
+  internal::ATy k;
+  // scalar randomness
+  std::vector<internal::ATy> s;
+  internal::ATy t;
+
+  ScalarDyBeaverTy() { ; }
+  ScalarDyBeaverTy(uint32_t n) {
+    a.resize(n);
+    b.resize(n);
+    c.resize(n);
+    r.resize(n);
+    s.resize(n);
+  }
+};
+
 struct AuthTy {
   std::vector<internal::ATy> data;
   AuthTy() { ; }
@@ -122,6 +148,8 @@ struct CorrelationCache {
   BeaverTy beaver_cache;
   DyBeaverSetTy dy_beaver_set_cache;
   DyBeaverGetTy dy_beaver_get_cache;
+  ScalarDyBeaverTy scalar_dy_beaver_set_cache;
+  ScalarDyBeaverTy scalar_dy_beaver_get_cache;
   AuthTy random_set_cache;
   AuthTy random_get_cache;
   std::unordered_map<uint64_t, std::vector<ShuffleSTy>> shuffle_set_cache;
@@ -130,6 +158,12 @@ struct CorrelationCache {
   size_t BeaverCacheSize() { return beaver_cache.a.size(); }
   size_t DyBeaverSetCacheSize() { return dy_beaver_set_cache.a.size(); }
   size_t DyBeaverGetCacheSize() { return dy_beaver_get_cache.a.size(); }
+  size_t ScalarDyBeaverSetCacheSize() {
+    return scalar_dy_beaver_set_cache.a.size();
+  }
+  size_t ScalarDyBeaverGetCacheSize() {
+    return scalar_dy_beaver_get_cache.a.size();
+  }
   size_t RandomSetSize() { return random_set_cache.data.size(); }
   size_t RandomGetSize() { return random_get_cache.data.size(); }
   size_t ShuffleSetCount(size_t num, size_t repeat = 1) {
@@ -152,10 +186,24 @@ struct CorrelationCache {
   BeaverTy BeaverTriple(size_t num);
   DyBeaverSetTy DyBeaverTripleSet(size_t num);
   DyBeaverGetTy DyBeaverTripleGet(size_t num);
+  ScalarDyBeaverTy ScalarDyBeaverTripleSet(size_t num);
+  ScalarDyBeaverTy ScalarDyBeaverTripleGet(size_t num);
   AuthTy RandomSet(size_t num);
   AuthTy RandomGet(size_t num);
   ShuffleSTy ShuffleSet(size_t num, size_t repeat = 1);
   ShuffleGTy ShuffleGet(size_t num, size_t repeat = 1);
+
+  // the same, into the given storage (returns the DY-PRF key)
+  void BeaverTriple(absl::Span<internal::ATy> a, absl::Span<internal::ATy> b,
+                    absl::Span<internal::ATy> c);
+  internal::ATy DyBeaverTripleSet(absl::Span<internal::ATy> a,
+                                  absl::Span<internal::ATy> b,
+                                  absl::Span<internal::ATy> c,
+                                  absl::Span<internal::ATy> r);
+  internal::ATy DyBeaverTripleGet(absl::Span<internal::ATy> a,
+                                  absl::Span<internal::ATy> b,
+                                  absl::Span<internal::ATy> c,
+                                  absl::Span<internal::ATy> r);
 };
 
 class Correlation : public State {
@@ -167,6 +215,7 @@ class Correlation : public State {
 
  public:
   static const std::string id;
+  static constexpr StateSlot slot = StateSlot::kCorrelation;
   // DY-OPRF key
   internal::ATy dy_key_;
 
@@ -180,6 +229,9 @@ class Correlation : public State {
 
   virtual internal::ATy GetDyKey() const { return dy_key_; }
 
+  // NOTE: only after OneTimeSetup, e.g. restore a persisted DY-PRF key
+  virtual void SetDyKey(const internal::ATy& dy_key) { dy_key_ = dy_key; }
+
   virtual void OneTimeSetup() = 0;
 
   // implementation
@@ -194,6 +246,19 @@ class Correlation : public State {
                                  absl::Span<internal::ATy> b,
                                  absl::Span<internal::ATy> c,
                                  absl::Span<internal::ATy> r) = 0;
+  // DyBeaverTripleSet / DyBeaverTripleGet, plus [s] = [a * t]
+  virtual void ScalarDyBeaverTripleSet(const internal::ATy& t,
+                                       absl::Span<internal::ATy> a,
+                                       absl::Span<internal::ATy> b,
+                                       absl::Span<internal::ATy> c,
+                                       absl::Span<internal::ATy> r,
+                                       absl::Span<internal::ATy> s) = 0;
+  virtual void ScalarDyBeaverTripleGet(const internal::ATy& t,
+                                       absl::Span<internal::ATy> a,
+                                       absl::Span<internal::ATy> b,
+                                       absl::Span<internal::ATy> c,
+                                       absl::Span<internal::ATy> r,
+                                       absl::Span<internal::ATy> s) = 0;
 
   virtual void RandomSet(absl::Span<internal::ATy> out) = 0;
   virtual void RandomGet(absl::Span<internal::ATy> out) = 0;
@@ -208,17 +273,38 @@ class Correlation : public State {
   BeaverTy BeaverTriple(size_t num);
   DyBeaverSetTy DyBeaverTripleSet(size_t num);
   DyBeaverGetTy DyBeaverTripleGet(size_t num);
+  // NOTE: all tuples of one call share the mask [t], use them for a single
+  // scalar only; each call draws a fresh [t] (a cache hit takes the cached
+  // [t] && drops the rest of the cache)
+  ScalarDyBeaverTy ScalarDyBeaverTripleSet(size_t num);
+  ScalarDyBeaverTy ScalarDyBeaverTripleGet(size_t num);
   AuthTy RandomSet(size_t num);
   AuthTy RandomGet(size_t num);
   AuthTy RandomAuth(size_t num);
   ShuffleSTy ShuffleSet(size_t num, size_t repeat = 1);
   ShuffleGTy ShuffleGet(size_t num, size_t repeat = 1);
 
+  // interface, into the given storage (e.g. the arena of the context)
+  void FillBeaverTriple(absl::Span<internal::ATy> a,
+                        absl::Span<internal::ATy> b,
+                        absl::Span<internal::ATy> c);
+  // returns the DY-PRF key of the tuples
+  internal::ATy FillDyBeaverTripleSet(absl::Span<internal::ATy> a,
+                                      absl::Span<internal::ATy> b,
+                                      absl::Span<internal::ATy> c,
+                                      absl::Span<internal::ATy> r);
+  internal::ATy FillDyBeaverTripleGet(absl::Span<internal::ATy> a,
+                                      absl::Span<internal::ATy> b,
+                                      absl::Span<internal::ATy> c,
+                                      absl::Span<internal::ATy> r);
+
   // ------------ cache -------------
  private:
   size_t b_num_{0};
   size_t b_s_num_{0};
   size_t b_g_num_{0};
+  size_t sb_s_num_{0};
+  size_t sb_g_num_{0};
   size_t r_s_num_{0};
   size_t r_g_num_{0};
   std::vector<uint64_t> s_s_shape_;
@@ -230,6 +316,8 @@ class Correlation : public State {
   void BeaverTriple_cache(size_t num) { b_num_ += num; }
   void DyBeaverTripleSet_cache(size_t num) { b_s_num_ += num; }
   void DyBeaverTripleGet_cache(size_t num) { b_g_num_ += num; }
+  void ScalarDyBeaverTripleSet_cache(size_t num) { sb_s_num_ += num; }
+  void ScalarDyBeaverTripleGet_cache(size_t num) { sb_g_num_ += num; }
   void RandomSet_cache(size_t num) { r_s_num_ += num; }
   void RandomGet_cache(size_t num) { r_g_num_ += num; }
   void RandomAuth_cache(size_t num) {
@@ -247,19 +335,22 @@ class Correlation : public State {
   void force_cache() {
     SPDLOG_INFO(
         "[P{}] FORCE CACHE!!! beaver num : {} , dy beaver get num : {} , dy "
+        "beaver set num : {} , scalar dy beaver get num : {} , scalar dy "
         "beaver set num : {} , random set num : {} , random "
         "get num: {} , shuffle set num: {} , shuffle get num: {} ",
-        ctx_->GetRank(), b_num_, b_s_num_, b_g_num_, r_s_num_, r_g_num_,
-        s_s_shape_.size(), s_g_shape_.size());
+        ctx_->GetRank(), b_num_, b_g_num_, b_s_num_, sb_g_num_, sb_s_num_,
+        r_s_num_, r_g_num_, s_s_shape_.size(), s_g_shape_.size());
     force_cache(b_num_, b_s_num_, b_g_num_, r_s_num_, r_g_num_, s_s_shape_,
-                s_g_shape_);
+                s_g_shape_, sb_s_num_, sb_g_num_);
   }
 
   void force_cache(size_t beaver_num, size_t dy_beaver_set_num,
                    size_t dy_beaver_get_num, size_t rand_set_num,
                    size_t rand_get_num,
                    const std::vector<uint64_t>& shuffle_set_shape = {},
-                   const std::vector<uint64_t>& shuffle_get_shape = {});
+                   const std::vector<uint64_t>& shuffle_get_shape = {},
+                   size_t scalar_dy_beaver_set_num = 0,
+                   size_t scalar_dy_beaver_get_num = 0);
 };
 
 }  // namespace mcpsi
@@ -0,0 +1,89 @@
+#include "benchmark/benchmark.h"
+#include "mcpsi/cr/cr.h"
+#include "mcpsi/utils/bench_util.h"
+
+namespace mcpsi {
+
+namespace {
+
+// Benchmark arguments: {size, threads, CR mode}
+void CorrelationArgs(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"size", "threads", "CR"});
+  for (int64_t CR_mode : {0, 1}) {
+    for (int64_t size : {1 << 10, 1 << 14}) {
+      for (int64_t thread : {1, 4}) {
+        b->Args({size, thread, CR_mode});
+      }
+    }
+  }
+  b->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
+void BM_BeaverTriple(benchmark::State& state) {
+  const size_t num = state.range(0);
+  yacl::set_num_threads(state.range(1));
+  auto& ctxs = bench::GetBenchContext(state.range(2) != 0);
+  auto begin = bench::GetCommStats(ctxs[0]);
+  for (auto _ : state) {
+    bench::RunParties(ctxs, [&](std::shared_ptr<Context>& ctx) {
+      return ctx->GetState<Correlation>()->BeaverTriple(num);
+    });
+  }
+  bench::ReportCounters(state, num, begin, bench::GetCommStats(ctxs[0]));
+}
+
+void BM_DyBeaverTriple(benchmark::State& state) {
+  const size_t num = state.range(0);
+  yacl::set_num_threads(state.range(1));
+  auto& ctxs = bench::GetBenchContext(state.range(2) != 0);
+  auto begin = bench::GetCommStats(ctxs[0]);
+  for (auto _ : state) {
+    bench::RunParties(ctxs, [&](std::shared_ptr<Context>& ctx) {
+      auto cr = ctx->GetState<Correlation>();
+      if (ctx->GetRank() == 0) {
+        return cr->DyBeaverTripleSet(num).a.size();
+      }
+      return cr->DyBeaverTripleGet(num).a.size();
+    });
+  }
+  bench::ReportCounters(state, num, begin, bench::GetCommStats(ctxs[0]));
+}
+
+void BM_RandomAuth(benchmark::State& state) {
+  const size_t num = state.range(0);
+  yacl::set_num_threads(state.range(1));
+  auto& ctxs = bench::GetBenchContext(state.range(2) != 0);
+  auto begin = bench::GetCommStats(ctxs[0]);
+  for (auto _ : state) {
+    bench::RunParties(ctxs, [&](std::shared_ptr<Context>& ctx) {
+      return ctx->GetState<Correlation>()->RandomAuth(num);
+    });
+  }
+  bench::ReportCounters(state, num, begin, bench::GetCommStats(ctxs[0]));
+}
+
+void BM_Shuffle(benchmark::State& state) {
+  const size_t num = state.range(0);
+  yacl::set_num_threads(state.range(1));
+  auto& ctxs = bench::GetBenchContext(state.range(2) != 0);
+  auto begin = bench::GetCommStats(ctxs[0]);
+  for (auto _ : state) {
+    bench::RunParties(ctxs, [&](std::shared_ptr<Context>& ctx) {
+      auto cr = ctx->GetState<Correlation>();
+      if (ctx->GetRank() == 0) {
+        return cr->ShuffleSet(num).delta.size();
+      }
+      return cr->ShuffleGet(num).a.size();
+    });
+  }
+  bench::ReportCounters(state, num, begin, bench::GetCommStats(ctxs[0]));
+}
+
+}  // namespace
+
+BENCHMARK(BM_BeaverTriple)->Apply(CorrelationArgs);
+BENCHMARK(BM_DyBeaverTriple)->Apply(CorrelationArgs);
+BENCHMARK(BM_RandomAuth)->Apply(CorrelationArgs);
+BENCHMARK(BM_Shuffle)->Apply(CorrelationArgs);
+
+}  // namespace mcpsi
@@ -164,6 +164,74 @@ TEST(CrTest, AuthBeaverCacheWork) {
   }
 }
 
+TEST(CrTest, ScalarDyBeaverWork) {
+  auto context = TestParam::GetContext();
+  const size_t num = 1000;
+
+  auto rank0 = std::async([&] {
+    auto cr = context[0]->GetState<Correlation>();
+    return std::make_pair(cr->ScalarDyBeaverTripleSet(num), cr->GetKey());
+  });
+  auto rank1 = std::async([&] {
+    auto cr = context[1]->GetState<Correlation>();
+    return std::make_pair(cr->ScalarDyBeaverTripleGet(num), cr->GetKey());
+  });
+
+  auto [ret0, key0] = rank0.get();
+  auto [ret1, key1] = rank1.get();
+  auto key = key0 + key1;
+  auto k = ret0.k.val + ret1.k.val;
+  auto t = ret0.t.val + ret1.t.val;
+  EXPECT_EQ(ret0.t.mac + ret1.t.mac, key * t);
+
+  for (size_t i = 0; i < num; ++i) {
+    auto a = ret0.a[i].val + ret1.a[i].val;
+    auto b = ret0.b[i].val + ret1.b[i].val;
+    auto c = ret0.c[i].val + ret1.c[i].val;
+    auto r = ret0.r[i].val + ret1.r[i].val;
+    auto s = ret0.s[i].val + ret1.s[i].val;
+    EXPECT_EQ(b, ret0.b[i].val);
+    EXPECT_EQ(a * b, c);
+    EXPECT_EQ(a * k, r);
+    EXPECT_EQ(a * t, s);
+    EXPECT_EQ(ret0.s[i].mac + ret1.s[i].mac, key * s);
+  }
+}
+
+TEST(CrTest, ScalarDyBeaverCacheWork) {
+  auto context = TestParam::GetContext();
+  const size_t num = 1000;
+
+  auto rank0 = std::async([&] {
+    auto cr = context[0]->GetState<Correlation>();
+    cr->force_cache(0, 0, 0, 0, 0, {}, {}, num, 0);
+    auto first = cr->ScalarDyBeaverTripleSet(num / 2);
+    return std::make_pair(first, cr->ScalarDyBeaverTripleSet(num / 2));
+  });
+  auto rank1 = std::async([&] {
+    auto cr = context[1]->GetState<Correlation>();
+    cr->force_cache(0, 0, 0, 0, 0, {}, {}, 0, num);
+    auto first = cr->ScalarDyBeaverTripleGet(num / 2);
+    return std::make_pair(first, cr->ScalarDyBeaverTripleGet(num / 2));
+  });
+
+  auto [first0, second0] = rank0.get();
+  auto [first1, second1] = rank1.get();
+  // the first take drops the cache, the second one comes with a fresh mask
+  auto t = first0.t.val + first1.t.val;
+  auto fresh_t = second0.t.val + second1.t.val;
+  EXPECT_NE(t, fresh_t);
+
+  for (size_t i = 0; i < num / 2; ++i) {
+    auto a = first0.a[i].val + first1.a[i].val;
+    auto s = first0.s[i].val + first1.s[i].val;
+    EXPECT_EQ(a * t, s);
+    auto fresh_a = second0.a[i].val + second1.a[i].val;
+    auto fresh_s = second0.s[i].val + second1.s[i].val;
+    EXPECT_EQ(fresh_a * fresh_t, fresh_s);
+  }
+}
+
 TEST(CrTest, AuthDyBeaverCacheWork) {
   auto context = TestParam::GetContext();
   const size_t num = 1000;
@@ -0,0 +1,493 @@
+#include "mcpsi/cr/dealer_cr.h"
+
+#include <cstring>
+
+#include "mcpsi/utils/vec_op.h"
+#include "yacl/crypto/utils/rand.h"
+#include "yacl/utils/parallel.h"
+
+namespace mcpsi {
+
+namespace {
+
+using internal::ATy;
+using internal::PTy;
+
+constexpr size_t kGrain = 4096;
+
+// ranks on the link between a party && the dealer
+constexpr size_t kPartyRank = 0;
+constexpr size_t kDealerRank = 1;
+
+constexpr char kRequestTag[] = "Dealer:Request";
+constexpr char kReplyTag[] = "Dealer:Reply";
+
+// a request is the header && its payload
+struct Header {
+  DealerOp op;
+  uint64_t num;     // tuples, or the batch size of a shuffle
+  uint64_t repeat;  // shuffles only
+};
+
+// the (val, mac) slots of the a-shares, the shares are sampled straight into
+// them && then rewritten in place
+absl::Span<PTy> Slots(absl::Span<ATy> in) {
+  return absl::MakeSpan(reinterpret_cast<PTy*>(in.data()), 2 * in.size());
+}
+
+// the request of the other party, Set && Get go in pairs
+DealerOp Peer(DealerOp op) {
+  switch (op) {
+    case DealerOp::kDyBeaverSet:
+      return DealerOp::kDyBeaverGet;
+    case DealerOp::kDyBeaverGet:
+      return DealerOp::kDyBeaverSet;
+    case DealerOp::kScalarDyBeaverSet:
+      return DealerOp::kScalarDyBeaverGet;
+    case DealerOp::kScalarDyBeaverGet:
+      return DealerOp::kScalarDyBeaverSet;
+    case DealerOp::kRandomSet:
+      return DealerOp::kRandomGet;
+    case DealerOp::kRandomGet:
+      return DealerOp::kRandomSet;
+    case DealerOp::kShuffleSet:
+      return DealerOp::kShuffleGet;
+    case DealerOp::kShuffleGet:
+      return DealerOp::kShuffleSet;
+    default:
+      return op;
+  }
+}
+
+// the getter of RandomGet holds a zero share of the value
+bool KeepVal(DealerOp op) { return op != DealerOp::kRandomGet; }
+
+Header ParseHeader(const yacl::Buffer& buf) {
+  YACL_ENFORCE(static_cast<uint64_t>(buf.size()) >= sizeof(Header));
+  Header header;
+  std::memcpy(&header, buf.data(), sizeof(Header));
+  return header;
+}
+
+// NOTE: copied out, the payload is not aligned for T
+template <typename T>
+std::vector<T> ParsePayload(const yacl::Buffer& buf, size_t num) {
+  YACL_ENFORCE(static_cast<uint64_t>(buf.size()) ==
+               sizeof(Header) + num * sizeof(T));
+  std::vector<T> ret(num);
+  std::memcpy(ret.data(), buf.data<uint8_t>() + sizeof(Header),
+              num * sizeof(T));
+  return ret;
+}
+
+}  // namespace
+
+// register string
+const std::string DealerLink::id = std::string("DealerLink");
+
+DealerCorrelation::DealerCorrelation(std::shared_ptr<Context> ctx)
+    : Correlation(ctx), link_(ctx->GetState<DealerLink>()) {}
+
+DealerCorrelation::~DealerCorrelation() {
+  try {
+    Stop();
+  } catch (const std::exception& e) {
+    SPDLOG_WARN("[P{}] fail to stop the dealer: {}", ctx_->GetRank(),
+                e.what());
+  }
+}
+
+void DealerCorrelation::Stop() {
+  if (!stopped_) {
+    Request(DealerOp::kStop, 0);
+    stopped_ = true;
+  }
+}
+
+void DealerCorrelation::Request(DealerOp op, size_t num, size_t repeat,
+                                yacl::ByteContainerView payload) {
+  const Header header{op, num, repeat};
+  yacl::Buffer buf(sizeof(Header) + payload.size());
+  std::memcpy(buf.data(), &header, sizeof(Header));
+  if (payload.size() != 0) {
+    std::memcpy(buf.data<uint8_t>() + sizeof(Header), payload.data(),
+                payload.size());
+  }
+  link_->SendAsync(kDealerRank, std::move(buf), kRequestTag);
+}
+
+yacl::Buffer DealerCorrelation::Reply(size_t num) {
+  auto buf = link_->Recv(kDealerRank, kReplyTag);
+  YACL_ENFORCE(static_cast<uint64_t>(buf.size()) == num * sizeof(PTy));
+  return buf;
+}
+
+void DealerCorrelation::OneTimeSetup() {
+  Request(DealerOp::kSetup, 1, 1, yacl::ByteContainerView(&key_, sizeof(PTy)));
+  auto buf = link_->Recv(kDealerRank, kReplyTag);
+  YACL_ENFORCE(static_cast<uint64_t>(buf.size()) == sizeof(uint128_t));
+  uint128_t seed;
+  std::memcpy(&seed, buf.data(), sizeof(seed));
+  prg_ = std::make_unique<yacl::crypto::Prg<uint8_t>>(seed);
+
+  Random(DealerOp::kDyKey, absl::MakeSpan(&dy_key_, 1));
+}
+
+void DealerCorrelation::SetDyKey(const ATy& dy_key) {
+  dy_key_ = dy_key;
+  Request(DealerOp::kSetDyKey, 1, 1,
+          yacl::ByteContainerView(&dy_key_.val, sizeof(PTy)));
+}
+
+void DealerCorrelation::BeaverTriple(absl::Span<ATy> a, absl::Span<ATy> b,
+                                     absl::Span<ATy> c) {
+  const size_t num = c.size();
+  YACL_ENFORCE(num == a.size());
+  YACL_ENFORCE(num == b.size());
+  Request(DealerOp::kBeaver, num);
+
+  // party0: all from its seed, party1: the values of a && b
+  internal::op::Rand(*prg_, Slots(a));
+  internal::op::Rand(*prg_, Slots(b));
+  if (ctx_->GetRank() == 0) {
+    internal::op::Rand(*prg_, Slots(c));
+    return;
+  }
+
+  // (mac_a, mac_b, c, mac_c)
+  auto buf = Reply(4 * num);
+  auto corr = reinterpret_cast<const PTy*>(buf.data());
+  yacl::parallel_for(0, num, kGrain, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      a[i].mac = corr[4 * i];
+      b[i].mac = corr[4 * i + 1];
+      c[i] = {corr[4 * i + 2], corr[4 * i + 3]};
+    }
+  });
+}
+
+void DealerCorrelation::DyBeaverTripleSet(absl::Span<ATy> a, absl::Span<ATy> b,
+                                          absl::Span<ATy> c,
+                                          absl::Span<ATy> r) {
+  DyBeaverTriple(true, a, b, c, r);
+}
+
+void DealerCorrelation::DyBeaverTripleGet(absl::Span<ATy> a, absl::Span<ATy> b,
+                                          absl::Span<ATy> c,
+                                          absl::Span<ATy> r) {
+  DyBeaverTriple(false, a, b, c, r);
+}
+
+void DealerCorrelation::ScalarDyBeaverTripleSet(const ATy& t,
+                                                absl::Span<ATy> a,
+                                                absl::Span<ATy> b,
+                                                absl::Span<ATy> c,
+                                                absl::Span<ATy> r,
+                                                absl::Span<ATy> s) {
+  DyBeaverTriple(true, a, b, c, r, &t, s);
+}
+
+void DealerCorrelation::ScalarDyBeaverTripleGet(const ATy& t,
+                                                absl::Span<ATy> a,
+                                                absl::Span<ATy> b,
+                                                absl::Span<ATy> c,
+                                                absl::Span<ATy> r,
+                                                absl::Span<ATy> s) {
+  DyBeaverTriple(false, a, b, c, r, &t, s);
+}
+
+void DealerCorrelation::DyBeaverTriple(bool is_set, absl::Span<ATy> a,
+                                       absl::Span<ATy> b, absl::Span<ATy> c,
+                                       absl::Span<ATy> r, const ATy* t,
+                                       absl::Span<ATy> s) {
+  const size_t num = c.size();
+  YACL_ENFORCE(num == a.size());
+  YACL_ENFORCE(num == b.size());
+  YACL_ENFORCE(num == r.size());
+  YACL_ENFORCE(t == nullptr || num == s.size());
+  if (t == nullptr) {
+    Request(is_set ? DealerOp::kDyBeaverSet : DealerOp::kDyBeaverGet, num);
+  } else {
+    // the dealer opens t
+    Request(is_set ? DealerOp::kScalarDyBeaverSet
+                   : DealerOp::kScalarDyBeaverGet,
+            num, 1, yacl::ByteContainerView(&t->val, sizeof(PTy)));
+  }
+
+  // a from both seeds, b from the one of the setter (public to the setter)
+  internal::op::Rand(*prg_, Slots(a));
+  internal::op::Rand(*prg_, Slots(b));
+  if (ctx_->GetRank() == 0) {
+    internal::op::Rand(*prg_, Slots(c));
+    internal::op::Rand(*prg_, Slots(r));
+    if (t != nullptr) {
+      internal::op::Rand(*prg_, Slots(s));
+    }
+    if (!is_set) {
+      for (auto& e : b) {
+        e.val = PTy::Zero();
+      }
+    }
+    return;
+  }
+
+  // (mac_a, mac_b, c, mac_c, r, mac_r) && (s, mac_s)
+  const size_t width = t == nullptr ? 6 : 8;
+  auto buf = Reply(width * num);
+  auto corr = reinterpret_cast<const PTy*>(buf.data());
+  yacl::parallel_for(0, num, kGrain, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      const PTy* w = corr + width * i;
+      a[i].mac = w[0];
+      b[i] = {is_set ? b[i].val : PTy::Zero(), w[1]};
+      c[i] = {w[2], w[3]};
+      r[i] = {w[4], w[5]};
+      if (t != nullptr) {
+        s[i] = {w[6], w[7]};
+      }
+    }
+  });
+}
+
+void DealerCorrelation::RandomSet(absl::Span<ATy> out) {
+  Random(DealerOp::kRandomSet, out);
+}
+
+void DealerCorrelation::RandomGet(absl::Span<ATy> out) {
+  Random(DealerOp::kRandomGet, out);
+}
+
+void DealerCorrelation::RandomAuth(absl::Span<ATy> out) {
+  Random(DealerOp::kRandomAuth, out);
+}
+
+void DealerCorrelation::Random(DealerOp op, absl::Span<ATy> out) {
+  const size_t num = out.size();
+  Request(op, num);
+
+  // the value from the seeds of the setters (both for RandomAuth)
+  internal::op::Rand(*prg_, Slots(out));
+  if (ctx_->GetRank() == 0) {
+    if (!KeepVal(op)) {
+      for (auto& e : out) {
+        e.val = PTy::Zero();
+      }
+    }
+    return;
+  }
+
+  auto buf = Reply(num);
+  auto corr = reinterpret_cast<const PTy*>(buf.data());
+  yacl::parallel_for(0, num, kGrain, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      out[i] = {KeepVal(op) ? out[i].val : PTy::Zero(), corr[i]};
+    }
+  });
+}
+
+void DealerCorrelation::ShuffleSet(absl::Span<const size_t> perm,
+                                   absl::Span<PTy> delta, size_t repeat) {
+  const size_t batch_size = perm.size();
+  const size_t full_size = delta.size();
+  YACL_ENFORCE(batch_size * repeat == full_size);
+
+  // the dealer learns the permutation
+  Request(DealerOp::kShuffleSet, batch_size, repeat,
+          yacl::ByteContainerView(perm.data(), batch_size * sizeof(size_t)));
+  auto buf = Reply(full_size);
+  std::memcpy(delta.data(), buf.data(), full_size * sizeof(PTy));
+}
+
+void DealerCorrelation::ShuffleGet(absl::Span<PTy> a, absl::Span<PTy> b,
+                                   size_t repeat) {
+  const size_t full_size = a.size();
+  const size_t batch_size = full_size / repeat;
+  YACL_ENFORCE(full_size == b.size());
+  YACL_ENFORCE(full_size == batch_size * repeat);
+
+  Request(DealerOp::kShuffleGet, batch_size, repeat);
+  internal::op::Rand(*prg_, a);
+  internal::op::Rand(*prg_, b);
+}
+
+void Dealer::Run() {
+  while (true) {
+    auto buf0 = links_[0]->Recv(kPartyRank, kRequestTag);
+    auto buf1 = links_[1]->Recv(kPartyRank, kRequestTag);
+    const auto req0 = ParseHeader(buf0);
+    const auto req1 = ParseHeader(buf1);
+    YACL_ENFORCE(req1.op == Peer(req0.op) && req0.num == req1.num &&
+                     req0.repeat == req1.repeat,
+                 "mismatched requests of the parties");
+    YACL_ENFORCE(prgs_[0] != nullptr || req0.op == DealerOp::kSetup ||
+                     req0.op == DealerOp::kStop,
+                 "request before the setup");
+
+    const size_t num = req0.num;
+    switch (req0.op) {
+      case DealerOp::kStop:
+        return;
+      case DealerOp::kSetup:
+        Setup(ParsePayload<PTy>(buf0, 1)[0], ParsePayload<PTy>(buf1, 1)[0]);
+        break;
+      case DealerOp::kSetDyKey:
+        dy_key_ = ParsePayload<PTy>(buf0, 1)[0] + ParsePayload<PTy>(buf1, 1)[0];
+        break;
+      case DealerOp::kBeaver:
+        BeaverTriple(num);
+        break;
+      case DealerOp::kDyBeaverSet:
+      case DealerOp::kDyBeaverGet:
+        DyBeaverTriple(req0.op == DealerOp::kDyBeaverSet ? 0 : 1, num);
+        break;
+      case DealerOp::kScalarDyBeaverSet:
+      case DealerOp::kScalarDyBeaverGet:
+        DyBeaverTriple(
+            req0.op == DealerOp::kScalarDyBeaverSet ? 0 : 1, num, true,
+            ParsePayload<PTy>(buf0, 1)[0] + ParsePayload<PTy>(buf1, 1)[0]);
+        break;
+      case DealerOp::kDyKey:
+      case DealerOp::kRandomSet:
+      case DealerOp::kRandomGet:
+      case DealerOp::kRandomAuth:
+        Random(req0.op, req1.op, num);
+        break;
+      case DealerOp::kShuffleSet:
+        Shuffle(0, absl::MakeConstSpan(ParsePayload<size_t>(buf0, num)),
+                req0.repeat);
+        break;
+      case DealerOp::kShuffleGet:
+        Shuffle(1, absl::MakeConstSpan(ParsePayload<size_t>(buf1, num)),
+                req0.repeat);
+        break;
+      default:
+        YACL_THROW("unknown request {}", static_cast<uint64_t>(req0.op));
+    }
+  }
+}
+
+void Dealer::Reply(size_t rank, const std::vector<PTy>& corr) {
+  links_[rank]->SendAsync(
+      kPartyRank,
+      yacl::ByteContainerView(corr.data(), corr.size() * sizeof(PTy)),
+      kReplyTag);
+}
+
+void Dealer::Setup(const PTy& key0, const PTy& key1) {
+  key_ = key0 + key1;
+  for (size_t rank = 0; rank < 2; ++rank) {
+    const uint128_t seed = yacl::crypto::SecureRandU128();
+    prgs_[rank] = std::make_unique<yacl::crypto::Prg<uint8_t>>(seed);
+    links_[rank]->SendAsync(kPartyRank,
+                            yacl::ByteContainerView(&seed, sizeof(seed)),
+                            kReplyTag);
+  }
+}
+
+// the shares of party0 are expanded from its seed, the correction words are
+// the shares of party1 minus them
+
+void Dealer::BeaverTriple(size_t num) {
+  std::vector<ATy> a0(num), b0(num), c0(num), a1(num), b1(num);
+  internal::op::Rand(*prgs_[0], Slots(absl::MakeSpan(a0)));
+  internal::op::Rand(*prgs_[0], Slots(absl::MakeSpan(b0)));
+  internal::op::Rand(*prgs_[0], Slots(absl::MakeSpan(c0)));
+  internal::op::Rand(*prgs_[1], Slots(absl::MakeSpan(a1)));
+  internal::op::Rand(*prgs_[1], Slots(absl::MakeSpan(b1)));
+
+  std::vector<PTy> corr(4 * num);
+  yacl::parallel_for(0, num, kGrain, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      const PTy aa = a0[i].val + a1[i].val;
+      const PTy bb = b0[i].val + b1[i].val;
+      const PTy cc = aa * bb;
+      corr[4 * i] = key_ * aa - a0[i].mac;
+      corr[4 * i + 1] = key_ * bb - b0[i].mac;
+      corr[4 * i + 2] = cc - c0[i].val;
+      corr[4 * i + 3] = key_ * cc - c0[i].mac;
+    }
+  });
+  Reply(1, corr);
+}
+
+void Dealer::DyBeaverTriple(size_t set_rank, size_t num, bool is_scalar,
+                            const PTy& t) {
+  std::vector<ATy> a0(num), b0(num), c0(num), r0(num), a1(num), b1(num);
+  std::vector<ATy> s0(is_scalar ? num : 0);
+  internal::op::Rand(*prgs_[0], Slots(absl::MakeSpan(a0)));
+  internal::op::Rand(*prgs_[0], Slots(absl::MakeSpan(b0)));
+  internal::op::Rand(*prgs_[0], Slots(absl::MakeSpan(c0)));
+  internal::op::Rand(*prgs_[0], Slots(absl::MakeSpan(r0)));
+  if (is_scalar) {
+    internal::op::Rand(*prgs_[0], Slots(absl::MakeSpan(s0)));
+  }
+  internal::op::Rand(*prgs_[1], Slots(absl::MakeSpan(a1)));
+  internal::op::Rand(*prgs_[1], Slots(absl::MakeSpan(b1)));
+
+  const size_t width = is_scalar ? 8 : 6;
+  std::vector<PTy> corr(width * num);
+  yacl::parallel_for(0, num, kGrain, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      const PTy aa = a0[i].val + a1[i].val;
+      const PTy bb = set_rank == 0 ? b0[i].val : b1[i].val;
+      const PTy cc = aa * bb;
+      const PTy rr = dy_key_ * aa;
+      PTy* w = corr.data() + width * i;
+      w[0] = key_ * aa - a0[i].mac;
+      // the share of party0 is 0, if it is the getter
+      w[1] = key_ * bb - b0[i].mac;
+      w[2] = cc - c0[i].val;
+      w[3] = key_ * cc - c0[i].mac;
+      w[4] = rr - r0[i].val;
+      w[5] = key_ * rr - r0[i].mac;
+      if (is_scalar) {
+        const PTy ss = t * aa;
+        w[6] = ss - s0[i].val;
+        w[7] = key_ * ss - s0[i].mac;
+      }
+    }
+  });
+  Reply(1, corr);
+}
+
+void Dealer::Random(DealerOp op0, DealerOp op1, size_t num) {
+  std::vector<ATy> out0(num), out1(num);
+  internal::op::Rand(*prgs_[0], Slots(absl::MakeSpan(out0)));
+  internal::op::Rand(*prgs_[1], Slots(absl::MakeSpan(out1)));
+
+  std::vector<PTy> corr(num);
+  yacl::parallel_for(0, num, kGrain, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      const PTy rr = (KeepVal(op0) ? out0[i].val : PTy::Zero()) +
+                     (KeepVal(op1) ? out1[i].val : PTy::Zero());
+      corr[i] = key_ * rr - out0[i].mac;
+    }
+  });
+  if (op0 == DealerOp::kDyKey) {
+    dy_key_ = out0[0].val + out1[0].val;
+  }
+  Reply(1, corr);
+}
+
+void Dealer::Shuffle(size_t set_rank, absl::Span<const size_t> perm,
+                     size_t repeat) {
+  const size_t batch_size = perm.size();
+  const size_t full_size = batch_size * repeat;
+  for (const auto& e : perm) {
+    YACL_ENFORCE(e < batch_size);
+  }
+
+  // a && b of the getter, delta = - \Pi(a) - b for the setter
+  auto& prg = *prgs_[1 - set_rank];
+  auto a = internal::op::Rand(prg, full_size);
+  auto delta = internal::op::Rand(prg, full_size);
+  yacl::parallel_for(0, full_size, kGrain, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      const size_t offset = i - i % batch_size;
+      delta[i] = PTy::Neg(a[offset + perm[i - offset]] + delta[i]);
+    }
+  });
+  Reply(set_rank, delta);
+}
+
+}  // namespace mcpsi
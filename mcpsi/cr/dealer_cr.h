@@ -0,0 +1,160 @@
+#pragma once
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "mcpsi/context/context.h"
+#include "mcpsi/context/state.h"
+#include "mcpsi/cr/cr.h"
+#include "mcpsi/ss/type.h"
+#include "yacl/crypto/tools/prg.h"
+#include "yacl/link/link.h"
+
+namespace mcpsi {
+
+// Link from a party to the dealer (impl yacl::link::Context), a 2-party link
+// on which the party is rank 0 && the dealer rank 1. It should be added to
+// the context before SetupContext (CrMode::kDealer).
+class DealerLink : public State, public yacl::link::Context {
+ public:
+  static const std::string id;
+  static constexpr StateSlot slot = StateSlot::kDealerLink;
+
+  template <typename... Args>
+  DealerLink(Args&&... args)
+      : yacl::link::Context(std::forward<Args>(args)...) {}
+};
+
+// requests of DealerCorrelation
+enum class DealerOp : uint64_t {
+  kSetup,
+  kDyKey,
+  kSetDyKey,
+  kBeaver,
+  kDyBeaverSet,
+  kDyBeaverGet,
+  kScalarDyBeaverSet,
+  kScalarDyBeaverGet,
+  kRandomSet,
+  kRandomGet,
+  kRandomAuth,
+  kShuffleSet,
+  kShuffleGet,
+  kStop,
+};
+
+// Correlated randomness from a trusted dealer (see Dealer), for tests && for
+// deployments with a trusted third machine.
+// > the dealer shares a seed with each party, party0 expands all its shares
+//   from its seed, party1 only the free values (e.g. a && b of a triple)
+// > the dealer streams the correction words of party1 (the bound values,
+//   e.g. c = a * b, && the macs) && the deltas of shuffles, nothing else
+// > the dealer learns the SPDZ key, the DY-PRF key && the permutations
+class DealerCorrelation : public Correlation {
+ public:
+  DealerCorrelation(std::shared_ptr<Context> ctx);
+
+  ~DealerCorrelation();
+
+  internal::PTy GetKey() const override { return key_; }
+
+  void SetKey(internal::PTy key) override { key_ = key; }
+
+  // the dealer has to know the persisted key as well
+  void SetDyKey(const internal::ATy& dy_key) override;
+
+  void OneTimeSetup() override;
+
+  // entry
+  void BeaverTriple(absl::Span<internal::ATy> a, absl::Span<internal::ATy> b,
+                    absl::Span<internal::ATy> c) override;
+  void DyBeaverTripleSet(absl::Span<internal::ATy> a,
+                         absl::Span<internal::ATy> b,
+                         absl::Span<internal::ATy> c,
+                         absl::Span<internal::ATy> r) override;
+  void DyBeaverTripleGet(absl::Span<internal::ATy> a,
+                         absl::Span<internal::ATy> b,
+                         absl::Span<internal::ATy> c,
+                         absl::Span<internal::ATy> r) override;
+  void ScalarDyBeaverTripleSet(const internal::ATy& t,
+                               absl::Span<internal::ATy> a,
+                               absl::Span<internal::ATy> b,
+                               absl::Span<internal::ATy> c,
+                               absl::Span<internal::ATy> r,
+                               absl::Span<internal::ATy> s) override;
+  void ScalarDyBeaverTripleGet(const internal::ATy& t,
+                               absl::Span<internal::ATy> a,
+                               absl::Span<internal::ATy> b,
+                               absl::Span<internal::ATy> c,
+                               absl::Span<internal::ATy> r,
+                               absl::Span<internal::ATy> s) override;
+
+  // entry
+  void RandomSet(absl::Span<internal::ATy> out) override;
+  void RandomGet(absl::Span<internal::ATy> out) override;
+  void RandomAuth(absl::Span<internal::ATy> out) override;
+
+  // entry
+  void ShuffleSet(absl::Span<const size_t> perm,
+                  absl::Span<internal::PTy> delta, size_t repeat = 1) override;
+
+  void ShuffleGet(absl::Span<internal::PTy> a, absl::Span<internal::PTy> b,
+                  size_t repeat = 1) override;
+
+  // release the dealer (once both parties stop), the destructor stops as well
+  void Stop();
+
+ private:
+  std::shared_ptr<DealerLink> link_;
+  // expands the shares of this party, shared with the dealer
+  std::unique_ptr<yacl::crypto::Prg<uint8_t>> prg_{nullptr};
+  bool stopped_{false};
+
+  void Request(DealerOp op, size_t num, size_t repeat = 1,
+               yacl::ByteContainerView payload = {});
+  // correction words (or deltas) of `num` elements
+  yacl::Buffer Reply(size_t num);
+
+  // RandomSet / RandomGet / RandomAuth && the DY-PRF key
+  void Random(DealerOp op, absl::Span<internal::ATy> out);
+  // s = t * a as well, if t is given
+  void DyBeaverTriple(bool is_set, absl::Span<internal::ATy> a,
+                      absl::Span<internal::ATy> b, absl::Span<internal::ATy> c,
+                      absl::Span<internal::ATy> r,
+                      const internal::ATy* t = nullptr,
+                      absl::Span<internal::ATy> s = {});
+};
+
+// Trusted dealer of DealerCorrelation, it serves the requests of both parties
+// in order, which should match (e.g. DyBeaverTripleSet on one party &&
+// DyBeaverTripleGet on the other one, as for the other correlations).
+// > links[i] is the link to party i (the party is rank 0, the dealer rank 1)
+// > Run blocks until both parties stop, e.g. run it in a thread for an
+//   in-process dealer, or in a process of its own
+class Dealer {
+ public:
+  Dealer(std::array<std::shared_ptr<yacl::link::Context>, 2> links)
+      : links_(std::move(links)) {}
+
+  void Run();
+
+ private:
+  std::array<std::shared_ptr<yacl::link::Context>, 2> links_;
+  // the Prgs of both parties
+  std::array<std::unique_ptr<yacl::crypto::Prg<uint8_t>>, 2> prgs_;
+  // SPDZ key && DY-PRF key
+  internal::PTy key_;
+  internal::PTy dy_key_;
+
+  void Reply(size_t rank, const std::vector<internal::PTy>& corr);
+
+  void Setup(const internal::PTy& key0, const internal::PTy& key1);
+  void BeaverTriple(size_t num);
+  // `set_rank` is the setter, s = t * a as well, if is_scalar
+  void DyBeaverTriple(size_t set_rank, size_t num, bool is_scalar = false,
+                      const internal::PTy& t = internal::PTy::Zero());
+  void Random(DealerOp op0, DealerOp op1, size_t num);
+  void Shuffle(size_t set_rank, absl::Span<const size_t> perm, size_t repeat);
+};
+
+}  // namespace mcpsi
@@ -0,0 +1,191 @@
+#include "mcpsi/cr/dealer_cr.h"
+
+#include <future>
+
+#include "gtest/gtest.h"
+#include "mcpsi/context/register.h"
+#include "mcpsi/utils/test_util.h"
+#include "mcpsi/utils/vec_op.h"
+
+namespace mcpsi {
+
+using internal::ATy;
+using internal::PTy;
+
+// two parties && an in-process dealer
+class DealerCrTest : public ::testing::Test {
+ public:
+  static std::vector<std::shared_ptr<Context>> ctx;
+  static std::future<void> dealer;
+
+  static void SetUpTestSuite() {
+    ctx = MockContext(2);
+    std::array<std::shared_ptr<yl::Context>, 2> links;
+    for (size_t rank = 0; rank < 2; ++rank) {
+      auto lctxs = SetupWorld(fmt::format("dealer.{}", rank), 2);
+      ctx[rank]->AddState<DealerLink>(*lctxs[0]);
+      links[rank] = lctxs[1];
+    }
+    dealer = std::async(std::launch::async, [links] { Dealer(links).Run(); });
+    auto task0 = std::async([&] { SetupContext(ctx[0], CrMode::kDealer); });
+    auto task1 = std::async([&] { SetupContext(ctx[1], CrMode::kDealer); });
+    task0.get();
+    task1.get();
+  }
+
+  static void TearDownTestSuite() {
+    for (auto& c : ctx) {
+      std::dynamic_pointer_cast<DealerCorrelation>(c->GetState<Correlation>())
+          ->Stop();
+    }
+    dealer.get();
+    ctx.clear();
+  }
+
+  static std::shared_ptr<Correlation> GetCr(size_t rank) {
+    return ctx[rank]->GetState<Correlation>();
+  }
+
+  static PTy GetKey() { return GetCr(0)->GetKey() + GetCr(1)->GetKey(); }
+
+  static void CheckMac(const ATy& x0, const ATy& x1) {
+    EXPECT_EQ(x0.mac + x1.mac, GetKey() * (x0.val + x1.val));
+  }
+};
+
+std::vector<std::shared_ptr<Context>> DealerCrTest::ctx;
+std::future<void> DealerCrTest::dealer;
+
+TEST_F(DealerCrTest, BeaverWork) {
+  const size_t num = 10000;
+  auto rank0 = std::async([&] { return GetCr(0)->BeaverTriple(num); });
+  auto rank1 = std::async([&] { return GetCr(1)->BeaverTriple(num); });
+  auto ret0 = rank0.get();
+  auto ret1 = rank1.get();
+
+  for (size_t i = 0; i < num; ++i) {
+    auto a = ret0.a[i].val + ret1.a[i].val;
+    auto b = ret0.b[i].val + ret1.b[i].val;
+    auto c = ret0.c[i].val + ret1.c[i].val;
+    EXPECT_EQ(a * b, c);
+    CheckMac(ret0.a[i], ret1.a[i]);
+    CheckMac(ret0.b[i], ret1.b[i]);
+    CheckMac(ret0.c[i], ret1.c[i]);
+  }
+}
+
+TEST_F(DealerCrTest, DyBeaverWork) {
+  const size_t num = 1000;
+  CheckMac(GetCr(0)->GetDyKey(), GetCr(1)->GetDyKey());
+  auto k = GetCr(0)->GetDyKey().val + GetCr(1)->GetDyKey().val;
+
+  // either party could be the setter
+  for (size_t set_rank = 0; set_rank < 2; ++set_rank) {
+    auto set = std::async(
+        [&] { return GetCr(set_rank)->DyBeaverTripleSet(num); });
+    auto get = std::async(
+        [&] { return GetCr(1 - set_rank)->DyBeaverTripleGet(num); });
+    auto ret0 = set.get();
+    auto ret1 = get.get();
+
+    for (size_t i = 0; i < num; ++i) {
+      auto a = ret0.a[i].val + ret1.a[i].val;
+      auto b = ret0.b[i].val + ret1.b[i].val;
+      auto c = ret0.c[i].val + ret1.c[i].val;
+      auto r = ret0.r[i].val + ret1.r[i].val;
+      EXPECT_EQ(ret1.b[i].val, PTy::Zero());
+      EXPECT_EQ(a * b, c);
+      EXPECT_EQ(a * k, r);
+      CheckMac(ret0.a[i], ret1.a[i]);
+      CheckMac(ret0.b[i], ret1.b[i]);
+      CheckMac(ret0.c[i], ret1.c[i]);
+      CheckMac(ret0.r[i], ret1.r[i]);
+    }
+  }
+}
+
+TEST_F(DealerCrTest, ScalarDyBeaverWork) {
+  const size_t num = 1000;
+  auto rank0 =
+      std::async([&] { return GetCr(0)->ScalarDyBeaverTripleGet(num); });
+  auto rank1 =
+      std::async([&] { return GetCr(1)->ScalarDyBeaverTripleSet(num); });
+  auto ret0 = rank0.get();
+  auto ret1 = rank1.get();
+  auto k = ret0.k.val + ret1.k.val;
+  auto t = ret0.t.val + ret1.t.val;
+  CheckMac(ret0.t, ret1.t);
+
+  for (size_t i = 0; i < num; ++i) {
+    auto a = ret0.a[i].val + ret1.a[i].val;
+    auto b = ret0.b[i].val + ret1.b[i].val;
+    auto c = ret0.c[i].val + ret1.c[i].val;
+    auto r = ret0.r[i].val + ret1.r[i].val;
+    auto s = ret0.s[i].val + ret1.s[i].val;
+    EXPECT_EQ(b, ret1.b[i].val);
+    EXPECT_EQ(a * b, c);
+    EXPECT_EQ(a * k, r);
+    EXPECT_EQ(a * t, s);
+    CheckMac(ret0.r[i], ret1.r[i]);
+    CheckMac(ret0.s[i], ret1.s[i]);
+  }
+}
+
+TEST_F(DealerCrTest, RandomWork) {
+  const size_t num = 1000;
+  auto rank0 = std::async([&] {
+    auto cr = GetCr(0);
+    return std::make_pair(cr->RandomSet(num), cr->RandomAuth(num));
+  });
+  auto rank1 = std::async([&] {
+    auto cr = GetCr(1);
+    return std::make_pair(cr->RandomGet(num), cr->RandomAuth(num));
+  });
+  auto [set0, auth0] = rank0.get();
+  auto [get1, auth1] = rank1.get();
+
+  for (size_t i = 0; i < num; ++i) {
+    EXPECT_EQ(get1.data[i].val, PTy::Zero());
+    CheckMac(set0.data[i], get1.data[i]);
+    CheckMac(auth0.data[i], auth1.data[i]);
+  }
+}
+
+TEST_F(DealerCrTest, ShuffleWork) {
+  const size_t num = 1000;
+  const size_t repeat = 2;
+  auto rank0 = std::async([&] { return GetCr(0)->ShuffleGet(num, repeat); });
+  auto rank1 = std::async([&] { return GetCr(1)->ShuffleSet(num, repeat); });
+  auto get = rank0.get();
+  auto set = rank1.get();
+
+  // delta = - \Pi(a) - b
+  for (size_t i = 0; i < num * repeat; ++i) {
+    const size_t offset = i - i % num;
+    EXPECT_EQ(set.delta[i] + get.a[offset + set.perm[i - offset]] + get.b[i],
+              PTy::Zero());
+  }
+}
+
+TEST_F(DealerCrTest, SetDyKeyWork) {
+  const size_t num = 1000;
+  // a fresh DY-PRF key, known to the dealer
+  auto task0 = std::async([&] { RotateDyKey(ctx[0]); });
+  auto task1 = std::async([&] { RotateDyKey(ctx[1]); });
+  task0.get();
+  task1.get();
+  auto k = GetCr(0)->GetDyKey().val + GetCr(1)->GetDyKey().val;
+
+  auto rank0 = std::async([&] { return GetCr(0)->DyBeaverTripleSet(num); });
+  auto rank1 = std::async([&] { return GetCr(1)->DyBeaverTripleGet(num); });
+  auto ret0 = rank0.get();
+  auto ret1 = rank1.get();
+  for (size_t i = 0; i < num; ++i) {
+    auto a = ret0.a[i].val + ret1.a[i].val;
+    auto r = ret0.r[i].val + ret1.r[i].val;
+    EXPECT_EQ(a * k, r);
+    CheckMac(ret0.r[i], ret1.r[i]);
+  }
+}
+
+}  // namespace mcpsi
@@ -1,183 +1,176 @@
 #include "mcpsi/cr/fake_cr.h"
 
 #include "mcpsi/utils/vec_op.h"
+#include "yacl/utils/parallel.h"
 
 namespace mcpsi {
 
-void FakeCorrelation::BeaverTriple(absl::Span<internal::ATy> a,
-                                   absl::Span<internal::ATy> b,
-                                   absl::Span<internal::ATy> c) {
-  const size_t num = c.size();
-  YACL_ENFORCE(num == a.size());
-  YACL_ENFORCE(num == b.size());
+namespace {
+
+using internal::ATy;
+using internal::PTy;
 
-  auto a0 = internal::op::Rand(*ctx_->GetState<Prg>(), num);
-  auto a1 = internal::op::Rand(*ctx_->GetState<Prg>(), num);
-  auto b0 = internal::op::Rand(*ctx_->GetState<Prg>(), num);
-  auto b1 = internal::op::Rand(*ctx_->GetState<Prg>(), num);
-  auto c0 = internal::op::Rand(*ctx_->GetState<Prg>(), num);
-
-  auto aa = internal::op::Add(absl::MakeConstSpan(a0), absl::MakeConstSpan(a1));
-  auto bb = internal::op::Add(absl::MakeConstSpan(b0), absl::MakeConstSpan(b1));
-  auto cc = internal::op::Mul(absl::MakeConstSpan(aa), absl::MakeConstSpan(bb));
-  auto c1 = internal::op::Sub(absl::MakeConstSpan(cc), absl::MakeConstSpan(c0));
-
-  auto a_mac = internal::op::ScalarMul(key_, absl::MakeConstSpan(aa));
-  auto b_mac = internal::op::ScalarMul(key_, absl::MakeConstSpan(bb));
-  auto c_mac = internal::op::ScalarMul(key_, absl::MakeConstSpan(cc));
-
-  if (ctx_->GetRank() == 0) {
-    internal::Pack(absl::MakeConstSpan(a0), absl::MakeConstSpan(a_mac), a);
-    internal::Pack(absl::MakeConstSpan(b0), absl::MakeConstSpan(b_mac), b);
-    internal::Pack(absl::MakeConstSpan(c0), absl::MakeConstSpan(c_mac), c);
-  } else {
-    internal::Pack(absl::MakeConstSpan(a1), absl::MakeConstSpan(a_mac), a);
-    internal::Pack(absl::MakeConstSpan(b1), absl::MakeConstSpan(b_mac), b);
-    internal::Pack(absl::MakeConstSpan(c1), absl::MakeConstSpan(c_mac), c);
-  }
+constexpr size_t kGrain = 4096;
+
+// the (val, mac) slots of the a-shares, the fake generators sample straight
+// into them && then rewrite each tuple in place, in one parallel pass
+absl::Span<PTy> Slots(absl::Span<ATy> in) {
+  return absl::MakeSpan(reinterpret_cast<PTy*>(in.data()), 2 * in.size());
 }
 
-void FakeCorrelation::DyBeaverTripleSet(absl::Span<internal::ATy> a,
-                                        absl::Span<internal::ATy> b,
-                                        absl::Span<internal::ATy> c,
-                                        absl::Span<internal::ATy> r) {
+}  // namespace
+
+void FakeCorrelation::BeaverTriple(absl::Span<ATy> a, absl::Span<ATy> b,
+                                   absl::Span<ATy> c) {
   const size_t num = c.size();
   YACL_ENFORCE(num == a.size());
   YACL_ENFORCE(num == b.size());
 
-  auto a0 = internal::op::Rand(*ctx_->GetState<Prg>(), num);
-  auto a1 = internal::op::Rand(*ctx_->GetState<Prg>(), num);
-  auto bb = internal::op::Rand(*ctx_->GetState<Prg>(), num);
-  auto c0 = internal::op::Rand(*ctx_->GetState<Prg>(), num);
-
-  auto aa = internal::op::Add(absl::MakeConstSpan(a0), absl::MakeConstSpan(a1));
-  auto cc = internal::op::Mul(absl::MakeConstSpan(aa), absl::MakeConstSpan(bb));
-  auto c1 = internal::op::Sub(absl::MakeConstSpan(cc), absl::MakeConstSpan(c0));
+  // (a0, a1), (b0, b1) && (c0, -)
+  auto prg = ctx_->GetState<Prg>();
+  internal::op::Rand(*prg, Slots(a));
+  internal::op::Rand(*prg, Slots(b));
+  internal::op::Rand(*prg, Slots(c));
+
+  const bool is_rank0 = ctx_->GetRank() == 0;
+  yacl::parallel_for(0, num, kGrain, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      const PTy aa = a[i].val + a[i].mac;
+      const PTy bb = b[i].val + b[i].mac;
+      const PTy cc = aa * bb;
+      const PTy c0 = c[i].val;
+      a[i] = {is_rank0 ? a[i].val : a[i].mac, key_ * aa};
+      b[i] = {is_rank0 ? b[i].val : b[i].mac, key_ * bb};
+      c[i] = {is_rank0 ? c0 : cc - c0, key_ * cc};
+    }
+  });
+}
 
-  // beaver
-  auto a_mac = internal::op::ScalarMul(key_, absl::MakeConstSpan(aa));
-  auto b_mac = internal::op::ScalarMul(key_, absl::MakeConstSpan(bb));
-  auto c_mac = internal::op::ScalarMul(key_, absl::MakeConstSpan(cc));
+void FakeCorrelation::DyBeaverTripleSet(absl::Span<ATy> a, absl::Span<ATy> b,
+                                        absl::Span<ATy> c, absl::Span<ATy> r) {
+  DyBeaverTriple(true, a, b, c, r);
+}
 
-  internal::Pack(absl::MakeConstSpan(a0), absl::MakeConstSpan(a_mac), a);
-  internal::Pack(absl::MakeConstSpan(bb), absl::MakeConstSpan(b_mac), b);
-  internal::Pack(absl::MakeConstSpan(c0), absl::MakeConstSpan(c_mac), c);
+void FakeCorrelation::DyBeaverTripleGet(absl::Span<ATy> a, absl::Span<ATy> b,
+                                        absl::Span<ATy> c, absl::Span<ATy> r) {
+  DyBeaverTriple(false, a, b, c, r);
+}
 
-  // dy-key
-  auto dy_key = dy_key_.val;
-  auto dy_mac = dy_key_.mac;
+void FakeCorrelation::ScalarDyBeaverTripleSet(const ATy& t, absl::Span<ATy> a,
+                                              absl::Span<ATy> b,
+                                              absl::Span<ATy> c,
+                                              absl::Span<ATy> r,
+                                              absl::Span<ATy> s) {
+  DyBeaverTriple(true, a, b, c, r, &t, s);
+}
 
-  auto ak = internal::op::ScalarMul(dy_key, absl::MakeConstSpan(aa));
-  auto ak_mac = internal::op::ScalarMul(dy_mac, absl::MakeConstSpan(aa));
-  internal::Pack(absl::MakeConstSpan(ak), absl::MakeConstSpan(ak_mac), r);
+void FakeCorrelation::ScalarDyBeaverTripleGet(const ATy& t, absl::Span<ATy> a,
+                                              absl::Span<ATy> b,
+                                              absl::Span<ATy> c,
+                                              absl::Span<ATy> r,
+                                              absl::Span<ATy> s) {
+  DyBeaverTriple(false, a, b, c, r, &t, s);
 }
 
-void FakeCorrelation::DyBeaverTripleGet(absl::Span<internal::ATy> a,
-                                        absl::Span<internal::ATy> b,
-                                        absl::Span<internal::ATy> c,
-                                        absl::Span<internal::ATy> r) {
+void FakeCorrelation::DyBeaverTriple(bool is_set, absl::Span<ATy> a,
+                                     absl::Span<ATy> b, absl::Span<ATy> c,
+                                     absl::Span<ATy> r, const ATy* t,
+                                     absl::Span<ATy> s) {
   const size_t num = c.size();
   YACL_ENFORCE(num == a.size());
   YACL_ENFORCE(num == b.size());
-
-  auto a0 = internal::op::Rand(*ctx_->GetState<Prg>(), num);
-  auto a1 = internal::op::Rand(*ctx_->GetState<Prg>(), num);
-  auto bb = internal::op::Rand(*ctx_->GetState<Prg>(), num);
-  auto c0 = internal::op::Rand(*ctx_->GetState<Prg>(), num);
-
-  auto aa = internal::op::Add(absl::MakeConstSpan(a0), absl::MakeConstSpan(a1));
-  auto cc = internal::op::Mul(absl::MakeConstSpan(aa), absl::MakeConstSpan(bb));
-  auto c1 = internal::op::Sub(absl::MakeConstSpan(cc), absl::MakeConstSpan(c0));
-
-  // beaver
-  auto a_mac = internal::op::ScalarMul(key_, absl::MakeConstSpan(aa));
-  auto b_mac = internal::op::ScalarMul(key_, absl::MakeConstSpan(bb));
-  auto c_mac = internal::op::ScalarMul(key_, absl::MakeConstSpan(cc));
-
-  auto zeros = internal::op::Zeros(num);
-
-  internal::Pack(absl::MakeConstSpan(a1), absl::MakeConstSpan(a_mac), a);
-  internal::Pack(absl::MakeConstSpan(zeros), absl::MakeConstSpan(b_mac), b);
-  internal::Pack(absl::MakeConstSpan(c1), absl::MakeConstSpan(c_mac), c);
-
-  // dy-key
-  auto dy_key = dy_key_.val;
-  auto dy_mac = dy_key_.mac;
-
-  auto ak = internal::op::ScalarMul(dy_key, absl::MakeConstSpan(aa));
-  auto ak_mac = internal::op::ScalarMul(dy_mac, absl::MakeConstSpan(aa));
-  internal::Pack(absl::MakeConstSpan(ak), absl::MakeConstSpan(ak_mac), r);
+  YACL_ENFORCE(num == r.size());
+  YACL_ENFORCE(t == nullptr || num == s.size());
+
+  // (a0, a1) && (b, c0), b is public to the setter
+  auto prg = ctx_->GetState<Prg>();
+  internal::op::Rand(*prg, Slots(a));
+  internal::op::Rand(*prg, Slots(b));
+
+  yacl::parallel_for(0, num, kGrain, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      const PTy aa = a[i].val + a[i].mac;
+      const PTy bb = b[i].val;
+      const PTy cc = aa * bb;
+      const PTy c0 = b[i].mac;
+      // beaver
+      a[i] = {is_set ? a[i].val : a[i].mac, key_ * aa};
+      b[i] = {is_set ? bb : PTy::Zero(), key_ * bb};
+      c[i] = {is_set ? c0 : cc - c0, key_ * cc};
+      // dy-key
+      r[i] = {dy_key_.val * aa, dy_key_.mac * aa};
+      if (t != nullptr) {
+        s[i] = {t->val * aa, t->mac * aa};
+      }
+    }
+  });
 }
 
-void FakeCorrelation::RandomSet(absl::Span<internal::ATy> out) {
+void FakeCorrelation::RandomSet(absl::Span<ATy> out) {
   const size_t num = out.size();
-  auto rands = internal::op::Rand(*ctx_->GetState<Prg>(), num);
-  auto mac = internal::op::ScalarMul(key_, absl::MakeSpan(rands));
-  internal::Pack(absl::MakeConstSpan(rands), absl::MakeConstSpan(mac), out);
+  // NOTE: the mac slots are sampled too (&& discarded)
+  internal::op::Rand(*ctx_->GetState<Prg>(), Slots(out));
+  yacl::parallel_for(0, num, kGrain, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      out[i].mac = key_ * out[i].val;
+    }
+  });
 }
 
-void FakeCorrelation::RandomGet(absl::Span<internal::ATy> out) {
+void FakeCorrelation::RandomGet(absl::Span<ATy> out) {
   const size_t num = out.size();
-  auto rands = internal::op::Rand(*ctx_->GetState<Prg>(), num);
-  auto mac = internal::op::ScalarMul(key_, absl::MakeSpan(rands));
-  auto zeros = internal::op::Zeros(num);
-  internal::Pack(absl::MakeConstSpan(zeros), absl::MakeConstSpan(mac), out);
+  // NOTE: the mac slots are sampled too (&& discarded)
+  internal::op::Rand(*ctx_->GetState<Prg>(), Slots(out));
+  yacl::parallel_for(0, num, kGrain, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      out[i] = {PTy::Zero(), key_ * out[i].val};
+    }
+  });
 }
 
-void FakeCorrelation::RandomAuth(absl::Span<internal::ATy> out) {
+void FakeCorrelation::RandomAuth(absl::Span<ATy> out) {
   const size_t num = out.size();
-  std::vector<internal::ATy> zeros(num);
-  std::vector<internal::ATy> rands(num);
-  if (ctx_->GetRank() == 0) {
-    RandomSet(absl::MakeSpan(rands));
-    RandomGet(absl::MakeSpan(zeros));
-  } else {
-    RandomGet(absl::MakeSpan(zeros));
-    RandomSet(absl::MakeSpan(rands));
-  }
-  internal::op::Add(
-      absl::MakeConstSpan(reinterpret_cast<const internal::PTy*>(zeros.data()),
-                          2 * num),
-      absl::MakeConstSpan(reinterpret_cast<const internal::PTy*>(rands.data()),
-                          2 * num),
-      absl::MakeSpan(reinterpret_cast<internal::PTy*>(out.data()), 2 * num));
+  // (r0, r1), r0 is input by party0 && r1 by party1
+  internal::op::Rand(*ctx_->GetState<Prg>(), Slots(out));
+  const bool is_rank0 = ctx_->GetRank() == 0;
+  yacl::parallel_for(0, num, kGrain, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      const PTy rr = out[i].val + out[i].mac;
+      out[i] = {is_rank0 ? out[i].val : out[i].mac, key_ * rr};
+    }
+  });
 }
 
 void FakeCorrelation::ShuffleSet(absl::Span<const size_t> perm,
-                                 absl::Span<internal::PTy> delta,
-                                 size_t repeat) {
+                                 absl::Span<PTy> delta, size_t repeat) {
   const size_t batch_size = perm.size();
   const size_t full_size = delta.size();
   YACL_ENFORCE(batch_size * repeat == full_size);
 
-  std::vector<uint128_t> seeds(2);
-  ctx_->GetState<Prg>()->Fill(absl::MakeSpan(seeds));
-  auto a = internal::op::Rand(seeds[0], full_size);
-  auto b = internal::op::Rand(seeds[1], full_size);
+  // a is permuted, b lands in delta
+  auto prg = ctx_->GetState<Prg>();
+  auto a = internal::op::Rand(*prg, full_size);
+  internal::op::Rand(*prg, delta);
 
-  for (size_t offset = 0; offset < full_size; offset += batch_size) {
-    for (size_t i = 0; i < batch_size; ++i) {
-      delta[offset + i] = a[offset + perm[i]] + b[offset + i];
-    }
-  }
   // delta = - \Pi(a) - b
-  internal::op::Neg(absl::MakeConstSpan(delta), absl::MakeSpan(delta));
+  yacl::parallel_for(0, full_size, kGrain, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      const size_t offset = i - i % batch_size;
+      delta[i] = PTy::Neg(a[offset + perm[i - offset]] + delta[i]);
+    }
+  });
 }
 
-void FakeCorrelation::ShuffleGet(absl::Span<internal::PTy> a,
-                                 absl::Span<internal::PTy> b, size_t repeat) {
+void FakeCorrelation::ShuffleGet(absl::Span<PTy> a, absl::Span<PTy> b,
+                                 size_t repeat) {
   const size_t full_size = a.size();
   const size_t batch_size = full_size / repeat;
   YACL_ENFORCE(full_size == b.size());
   YACL_ENFORCE(full_size == batch_size * repeat);
 
-  std::vector<uint128_t> seeds(2);
-  ctx_->GetState<Prg>()->Fill(absl::MakeSpan(seeds));
-  auto a_buf = internal::op::Rand(seeds[0], full_size);
-  auto b_buf = internal::op::Rand(seeds[1], full_size);
-
-  memcpy(a.data(), a_buf.data(), full_size * sizeof(internal::PTy));
-  memcpy(b.data(), b_buf.data(), full_size * sizeof(internal::PTy));
+  auto prg = ctx_->GetState<Prg>();
+  internal::op::Rand(*prg, a);
+  internal::op::Rand(*prg, b);
 }
 
 }  // namespace mcpsi
@@ -9,6 +9,10 @@
 
 namespace mcpsi {
 
+// Correlated randomness from the shared Prg, to benchmark the online phase
+// on its own. Each generator samples straight into the destination spans
+// (by the parallel sampler) && then builds the tuples in place, in a single
+// parallel pass, without temporary vectors.
 class FakeCorrelation : public Correlation {
  public:
   FakeCorrelation(std::shared_ptr<Context> ctx) : Correlation(ctx) {}
@@ -32,6 +36,18 @@ class FakeCorrelation : public Correlation {
                          absl::Span<internal::ATy> b,
                          absl::Span<internal::ATy> c,
                          absl::Span<internal::ATy> r) override;
+  void ScalarDyBeaverTripleSet(const internal::ATy& t,
+                               absl::Span<internal::ATy> a,
+                               absl::Span<internal::ATy> b,
+                               absl::Span<internal::ATy> c,
+                               absl::Span<internal::ATy> r,
+                               absl::Span<internal::ATy> s) override;
+  void ScalarDyBeaverTripleGet(const internal::ATy& t,
+                               absl::Span<internal::ATy> a,
+                               absl::Span<internal::ATy> b,
+                               absl::Span<internal::ATy> c,
+                               absl::Span<internal::ATy> r,
+                               absl::Span<internal::ATy> s) override;
 
   // entry
   void RandomSet(absl::Span<internal::ATy> out) override;
@@ -44,6 +60,14 @@ class FakeCorrelation : public Correlation {
 
   void ShuffleGet(absl::Span<internal::PTy> a, absl::Span<internal::PTy> b,
                   size_t repeat = 1) override;
+
+ private:
+  // s = t * a as well, if t is given
+  void DyBeaverTriple(bool is_set, absl::Span<internal::ATy> a,
+                      absl::Span<internal::ATy> b, absl::Span<internal::ATy> c,
+                      absl::Span<internal::ATy> r,
+                      const internal::ATy* t = nullptr,
+                      absl::Span<internal::ATy> s = {});
 };
 
 }  // namespace mcpsi
@@ -0,0 +1,156 @@
+#include "mcpsi/cr/payload_cr.h"
+
+#include <future>
+
+#include "mcpsi/cr/true_cr.h"
+#include "mcpsi/cr/utils/shuffle.h"
+#include "mcpsi/utils/vec_op.h"
+
+namespace mcpsi {
+
+namespace {
+
+using PayOp = internal::FieldOp<internal::PayTy>;
+
+std::shared_ptr<TrueCorrelation> GetTrueCorrelation(
+    const std::shared_ptr<Context>& ctx) {
+  auto true_cr =
+      std::dynamic_pointer_cast<TrueCorrelation>(ctx->GetState<Correlation>());
+  YACL_ENFORCE(true_cr != nullptr,
+               "true payload correlation needs a TrueCorrelation");
+  true_cr->InitOtAdapter();
+  return true_cr;
+}
+
+}  // namespace
+
+// register string
+const std::string PayloadCorrelation::id = std::string("PayloadCorrelation");
+
+void PayloadCorrelation::InitVoleAdapter() {
+  auto true_cr = GetTrueCorrelation(ctx_);
+  // party0 sends on the first spawned link and party1 on the second
+  auto conn = ctx_->GetConnection();
+  auto link0 = conn->SpawnConnection();
+  auto link1 = conn->SpawnConnection();
+  auto send_link = ctx_->GetRank() == 0 ? link0 : link1;
+  auto recv_link = ctx_->GetRank() == 0 ? link1 : link0;
+
+  auto sender = std::make_shared<vole::PayWolverineVoleAdapter>(
+      send_link, true_cr->ot_sender_, key_);
+  auto receiver = std::make_shared<vole::PayWolverineVoleAdapter>(
+      recv_link, true_cr->ot_receiver_);
+  // both directions at once, each on its own link
+  auto task = std::async(std::launch::async, [&] { sender->OneTimeSetup(); });
+  receiver->OneTimeSetup();
+  task.get();
+
+  vole_sender_ = sender;
+  vole_receiver_ = receiver;
+  setup_vole_ = true;
+}
+
+void PayloadCorrelation::RandomSet(absl::Span<internal::PayATy> out) {
+  const size_t num = out.size();
+  std::vector<internal::PayTy> a(num);
+  std::vector<internal::PayTy> b(num);
+  if (CR_mode_) {
+    // a * remote_key + b = remote_c
+    if (setup_vole_ == false) InitVoleAdapter();
+    vole_receiver_->rrecv(absl::MakeSpan(a), absl::MakeSpan(b));
+  } else {
+    PayOp::Rand(*ctx_->GetState<Prg>(), absl::MakeSpan(a));
+  }
+  // a's mac = a * local_key - b
+  auto mac = PayOp::ScalarMul(key_, absl::MakeConstSpan(a));
+  PayOp::SubInplace(absl::MakeSpan(mac), absl::MakeConstSpan(b));
+  internal::Pack<internal::PayTy>(a, mac, out);
+}
+
+void PayloadCorrelation::RandomGet(absl::Span<internal::PayATy> out) {
+  const size_t num = out.size();
+  std::vector<internal::PayTy> c(num);
+  if (CR_mode_) {
+    // remote_a * key_ + remote_b = c
+    if (setup_vole_ == false) InitVoleAdapter();
+    vole_sender_->rsend(absl::MakeSpan(c));
+  } else {
+    auto rands = PayOp::Rand(*ctx_->GetState<Prg>(), num);
+    PayOp::ScalarMul(key_, absl::MakeConstSpan(rands), absl::MakeSpan(c));
+  }
+  auto zeros = PayOp::Zeros(num);
+  internal::Pack<internal::PayTy>(zeros, c, out);
+}
+
+void PayloadCorrelation::RandomAuth(absl::Span<internal::PayATy> out) {
+  const size_t num = out.size();
+  std::vector<internal::PayATy> zeros(num);
+  std::vector<internal::PayATy> rands(num);
+  if (ctx_->GetRank() == 0) {
+    RandomSet(absl::MakeSpan(rands));
+    RandomGet(absl::MakeSpan(zeros));
+  } else {
+    RandomGet(absl::MakeSpan(zeros));
+    RandomSet(absl::MakeSpan(rands));
+  }
+  PayOp::Add(absl::MakeConstSpan(
+                 reinterpret_cast<const internal::PayTy*>(zeros.data()),
+                 2 * num),
+             absl::MakeConstSpan(
+                 reinterpret_cast<const internal::PayTy*>(rands.data()),
+                 2 * num),
+             absl::MakeSpan(reinterpret_cast<internal::PayTy*>(out.data()),
+                            2 * num));
+}
+
+void PayloadCorrelation::ShuffleSet(absl::Span<const size_t> perm,
+                                    absl::Span<internal::PayTy> delta,
+                                    size_t repeat) {
+  const size_t batch_size = perm.size();
+  const size_t full_size = delta.size();
+  YACL_ENFORCE(full_size == batch_size * repeat);
+
+  if (CR_mode_) {
+    auto true_cr = GetTrueCorrelation(ctx_);
+    auto conn = ctx_->GetConnection();
+    shuffle::ShuffleSend(conn, true_cr->ot_receiver_, perm, delta, repeat);
+    return;
+  }
+
+  std::vector<uint128_t> seeds(2);
+  ctx_->GetState<Prg>()->Fill(absl::MakeSpan(seeds));
+  auto a = PayOp::Rand(seeds[0], full_size);
+  auto b = PayOp::Rand(seeds[1], full_size);
+  for (size_t offset = 0; offset < full_size; offset += batch_size) {
+    for (size_t i = 0; i < batch_size; ++i) {
+      delta[offset + i] = a[offset + perm[i]] + b[offset + i];
+    }
+  }
+  // delta = - \Pi(a) - b
+  PayOp::Neg(absl::MakeConstSpan(delta), delta);
+}
+
+void PayloadCorrelation::ShuffleGet(absl::Span<internal::PayTy> a,
+                                    absl::Span<internal::PayTy> b,
+                                    size_t repeat) {
+  const size_t full_size = a.size();
+  const size_t batch_size = full_size / repeat;
+  YACL_ENFORCE(full_size == b.size());
+  YACL_ENFORCE(full_size == batch_size * repeat);
+
+  if (CR_mode_) {
+    auto true_cr = GetTrueCorrelation(ctx_);
+    auto conn = ctx_->GetConnection();
+    shuffle::ShuffleRecv(conn, true_cr->ot_sender_, a, b, repeat);
+    return;
+  }
+
+  std::vector<uint128_t> seeds(2);
+  ctx_->GetState<Prg>()->Fill(absl::MakeSpan(seeds));
+  auto a_buf = PayOp::Rand(seeds[0], full_size);
+  auto b_buf = PayOp::Rand(seeds[1], full_size);
+  memcpy(a.data(), a_buf.data(), full_size * sizeof(internal::PayTy));
+  memcpy(b.data(), b_buf.data(), full_size * sizeof(internal::PayTy));
+}
+
+}  // namespace mcpsi
@@ -0,0 +1,61 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "mcpsi/context/context.h"
+#include "mcpsi/context/state.h"
+#include "mcpsi/cr/utils/vole_adapter.h"
+#include "mcpsi/ss/type.h"
+
+namespace mcpsi {
+
+// Correlated randomness of the payload SPDZ instance (over internal::PayTy)
+// > fake mode : from the shared Prg, the same as FakeCorrelation
+// > true mode : Wolverine VOLE over PayTy (base VOLEs by Gilboa) && the
+//               punctured-OT shuffle, both on the OT adapters of the
+//               TrueCorrelation in the same context
+//
+// NOTE: only random a-shares && shuffles, the payloads are never multiplied
+class PayloadCorrelation : public State {
+ private:
+  std::shared_ptr<Context> ctx_;
+  bool CR_mode_{false};
+  // SPDZ key of the payloads
+  internal::PayTy key_;
+
+  // VOLE adapters are built lazily, on the first request
+  bool setup_vole_{false};
+  std::shared_ptr<vole::PayVoleAdapter> vole_sender_;
+  std::shared_ptr<vole::PayVoleAdapter> vole_receiver_;
+
+ public:
+  static const std::string id;
+  static constexpr StateSlot slot = StateSlot::kPayloadCorrelation;
+
+  PayloadCorrelation(std::shared_ptr<Context> ctx, bool CR_mode)
+      : ctx_(ctx), CR_mode_(CR_mode) {}
+
+  internal::PayTy GetKey() const { return key_; }
+
+  void SetKey(internal::PayTy key) {
+    key_ = key;
+    setup_vole_ = false;  // rebuilt on the next request
+  }
+
+  // entry
+  void RandomSet(absl::Span<internal::PayATy> out);
+  void RandomGet(absl::Span<internal::PayATy> out);
+  void RandomAuth(absl::Span<internal::PayATy> out);
+
+  // entry, `perm` is given (e.g. the one of the keys), so that the keys &&
+  // the payloads could be shuffled together
+  void ShuffleSet(absl::Span<const size_t> perm,
+                  absl::Span<internal::PayTy> delta, size_t repeat = 1);
+  void ShuffleGet(absl::Span<internal::PayTy> a, absl::Span<internal::PayTy> b,
+                  size_t repeat = 1);
+
+ private:
+  void InitVoleAdapter();
+};
+
+}  // namespace mcpsi
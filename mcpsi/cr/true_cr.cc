@@ -1,5 +1,7 @@
 #include "mcpsi/cr/true_cr.h"
 
+#include <array>
+
 #include "mcpsi/cr/utils/ot_helper.h"
 #include "mcpsi/ss/type.h"
 #include "mcpsi/utils/vec_op.h"
@@ -62,7 +64,7 @@ void TrueCorrelation::BeaverTriple(absl::Span<internal::ATy> a,
   // ---- consistency check ----
   auto auth_A = auth_abcAC_span.subspan(3 * num, num);
   auto auth_C = auth_abcAC_span.subspan(4 * num, num);
-  auto seed = conn->SyncSeed();
+  auto seed = conn->DrawCoin();
   auto p_coef = internal::op::Rand(seed, num);
   std::vector<internal::ATy> coef(num, {0, 0});
   std::transform(p_coef.cbegin(), p_coef.cend(), coef.begin(),
@@ -176,7 +178,7 @@ void TrueCorrelation::DyBeaverTripleGet(absl::Span<internal::ATy> a,
   // ---- consistency check ----
   auto auth_A = auth_abcAC_span.subspan(3 * num, num);
   auto auth_C = auth_abcAC_span.subspan(4 * num, num);
-  auto seed = conn->SyncSeed();
+  auto seed = conn->DrawCoin();
   auto p_coef = internal::op::Rand(seed, num);
   std::vector<internal::ATy> coef(num, {0, 0});
   std::transform(p_coef.cbegin(), p_coef.cend(), coef.begin(),
@@ -233,43 +235,8 @@ void TrueCorrelation::DyBeaverTripleGet(absl::Span<internal::ATy> a,
   }
   // ---- consistency check ----
   // Dy
-  auto delta = dy_key_.val;
-  std::vector<internal::PTy> R(num * 2, 0);
-  std::vector<internal::PTy> A(num * 2, 0);
-  std::vector<internal::PTy> B(num * 2, 0);
-
-  dy_key_sender_->rsend(absl::MakeSpan(R));
-  // ot::OtHelper(ot_sender_, ot_receiver_)
-  //     .BaseVoleSend(conn, delta, absl::MakeSpan(R));
-  dy_key_receiver_->rrecv(absl::MakeSpan(A), absl::MakeSpan(B));
-  // ot::OtHelper(ot_sender_, ot_receiver_)
-  //     .BaseVoleRecv(conn, absl::MakeSpan(A), absl::MakeSpan(B));
-
-  internal::op::SubInplace(absl::MakeSpan(R), absl::MakeSpan(B));
-  internal::op::AddInplace(
-      absl::MakeSpan(R),
-      internal::op::ScalarMul(
-          delta,
-          absl::MakeConstSpan(reinterpret_cast<const internal::PTy*>(a.data()),
-                              2 * num)));
-
-  auto diff_A = internal::op::Sub(
-      absl::MakeConstSpan(A),
-      absl::MakeConstSpan(reinterpret_cast<const internal::PTy*>(a.data()),
-                          2 * num));
-
-  auto diff_buf = conn->Exchange(
-      yacl::ByteContainerView(diff_A.data(), 2 * num * sizeof(internal::PTy)));
-  YACL_ENFORCE(static_cast<uint64_t>(diff_buf.size()) ==
-               2 * num * sizeof(internal::PTy));
-  auto remote_diff_A = absl::MakeSpan(
-      reinterpret_cast<internal::PTy*>(diff_buf.data()), 2 * num);
-
-  internal::op::SubInplace(absl::MakeSpan(R),
-                           internal::op::ScalarMul(delta, remote_diff_A));
-
-  memcpy(reinterpret_cast<internal::PTy*>(r.data()), R.data(),
-         2 * num * sizeof(internal::PTy));
+  EnsureDyKeyAdapter();
+  VoleProduct(*dy_key_sender_, *dy_key_receiver_, dy_key_.val, a, r, true);
 }
 
 // TODO: Current is the same as BeaverTriple
@@ -340,7 +307,7 @@ void TrueCorrelation::DyBeaverTripleSet(absl::Span<internal::ATy> a,
   // ---- consistency check ----
   auto auth_A = auth_abcAC_span.subspan(3 * num, num);
   auto auth_C = auth_abcAC_span.subspan(4 * num, num);
-  auto seed = conn->SyncSeed();
+  auto seed = conn->DrawCoin();
   auto p_coef = internal::op::Rand(seed, num);
   std::vector<internal::ATy> coef(num, {0, 0});
   std::transform(p_coef.cbegin(), p_coef.cend(), coef.begin(),
@@ -397,43 +364,130 @@ void TrueCorrelation::DyBeaverTripleSet(absl::Span<internal::ATy> a,
   }
   // ---- consistency check ----
   // Dy
-  auto delta = dy_key_.val;
-  std::vector<internal::PTy> R(num * 2, 0);
-  std::vector<internal::PTy> A(num * 2, 0);
-  std::vector<internal::PTy> B(num * 2, 0);
+  EnsureDyKeyAdapter();
+  VoleProduct(*dy_key_sender_, *dy_key_receiver_, dy_key_.val, a, r, false);
+}
 
-  dy_key_receiver_->rrecv(absl::MakeSpan(A), absl::MakeSpan(B));
-  // ot::OtHelper(ot_sender_, ot_receiver_)
-  //     .BaseVoleRecv(conn, absl::MakeSpan(A), absl::MakeSpan(B));
-  dy_key_sender_->rsend(absl::MakeSpan(R));
-  // ot::OtHelper(ot_sender_, ot_receiver_)
-  //     .BaseVoleSend(conn, delta, absl::MakeSpan(R));
+void TrueCorrelation::ScalarDyBeaverTripleSet(const internal::ATy& t,
+                                              absl::Span<internal::ATy> a,
+                                              absl::Span<internal::ATy> b,
+                                              absl::Span<internal::ATy> c,
+                                              absl::Span<internal::ATy> r,
+                                              absl::Span<internal::ATy> s) {
+  DyBeaverTripleSet(a, b, c, r);
+  MaskProduct(t.val, a, s, false);
+}
 
-  internal::op::SubInplace(absl::MakeSpan(R), absl::MakeSpan(B));
-  internal::op::AddInplace(
-      absl::MakeSpan(R),
-      internal::op::ScalarMul(
-          delta,
-          absl::MakeConstSpan(reinterpret_cast<const internal::PTy*>(a.data()),
-                              2 * num)));
+void TrueCorrelation::ScalarDyBeaverTripleGet(const internal::ATy& t,
+                                              absl::Span<internal::ATy> a,
+                                              absl::Span<internal::ATy> b,
+                                              absl::Span<internal::ATy> c,
+                                              absl::Span<internal::ATy> r,
+                                              absl::Span<internal::ATy> s) {
+  DyBeaverTripleGet(a, b, c, r);
+  MaskProduct(t.val, a, s, true);
+}
 
-  auto diff_A = internal::op::Sub(
-      absl::MakeConstSpan(A),
-      absl::MakeConstSpan(reinterpret_cast<const internal::PTy*>(a.data()),
-                          2 * num));
+SnapshotPayload TrueCorrelation::DrawBase() {
+  YACL_ENFORCE(setup_ot_ == true, "call OneTimeSetup (or LoadSnapshot) first");
+  EnsureVoleAdapter();
+  EnsureDyKeyAdapter();
+  const bool send_first = ctx_->GetRank() == 0;
+
+  SnapshotPayload payload;
+  payload.AppendOne(key_);
+  payload.AppendOne(dy_key_);
+
+  // base OTs: random OTs sent by ot_sender_ are the base OTs of the next
+  // receiver, && vice versa
+  const size_t ot_num = ot::YaclSsOtAdapter::kBaseOtNum;
+  std::vector<std::array<uint128_t, 2>> send_base(ot_num);
+  std::vector<uint128_t> recv_base(ot_num);
+  yacl::dynamic_bitset<uint128_t> choices(ot_num);
+  if (send_first) {
+    ot_sender_->send_rrot(absl::MakeSpan(send_base));
+    ot_receiver_->recv_rrot(absl::MakeSpan(recv_base), choices);
+  } else {
+    ot_receiver_->recv_rrot(absl::MakeSpan(recv_base), choices);
+    ot_sender_->send_rrot(absl::MakeSpan(send_base));
+  }
+  uint128_t choice_bits = 0;
+  for (size_t i = 0; i < ot_num; ++i) {
+    choice_bits |= static_cast<uint128_t>(choices[i]) << i;
+  }
+  payload.Append<std::array<uint128_t, 2>>(send_base);
+  payload.Append<uint128_t>(recv_base);
+  payload.AppendOne(choice_bits);
+
+  // base VOLEs of the SPDZ-key && the DY-key adapters
+  const size_t vole_num = vole::WolverineVoleAdapter::SetupVoleNum();
+  for (auto [sender, receiver] :
+       {std::make_pair(vole_sender_, vole_receiver_),
+        std::make_pair(dy_key_sender_, dy_key_receiver_)}) {
+    std::vector<internal::PTy> c(vole_num);
+    std::vector<internal::PTy> a(vole_num);
+    std::vector<internal::PTy> b(vole_num);
+    if (send_first) {
+      sender->rsend(absl::MakeSpan(c));
+      receiver->rrecv(absl::MakeSpan(a), absl::MakeSpan(b));
+    } else {
+      receiver->rrecv(absl::MakeSpan(a), absl::MakeSpan(b));
+      sender->rsend(absl::MakeSpan(c));
+    }
+    payload.Append<internal::PTy>(c);
+    payload.Append<internal::PTy>(a);
+    payload.Append<internal::PTy>(b);
+  }
+  return payload;
+}
 
-  auto diff_buf = conn->Exchange(
-      yacl::ByteContainerView(diff_A.data(), 2 * num * sizeof(internal::PTy)));
-  YACL_ENFORCE(static_cast<uint64_t>(diff_buf.size()) ==
-               2 * num * sizeof(internal::PTy));
-  auto remote_diff_A = absl::MakeSpan(
-      reinterpret_cast<internal::PTy*>(diff_buf.data()), 2 * num);
+void TrueCorrelation::SetupFromBase(SnapshotPayload& payload) {
+  key_ = payload.NextOne<internal::PTy>();
+  dy_key_ = payload.NextOne<internal::ATy>();
 
-  internal::op::SubInplace(absl::MakeSpan(R),
-                           internal::op::ScalarMul(delta, remote_diff_A));
+  auto send_base = payload.Next<std::array<uint128_t, 2>>();
+  auto recv_base = payload.Next<uint128_t>();
+  auto choice_bits = payload.NextOne<uint128_t>();
+  yacl::dynamic_bitset<uint128_t> choices(ot::YaclSsOtAdapter::kBaseOtNum);
+  for (size_t i = 0; i < choices.size(); ++i) {
+    choices[i] = (choice_bits >> i) & 1;
+  }
+  auto [send_link, recv_link] = SpawnLinkPair();
+  auto ot_sender = std::make_shared<ot::YaclSsOtAdapter>(send_link, true);
+  auto ot_receiver = std::make_shared<ot::YaclSsOtAdapter>(recv_link, false);
+  auto task = std::async(std::launch::async,
+                         [&] { ot_sender->OneTimeSetup(choices, recv_base); });
+  ot_receiver->OneTimeSetup(send_base);
+  task.get();
+  ot_sender_ = ot_sender;
+  ot_receiver_ = ot_receiver;
+  setup_ot_ = true;
+
+  auto vole_c = payload.Next<internal::PTy>();
+  auto vole_a = payload.Next<internal::PTy>();
+  auto vole_b = payload.Next<internal::PTy>();
+  InitVolePair(key_, vole_sender_, vole_receiver_, vole_c, vole_a, vole_b);
+  setup_vole_ = true;
+
+  auto dy_c = payload.Next<internal::PTy>();
+  auto dy_a = payload.Next<internal::PTy>();
+  auto dy_b = payload.Next<internal::PTy>();
+  InitVolePair(dy_key_.val, dy_key_sender_, dy_key_receiver_, dy_c, dy_a,
+               dy_b);
+  setup_dy_key_ = true;
+}
 
-  memcpy(reinterpret_cast<internal::PTy*>(r.data()), R.data(),
-         2 * num * sizeof(internal::PTy));
+void TrueCorrelation::SaveSnapshot(SetupSnapshot& snapshot) {
+  snapshot.Save(ctx_->GetConnection(), DrawBase());
+}
+
+bool TrueCorrelation::LoadSnapshot(SetupSnapshot& snapshot) {
+  SnapshotPayload payload;
+  if (snapshot.Load(ctx_->GetConnection(), &payload) == false) {
+    return false;
+  }
+  SetupFromBase(payload);
+  return true;
 }
 
 void TrueCorrelation::RandomSet(absl::Span<internal::ATy> out) {
@@ -441,6 +495,7 @@ void TrueCorrelation::RandomSet(absl::Span<internal::ATy> out) {
   std::vector<internal::PTy> a(num);
   std::vector<internal::PTy> b(num);
   // a * remote_key + b = remote_c
+  EnsureVoleAdapter();
   vole_receiver_->rrecv(absl::MakeSpan(a), absl::MakeSpan(b));
   // mac = a * key_
   auto mac = internal::op::ScalarMul(key_, absl::MakeConstSpan(a));
@@ -456,6 +511,7 @@ void TrueCorrelation::RandomGet(absl::Span<internal::ATy> out) {
   const size_t num = out.size();
   std::vector<internal::PTy> c(num);
   // remote_a * key_ + remote_b = c
+  EnsureVoleAdapter();
   vole_sender_->rsend(absl::MakeSpan(c));
   // Pack
   auto zeros = internal::op::Zeros(num);
@@ -545,6 +601,104 @@ void TrueCorrelation::AuthGet(absl::Span<internal::ATy> out) {
   memcpy(out.data(), ret.data(), ret.size() * sizeof(internal::ATy));
 }
 
+// [out] = [a] * delta, where delta is the sum of both parties' (sender) deltas
+void TrueCorrelation::VoleProduct(vole::VoleAdapter& sender,
+                                  vole::VoleAdapter& receiver,
+                                  const internal::PTy& delta,
+                                  absl::Span<const internal::ATy> a,
+                                  absl::Span<internal::ATy> out,
+                                  bool send_first) {
+  const size_t num = a.size();
+  YACL_ENFORCE(num == out.size());
+
+  std::vector<internal::PTy> R(num * 2, 0);
+  std::vector<internal::PTy> A(num * 2, 0);
+  std::vector<internal::PTy> B(num * 2, 0);
+
+  if (send_first) {
+    sender.rsend(absl::MakeSpan(R));
+    receiver.rrecv(absl::MakeSpan(A), absl::MakeSpan(B));
+  } else {
+    receiver.rrecv(absl::MakeSpan(A), absl::MakeSpan(B));
+    sender.rsend(absl::MakeSpan(R));
+  }
+  VoleCombine(delta, a, absl::MakeSpan(R), absl::MakeConstSpan(A),
+              absl::MakeConstSpan(B), out);
+}
+
+// [out] = [a] * t for a fresh mask t (one per call, never reused)
+// > small batches : Gilboa base VOLEs on the OT adapters
+// > large batches : a Wolverine pair with delta t, whose setup costs
+//                   SetupVoleNum() base VOLEs anyway
+void TrueCorrelation::MaskProduct(const internal::PTy& t,
+                                  absl::Span<const internal::ATy> a,
+                                  absl::Span<internal::ATy> out,
+                                  bool send_first) {
+  const size_t num = a.size();
+  YACL_ENFORCE(num == out.size());
+  if (num * 2 > vole::WolverineVoleAdapter::SetupVoleNum()) {
+    std::shared_ptr<vole::VoleAdapter> t_sender;
+    std::shared_ptr<vole::VoleAdapter> t_receiver;
+    InitVolePair(t, t_sender, t_receiver);
+    VoleProduct(*t_sender, *t_receiver, t, a, out, send_first);
+    return;
+  }
+
+  auto conn = ctx_->GetConnection();
+  ot::OtHelper helper(ot_sender_, ot_receiver_);
+  std::vector<internal::PTy> R(num * 2, 0);
+  std::vector<internal::PTy> A(num * 2, 0);
+  std::vector<internal::PTy> B(num * 2, 0);
+  if (send_first) {
+    helper.BaseVoleSend(conn, t, absl::MakeSpan(R));
+    helper.BaseVoleRecv(conn, absl::MakeSpan(A), absl::MakeSpan(B));
+  } else {
+    helper.BaseVoleRecv(conn, absl::MakeSpan(A), absl::MakeSpan(B));
+    helper.BaseVoleSend(conn, t, absl::MakeSpan(R));
+  }
+  VoleCombine(t, a, absl::MakeSpan(R), absl::MakeConstSpan(A),
+              absl::MakeConstSpan(B), out);
+}
+
+// turn random VOLEs (R; A, B), 2 for each [a], into [out] = [a] * delta
+void TrueCorrelation::VoleCombine(const internal::PTy& delta,
+                                  absl::Span<const internal::ATy> a,
+                                  absl::Span<internal::PTy> R,
+                                  absl::Span<const internal::PTy> A,
+                                  absl::Span<const internal::PTy> B,
+                                  absl::Span<internal::ATy> out) {
+  const size_t num = a.size();
+  YACL_ENFORCE(R.size() == num * 2 && A.size() == num * 2 &&
+               B.size() == num * 2);
+  auto conn = ctx_->GetConnection();
+
+  internal::op::SubInplace(R, B);
+  internal::op::AddInplace(
+      absl::MakeSpan(R),
+      internal::op::ScalarMul(
+          delta,
+          absl::MakeConstSpan(reinterpret_cast<const internal::PTy*>(a.data()),
+                              2 * num)));
+
+  auto diff_A = internal::op::Sub(
+      absl::MakeConstSpan(A),
+      absl::MakeConstSpan(reinterpret_cast<const internal::PTy*>(a.data()),
+                          2 * num));
+
+  auto diff_buf = conn->Exchange(
+      yacl::ByteContainerView(diff_A.data(), 2 * num * sizeof(internal::PTy)));
+  YACL_ENFORCE(static_cast<uint64_t>(diff_buf.size()) ==
+               2 * num * sizeof(internal::PTy));
+  auto remote_diff_A = absl::MakeSpan(
+      reinterpret_cast<internal::PTy*>(diff_buf.data()), 2 * num);
+
+  internal::op::SubInplace(absl::MakeSpan(R),
+                           internal::op::ScalarMul(delta, remote_diff_A));
+
+  memcpy(reinterpret_cast<internal::PTy*>(out.data()), R.data(),
+         2 * num * sizeof(internal::PTy));
+}
+
 // Copy from A2P
 std::vector<internal::PTy> TrueCorrelation::OpenAndCheck(
     absl::Span<const internal::ATy> in) {
@@ -562,7 +716,7 @@ std::vector<internal::PTy> TrueCorrelation::OpenAndCheck(
       absl::MakeConstSpan(val), absl::MakeSpan(real_val));
 
   // Generate Sync Seed After open Value
-  auto sync_seed = conn->SyncSeed();
+  auto sync_seed = conn->DrawCoin();
   auto coef = internal::op::Rand(sync_seed, size);
   // linear combination
   auto real_val_affine =
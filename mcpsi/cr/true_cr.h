@@ -1,20 +1,30 @@
 #pragma once
+#include <future>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "mcpsi/context/context.h"
 #include "mcpsi/context/state.h"
 #include "mcpsi/cr/cr.h"
 #include "mcpsi/cr/utils/ot_adapter.h"
+#include "mcpsi/cr/utils/snapshot.h"
 #include "mcpsi/cr/utils/vole_adapter.h"
 #include "mcpsi/ss/type.h"
 
 namespace mcpsi {
 
+// Correlated randomness from OT && VOLE
+// > products (Beaver / DyBeaver) : OT-based Gilboa multiplication (OtHelper)
+// > MACs && DY-key products      : Wolverine VOLE (sublinear communication)
+// > scalar-mask products         : base VOLE on the OT adapters (Wolverine
+//                                  VOLE only for large batches)
 class TrueCorrelation : public Correlation {
  private:
   bool setup_ot_{false};
-  bool setup_vole_{false};  // useless
+  // VOLE adapters are built lazily, on the first request
+  bool setup_vole_{false};
+  bool setup_dy_key_{false};
 
  public:
   // OT adapter
@@ -34,22 +44,10 @@ class TrueCorrelation : public Correlation {
   void InitOtAdapter() {
     if (setup_ot_ == true) return;
 
-    auto conn = ctx_->GetConnection();
-    if (ctx_->GetRank() == 0) {
-      ot_sender_ = std::make_shared<ot::YaclSsOtAdapter>(conn->Spawn(), true);
-      ot_sender_->OneTimeSetup();
-
-      ot_receiver_ =
-          std::make_shared<ot::YaclSsOtAdapter>(conn->Spawn(), false);
-      ot_receiver_->OneTimeSetup();
-    } else {
-      ot_receiver_ =
-          std::make_shared<ot::YaclSsOtAdapter>(conn->Spawn(), false);
-      ot_receiver_->OneTimeSetup();
-
-      ot_sender_ = std::make_shared<ot::YaclSsOtAdapter>(conn->Spawn(), true);
-      ot_sender_->OneTimeSetup();
-    }
+    auto [send_link, recv_link] = SpawnLinkPair();
+    ot_sender_ = std::make_shared<ot::YaclSsOtAdapter>(send_link, true);
+    ot_receiver_ = std::make_shared<ot::YaclSsOtAdapter>(recv_link, false);
+    SetupBoth(*ot_sender_, *ot_receiver_);
 
     setup_ot_ = true;
   }
@@ -58,66 +56,55 @@ class TrueCorrelation : public Correlation {
     YACL_ENFORCE(setup_vole_ == false);
     if (setup_ot_ == false) InitOtAdapter();
 
-    auto conn = ctx_->GetConnection();
-    if (ctx_->GetRank() == 0) {
-      vole_sender_ =
-          std::make_shared<vole::WolverineVoleAdapter>(conn, ot_sender_, key_);
-      vole_sender_->OneTimeSetup();
+    InitVolePair(key_, vole_sender_, vole_receiver_);
+    setup_vole_ = true;
+  }
 
-      vole_receiver_ =
-          std::make_shared<vole::WolverineVoleAdapter>(conn, ot_receiver_);
-      vole_receiver_->OneTimeSetup();
-    } else {
-      vole_receiver_ =
-          std::make_shared<vole::WolverineVoleAdapter>(conn, ot_receiver_);
-      vole_receiver_->OneTimeSetup();
+  // (re)build the VOLE adapters whose delta is the DY-PRF key
+  void InitDyKeyAdapter() {
+    if (setup_ot_ == false) InitOtAdapter();
 
-      vole_sender_ =
-          std::make_shared<vole::WolverineVoleAdapter>(conn, ot_sender_, key_);
-      vole_sender_->OneTimeSetup();
-    }
-    setup_vole_ = true;
+    InitVolePair(dy_key_.val, dy_key_sender_, dy_key_receiver_);
+    setup_dy_key_ = true;
   }
 
+  // NOTE: the SPDZ key should be set (SetKey) before, adapters built with
+  // another key would be rebuilt
   void OneTimeSetup() override {
     if (setup_ot_ == false) {
       InitOtAdapter();
     }
 
-    if (setup_vole_ == false) {
-      InitVoleAdapter();
-    }
-
     RandomAuth(absl::MakeSpan(&dy_key_, 1));
+  }
 
-    auto conn = ctx_->GetConnection();
-    if (ctx_->GetRank() == 0) {
-      dy_key_sender_ = std::make_shared<vole::WolverineVoleAdapter>(
-          conn, ot_sender_, dy_key_.val);
-      dy_key_sender_->OneTimeSetup();
+  // the keys && fresh base OTs / base VOLEs (drawn from the running adapters,
+  // never used by them), both parties should call it after the setup
+  SnapshotPayload DrawBase();
 
-      dy_key_receiver_ =
-          std::make_shared<vole::WolverineVoleAdapter>(conn, ot_receiver_);
-      dy_key_receiver_->OneTimeSetup();
-    } else {
-      dy_key_receiver_ =
-          std::make_shared<vole::WolverineVoleAdapter>(conn, ot_receiver_);
-      dy_key_receiver_->OneTimeSetup();
+  // instead of OneTimeSetup (&& SetKey / SetDyKey), set up all adapters from
+  // the output of DrawBase (of the same party), e.g. a sub-context on a
+  // spawned link, without base OT / base VOLE
+  void SetupFromBase(SnapshotPayload& payload);
 
-      dy_key_sender_ = std::make_shared<vole::WolverineVoleAdapter>(
-          conn, ot_sender_, dy_key_.val);
-      dy_key_sender_->OneTimeSetup();
-    }
-  }
+  // warm start: seal the output of DrawBase into `snapshot`
+  void SaveSnapshot(SetupSnapshot& snapshot);
+
+  // instead of OneTimeSetup (&& SetKey / SetDyKey), set up all adapters from
+  // `snapshot` without base OT / base VOLE, return false (nothing is set up)
+  // if there is no matching snapshot
+  bool LoadSnapshot(SetupSnapshot& snapshot);
 
   internal::PTy GetKey() const override { return key_; }
 
   void SetKey(internal::PTy key) override {
     key_ = key;
+    setup_vole_ = false;  // rebuilt on the next request
+  }
 
-    setup_vole_ = false;  // set it as false
-    InitVoleAdapter();
-    YACL_ENFORCE(setup_vole_ == true);
+  void SetDyKey(const internal::ATy& dy_key) override {
+    dy_key_ = dy_key;
+    setup_dy_key_ = false;  // rebuilt on the next request
   }
 
   // entry
@@ -131,6 +118,18 @@ class TrueCorrelation : public Correlation {
                          absl::Span<internal::ATy> b,
                          absl::Span<internal::ATy> c,
                          absl::Span<internal::ATy> r) override;
+  void ScalarDyBeaverTripleSet(const internal::ATy& t,
+                               absl::Span<internal::ATy> a,
+                               absl::Span<internal::ATy> b,
+                               absl::Span<internal::ATy> c,
+                               absl::Span<internal::ATy> r,
+                               absl::Span<internal::ATy> s) override;
+  void ScalarDyBeaverTripleGet(const internal::ATy& t,
+                               absl::Span<internal::ATy> a,
+                               absl::Span<internal::ATy> b,
+                               absl::Span<internal::ATy> c,
+                               absl::Span<internal::ATy> r,
+                               absl::Span<internal::ATy> s) override;
 
   // entry
   void RandomSet(absl::Span<internal::ATy> out) override;
@@ -147,7 +146,72 @@ class TrueCorrelation : public Correlation {
   void AuthSet(absl::Span<const internal::PTy> in,
                absl::Span<internal::ATy> out);
   void AuthGet(absl::Span<internal::ATy> out);
+  void VoleProduct(vole::VoleAdapter& sender, vole::VoleAdapter& receiver,
+                   const internal::PTy& delta,
+                   absl::Span<const internal::ATy> a,
+                   absl::Span<internal::ATy> out, bool send_first);
+  void MaskProduct(const internal::PTy& t, absl::Span<const internal::ATy> a,
+                   absl::Span<internal::ATy> out, bool send_first);
+  void VoleCombine(const internal::PTy& delta,
+                   absl::Span<const internal::ATy> a,
+                   absl::Span<internal::PTy> R,
+                   absl::Span<const internal::PTy> A,
+                   absl::Span<const internal::PTy> B,
+                   absl::Span<internal::ATy> out);
   std::vector<internal::PTy> OpenAndCheck(absl::Span<const internal::ATy> in);
+
+  void EnsureVoleAdapter() {
+    if (setup_vole_ == false) InitVoleAdapter();
+  }
+  void EnsureDyKeyAdapter() {
+    if (setup_dy_key_ == false) InitDyKeyAdapter();
+  }
+
+  // a pair of spawned links (send_link, recv_link), party0 sends on the first
+  // spawned one and party1 on the second
+  std::pair<std::shared_ptr<Connection>, std::shared_ptr<Connection>>
+  SpawnLinkPair() {
+    auto conn = ctx_->GetConnection();
+    auto link0 = conn->SpawnConnection();
+    auto link1 = conn->SpawnConnection();
+    if (ctx_->GetRank() == 0) {
+      return {link0, link1};
+    }
+    return {link1, link0};
+  }
+
+  // set up both directions at once, each on its own link
+  template <typename AdapterTy>
+  static void SetupBoth(AdapterTy& sender, AdapterTy& receiver) {
+    auto task = std::async(std::launch::async, [&] { sender.OneTimeSetup(); });
+    receiver.OneTimeSetup();
+    task.get();
+  }
+
+  // VOLE adapters with `delta` (sender) on a fresh pair of links, set up
+  // from the given base VOLEs (pre_c; pre_a, pre_b) if any
+  void InitVolePair(const internal::PTy& delta,
+                    std::shared_ptr<vole::VoleAdapter>& sender,
+                    std::shared_ptr<vole::VoleAdapter>& receiver,
+                    absl::Span<const internal::PTy> pre_c = {},
+                    absl::Span<const internal::PTy> pre_a = {},
+                    absl::Span<const internal::PTy> pre_b = {}) {
+    auto [send_link, recv_link] = SpawnLinkPair();
+    auto wolverine_sender = std::make_shared<vole::WolverineVoleAdapter>(
+        send_link, ot_sender_, delta);
+    auto wolverine_receiver =
+        std::make_shared<vole::WolverineVoleAdapter>(recv_link, ot_receiver_);
+    if (pre_c.empty()) {
+      SetupBoth(*wolverine_sender, *wolverine_receiver);
+    } else {
+      auto task = std::async(std::launch::async,
+                             [&] { wolverine_sender->OneTimeSetup(pre_c); });
+      wolverine_receiver->OneTimeSetup(pre_a, pre_b);
+      task.get();
+    }
+    sender = wolverine_sender;
+    receiver = wolverine_receiver;
+  }
   // TODO:
   // internal::PTy SingleOpenAndCheck(const internal::ATy& in);
 };
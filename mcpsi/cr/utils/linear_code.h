@@ -66,9 +66,10 @@ class LocalLinearCode : LinearCodeInterface {
   uint32_t GetDimention() const override { return k_; }
   uint32_t GetLength() const override { return n_; }
 
-  // Encode a message (input) into a codeword (output)
-  void Encode(absl::Span<const internal::PTy> in,
-              absl::Span<internal::PTy> out) {
+  // Encode a message (input) into a codeword (output), over any field T
+  template <typename T = internal::PTy>
+  void Encode(absl::Span<const internal::NonDeduced<T>> in,
+              absl::Span<T> out) {
     YACL_ENFORCE_EQ(in.size(), k_);
     // YACL_ENFORCE_EQ(out.size(), n_);
 
@@ -119,10 +120,11 @@ class LocalLinearCode : LinearCodeInterface {
     }
   }
 
-  void Encode2(absl::Span<const internal::PTy> in0,
-               absl::Span<internal::PTy> out0,
-               absl::Span<const internal::PTy> in1,
-               absl::Span<internal::PTy> out1) {
+  template <typename T = internal::PTy>
+  void Encode2(absl::Span<const internal::NonDeduced<T>> in0,
+               absl::Span<T> out0,
+               absl::Span<const internal::NonDeduced<T>> in1,
+               absl::Span<T> out1) {
     YACL_ENFORCE_EQ(in0.size(), k_);
     YACL_ENFORCE_EQ(in1.size(), k_);
     YACL_ENFORCE_EQ(out0.size(), out1.size());
@@ -57,9 +57,10 @@ void MpCotRecv(const std::shared_ptr<Connection>& conn,
   }
 }
 
+template <typename T>
 void MpFssSend(const std::shared_ptr<Connection>& conn,
                const yc::OtSendStore& send_ot, const MpParam& param,
-               absl::Span<internal::PTy> w, absl::Span<internal::PTy> output) {
+               absl::Span<T> w, absl::Span<T> output) {
   YACL_ENFORCE(output.size() >= param.mp_vole_size_);
   YACL_ENFORCE(w.size() >= param.noise_num_);
   YACL_ENFORCE(send_ot.Size() >= param.require_ot_num_);
@@ -75,7 +76,7 @@ void MpFssSend(const std::shared_ptr<Connection>& conn,
   const auto& batch_size = param.sp_vole_size_;
   const auto& last_batch_size = param.last_sp_vole_size_;
 
-  auto send_msgs = std::vector<internal::PTy>(batch_num, 0);
+  auto send_msgs = std::vector<T>(batch_num, 0);
 
   for (size_t i = 0; i < batch_num; ++i) {
     auto this_size = (i == batch_num - 1) ? last_batch_size : batch_size;
@@ -83,22 +84,22 @@ void MpFssSend(const std::shared_ptr<Connection>& conn,
     auto this_output = output.subspan(i * batch_size, this_size);
 
     std::transform(this_span.cbegin(), this_span.cend(), this_output.begin(),
-                   [](uint128_t val) { return internal::PTy(val); });
-    auto tmp = std::reduce(this_output.cbegin(), this_output.cend(),
-                           internal::PTy(0), std::plus<internal::PTy>());
+                   [](uint128_t val) { return T(val); });
+    auto tmp = std::reduce(this_output.cbegin(), this_output.cend(), T(0),
+                           std::plus<T>());
     send_msgs[i] = tmp - w[i];
   }
 
   conn->SendAsync(
       conn->NextRank(),
-      yacl::ByteContainerView(send_msgs.data(),
-                              send_msgs.size() * sizeof(internal::PTy)),
+      yacl::ByteContainerView(send_msgs.data(), send_msgs.size() * sizeof(T)),
       "MpVole");
 }
 
+template <typename T>
 void MpFssRecv(const std::shared_ptr<Connection>& conn,
                const yc::OtRecvStore& recv_ot, const MpParam& param,
-               absl::Span<internal::PTy> output) {
+               absl::Span<T> output) {
   YACL_ENFORCE(output.size() >= param.mp_vole_size_);
   YACL_ENFORCE(recv_ot.Size() >= param.require_ot_num_);
 
@@ -115,8 +116,8 @@ void MpFssRecv(const std::shared_ptr<Connection>& conn,
   const auto& indexes = param.indexes_;
 
   auto recv_buff = conn->Recv(conn->NextRank(), "MpVole");
-  auto recv_msgs = absl::MakeSpan(
-      reinterpret_cast<internal::PTy*>(recv_buff.data()), batch_num);
+  auto recv_msgs =
+      absl::MakeSpan(reinterpret_cast<T*>(recv_buff.data()), batch_num);
 
   for (size_t i = 0; i < batch_num; ++i) {
     auto this_size = (i == batch_num - 1) ? last_batch_size : batch_size;
@@ -124,18 +125,19 @@ void MpFssRecv(const std::shared_ptr<Connection>& conn,
     auto this_output = output.subspan(i * batch_size, this_size);
 
     std::transform(this_span.cbegin(), this_span.cend(), this_output.begin(),
-                   [](uint128_t val) { return internal::PTy(val); });
+                   [](uint128_t val) { return T(val); });
 
-    auto tmp = std::reduce(this_output.cbegin(), this_output.cend(),
-                           internal::PTy(0), std::plus<internal::PTy>());
+    auto tmp = std::reduce(this_output.cbegin(), this_output.cend(), T(0),
+                           std::plus<T>());
     recv_msgs[i] = recv_msgs[i] - tmp;
     this_output[indexes[i]] = this_output[indexes[i]] + recv_msgs[i];
   }
 }
 
+template <typename T>
 void MpVoleSend(const std::shared_ptr<Connection>& conn,
                 const yc::OtSendStore& send_ot, const MpParam& param,
-                absl::Span<internal::PTy> w, absl::Span<internal::PTy> output) {
+                absl::Span<T> w, absl::Span<T> output) {
   YACL_ENFORCE(output.size() >= param.mp_vole_size_);
   YACL_ENFORCE(w.size() >= param.noise_num_);
   YACL_ENFORCE(send_ot.Size() >= param.require_ot_num_);
@@ -143,9 +145,10 @@ void MpVoleSend(const std::shared_ptr<Connection>& conn,
   MpFssSend(conn, send_ot, param, w, output);
 }
 
+template <typename T>
 void MpVoleRecv(const std::shared_ptr<Connection>& conn,
                 const yc::OtRecvStore& recv_ot, const MpParam& param,
-                absl::Span<internal::PTy> v, absl::Span<internal::PTy> output) {
+                absl::Span<T> v, absl::Span<T> output) {
   YACL_ENFORCE(output.size() >= param.mp_vole_size_);
   YACL_ENFORCE(v.size() >= param.noise_num_);
   YACL_ENFORCE(recv_ot.Size() >= param.require_ot_num_);
@@ -164,4 +167,25 @@ void MpVoleRecv(const std::shared_ptr<Connection>& conn,
   }
 }
 
+#define INSTANTIATE_MP(T)                                                 \
+  template void MpFssSend<T>(const std::shared_ptr<Connection>& conn,     \
+                             const yc::OtSendStore& send_ot,              \
+                             const MpParam& param, absl::Span<T> w,       \
+                             absl::Span<T> output);                       \
+  template void MpFssRecv<T>(const std::shared_ptr<Connection>& conn,     \
+                             const yc::OtRecvStore& recv_ot,              \
+                             const MpParam& param, absl::Span<T> output); \
+  template void MpVoleSend<T>(const std::shared_ptr<Connection>& conn,    \
+                              const yc::OtSendStore& send_ot,             \
+                              const MpParam& param, absl::Span<T> w,      \
+                              absl::Span<T> output);                      \
+  template void MpVoleRecv<T>(const std::shared_ptr<Connection>& conn,    \
+                              const yc::OtRecvStore& recv_ot,             \
+                              const MpParam& param, absl::Span<T> v,      \
+                              absl::Span<T> output)
+
+INSTANTIATE_MP(kFp128);
+INSTANTIATE_MP(kFp256);
+#undef INSTANTIATE_MP
+
 }  // namespace mcpsi::vole
@@ -60,21 +60,25 @@ void MpCotSend(const std::shared_ptr<Connection>& conn,
                const yc::OtRecvStore& recv_ot, const MpParam& param,
                absl::Span<uint128_t> output);
 
-// Multi-points Fss
+// Multi-points Fss, T is the field (kFp128 or kFp256)
+template <typename T>
 void MpFssSend(const std::shared_ptr<Connection>& conn,
                const yc::OtSendStore& send_ot, const MpParam& param,
-               absl::Span<internal::PTy> w, absl::Span<internal::PTy> output);
+               absl::Span<T> w, absl::Span<T> output);
 
+template <typename T>
 void MpFssRecv(const std::shared_ptr<Connection>& conn,
                const yc::OtRecvStore& recv_ot, const MpParam& param,
-               absl::Span<internal::PTy> output);
+               absl::Span<T> output);
 
 // Multi-points Vole
+template <typename T>
 void MpVoleSend(const std::shared_ptr<Connection>& conn,
                 const yc::OtSendStore& send_ot, const MpParam& param,
-                absl::Span<internal::PTy> w, absl::Span<internal::PTy> output);
+                absl::Span<T> w, absl::Span<T> output);
+template <typename T>
 void MpVoleRecv(const std::shared_ptr<Connection>& conn,
                 const yc::OtRecvStore& recv_ot, const MpParam& param,
-                absl::Span<internal::PTy> v, absl::Span<internal::PTy> output);
+                absl::Span<T> v, absl::Span<T> output);
 
 }  // namespace mcpsi::vole
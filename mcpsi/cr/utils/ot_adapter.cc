@@ -71,6 +71,33 @@ void YaclSsOtAdapter::OneTimeSetup() {
   is_setup_ = true;
 }
 
+void YaclSsOtAdapter::OneTimeSetup(
+    const yacl::dynamic_bitset<uint128_t>& choices,
+    absl::Span<const uint128_t> blocks) {
+  YACL_ENFORCE(is_sender_);
+  YACL_ENFORCE(choices.size() == kBaseOtNum);
+  YACL_ENFORCE(blocks.size() == kBaseOtNum);
+
+  auto base_ot = yc::MakeOtRecvStore(
+      choices, std::vector<uint128_t>(blocks.begin(), blocks.end()));
+  ss_ot_sender_->OneTimeSetup(ctx_, base_ot);
+  Delta = ss_ot_sender_->GetDelta();
+
+  is_setup_ = true;
+}
+
+void YaclSsOtAdapter::OneTimeSetup(
+    absl::Span<const std::array<uint128_t, 2>> blocks) {
+  YACL_ENFORCE(is_sender_ == false);
+  YACL_ENFORCE(blocks.size() == kBaseOtNum);
+
+  auto base_ot = yc::MakeOtSendStore(
+      std::vector<std::array<uint128_t, 2>>(blocks.begin(), blocks.end()));
+  ss_ot_receiver_->OneTimeSetup(ctx_, base_ot);
+
+  is_setup_ = true;
+}
+
 void YaclSsOtAdapter::send_cot(absl::Span<uint128_t> data) {
   YACL_ENFORCE(is_sender_);
   // [Warning] copy, low efficiency
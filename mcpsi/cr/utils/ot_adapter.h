@@ -109,8 +109,19 @@ class YaclSsOtAdapter : public OtAdapter {
 
   ~YaclSsOtAdapter() {}
 
+  // number of base OTs
+  static constexpr size_t kBaseOtNum = 128;
+
   void OneTimeSetup() override;
 
+  // set up from given base OTs (e.g. of a warm-start snapshot), skip the
+  // public-key base OT
+  // sender (base-OT receiver): choices && received blocks
+  void OneTimeSetup(const yacl::dynamic_bitset<uint128_t>& choices,
+                    absl::Span<const uint128_t> blocks);
+  // receiver (base-OT sender): pairs of blocks
+  void OneTimeSetup(absl::Span<const std::array<uint128_t, 2>> blocks);
+
   inline void send_rcot(absl::Span<uint128_t> data) override { send_cot(data); }
 
   inline void send_rrot(absl::Span<std::array<uint128_t, 2>> data) override {
@@ -5,6 +5,7 @@
 #include "yacl/crypto/primitives/ot/gywz_ote.h"
 #include "yacl/crypto/tools/crhash.h"
 #include "yacl/math/gadget.h"
+#include "yacl/utils/parallel.h"
 
 namespace mcpsi::ot {
 
@@ -15,6 +16,200 @@ namespace {
 // https://eprint.iacr.org/2016/505.pdf
 // MASCOT
 constexpr size_t kExtFactor = 3;
+
+// bits in Public Type
+constexpr size_t kPTyBits = sizeof(internal::PTy) * 8;
+
+// ------------------------------------------------------------
+//  Gilboa engine: ROT <--> additive COT, one block of
+//  GilboaBits() OTs per multiplication
+// ------------------------------------------------------------
+
+// bit length of the prime, i.e. ceil(log2 prime)
+// NOTE: field elements (the multiplier of the receiver) never set the bits
+// beyond it, so the OTs for those bits are skipped
+size_t GilboaBits() {
+  static const size_t bits = [] {
+    const uint256_t max_val = internal::PTy::GetPrime() - 1;
+    size_t ret = 0;
+    while (ret < kPTyBits && (max_val >> ret) != uint256_t(0)) {
+      ++ret;
+    }
+    return ret;
+  }();
+  return bits;
+}
+
+// bytes of each correction on the wire, i.e. ceil(GilboaBits() / 8)
+size_t GilboaBytes() { return (GilboaBits() + 7) / 8; }
+
+// the number of raw terms (each below max(prime, 2^128)) that a uint256
+// accumulator could hold without overflow
+size_t LazyTerms() {
+  static const size_t terms = [] {
+    const uint256_t u128_bound = uint256_t(absl::Uint128Max()) + 1;
+    const uint256_t prime = internal::PTy::GetPrime();
+    const uint256_t bound = prime > u128_bound ? prime : u128_bound;
+    const uint256_t ret = (~uint256_t(0)) / bound;
+    YACL_ENFORCE(ret >= uint256_t(2));
+    return ret > uint256_t(kPTyBits * 2) ? kPTyBits * 2
+                                         : static_cast<size_t>(ret);
+  }();
+  return terms;
+}
+
+// sum of field elements with lazy reduction (reduce once at the end)
+class LazySum {
+ public:
+  void Add(const uint256_t& val) {
+    if (terms_ == limit_) {
+      acc_ = internal::PTy(acc_).GetVal();
+      terms_ = 1;
+    }
+    acc_ += val;
+    ++terms_;
+  }
+
+  internal::PTy Get() const { return internal::PTy(acc_); }
+
+ private:
+  const size_t limit_{LazyTerms()};
+  uint256_t acc_{0};
+  size_t terms_{0};
+};
+
+// b * 2^k for k in [0, out.size()), by modular doubling
+void PowersOfTwo(const internal::PTy& b, absl::Span<uint256_t> out) {
+  const uint256_t prime = internal::PTy::GetPrime();
+  out[0] = b.GetVal();
+  for (size_t k = 1; k < out.size(); ++k) {
+    out[k] = out[k - 1] + out[k - 1];
+    if (out[k] >= prime) {
+      out[k] -= prime;
+    }
+  }
+}
+
+// Receiver: the lowest GilboaBits() bits of each element as OT choices
+yacl::dynamic_bitset<uint128_t> ChoiceBits(absl::Span<const internal::PTy> a) {
+  const size_t bits = GilboaBits();
+  auto choices = yacl::dynamic_bitset<uint128_t>(a.size() * bits);
+  for (size_t i = 0; i < a.size(); ++i) {
+    uint64_t limbs[kPTyBits / 64];
+    memcpy(limbs, &a[i], sizeof(limbs));
+    for (size_t k = 0; k < bits; ++k) {
+      choices.set(i * bits + k, (limbs[k / 64] >> (k % 64)) & 1);
+    }
+  }
+  return choices;
+}
+
+// Sender: msgs[k] = block0 - block1 + b * 2^k, each b owns `repeat` blocks,
+// msgs are packed into GilboaBytes() bytes each
+void CotSendMsgs(absl::Span<const std::array<uint128_t, 2>> ot_msgs,
+                 absl::Span<const internal::PTy> b, size_t repeat,
+                 absl::Span<uint8_t> msgs) {
+  const size_t bits = GilboaBits();
+  const size_t bytes = GilboaBytes();
+  const size_t block_num = b.size() * repeat;
+  YACL_ENFORCE(ot_msgs.size() == block_num * bits);
+  YACL_ENFORCE(msgs.size() == block_num * bits * bytes);
+  const uint256_t prime = internal::PTy::GetPrime();
+  yacl::parallel_for(0, block_num, [&](uint64_t bg, uint64_t ed) {
+    std::vector<uint256_t> pows(bits);
+    size_t cur = b.size();  // the owner of `pows`
+    for (auto blk = bg; blk < ed; ++blk) {
+      if (blk / repeat != cur) {
+        cur = blk / repeat;
+        PowersOfTwo(b[cur], absl::MakeSpan(pows));
+      }
+      const size_t offset = blk * bits;
+      for (size_t k = 0; k < bits; ++k) {
+        const auto& m = ot_msgs[offset + k];
+        // block0, block1 < 2^128 < prime, so the sum is below 3 * prime
+        uint256_t val = uint256_t(m[0]) + (prime - uint256_t(m[1])) + pows[k];
+        while (val >= prime) {
+          val -= prime;
+        }
+        // little-endian, the dropped (high) bytes are zero
+        memcpy(msgs.data() + (offset + k) * bytes, &val, bytes);
+      }
+    }
+  });
+}
+
+// Sender: out[i] = - sum of block0 in the i-th block
+void CotSendSum(absl::Span<const std::array<uint128_t, 2>> ot_msgs,
+                absl::Span<internal::PTy> out) {
+  const size_t bits = GilboaBits();
+  YACL_ENFORCE(ot_msgs.size() == out.size() * bits);
+  yacl::parallel_for(0, out.size(), [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      const size_t offset = i * bits;
+      // kPTyBits * 2^128 never overflows
+      uint256_t acc = 0;
+      for (size_t k = 0; k < bits; ++k) {
+        acc += uint256_t(ot_msgs[offset + k][0]);
+      }
+      out[i] = internal::PTy::Neg(internal::PTy(acc));
+    }
+  });
+}
+
+// Receiver: out[i] = sum of (block_choice + choice * msgs) in the i-th block,
+// msgs are packed as CotSendMsgs
+void CotRecvSum(absl::Span<const uint128_t> ot_msgs,
+                const yacl::dynamic_bitset<uint128_t>& choices,
+                absl::Span<const uint8_t> msgs, absl::Span<internal::PTy> out) {
+  const size_t bits = GilboaBits();
+  const size_t bytes = GilboaBytes();
+  YACL_ENFORCE(ot_msgs.size() >= out.size() * bits);
+  YACL_ENFORCE(msgs.size() >= out.size() * bits * bytes);
+  const uint256_t prime = internal::PTy::GetPrime();
+  yacl::parallel_for(0, out.size(), [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      const size_t offset = i * bits;
+      LazySum acc;
+      for (size_t k = 0; k < bits; ++k) {
+        acc.Add(uint256_t(ot_msgs[offset + k]));
+        if (choices[offset + k]) {
+          uint256_t val = 0;
+          memcpy(&val, msgs.data() + (offset + k) * bytes, bytes);
+          // a (malicious) sender may send non-reduced values
+          while (val >= prime) {
+            val -= prime;
+          }
+          acc.Add(val);
+        }
+      }
+      out[i] = acc.Get();
+    }
+  });
+}
+
+// out0[i] = sum_j in[i * kExtFactor + j] * coef0[i * kExtFactor + j]
+// out1[i] = sum_j in[i * kExtFactor + j] * coef1[i * kExtFactor + j]
+void Compress(absl::Span<const internal::PTy> in,
+              absl::Span<const internal::PTy> coef0,
+              absl::Span<const internal::PTy> coef1,
+              absl::Span<internal::PTy> out0, absl::Span<internal::PTy> out1) {
+  YACL_ENFORCE(in.size() == out0.size() * kExtFactor);
+  YACL_ENFORCE(out0.size() == out1.size());
+  yacl::parallel_for(0, out0.size(), [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      auto sum0 = internal::PTy::Zero();
+      auto sum1 = internal::PTy::Zero();
+      for (size_t j = 0; j < kExtFactor; ++j) {
+        const size_t idx = i * kExtFactor + j;
+        sum0 = sum0 + in[idx] * coef0[idx];
+        sum1 = sum1 + in[idx] * coef1[idx];
+      }
+      out0[i] = sum0;
+      out1[i] = sum1;
+    }
+  });
+}
+
 }  // namespace
 
 // ---------------------
@@ -26,43 +221,26 @@ void OtHelper::MulPPSend(std::shared_ptr<Connection> conn,
                          absl::Span<internal::PTy> c) {
   const size_t num = b.size();
   YACL_ENFORCE(num == c.size());
-  // bits in Public Type
-  const size_t PTy_bits = sizeof(internal::PTy) * 8;
   // ot num = num * bits of Public Type
-  const size_t ot_num = num * PTy_bits;
+  const size_t ot_num = num * GilboaBits();
   internal::op::Rand(absl::MakeSpan(b));
 
   std::vector<std::array<uint128_t, 2>> ot_send_msgs(ot_num);
   ot_sender_->send_rot(absl::MakeSpan(ot_send_msgs));  // rot
 
   // Convert ROT to additive-COT
-  auto send_msgs = std::vector<internal::PTy>(ot_num);
-  for (size_t i = 0; i < num; ++i) {
-    // ot_block0 - ot_block1 + b
-    // c = - block0
-    const size_t offset = i * PTy_bits;
-    auto bi_k = b[i];
-    for (size_t k = 0; k < PTy_bits; ++k) {
-      send_msgs[offset + k] = internal::PTy(ot_send_msgs[offset + k][0]) -
-                              internal::PTy(ot_send_msgs[offset + k][1]) + bi_k;
-      bi_k = bi_k * internal::PTy(2);
-    }
-  }
+  // ot_block0 - ot_block1 + b * 2^k
+  auto send_msgs = std::vector<uint8_t>(ot_num * GilboaBytes());
+  CotSendMsgs(ot_send_msgs, b, 1, absl::MakeSpan(send_msgs));
 
   // send
   conn->SendAsync(
       conn->NextRank(),
-      yacl::ByteContainerView(send_msgs.data(),
-                              send_msgs.size() * sizeof(internal::PTy)),
+      yacl::ByteContainerView(send_msgs.data(), send_msgs.size()),
       "Beaver:MulPP");
 
-  for (size_t i = 0; i < num; ++i) {
-    c[i] = internal::PTy::Zero();
-    const size_t offset = i * PTy_bits;
-    for (size_t j = 0; j < PTy_bits; ++j) {
-      c[i] = c[i] - internal::PTy(ot_send_msgs[offset + j][0]);
-    }
-  }
+  // c = - block0
+  CotSendSum(ot_send_msgs, c);
 }
 
 void OtHelper::MulPPRecv(std::shared_ptr<Connection> conn,
@@ -70,32 +248,22 @@ void OtHelper::MulPPRecv(std::shared_ptr<Connection> conn,
                          absl::Span<internal::PTy> c) {
   const size_t num = a.size();
   YACL_ENFORCE(num == c.size());
-  // bits in Public Type
-  const size_t PTy_bits = sizeof(internal::PTy) * 8;
   // ot num = num * bits of Public Type
-  const size_t ot_num = num * PTy_bits;
+  const size_t ot_num = num * GilboaBits();
 
   internal::op::Rand(a);  // rand a
-  auto choices = yacl::dynamic_bitset<uint128_t>(ot_num);
-  memcpy(choices.data(), a.data(), num * sizeof(internal::PTy));
+  auto choices = ChoiceBits(a);
 
   std::vector<uint128_t> ot_recv_msgs(ot_num);
   ot_receiver_->recv_rot(absl::MakeSpan(ot_recv_msgs), choices);
 
   auto recv_buf = conn->Recv(conn->NextRank(), "Beaver:MulPP");
+  YACL_ENFORCE(recv_buf.size() ==
+               static_cast<int64_t>(ot_num * GilboaBytes()));
   auto recv_span = absl::MakeConstSpan(
-      reinterpret_cast<internal::PTy *>(recv_buf.data()), ot_num);
-
-  for (size_t i = 0; i < num; ++i) {
-    c[i] = internal::PTy::Zero();
-    const size_t offset = i * PTy_bits;
-    for (size_t j = 0; j < PTy_bits; ++j) {
-      c[i] = c[i] + internal::PTy(ot_recv_msgs[offset + j]);
-      if (choices[offset + j]) {
-        c[i] = c[i] + internal::PTy(recv_span[offset + j]);
-      }
-    }
-  }
+      reinterpret_cast<const uint8_t *>(recv_buf.data()), recv_buf.size());
+
+  CotRecvSum(ot_recv_msgs, choices, recv_span, c);
 }
 
 void OtHelper::BeaverTriple(std::shared_ptr<Connection> conn,
@@ -134,69 +302,37 @@ void OtHelper::MulPPExtendSend(std::shared_ptr<Connection> conn,
                                absl::Span<internal::PTy> C) {
   const size_t num = b.size();
   YACL_ENFORCE(num == c.size());
-  // bits in Public Type
-  const size_t PTy_bits = sizeof(internal::PTy) * 8;
   // beaver extend num = num * extend factor
   const size_t ext_num = num * kExtFactor;
   // ot num = num * extend factor * bits of Public Type
-  const size_t ot_num = ext_num * PTy_bits;
+  const size_t ot_num = ext_num * GilboaBits();
   internal::op::Rand(absl::MakeSpan(b));
 
   std::vector<std::array<uint128_t, 2>> ot_send_msgs(ot_num);
   ot_sender_->send_rot(absl::MakeSpan(ot_send_msgs));  // rot
 
   // Convert ROT to additive-COT
-  auto send_msgs = std::vector<internal::PTy>(ot_num);
-  for (size_t i = 0; i < num; ++i) {
-    // ot_block0 - ot_block1 + b
-    // c = - block0
-    for (size_t j = 0; j < kExtFactor; ++j) {
-      const size_t offset = i * kExtFactor * PTy_bits + j * PTy_bits;
-      auto bi_k = b[i];
-      for (size_t k = 0; k < PTy_bits; ++k) {
-        send_msgs[offset + k] = internal::PTy(ot_send_msgs[offset + k][0]) -
-                                internal::PTy(ot_send_msgs[offset + k][1]) +
-                                bi_k;
-        bi_k = bi_k * internal::PTy(2);
-      }
-    }
-  }
+  // ot_block0 - ot_block1 + b * 2^k
+  auto send_msgs = std::vector<uint8_t>(ot_num * GilboaBytes());
+  CotSendMsgs(ot_send_msgs, b, kExtFactor, absl::MakeSpan(send_msgs));
 
   // send
   conn->SendAsync(
       conn->NextRank(),
-      yacl::ByteContainerView(send_msgs.data(),
-                              send_msgs.size() * sizeof(internal::PTy)),
+      yacl::ByteContainerView(send_msgs.data(), send_msgs.size()),
       "Beaver:MulPP");
 
-  auto ext_c = internal::op::Zeros(ext_num);
-  for (size_t i = 0; i < ext_num; ++i) {
-    const size_t offset = i * PTy_bits;
-    for (size_t j = 0; j < PTy_bits; ++j) {
-      ext_c[i] = ext_c[i] - internal::PTy(ot_send_msgs[offset + j][0]);
-    }
-  }
+  // c = - block0
+  auto ext_c = std::vector<internal::PTy>(ext_num);
+  CotSendSum(ot_send_msgs, absl::MakeSpan(ext_c));
 
   // sync and generate the coefficient
-  auto seed = conn->SyncSeed();
+  auto seed = conn->DrawCoin();
   auto coef = internal::op::Rand(seed, ext_num * 2);
-
   auto coef_span = absl::MakeConstSpan(coef);
-  //
-  auto cc = internal::op::Mul(absl::MakeConstSpan(ext_c),
-                              coef_span.subspan(0, ext_num));
-  //
-  auto CC = internal::op::Mul(absl::MakeConstSpan(ext_c),
-                              coef_span.subspan(ext_num, ext_num));
-
-  for (size_t i = 0; i < num; ++i) {
-    c[i] = internal::PTy::Zero();
-    C[i] = internal::PTy::Zero();
-    for (size_t j = 0; j < kExtFactor; ++j) {
-      c[i] = c[i] + cc[i * kExtFactor + j];
-      C[i] = C[i] + CC[i * kExtFactor + j];
-    }
-  }
+
+  Compress(ext_c, coef_span.subspan(0, ext_num),
+           coef_span.subspan(ext_num, ext_num), c, C);
 }
 
 void OtHelper::MulPPExtendRecv(std::shared_ptr<Connection> conn,
@@ -206,63 +342,35 @@ void OtHelper::MulPPExtendRecv(std::shared_ptr<Connection> conn,
                                absl::Span<internal::PTy> C) {
   const size_t num = a.size();
   YACL_ENFORCE(num == c.size());
-  // bits in Public Type
-  const size_t PTy_bits = sizeof(internal::PTy) * 8;
   // beaver extend num = num * extend factor
   const size_t ext_num = num * kExtFactor;
   // ot num = num * extend factor * bits of Public Type
-  const size_t ot_num = ext_num * PTy_bits;
+  const size_t ot_num = ext_num * GilboaBits();
 
   auto ext_a = internal::op::Rand(ext_num);
-  auto choices = yacl::dynamic_bitset<uint128_t>(ot_num);
-  memcpy(choices.data(), ext_a.data(), ext_num * sizeof(internal::PTy));
+  auto choices = ChoiceBits(ext_a);
 
   std::vector<uint128_t> ot_recv_msgs(ot_num);
   ot_receiver_->recv_rot(absl::MakeSpan(ot_recv_msgs), choices);
 
   auto recv_buf = conn->Recv(conn->NextRank(), "Beaver:MulPP");
+  YACL_ENFORCE(recv_buf.size() ==
+               static_cast<int64_t>(ot_num * GilboaBytes()));
   auto recv_span = absl::MakeConstSpan(
-      reinterpret_cast<internal::PTy *>(recv_buf.data()), ot_num);
-
-  auto ext_c = internal::op::Zeros(ext_num);
-  for (size_t i = 0; i < ext_num; ++i) {
-    const size_t offset = i * PTy_bits;
-    for (size_t j = 0; j < PTy_bits; ++j) {
-      ext_c[i] = ext_c[i] + internal::PTy(ot_recv_msgs[offset + j]);
-      if (choices[offset + j]) {
-        ext_c[i] = ext_c[i] + internal::PTy(recv_span[offset + j]);
-      }
-    }
-  }
+      reinterpret_cast<const uint8_t *>(recv_buf.data()), recv_buf.size());
+
+  auto ext_c = std::vector<internal::PTy>(ext_num);
+  CotRecvSum(ot_recv_msgs, choices, recv_span, absl::MakeSpan(ext_c));
+
   // sync and generate the coefficient
-  auto seed = conn->SyncSeed();
+  auto seed = conn->DrawCoin();
   auto coef = internal::op::Rand(seed, ext_num * 2);
   auto coef_span = absl::MakeConstSpan(coef);
 
-  auto aa = internal::op::Mul(absl::MakeConstSpan(ext_a),
-                              coef_span.subspan(0, ext_num));
-  auto cc = internal::op::Mul(absl::MakeConstSpan(ext_c),
-                              coef_span.subspan(0, ext_num));
-
-  auto AA = internal::op::Mul(absl::MakeConstSpan(ext_a),
-                              coef_span.subspan(ext_num, ext_num));
-  auto CC = internal::op::Mul(absl::MakeConstSpan(ext_c),
-                              coef_span.subspan(ext_num, ext_num));
-
-  for (size_t i = 0; i < num; ++i) {
-    c[i] = internal::PTy::Zero();
-    a[i] = internal::PTy::Zero();
-
-    C[i] = internal::PTy::Zero();
-    A[i] = internal::PTy::Zero();
-    for (size_t j = 0; j < kExtFactor; ++j) {
-      c[i] = c[i] + cc[i * kExtFactor + j];
-      a[i] = a[i] + aa[i * kExtFactor + j];
-
-      C[i] = C[i] + CC[i * kExtFactor + j];
-      A[i] = A[i] + AA[i * kExtFactor + j];
-    }
-  }
+  Compress(ext_a, coef_span.subspan(0, ext_num),
+           coef_span.subspan(ext_num, ext_num), a, A);
+  Compress(ext_c, coef_span.subspan(0, ext_num),
+           coef_span.subspan(ext_num, ext_num), c, C);
 }
 
 void OtHelper::BeaverTripleExtend(std::shared_ptr<Connection> conn,
@@ -320,68 +428,36 @@ void OtHelper::MulPPExtendSendWithChosenB(std::shared_ptr<Connection> &conn,
                                           absl::Span<internal::PTy> C) {
   const size_t num = b.size();
   YACL_ENFORCE(num == c.size());
-  // bits in Public Type
-  const size_t PTy_bits = sizeof(internal::PTy) * 8;
   // beaver extend num = num * extend factor
   const size_t ext_num = num * kExtFactor;
   // ot num = num * extend factor * bits of Public Type
-  const size_t ot_num = ext_num * PTy_bits;
+  const size_t ot_num = ext_num * GilboaBits();
 
   std::vector<std::array<uint128_t, 2>> ot_send_msgs(ot_num);
   ot_sender_->send_rot(absl::MakeSpan(ot_send_msgs));  // rot
 
   // Convert ROT to additive-COT
-  auto send_msgs = std::vector<internal::PTy>(ot_num);
-  for (size_t i = 0; i < num; ++i) {
-    // ot_block0 - ot_block1 + b
-    // c = - block0
-    for (size_t j = 0; j < kExtFactor; ++j) {
-      const size_t offset = i * kExtFactor * PTy_bits + j * PTy_bits;
-      auto bi_k = b[i];
-      for (size_t k = 0; k < PTy_bits; ++k) {
-        send_msgs[offset + k] = internal::PTy(ot_send_msgs[offset + k][0]) -
-                                internal::PTy(ot_send_msgs[offset + k][1]) +
-                                bi_k;
-        bi_k = bi_k * internal::PTy(2);
-      }
-    }
-  }
+  // ot_block0 - ot_block1 + b * 2^k
+  auto send_msgs = std::vector<uint8_t>(ot_num * GilboaBytes());
+  CotSendMsgs(ot_send_msgs, b, kExtFactor, absl::MakeSpan(send_msgs));
 
   // send
   conn->SendAsync(
       conn->NextRank(),
-      yacl::ByteContainerView(send_msgs.data(),
-                              send_msgs.size() * sizeof(internal::PTy)),
+      yacl::ByteContainerView(send_msgs.data(), send_msgs.size()),
       "Beaver:MulPP");
 
-  auto ext_c = internal::op::Zeros(ext_num);
-  for (size_t i = 0; i < ext_num; ++i) {
-    const size_t offset = i * PTy_bits;
-    for (size_t j = 0; j < PTy_bits; ++j) {
-      ext_c[i] = ext_c[i] - internal::PTy(ot_send_msgs[offset + j][0]);
-    }
-  }
+  // c = - block0
+  auto ext_c = std::vector<internal::PTy>(ext_num);
+  CotSendSum(ot_send_msgs, absl::MakeSpan(ext_c));
 
   // sync and generate the coefficient
-  auto seed = conn->SyncSeed();
+  auto seed = conn->DrawCoin();
   auto coef = internal::op::Rand(seed, ext_num * 2);
-
   auto coef_span = absl::MakeConstSpan(coef);
-  //
-  auto cc = internal::op::Mul(absl::MakeConstSpan(ext_c),
-                              coef_span.subspan(0, ext_num));
-  //
-  auto CC = internal::op::Mul(absl::MakeConstSpan(ext_c),
-                              coef_span.subspan(ext_num, ext_num));
-
-  for (size_t i = 0; i < num; ++i) {
-    c[i] = internal::PTy::Zero();
-    C[i] = internal::PTy::Zero();
-    for (size_t j = 0; j < kExtFactor; ++j) {
-      c[i] = c[i] + cc[i * kExtFactor + j];
-      C[i] = C[i] + CC[i * kExtFactor + j];
-    }
-  }
+
+  Compress(ext_c, coef_span.subspan(0, ext_num),
+           coef_span.subspan(ext_num, ext_num), c, C);
 }
 
 void OtHelper::MulPPExtendRecvWithChosenB(std::shared_ptr<Connection> &conn,
@@ -391,63 +467,35 @@ void OtHelper::MulPPExtendRecvWithChosenB(std::shared_ptr<Connection> &conn,
                                           absl::Span<internal::PTy> C) {
   const size_t num = a.size();
   YACL_ENFORCE(num == c.size());
-  // bits in Public Type
-  const size_t PTy_bits = sizeof(internal::PTy) * 8;
   // beaver extend num = num * extend factor
   const size_t ext_num = num * kExtFactor;
   // ot num = num * extend factor * bits of Public Type
-  const size_t ot_num = ext_num * PTy_bits;
+  const size_t ot_num = ext_num * GilboaBits();
 
   auto ext_a = internal::op::Rand(ext_num);
-  auto choices = yacl::dynamic_bitset<uint128_t>(ot_num);
-  memcpy(choices.data(), ext_a.data(), ext_num * sizeof(internal::PTy));
+  auto choices = ChoiceBits(ext_a);
 
   std::vector<uint128_t> ot_recv_msgs(ot_num);
   ot_receiver_->recv_rot(absl::MakeSpan(ot_recv_msgs), choices);
 
   auto recv_buf = conn->Recv(conn->NextRank(), "Beaver:MulPP");
+  YACL_ENFORCE(recv_buf.size() ==
+               static_cast<int64_t>(ot_num * GilboaBytes()));
   auto recv_span = absl::MakeConstSpan(
-      reinterpret_cast<internal::PTy *>(recv_buf.data()), ot_num);
-
-  auto ext_c = internal::op::Zeros(ext_num);
-  for (size_t i = 0; i < ext_num; ++i) {
-    const size_t offset = i * PTy_bits;
-    for (size_t j = 0; j < PTy_bits; ++j) {
-      ext_c[i] = ext_c[i] + internal::PTy(ot_recv_msgs[offset + j]);
-      if (choices[offset + j]) {
-        ext_c[i] = ext_c[i] + internal::PTy(recv_span[offset + j]);
-      }
-    }
-  }
+      reinterpret_cast<const uint8_t *>(recv_buf.data()), recv_buf.size());
+
+  auto ext_c = std::vector<internal::PTy>(ext_num);
+  CotRecvSum(ot_recv_msgs, choices, recv_span, absl::MakeSpan(ext_c));
+
   // sync and generate the coefficient
-  auto seed = conn->SyncSeed();
+  auto seed = conn->DrawCoin();
   auto coef = internal::op::Rand(seed, ext_num * 2);
   auto coef_span = absl::MakeConstSpan(coef);
 
-  auto aa = internal::op::Mul(absl::MakeConstSpan(ext_a),
-                              coef_span.subspan(0, ext_num));
-  auto cc = internal::op::Mul(absl::MakeConstSpan(ext_c),
-                              coef_span.subspan(0, ext_num));
-
-  auto AA = internal::op::Mul(absl::MakeConstSpan(ext_a),
-                              coef_span.subspan(ext_num, ext_num));
-  auto CC = internal::op::Mul(absl::MakeConstSpan(ext_c),
-                              coef_span.subspan(ext_num, ext_num));
-
-  for (size_t i = 0; i < num; ++i) {
-    c[i] = internal::PTy::Zero();
-    a[i] = internal::PTy::Zero();
-
-    C[i] = internal::PTy::Zero();
-    A[i] = internal::PTy::Zero();
-    for (size_t j = 0; j < kExtFactor; ++j) {
-      c[i] = c[i] + cc[i * kExtFactor + j];
-      a[i] = a[i] + aa[i * kExtFactor + j];
-
-      C[i] = C[i] + CC[i * kExtFactor + j];
-      A[i] = A[i] + AA[i * kExtFactor + j];
-    }
-  }
+  Compress(ext_a, coef_span.subspan(0, ext_num),
+           coef_span.subspan(ext_num, ext_num), a, A);
+  Compress(ext_c, coef_span.subspan(0, ext_num),
+           coef_span.subspan(ext_num, ext_num), c, C);
 }
 
 void OtHelper::BeaverTripleExtendWithChosenB(std::shared_ptr<Connection> &conn,
@@ -503,58 +551,33 @@ void OtHelper::BaseVoleSend(std::shared_ptr<Connection> conn,
                             internal::PTy delta, absl::Span<internal::PTy> c) {
   const size_t num = c.size();
   const size_t ext_num = num + 1;
-  size_t PTy_bits = sizeof(internal::PTy) * 8;
-  size_t ot_num = ext_num * PTy_bits;
-
-  // initalize delta , delta * 2 , ...
-  std::vector<internal::PTy> deltas(PTy_bits);
-  deltas[0] = delta;
-  for (size_t i = 1; i < PTy_bits; ++i) {
-    deltas[i] = deltas[i - 1] * internal::PTy(2);
-  }
+  const size_t ot_num = ext_num * GilboaBits();
+
   // prepare for OT
   std::vector<std::array<uint128_t, 2>> ot_send_msgs(ot_num);
   ot_sender_->send_rot(absl::MakeSpan(ot_send_msgs));
 
   // Convert ROT to additive-COT
-  auto send_msgs = std::vector<internal::PTy>(ot_num);
-  for (size_t i = 0; i < ext_num; ++i) {
-    // ot_block0 - ot_block1 + b
-    const size_t offset = i * PTy_bits;
-    for (size_t k = 0; k < PTy_bits; ++k) {
-      send_msgs[offset + k] = internal::PTy(ot_send_msgs[offset + k][0]) -
-                              internal::PTy(ot_send_msgs[offset + k][1]) +
-                              deltas[k];
-    }
-  }
+  // ot_block0 - ot_block1 + delta * 2^k
+  auto send_msgs = std::vector<uint8_t>(ot_num * GilboaBytes());
+  CotSendMsgs(ot_send_msgs, absl::MakeConstSpan(&delta, 1), ext_num,
+              absl::MakeSpan(send_msgs));
 
   // send
   conn->SendAsync(
       conn->NextRank(),
-      yacl::ByteContainerView(send_msgs.data(),
-                              send_msgs.size() * sizeof(internal::PTy)),
+      yacl::ByteContainerView(send_msgs.data(), send_msgs.size()),
       "Beaver:BaseVole");
 
-  for (size_t i = 0; i < num; ++i) {
-    c[i] = internal::PTy::Zero();
-    const size_t offset = i * PTy_bits;
-    for (size_t j = 0; j < PTy_bits; ++j) {
-      // c = block0
-      c[i] = c[i] - internal::PTy(ot_send_msgs[offset + j][0]);
-    }
-  }
+  // c = - block0
+  auto ot_span = absl::MakeConstSpan(ot_send_msgs);
+  CotSendSum(ot_span.subspan(0, num * GilboaBits()), c);
 
   // ---- consistency check ----
   auto extra_c = internal::PTy::Zero();
-  {
-    const size_t offset = num * PTy_bits;
-    for (size_t j = 0; j < PTy_bits; ++j) {
-      // c = block0
-      extra_c = extra_c - internal::PTy(ot_send_msgs[offset + j][0]);
-    }
-  }
+  CotSendSum(ot_span.subspan(num * GilboaBits()), absl::MakeSpan(&extra_c, 1));
 
-  auto seed = conn->SyncSeed();
+  auto seed = conn->DrawCoin();
   auto coef = internal::op::Rand(seed, num);
   extra_c = extra_c + internal::op::InPro(absl::MakeSpan(coef), c);
   auto buf = conn->Recv(conn->NextRank(), "MalBaseVole");
@@ -572,49 +595,33 @@ void OtHelper::BaseVoleRecv(std::shared_ptr<Connection> conn,
   const size_t num = a.size();
   YACL_ENFORCE(num == b.size());
   const size_t ext_num = num + 1;
-  // bits in Public Type
-  const size_t PTy_bits = sizeof(internal::PTy) * 8;
   // ot num = ext_num * bits of Public Type
-  const size_t ot_num = ext_num * PTy_bits;
+  const size_t ot_num = ext_num * GilboaBits();
 
   auto ext_a = internal::op::Rand(ext_num);  // rand a
-  auto choices = yacl::dynamic_bitset<uint128_t>(ot_num);
   memcpy(a.data(), ext_a.data(), num * sizeof(internal::PTy));
-  memcpy(choices.data(), ext_a.data(), ext_num * sizeof(internal::PTy));
+  auto choices = ChoiceBits(ext_a);
 
   std::vector<uint128_t> ot_recv_msgs(ot_num);
   ot_receiver_->recv_rot(absl::MakeSpan(ot_recv_msgs), choices);
 
   auto recv_buf = conn->Recv(conn->NextRank(), "Beaver:BaseVole");
+  YACL_ENFORCE(recv_buf.size() ==
+               static_cast<int64_t>(ot_num * GilboaBytes()));
   auto recv_span = absl::MakeConstSpan(
-      reinterpret_cast<internal::PTy *>(recv_buf.data()), ot_num);
-
-  for (size_t i = 0; i < num; ++i) {
-    b[i] = internal::PTy::Zero();
-    const size_t offset = i * PTy_bits;
-    for (size_t j = 0; j < PTy_bits; ++j) {
-      b[i] = b[i] - internal::PTy(ot_recv_msgs[offset + j]);
-      if (choices[offset + j]) {
-        b[i] = b[i] - internal::PTy(recv_span[offset + j]);
-      }
-    }
-  }
+      reinterpret_cast<const uint8_t *>(recv_buf.data()), recv_buf.size());
+
+  // b = - (block_choice + choice * msgs)
+  auto ext_b = std::vector<internal::PTy>(ext_num);
+  CotRecvSum(ot_recv_msgs, choices, recv_span, absl::MakeSpan(ext_b));
+  internal::op::Neg(absl::MakeConstSpan(ext_b).subspan(0, num), b);
 
   // ---- consistency check ----
   std::array<internal::PTy, 2> extra_ab;  // extra_a && extra_b
   extra_ab[0] = ext_a[num];
-  extra_ab[1] = internal::PTy::Zero();
-  {
-    const size_t offset = num * PTy_bits;
-    for (size_t j = 0; j < PTy_bits; ++j) {
-      extra_ab[1] = extra_ab[1] - internal::PTy(ot_recv_msgs[offset + j]);
-      if (choices[offset + j]) {
-        extra_ab[1] = extra_ab[1] - internal::PTy(recv_span[offset + j]);
-      }
-    }
-  }
+  extra_ab[1] = internal::PTy::Neg(ext_b[num]);
 
-  auto seed = conn->SyncSeed();
+  auto seed = conn->DrawCoin();
   auto coef = internal::op::Rand(seed, num);
   extra_ab[0] = extra_ab[0] + internal::op::InPro(absl::MakeSpan(coef), a);
   extra_ab[1] = extra_ab[1] + internal::op::InPro(absl::MakeSpan(coef), b);
@@ -62,9 +62,10 @@ std::vector<uint128_t> SeedExtend(absl::Span<const uint128_t> seed,
 }
 }  // namespace
 
+template <typename T>
 void ShuffleSend(std::shared_ptr<Connection>& conn,
                  std::shared_ptr<ot::OtAdapter>& ot_ptr,
-                 absl::Span<const size_t> perm, absl::Span<internal::PTy> delta,
+                 absl::Span<const size_t> perm, absl::Span<T> delta,
                  size_t repeat) {
   YACL_ENFORCE(ot_ptr->IsSender() == false);
   const size_t batch_size = perm.size();
@@ -73,10 +74,10 @@ void ShuffleSend(std::shared_ptr<Connection>& conn,
 
   YACL_ENFORCE(repeat < kPrfKey.size());
 
-  std::vector<internal::PTy> a(full_size, internal::PTy(0));
-  std::vector<internal::PTy> b(full_size, internal::PTy(0));
+  std::vector<T> a(full_size, T(0));
+  std::vector<T> b(full_size, T(0));
   // gywz ote buff
-  std::vector<internal::PTy> opv(full_size);
+  std::vector<T> opv(full_size);
   std::vector<uint128_t> punctured_msgs(batch_size);
   // for consistency check
   std::vector<uint128_t> check_a(batch_size, 0);
@@ -101,7 +102,7 @@ void ShuffleSend(std::shared_ptr<Connection>& conn,
     }
 
     std::transform(extend.cbegin(), extend.cbegin() + full_size, opv.begin(),
-                   [](const uint128_t& val) { return internal::PTy(val); });
+                   [](const uint128_t& val) { return T(val); });
 
     // ---- consistency check ----
     std::transform(extend.cbegin() + full_size, extend.cend(), check_a.begin(),
@@ -110,12 +111,13 @@ void ShuffleSend(std::shared_ptr<Connection>& conn,
                              uint128_t(0), std::bit_xor<uint128_t>());
     // ---- consistency check ----
 
-    internal::op::AddInplace(absl::MakeSpan(a), absl::MakeConstSpan(opv));
+    internal::FieldOp<T>::AddInplace(absl::MakeSpan(a),
+                                     absl::MakeConstSpan(opv));
     for (size_t _ = 0; _ < repeat; ++_) {
       const size_t offset = _ * batch_size;
       b[offset + i] =
           std::reduce(opv.begin() + offset, opv.begin() + offset + batch_size,
-                      internal::PTy(0), std::plus<internal::PTy>());
+                      T(0), std::plus<T>());
     }
   }
 
@@ -146,10 +148,10 @@ void ShuffleSend(std::shared_ptr<Connection>& conn,
   // ---- consistency check ----
 }
 
+template <typename T>
 void ShuffleRecv(std::shared_ptr<Connection> conn,
-                 std::shared_ptr<ot::OtAdapter>& ot_ptr,
-                 absl::Span<internal::PTy> a, absl::Span<internal::PTy> b,
-                 size_t repeat) {
+                 std::shared_ptr<ot::OtAdapter>& ot_ptr, absl::Span<T> a,
+                 absl::Span<T> b, size_t repeat) {
   YACL_ENFORCE(ot_ptr->IsSender() == true);
   const size_t full_size = a.size();
   const size_t batch_size = full_size / repeat;
@@ -158,9 +160,9 @@ void ShuffleRecv(std::shared_ptr<Connection> conn,
 
   YACL_ENFORCE(repeat < kPrfKey.size());
 
-  internal::op::Zeros(a);
+  internal::FieldOp<T>::Zeros(a);
 
-  std::vector<internal::PTy> opv(full_size);
+  std::vector<T> opv(full_size);
   std::vector<uint128_t> all_msgs(batch_size);
   // for consistency check
   std::vector<uint128_t> check_a(batch_size, 0);
@@ -179,7 +181,7 @@ void ShuffleRecv(std::shared_ptr<Connection> conn,
     auto extend = SeedExtend(absl::MakeSpan(all_msgs), repeat + 1);
 
     std::transform(extend.cbegin(), extend.cbegin() + full_size, opv.begin(),
-                   [](const uint128_t& val) { return internal::PTy(val); });
+                   [](const uint128_t& val) { return T(val); });
 
     // ---- consistency check ----
     std::transform(extend.cbegin() + full_size, extend.cend(), check_a.begin(),
@@ -188,13 +190,13 @@ void ShuffleRecv(std::shared_ptr<Connection> conn,
                              uint128_t(0), std::bit_xor<uint128_t>());
     // ---- consistency check ----
 
-    internal::op::Sub(absl::MakeConstSpan(a), absl::MakeConstSpan(opv),
-                      absl::MakeSpan(a));
+    internal::FieldOp<T>::Sub(absl::MakeConstSpan(a), absl::MakeConstSpan(opv),
+                              absl::MakeSpan(a));
     for (size_t _ = 0; _ < repeat; ++_) {
       const size_t offset = _ * batch_size;
       b[offset + i] =
           std::reduce(opv.begin() + offset, opv.begin() + offset + batch_size,
-                      internal::PTy(0), std::plus<internal::PTy>());
+                      T(0), std::plus<T>());
     }
   }
   // ---- consistency check ----
@@ -213,4 +215,18 @@ void ShuffleRecv(std::shared_ptr<Connection> conn,
   // ---- consistency check ----
 }
 
+#define INSTANTIATE_SHUFFLE(T)                                         \
+  template void ShuffleSend<T>(std::shared_ptr<Connection>& conn,      \
+                               std::shared_ptr<ot::OtAdapter>& ot_ptr, \
+                               absl::Span<const size_t> perm,          \
+                               absl::Span<T> delta, size_t repeat);    \
+  template void ShuffleRecv<T>(std::shared_ptr<Connection> conn,       \
+                               std::shared_ptr<ot::OtAdapter>& ot_ptr, \
+                               absl::Span<T> a, absl::Span<T> b,       \
+                               size_t repeat)
+
+INSTANTIATE_SHUFFLE(kFp128);
+INSTANTIATE_SHUFFLE(kFp256);
+#undef INSTANTIATE_SHUFFLE
+
 }  // namespace mcpsi::shuffle
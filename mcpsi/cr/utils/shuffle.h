@@ -6,14 +6,17 @@
 
 namespace mcpsi::shuffle {
 
+// T is the field (kFp128 or kFp256), the correlation of any field is built
+// from the same punctured OT messages
+template <typename T>
 void ShuffleSend(std::shared_ptr<Connection>& conn,
                  std::shared_ptr<ot::OtAdapter>& ot_ptr,
-                 absl::Span<const size_t> perm, absl::Span<internal::PTy> delta,
+                 absl::Span<const size_t> perm, absl::Span<T> delta,
                  size_t repeat = 1);
 
+template <typename T>
 void ShuffleRecv(std::shared_ptr<Connection> conn,
-                 std::shared_ptr<ot::OtAdapter>& ot_ptr,
-                 absl::Span<internal::PTy> a, absl::Span<internal::PTy> b,
-                 size_t repeat = 1);
+                 std::shared_ptr<ot::OtAdapter>& ot_ptr, absl::Span<T> a,
+                 absl::Span<T> b, size_t repeat = 1);
 
 }  // namespace mcpsi::shuffle
@@ -0,0 +1,283 @@
+#include "mcpsi/cr/utils/snapshot.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <filesystem>
+
+#include "mcpsi/utils/stream.h"
+#include "yacl/crypto/base/hash/hash_utils.h"
+#include "yacl/crypto/tools/prg.h"
+#include "yacl/crypto/utils/rand.h"
+
+namespace mcpsi {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr uint64_t kMagic = 0x544f4853504d4357;  // "WCMPSHOT"
+constexpr uint32_t kVersion = 1;
+constexpr size_t kTagSize = 32;
+// labels of derived keys
+constexpr uint128_t kEncLabel = 1;
+constexpr uint128_t kMacLabel = 2;
+constexpr uint128_t kCounterLabel = 3;
+
+struct Header {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t rank;
+  uint64_t generation;
+  uint64_t size;  // bytes of payload
+  uint128_t id;
+  uint128_t nonce;
+};
+
+// Sm3(secret || label || nonce)
+std::array<uint8_t, 32> Derive(uint128_t secret, uint128_t label,
+                               uint128_t nonce) {
+  std::array<uint128_t, 3> buf = {secret, label, nonce};
+  auto digest =
+      yacl::crypto::Sm3(yacl::ByteContainerView(buf.data(), sizeof(buf)));
+  std::array<uint8_t, 32> ret;
+  memcpy(ret.data(), digest.data(), ret.size());
+  return ret;
+}
+
+// HMAC-SM3 over head || body
+std::array<uint8_t, kTagSize> Hmac(const std::array<uint8_t, 32>& key,
+                                   absl::Span<const uint8_t> head,
+                                   absl::Span<const uint8_t> body) {
+  constexpr size_t kBlock = 64;
+  std::vector<uint8_t> inner(kBlock + head.size() + body.size(), 0x36);
+  std::vector<uint8_t> outer(kBlock + kTagSize, 0x5c);
+  for (size_t i = 0; i < key.size(); ++i) {
+    inner[i] ^= key[i];
+    outer[i] ^= key[i];
+  }
+  std::copy(head.begin(), head.end(), inner.begin() + kBlock);
+  std::copy(body.begin(), body.end(), inner.begin() + kBlock + head.size());
+  auto inner_hash = yacl::crypto::Sm3(inner);
+  memcpy(outer.data() + kBlock, inner_hash.data(), kTagSize);
+  auto digest = yacl::crypto::Sm3(outer);
+  std::array<uint8_t, kTagSize> ret;
+  memcpy(ret.data(), digest.data(), kTagSize);
+  return ret;
+}
+
+// HMAC-SM3 over header || cipher
+std::array<uint8_t, kTagSize> Mac(uint128_t secret, const Header& header,
+                                  absl::Span<const uint8_t> cipher) {
+  return Hmac(Derive(secret, kMacLabel, header.nonce),
+              {reinterpret_cast<const uint8_t*>(&header), sizeof(header)},
+              cipher);
+}
+
+// constant-time comparison of tags
+bool TagEqual(absl::Span<const uint8_t> lhs, absl::Span<const uint8_t> rhs) {
+  uint8_t diff = 0;
+  for (size_t i = 0; i < kTagSize; ++i) {
+    diff |= lhs[i] ^ rhs[i];
+  }
+  return diff == 0;
+}
+
+// xor AES-CTR key stream (in place), encryption && decryption
+void Crypt(uint128_t secret, uint128_t nonce, absl::Span<uint8_t> data) {
+  auto key = Derive(secret, kEncLabel, nonce);
+  uint128_t seed = 0;
+  memcpy(&seed, key.data(), sizeof(seed));
+  auto prg = yacl::crypto::Prg<uint8_t>(seed);
+  std::vector<uint8_t> stream(data.size());
+  prg.Fill(absl::MakeSpan(stream));
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] ^= stream[i];
+  }
+}
+
+std::vector<uint8_t> ReadAll(const std::string& path) {
+  ChunkReader<uint8_t> reader(path);
+  return reader.Next(reader.Size());
+}
+
+// write into "path.tmp", sync it, then rename it (keep the old file if
+// crashed)
+void DurableWrite(const std::string& path, absl::Span<const uint8_t> in) {
+  auto tmp = path + ".tmp";
+  int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  YACL_ENFORCE(fd >= 0, "cannot open {}", tmp);
+  size_t done = 0;
+  while (done < in.size()) {
+    auto ret = ::write(fd, in.data() + done, in.size() - done);
+    YACL_ENFORCE(ret > 0, "cannot write {}", tmp);
+    done += ret;
+  }
+  YACL_ENFORCE(::fsync(fd) == 0, "cannot sync {}", tmp);
+  ::close(fd);
+  fs::rename(tmp, path);
+  // sync the rename
+  auto dir = fs::path(path).parent_path().string();
+  int dir_fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY);
+  if (dir_fd >= 0) {
+    ::fsync(dir_fd);
+    ::close(dir_fd);
+  }
+}
+
+// handshake digest, the first 128 bits of Sm3(id || generation)
+uint128_t Digest(uint128_t id, uint64_t generation) {
+  std::array<uint128_t, 2> buf = {id, generation};
+  auto digest =
+      yacl::crypto::Sm3(yacl::ByteContainerView(buf.data(), sizeof(buf)));
+  uint128_t ret = 0;
+  memcpy(&ret, digest.data(), sizeof(ret));
+  return ret;
+}
+
+}  // namespace
+
+SetupSnapshot::SetupSnapshot(const std::string& dir, size_t rank,
+                             uint128_t secret, const std::string& counter_path)
+    : dir_(dir), counter_path_(counter_path), rank_(rank), secret_(secret) {
+  YACL_ENFORCE(rank_ < 2);
+  auto file = fs::weakly_canonical(counter_path_);
+  auto self = fs::weakly_canonical(dir_);
+  YACL_ENFORCE(std::mismatch(self.begin(), self.end(), file.begin(), file.end())
+                       .first != self.end(),
+               "counter {} is inside of snapshot {}", counter_path_, dir_);
+}
+
+// counter || HMAC(counter), the MAC key is bound to the snapshot directory
+SetupSnapshot::Counter SetupSnapshot::ReadCounter() const {
+  if (!fs::exists(counter_path_)) {
+    return Counter();
+  }
+  auto buf = ReadAll(counter_path_);
+  YACL_ENFORCE(buf.size() == sizeof(Counter) + kTagSize, "broken counter {}",
+               counter_path_);
+  Counter ret;
+  memcpy(&ret, buf.data(), sizeof(ret));
+  auto tag = Hmac(Derive(secret_, kCounterLabel, DirTag()),
+                  absl::MakeConstSpan(buf.data(), sizeof(ret)), {});
+  if (!TagEqual(tag, absl::MakeConstSpan(buf.data() + sizeof(ret), kTagSize))) {
+    SPDLOG_WARN("[P{}] forged counter {}, nothing is loadable", rank_,
+                counter_path_);
+    return Counter();
+  }
+  return ret;
+}
+
+void SetupSnapshot::WriteCounter(const Counter& counter) const {
+  std::vector<uint8_t> buf(sizeof(counter) + kTagSize);
+  memcpy(buf.data(), &counter, sizeof(counter));
+  auto tag = Hmac(Derive(secret_, kCounterLabel, DirTag()),
+                  absl::MakeConstSpan(buf.data(), sizeof(counter)), {});
+  memcpy(buf.data() + sizeof(counter), tag.data(), kTagSize);
+  auto parent = fs::path(counter_path_).parent_path();
+  if (!parent.empty()) {
+    fs::create_directories(parent);
+  }
+  DurableWrite(counter_path_, buf);
+}
+
+uint128_t SetupSnapshot::DirTag() const {
+  auto dir = fs::weakly_canonical(dir_).string();
+  auto digest = yacl::crypto::Sm3(dir);
+  uint128_t ret = 0;
+  memcpy(&ret, digest.data(), sizeof(ret));
+  return ret;
+}
+
+void SetupSnapshot::Save(const std::shared_ptr<Connection>& conn,
+                         const SnapshotPayload& payload) {
+  fs::create_directories(dir_);
+  auto counter = ReadCounter();
+  const uint64_t generation =
+      std::max(counter.issued, conn->Exchange(counter.issued)) + 1;
+  const uint128_t id = conn->DrawCoin();
+  // the older snapshot is dead from now on
+  counter.issued = generation;
+  WriteCounter(counter);
+
+  const auto& plain = payload.Data();
+  Header header;
+  header.magic = kMagic;
+  header.version = kVersion;
+  header.rank = rank_;
+  header.generation = generation;
+  header.size = plain.size();
+  header.id = id;
+  header.nonce = yacl::crypto::SecureRandU128();
+  std::vector<uint8_t> buf(sizeof(header) + plain.size() + kTagSize);
+  memcpy(buf.data(), &header, sizeof(header));
+  auto cipher = absl::MakeSpan(buf.data() + sizeof(header), plain.size());
+  memcpy(cipher.data(), plain.data(), plain.size());
+  Crypt(secret_, header.nonce, cipher);
+  auto tag = Mac(secret_, header, cipher);
+  memcpy(buf.data() + sizeof(header) + plain.size(), tag.data(), kTagSize);
+
+  DurableWrite(dir_ + "/snapshot", buf);
+  generation_ = generation;
+}
+
+bool SetupSnapshot::Open(const Counter& counter, uint128_t* id,
+                         std::vector<uint8_t>* plain) const {
+  const auto path = dir_ + "/snapshot";
+  if (!fs::exists(path)) {
+    return false;
+  }
+  auto buf = ReadAll(path);
+  if (buf.size() < sizeof(Header) + kTagSize) {
+    return false;
+  }
+  Header header;
+  memcpy(&header, buf.data(), sizeof(header));
+  if (header.magic != kMagic || header.version != kVersion ||
+      header.rank != rank_ ||
+      header.size != buf.size() - sizeof(header) - kTagSize) {
+    return false;
+  }
+  // only the last issued generation, && only once
+  if (header.generation != counter.issued ||
+      header.generation <= counter.loaded) {
+    return false;
+  }
+  auto cipher = absl::MakeSpan(buf.data() + sizeof(header), header.size);
+  auto tag = Mac(secret_, header, cipher);
+  if (!TagEqual(tag, absl::MakeConstSpan(buf.data() + sizeof(header) +
+                                             header.size,
+                                         kTagSize))) {
+    return false;
+  }
+  Crypt(secret_, header.nonce, cipher);
+  plain->assign(cipher.begin(), cipher.end());
+  *id = header.id;
+  return true;
+}
+
+bool SetupSnapshot::Load(const std::shared_ptr<Connection>& conn,
+                         SnapshotPayload* payload) {
+  auto counter = ReadCounter();
+  uint128_t id = 0;
+  std::vector<uint8_t> plain;
+  const bool ok = Open(counter, &id, &plain);
+  // 0 for "not loadable"
+  const uint128_t digest = ok ? Digest(id, counter.issued) : 0;
+  const uint128_t remote = conn->ExchangeWithCommit(digest);
+  if (!ok || digest != remote) {
+    SPDLOG_WARN("[P{}] no matching snapshot in {}, self {} && remote {}",
+                rank_, dir_, ok, remote != 0);
+    return false;
+  }
+  // burn it before use
+  counter.loaded = counter.issued;
+  WriteCounter(counter);
+  generation_ = counter.issued;
+  *payload = SnapshotPayload(std::move(plain));
+  return true;
+}
+
+}  // namespace mcpsi
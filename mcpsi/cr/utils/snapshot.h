@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "mcpsi/context/state.h"
+#include "yacl/base/exception.h"
+#include "yacl/base/int128.h"
+
+namespace mcpsi {
+
+// Length-prefixed sections of trivially copyable values
+class SnapshotPayload {
+ public:
+  SnapshotPayload() = default;
+  explicit SnapshotPayload(std::vector<uint8_t> buf) : buf_(std::move(buf)) {}
+
+  template <typename T>
+  void Append(absl::Span<const T> in) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    uint64_t bytes = in.size() * sizeof(T);
+    auto* len = reinterpret_cast<const uint8_t*>(&bytes);
+    buf_.insert(buf_.end(), len, len + sizeof(bytes));
+    auto* data = reinterpret_cast<const uint8_t*>(in.data());
+    buf_.insert(buf_.end(), data, data + bytes);
+  }
+
+  template <typename T>
+  void AppendOne(const T& in) {
+    Append(absl::MakeConstSpan(&in, 1));
+  }
+
+  // next section, in the order of Append
+  template <typename T>
+  std::vector<T> Next() {
+    static_assert(std::is_trivially_copyable_v<T>);
+    uint64_t bytes = 0;
+    YACL_ENFORCE(pos_ + sizeof(bytes) <= buf_.size(), "broken payload");
+    memcpy(&bytes, buf_.data() + pos_, sizeof(bytes));
+    pos_ += sizeof(bytes);
+    YACL_ENFORCE(bytes <= buf_.size() - pos_ && bytes % sizeof(T) == 0,
+                 "broken payload");
+    std::vector<T> ret(bytes / sizeof(T));
+    memcpy(ret.data(), buf_.data() + pos_, bytes);
+    pos_ += bytes;
+    return ret;
+  }
+
+  template <typename T>
+  T NextOne() {
+    auto ret = Next<T>();
+    YACL_ENFORCE(ret.size() == 1, "broken payload");
+    return ret[0];
+  }
+
+  const std::vector<uint8_t>& Data() const { return buf_; }
+
+ private:
+  std::vector<uint8_t> buf_;
+  size_t pos_{0};
+};
+
+// Encrypted && authenticated warm-start snapshot of a one-time setup (e.g.
+// base OTs && base VOLEs, see TrueCorrelation::SaveSnapshot), one per party.
+//
+// Layout of `dir`: "snapshot" (header || ciphertext || tag). The payload is
+// encrypted by AES-CTR (yacl Prg) under a per-snapshot nonce and
+// authenticated (with the header) by HMAC-SM3, both keys are derived from the
+// local `secret`.
+//
+// Never reuse: both parties agree on a generation for every snapshot.
+// `counter_path` records the last issued && the last loaded generation
+// (synced before a snapshot is returned), so that a loaded snapshot, or an
+// older one copied back from a backup, is never loaded again. The counter is
+// kept outside of `dir` (next to the secret) && is HMAC-ed (bound to `dir`)
+// under the secret; a missing or forged counter loads nothing.
+// NOTE: the HMAC can't stop a rollback of the counter file itself, so whoever
+// may write next to the secret may replay a snapshot.
+// Handshake: both parties exchange (with commitment) the digest of (id,
+// generation), a snapshot is loaded only if both hold the matching one.
+// NOTE: "snapshot" holds key shares && base OTs, keep `dir` && `secret`
+// private.
+class SetupSnapshot {
+ public:
+  SetupSnapshot(const std::string& dir, size_t rank, uint128_t secret,
+                const std::string& counter_path);
+
+  // seal `payload` as a new generation, older ones can't be loaded anymore
+  void Save(const std::shared_ptr<Connection>& conn,
+            const SnapshotPayload& payload);
+
+  // both parties should call it, return false if any party has no loadable
+  // snapshot (missing, broken, forged, loaded before or mismatched)
+  bool Load(const std::shared_ptr<Connection>& conn, SnapshotPayload* payload);
+
+  // generation of the last saved / loaded snapshot
+  uint64_t Generation() const { return generation_; }
+
+ private:
+  struct Counter {
+    uint64_t issued{0};
+    uint64_t loaded{0};
+  };
+
+  Counter ReadCounter() const;
+  void WriteCounter(const Counter& counter) const;
+  // 128 bits of Sm3(canonical `dir`)
+  uint128_t DirTag() const;
+  // decrypt && verify the local snapshot, return false if not loadable
+  bool Open(const Counter& counter, uint128_t* id,
+            std::vector<uint8_t>* plain) const;
+
+  std::string dir_;
+  std::string counter_path_;
+  size_t rank_;
+  uint128_t secret_;
+  uint64_t generation_{0};
+};
+
+}  // namespace mcpsi
@@ -0,0 +1,100 @@
+#include "mcpsi/cr/utils/snapshot.h"
+
+#include <filesystem>
+#include <fstream>
+#include <future>
+
+#include "gtest/gtest.h"
+#include "mcpsi/utils/test_util.h"
+
+namespace mcpsi {
+
+namespace {
+
+SnapshotPayload MakePayload(size_t rank) {
+  SnapshotPayload payload;
+  std::vector<uint128_t> blocks(1000);
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    blocks[i] = i * 7 + rank;
+  }
+  payload.Append<uint128_t>(blocks);
+  payload.AppendOne<uint64_t>(rank);
+  return payload;
+}
+
+// which file of party0 to flip a byte of, after the save
+enum class Tamper { kNone, kSnapshot, kCounter };
+
+// save on both parties, then load (on both parties) for `rounds` times
+std::vector<bool> SaveAndLoad(const std::string& dir, size_t rounds,
+                              Tamper tamper) {
+  static size_t world_id = 0;
+  auto lctxs = SetupWorld("snapshot_test_" + std::to_string(world_id++), 2);
+  auto task = [&](size_t rank) {
+    auto conn = std::make_shared<Connection>(*lctxs[rank]);
+    auto path = dir + "/p" + std::to_string(rank);
+    // the counter is kept outside of the snapshot directory
+    auto counter = dir + "_counter/p" + std::to_string(rank);
+    SetupSnapshot snapshot(path, rank, 0x1234 + rank, counter);
+    snapshot.Save(conn, MakePayload(rank));
+    if (tamper != Tamper::kNone && rank == 0) {
+      std::fstream file(tamper == Tamper::kSnapshot ? path + "/snapshot"
+                                                    : counter,
+                        std::ios::binary | std::ios::in | std::ios::out);
+      file.seekp(tamper == Tamper::kSnapshot ? 100 : 0);
+      file.put(0x5a);
+    }
+
+    std::vector<bool> ret;
+    for (size_t i = 0; i < rounds; ++i) {
+      SnapshotPayload payload;
+      bool ok = snapshot.Load(conn, &payload);
+      if (ok) {
+        auto blocks = payload.Next<uint128_t>();
+        EXPECT_EQ(blocks.size(), 1000U);
+        EXPECT_TRUE(blocks[999] == 999 * 7 + rank);
+        EXPECT_EQ(payload.NextOne<uint64_t>(), rank);
+      }
+      ret.push_back(ok);
+    }
+    return ret;
+  };
+  auto rank0 = std::async([&] { return task(0); });
+  auto rank1 = std::async([&] { return task(1); });
+  auto ret0 = rank0.get();
+  auto ret1 = rank1.get();
+  EXPECT_EQ(ret0, ret1);
+  return ret0;
+}
+
+}  // namespace
+
+TEST(SnapshotTest, NeverReuseWork) {
+  const std::string dir = "snapshot_test";
+  auto ret = SaveAndLoad(dir, 2, Tamper::kNone);
+  EXPECT_TRUE(ret[0]);
+  // loaded already
+  EXPECT_FALSE(ret[1]);
+  // a new generation
+  ret = SaveAndLoad(dir, 1, Tamper::kNone);
+  EXPECT_TRUE(ret[0]);
+  std::filesystem::remove_all(dir);
+  std::filesystem::remove_all(dir + "_counter");
+}
+
+TEST(SnapshotTest, TamperWork) {
+  const std::string dir = "snapshot_test";
+  auto ret = SaveAndLoad(dir, 1, Tamper::kSnapshot);
+  // forged on party0, both fail
+  EXPECT_FALSE(ret[0]);
+  // a forged counter (e.g. the issued generation rolled back) loads nothing
+  ret = SaveAndLoad(dir, 1, Tamper::kCounter);
+  EXPECT_FALSE(ret[0]);
+  // && a later save starts over
+  ret = SaveAndLoad(dir, 1, Tamper::kNone);
+  EXPECT_TRUE(ret[0]);
+  std::filesystem::remove_all(dir);
+  std::filesystem::remove_all(dir + "_counter");
+}
+
+}  // namespace mcpsi
@@ -6,11 +6,11 @@
 
 namespace mcpsi::vole {
 
+template <typename T>
 void WolverineVoleSend(const std::shared_ptr<Connection>& conn,
                        const yc::OtSendStore& send_ot, const VoleParam& param,
-                       [[maybe_unused]] internal::PTy delta,
-                       absl::Span<internal::PTy> pre_c,
-                       absl::Span<internal::PTy> c) {
+                       [[maybe_unused]] internal::NonDeduced<T> delta,
+                       absl::Span<T> pre_c, absl::Span<T> c) {
   auto& lpn_param = param.lpn_param_;
   auto& mp_param = param.mp_param_;
 
@@ -22,11 +22,11 @@ void WolverineVoleSend(const std::shared_ptr<Connection>& conn,
 
   // ---- consistency check ----
   if (param.is_mal_) {
-    auto seed = conn->SyncSeed();
-    auto uhash = UniversalHash(seed, c.subspan(0, param.vole_num_));
+    auto seed = conn->DrawCoin();
+    auto uhash = UniversalHash<T>(seed, c.subspan(0, param.vole_num_));
     auto buf = conn->Recv(conn->NextRank(), "MalVole");
-    YACL_ENFORCE(buf.size() == sizeof(internal::PTy));
-    internal::PTy diff;
+    YACL_ENFORCE(buf.size() == sizeof(T));
+    T diff;
     memcpy(&diff, buf.data(), buf.size());
     uhash = uhash - delta * diff + pre_c.back();
 
@@ -37,17 +37,16 @@ void WolverineVoleSend(const std::shared_ptr<Connection>& conn,
   }
   // ---- consistency check ----
 
-  auto seed = conn->SyncSeed();
+  auto seed = conn->DrawCoin();
   auto llc = code::LocalLinearCode<10>(seed, lpn_param.n_, lpn_param.k_);
-  llc.Encode(pre_c.subspan(0, lpn_param.k_), c.subspan(0, lpn_param.n_));
+  llc.Encode<T>(pre_c.subspan(0, lpn_param.k_), c.subspan(0, lpn_param.n_));
 }
 
+template <typename T>
 void WolverineVoleRecv(const std::shared_ptr<Connection>& conn,
                        const yc::OtRecvStore& recv_ot, const VoleParam& param,
-                       absl::Span<internal::PTy> pre_a,
-                       absl::Span<internal::PTy> pre_b,
-                       absl::Span<internal::PTy> a,
-                       absl::Span<internal::PTy> b) {
+                       absl::Span<T> pre_a, absl::Span<T> pre_b,
+                       absl::Span<T> a, absl::Span<T> b) {
   auto& lpn_param = param.lpn_param_;
   auto& mp_param = param.mp_param_;
 
@@ -58,7 +57,7 @@ void WolverineVoleRecv(const std::shared_ptr<Connection>& conn,
 
   YACL_ENFORCE(recv_ot.Size() >= param.mp_vole_ot_num_);
 
-  std::for_each(a.begin(), a.end(), [](internal::PTy& e) { e = 0; });
+  std::for_each(a.begin(), a.end(), [](T& e) { e = 0; });
 
   std::vector<size_t> indexes;
   for (size_t i = 0; i < mp_param.noise_num_; ++i) {
@@ -70,11 +69,11 @@ void WolverineVoleRecv(const std::shared_ptr<Connection>& conn,
 
   // ---- consistency check ----
   if (param.is_mal_) {
-    auto seed = conn->SyncSeed();
-    auto uhash = UniversalHash(seed, b.subspan(0, param.vole_num_));
-    auto coef = ExtractCeof(seed, absl::MakeConstSpan(indexes));
-    auto diff = internal::op::InPro(absl::MakeConstSpan(coef),
-                                    pre_a.subspan(0, coef.size()));
+    auto seed = conn->DrawCoin();
+    auto uhash = UniversalHash<T>(seed, b.subspan(0, param.vole_num_));
+    auto coef = ExtractCeof<T>(seed, absl::MakeConstSpan(indexes));
+    auto diff = internal::FieldOp<T>::InPro(absl::MakeConstSpan(coef),
+                                            pre_a.subspan(0, coef.size()));
     diff = diff + pre_a.back();
     uhash = uhash + pre_b.back();
     conn->Send(conn->NextRank(), yacl::ByteContainerView(&diff, sizeof(diff)),
@@ -88,10 +87,23 @@ void WolverineVoleRecv(const std::shared_ptr<Connection>& conn,
   }
   // ---- consistency check ----
 
-  auto seed = conn->SyncSeed();
+  auto seed = conn->DrawCoin();
   auto llc = code::LocalLinearCode<10>(seed, lpn_param.n_, lpn_param.k_);
-  llc.Encode2(pre_a.subspan(0, lpn_param.k_), a.subspan(0, lpn_param.n_),
-              pre_b.subspan(0, lpn_param.k_), b.subspan(0, lpn_param.n_));
+  llc.Encode2<T>(pre_a.subspan(0, lpn_param.k_), a.subspan(0, lpn_param.n_),
+                 pre_b.subspan(0, lpn_param.k_), b.subspan(0, lpn_param.n_));
 }
 
+#define INSTANTIATE_WOLVERINE(T)                                               \
+  template void WolverineVoleSend<T>(                                          \
+      const std::shared_ptr<Connection>& conn, const yc::OtSendStore& send_ot, \
+      const VoleParam& param, T delta, absl::Span<T> pre_c, absl::Span<T> c);  \
+  template void WolverineVoleRecv<T>(                                          \
+      const std::shared_ptr<Connection>& conn, const yc::OtRecvStore& recv_ot, \
+      const VoleParam& param, absl::Span<T> pre_a, absl::Span<T> pre_b,        \
+      absl::Span<T> a, absl::Span<T> b)
+
+INSTANTIATE_WOLVERINE(kFp128);
+INSTANTIATE_WOLVERINE(kFp256);
+#undef INSTANTIATE_WOLVERINE
+
 }  // namespace mcpsi::vole
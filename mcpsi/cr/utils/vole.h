@@ -70,46 +70,48 @@ struct VoleParam {
 // > c     =     a * delta +     b
 // > Sender holds c && delta
 // > Receiver holds a && b
+// T is the field (kFp128 or kFp256)
+template <typename T>
 void WolverineVoleSend(const std::shared_ptr<Connection>& conn,
                        const yc::OtSendStore& send_ot, const VoleParam& param,
-                       internal::PTy delta, absl::Span<internal::PTy> pre_c,
-                       absl::Span<internal::PTy> c);
+                       internal::NonDeduced<T> delta, absl::Span<T> pre_c,
+                       absl::Span<T> c);
 
+template <typename T>
 void WolverineVoleRecv(const std::shared_ptr<Connection>& conn,
                        const yc::OtRecvStore& recv_ot, const VoleParam& param,
-                       absl::Span<internal::PTy> pre_a,
-                       absl::Span<internal::PTy> pre_b,
-                       absl::Span<internal::PTy> a,
-                       absl::Span<internal::PTy> b);
+                       absl::Span<T> pre_a, absl::Span<T> pre_b,
+                       absl::Span<T> a, absl::Span<T> b);
 
 // consistency check tools
-inline internal::PTy UniversalHash(internal::PTy seed,
-                                   absl::Span<const internal::PTy> in) {
-  internal::PTy result(0);
-  std::for_each(in.rbegin(), in.rend(),
-                [&result, &seed](const internal::PTy& val) {
-                  result = (result + val) * seed;
-                });
+template <typename T = internal::PTy>
+inline T UniversalHash(internal::NonDeduced<T> seed,
+                       absl::Span<const internal::NonDeduced<T>> in) {
+  T result(0);
+  std::for_each(in.rbegin(), in.rend(), [&result, &seed](const T& val) {
+    result = (result + val) * seed;
+  });
   return result;
 }
 
-inline std::vector<internal::PTy> ExtractCeof(
-    internal::PTy seed, absl::Span<const size_t> indexes) {
+template <typename T = internal::PTy>
+inline std::vector<T> ExtractCeof(internal::NonDeduced<T> seed,
+                                  absl::Span<const size_t> indexes) {
   auto max_index = indexes.back();
   auto bits = yacl::math::Log2Ceil(max_index + 1);
 
-  std::array<internal::PTy, 64> buf;
+  std::array<T, 64> buf;
   buf[0] = seed;
   for (size_t i = 1; i < 64 && i <= bits; ++i) {
     buf[i] = buf[i - 1] * buf[i - 1];
   }
 
-  std::vector<internal::PTy> ceof;
+  std::vector<T> ceof;
   for (const auto& index : indexes) {
     auto index_plus_one = index + 1;
     size_t mask = 1;
 
-    internal::PTy tmp(1);
+    T tmp(1);
     for (size_t i = 0; i < 64 && mask <= index_plus_one; ++i) {
       if (mask & index_plus_one) {
         tmp = tmp * buf[i];
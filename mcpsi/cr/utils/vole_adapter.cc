@@ -1,50 +1,221 @@
 #include "mcpsi/cr/utils/vole_adapter.h"
 
+#include <array>
+#include <type_traits>
+
+#include "yacl/utils/parallel.h"
+
 namespace mcpsi::vole {
 
-void WolverineVoleAdapter::OneTimeSetup() {
-  auto setup_param = VoleParam(LpnParam::GetPreDefault(), true);
+namespace {
 
-  auto ot_num = setup_param.mp_vole_ot_num_;
+// bit length of the prime, i.e. the OTs per Gilboa multiplication
+template <typename T>
+size_t PrimeBits() {
+  auto max_val = T::GetPrime() - 1;
+  size_t ret = 0;
+  while (max_val != 0) {
+    max_val >>= 1;
+    ++ret;
+  }
+  return ret;
+}
+
+// Gilboa multiplication (a random ROT per bit of a) for base VOLEs over T,
+// && the same consistency check as OtHelper::BaseVoleSend (one extra VOLE)
+// > c = a * delta + b
+// > Sender holds c && delta, Receiver holds a && b
+template <typename T>
+void GilboaVoleSend(const std::shared_ptr<Connection>& conn,
+                    const std::shared_ptr<ot::OtAdapter>& ot_ptr, T delta,
+                    absl::Span<T> c) {
+  const size_t num = c.size();
+  const size_t ext_num = num + 1;
+  const size_t bits = PrimeBits<T>();
+
+  std::vector<std::array<uint128_t, 2>> ot_msgs(ext_num * bits);
+  ot_ptr->send_rot(absl::MakeSpan(ot_msgs));
+
+  // delta * 2^k
+  std::vector<T> pows(bits);
+  pows[0] = delta;
+  for (size_t k = 1; k < bits; ++k) {
+    pows[k] = pows[k - 1] + pows[k - 1];
+  }
+
+  // corrections: block0 - block1 + delta * 2^k, c = - sum(block0)
+  std::vector<T> corrs(ext_num * bits);
+  std::vector<T> ext_c(ext_num);
+  yacl::parallel_for(0, ext_num, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      T sum(0);
+      for (size_t k = 0; k < bits; ++k) {
+        const auto& msg = ot_msgs[i * bits + k];
+        const T block0(msg[0]);
+        corrs[i * bits + k] = block0 - T(msg[1]) + pows[k];
+        sum = sum + block0;
+      }
+      ext_c[i] = T::Neg(sum);
+    }
+  });
+  conn->SendAsync(
+      conn->NextRank(),
+      yacl::ByteContainerView(corrs.data(), corrs.size() * sizeof(T)),
+      "GilboaVole");
+  memcpy(c.data(), ext_c.data(), num * sizeof(T));
+
+  // ---- consistency check ----
+  auto seed = conn->DrawCoin();
+  auto coef = internal::FieldOp<T>::Rand(seed, num);
+  auto extra_c =
+      ext_c[num] + internal::FieldOp<T>::InPro(absl::MakeSpan(coef), c);
+  auto buf = conn->Recv(conn->NextRank(), "MalGilboaVole");
+  YACL_ENFORCE(buf.size() == static_cast<int64_t>(2 * sizeof(T)));
+  auto extra_ab = absl::MakeSpan(reinterpret_cast<T*>(buf.data()), 2);
+  YACL_ENFORCE(extra_ab[0] * delta + extra_ab[1] == extra_c);
+  // ---- consistency check ----
+}
+
+template <typename T>
+void GilboaVoleRecv(const std::shared_ptr<Connection>& conn,
+                    const std::shared_ptr<ot::OtAdapter>& ot_ptr,
+                    absl::Span<T> a, absl::Span<T> b) {
+  const size_t num = a.size();
+  YACL_ENFORCE(num == b.size());
+  const size_t ext_num = num + 1;
+  const size_t bits = PrimeBits<T>();
+
+  auto ext_a = internal::FieldOp<T>::Rand(ext_num);
+  yacl::dynamic_bitset<uint128_t> choices(ext_num * bits);
+  for (size_t i = 0; i < ext_num; ++i) {
+    auto val = ext_a[i].GetVal();
+    for (size_t k = 0; k < bits; ++k) {
+      choices.set(i * bits + k, ((val >> k) & 1) != 0);
+    }
+  }
+  std::vector<uint128_t> ot_msgs(ext_num * bits);
+  ot_ptr->recv_rot(absl::MakeSpan(ot_msgs), choices);
+
+  auto buf = conn->Recv(conn->NextRank(), "GilboaVole");
+  YACL_ENFORCE(buf.size() == static_cast<int64_t>(ot_msgs.size() * sizeof(T)));
+  auto corrs = absl::MakeConstSpan(reinterpret_cast<const T*>(buf.data()),
+                                   ot_msgs.size());
+
+  // b = - sum(block_choice + choice * corrections)
+  std::vector<T> ext_b(ext_num);
+  yacl::parallel_for(0, ext_num, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      T sum(0);
+      for (size_t k = 0; k < bits; ++k) {
+        const size_t idx = i * bits + k;
+        sum = sum + T(ot_msgs[idx]);
+        if (choices[idx]) {
+          sum = sum + corrs[idx];
+        }
+      }
+      ext_b[i] = T::Neg(sum);
+    }
+  });
+  memcpy(a.data(), ext_a.data(), num * sizeof(T));
+  memcpy(b.data(), ext_b.data(), num * sizeof(T));
+
+  // ---- consistency check ----
+  auto seed = conn->DrawCoin();
+  auto coef = internal::FieldOp<T>::Rand(seed, num);
+  std::array<T, 2> extra_ab;  // extra_a && extra_b
+  extra_ab[0] =
+      ext_a[num] + internal::FieldOp<T>::InPro(absl::MakeSpan(coef), a);
+  extra_ab[1] =
+      ext_b[num] + internal::FieldOp<T>::InPro(absl::MakeSpan(coef), b);
+  conn->SendAsync(conn->NextRank(),
+                  yacl::ByteContainerView(extra_ab.data(), 2 * sizeof(T)),
+                  "MalGilboaVole");
+  // ---- consistency check ----
+}
+
+}  // namespace
+
+template <typename T>
+void BasicWolverineVoleAdapter<T>::OneTimeSetup() {
+  const auto num = SetupVoleNum();
   //   SPDLOG_INFO("OneTimeSetup isSender {}", is_sender_);
   if (is_sender_) {
-    std::vector<internal::PTy> pre_c(setup_param.base_vole_num_, 0);
-    ot::OtHelper(ot_ptr_, nullptr)
-        .BaseVoleSend(conn_, delta_, absl::MakeSpan(pre_c));
+    std::vector<T> pre_c(num, 0);
+    if constexpr (std::is_same_v<T, internal::PTy>) {
+      ot::OtHelper(ot_ptr_, nullptr)
+          .BaseVoleSend(conn_, this->delta_, absl::MakeSpan(pre_c));
+    } else {
+      GilboaVoleSend(conn_, ot_ptr_, this->delta_, absl::MakeSpan(pre_c));
+    }
+    OneTimeSetup(pre_c);
+  } else {
+    std::vector<T> pre_a(num, 0);
+    std::vector<T> pre_b(num, 0);
+    if constexpr (std::is_same_v<T, internal::PTy>) {
+      ot::OtHelper(nullptr, ot_ptr_)
+          .BaseVoleRecv(conn_, absl::MakeSpan(pre_a), absl::MakeSpan(pre_b));
+    } else {
+      GilboaVoleRecv(conn_, ot_ptr_, absl::MakeSpan(pre_a),
+                     absl::MakeSpan(pre_b));
+    }
+    OneTimeSetup(pre_a, pre_b);
+  }
+  //   SPDLOG_INFO("OneTimeSetup Done");
+}
 
-    std::vector<uint128_t> send_msgs(ot_num);
-    ot_ptr_->send_rcot(absl::MakeSpan(send_msgs));
-    auto send_store =
-        yc::MakeCompactOtSendStore(std::move(send_msgs), ot_ptr_->GetDelta());
-    // SPDLOG_INFO("Wolverine Send");
-    WolverineVoleSend(conn_, send_store, setup_param, delta_,
-                      absl::MakeSpan(pre_c), absl::MakeSpan(c_));
+template <typename T>
+void BasicWolverineVoleAdapter<T>::OneTimeSetup(absl::Span<const T> pre_c) {
+  YACL_ENFORCE(is_sender_ == true);
+  auto setup_param = VoleParam(LpnParam::GetPreDefault(), true);
+  YACL_ENFORCE(pre_c.size() == setup_param.base_vole_num_);
 
-  } else {
-    std::vector<internal::PTy> pre_a(setup_param.base_vole_num_, 0);
-    std::vector<internal::PTy> pre_b(setup_param.base_vole_num_, 0);
-    ot::OtHelper(nullptr, ot_ptr_)
-        .BaseVoleRecv(conn_, absl::MakeSpan(pre_a), absl::MakeSpan(pre_b));
+  auto ot_num = setup_param.mp_vole_ot_num_;
+  std::vector<uint128_t> send_msgs(ot_num);
+  ot_ptr_->send_rcot(absl::MakeSpan(send_msgs));
+  auto send_store =
+      yc::MakeCompactOtSendStore(std::move(send_msgs), ot_ptr_->GetDelta());
+  // Copy
+  std::vector<T> tmp_c(pre_c.begin(), pre_c.end());
+  // SPDLOG_INFO("Wolverine Send");
+  WolverineVoleSend(conn_, send_store, setup_param, this->delta_,
+                    absl::MakeSpan(tmp_c), absl::MakeSpan(c_));
+  FinishSetup(setup_param);
+}
 
-    std::vector<uint128_t> recv_msgs(ot_num);
-    yacl::dynamic_bitset<uint128_t> choices(ot_num);
-    ot_ptr_->recv_rcot(absl::MakeSpan(recv_msgs), choices);
-    auto recv_store = yc::MakeOtRecvStore(choices, std::move(recv_msgs));
-    // SPDLOG_INFO("Wolverine Recv");
-    setup_param.mp_param_.GenIndexes();
-    WolverineVoleRecv(conn_, recv_store, setup_param, absl::MakeSpan(pre_a),
-                      absl::MakeSpan(pre_b), absl::MakeSpan(a_),
-                      absl::MakeSpan(b_));
-  }
+template <typename T>
+void BasicWolverineVoleAdapter<T>::OneTimeSetup(absl::Span<const T> pre_a,
+                                                absl::Span<const T> pre_b) {
+  YACL_ENFORCE(is_sender_ == false);
+  auto setup_param = VoleParam(LpnParam::GetPreDefault(), true);
+  YACL_ENFORCE(pre_a.size() == setup_param.base_vole_num_);
+  YACL_ENFORCE(pre_b.size() == setup_param.base_vole_num_);
+
+  auto ot_num = setup_param.mp_vole_ot_num_;
+  std::vector<uint128_t> recv_msgs(ot_num);
+  yacl::dynamic_bitset<uint128_t> choices(ot_num);
+  ot_ptr_->recv_rcot(absl::MakeSpan(recv_msgs), choices);
+  auto recv_store = yc::MakeOtRecvStore(choices, std::move(recv_msgs));
+  // Copy
+  std::vector<T> tmp_a(pre_a.begin(), pre_a.end());
+  std::vector<T> tmp_b(pre_b.begin(), pre_b.end());
+  // SPDLOG_INFO("Wolverine Recv");
+  setup_param.mp_param_.GenIndexes();
+  WolverineVoleRecv(conn_, recv_store, setup_param, absl::MakeSpan(tmp_a),
+                    absl::MakeSpan(tmp_b), absl::MakeSpan(a_),
+                    absl::MakeSpan(b_));
+  FinishSetup(setup_param);
+}
 
+template <typename T>
+void BasicWolverineVoleAdapter<T>::FinishSetup(const VoleParam& setup_param) {
   reserve_num_ = vole_param_.base_vole_num_;
   buff_used_num_ = reserve_num_;
   buff_upper_bound_ = setup_param.vole_num_;
   is_setup_ = true;
-  //   SPDLOG_INFO("OneTimeSetup Done");
 }
 
-void WolverineVoleAdapter::rsend(absl::Span<internal::PTy> c) {
+template <typename T>
+void BasicWolverineVoleAdapter<T>::rsend(absl::Span<T> c) {
   YACL_ENFORCE(is_sender_ == true);
 
   //   SPDLOG_INFO("Call RSEND");
@@ -59,7 +230,7 @@ void WolverineVoleAdapter::rsend(absl::Span<internal::PTy> c) {
   {
     uint32_t bootstrap_inplace_counter = 0;
     YACL_ENFORCE(reserve_num_ == vole_param_.base_vole_num_);
-    absl::Span<internal::PTy> c_span = absl::MakeSpan(c_.data(), reserve_num_);
+    absl::Span<T> c_span = absl::MakeSpan(c_.data(), reserve_num_);
     while (require_num > vole_param_.vole_num_) {
       // avoid memory copy
       BootstrapInplaceSend(c_span,
@@ -72,14 +243,14 @@ void WolverineVoleAdapter::rsend(absl::Span<internal::PTy> c) {
       c_span = c.subspan(data_offset, reserve_num_);
     }
     if (bootstrap_inplace_counter != 0) {
-      memcpy(c_.data(), c_span.data(), reserve_num_ * sizeof(internal::PTy));
+      memcpy(c_.data(), c_span.data(), reserve_num_ * sizeof(T));
     }
   }
 
   uint64_t vole_num = std::min(remain_num, require_num);
 
   memcpy(c.data() + data_offset, c_.data() + buff_used_num_,
-         vole_num * sizeof(internal::PTy));
+         vole_num * sizeof(T));
 
   buff_used_num_ += vole_num;
   // add state
@@ -98,20 +269,20 @@ void WolverineVoleAdapter::rsend(absl::Span<internal::PTy> c) {
                   require_num);
       // Bootstrap would reset buff_used_num_
       memcpy(c.data() + data_offset, c_.data() + buff_used_num_,
-             (buff_upper_bound_ - reserve_num_) * sizeof(internal::PTy));
+             (buff_upper_bound_ - reserve_num_) * sizeof(T));
       require_num -= (buff_upper_bound_ - reserve_num_);
       data_offset += (buff_upper_bound_ - reserve_num_);
       // Bootstrap would reset buff_used_num_
       Bootstrap();
     }
     memcpy(c.data() + data_offset, c_.data() + buff_used_num_,
-           require_num * sizeof(internal::PTy));
+           require_num * sizeof(T));
     buff_used_num_ += require_num;
   }
 }
 
-void WolverineVoleAdapter::rrecv(absl::Span<internal::PTy> a,
-                                 absl::Span<internal::PTy> b) {
+template <typename T>
+void BasicWolverineVoleAdapter<T>::rrecv(absl::Span<T> a, absl::Span<T> b) {
   YACL_ENFORCE(is_sender_ == false);
   YACL_ENFORCE(a.size() == b.size());
 
@@ -127,8 +298,8 @@ void WolverineVoleAdapter::rrecv(absl::Span<internal::PTy> a,
   {
     uint32_t bootstrap_inplace_counter = 0;
     YACL_ENFORCE(reserve_num_ == vole_param_.base_vole_num_);
-    absl::Span<internal::PTy> a_span = absl::MakeSpan(a_.data(), reserve_num_);
-    absl::Span<internal::PTy> b_span = absl::MakeSpan(b_.data(), reserve_num_);
+    absl::Span<T> a_span = absl::MakeSpan(a_.data(), reserve_num_);
+    absl::Span<T> b_span = absl::MakeSpan(b_.data(), reserve_num_);
     while (require_num > vole_param_.vole_num_) {
       // avoid memory copy
       BootstrapInplaceRecv(a_span, b_span,
@@ -143,17 +314,17 @@ void WolverineVoleAdapter::rrecv(absl::Span<internal::PTy> a,
       b_span = b.subspan(data_offset, reserve_num_);
     }
     if (bootstrap_inplace_counter != 0) {
-      memcpy(a_.data(), a_span.data(), reserve_num_ * sizeof(internal::PTy));
-      memcpy(b_.data(), b_span.data(), reserve_num_ * sizeof(internal::PTy));
+      memcpy(a_.data(), a_span.data(), reserve_num_ * sizeof(T));
+      memcpy(b_.data(), b_span.data(), reserve_num_ * sizeof(T));
     }
   }
 
   uint64_t vole_num = std::min(remain_num, require_num);
 
   memcpy(a.data() + data_offset, a_.data() + buff_used_num_,
-         vole_num * sizeof(internal::PTy));
+         vole_num * sizeof(T));
   memcpy(b.data() + data_offset, b_.data() + buff_used_num_,
-         vole_num * sizeof(internal::PTy));
+         vole_num * sizeof(T));
 
   buff_used_num_ += vole_num;
   // add state
@@ -172,23 +343,24 @@ void WolverineVoleAdapter::rrecv(absl::Span<internal::PTy> a,
                   require_num);
       // Bootstrap would reset buff_used_num_
       memcpy(a.data() + data_offset, a_.data() + buff_used_num_,
-             (buff_upper_bound_ - reserve_num_) * sizeof(internal::PTy));
+             (buff_upper_bound_ - reserve_num_) * sizeof(T));
       memcpy(b.data() + data_offset, b_.data() + buff_used_num_,
-             (buff_upper_bound_ - reserve_num_) * sizeof(internal::PTy));
+             (buff_upper_bound_ - reserve_num_) * sizeof(T));
       require_num -= (buff_upper_bound_ - reserve_num_);
       data_offset += (buff_upper_bound_ - reserve_num_);
       // Bootstrap would reset buff_used_num_
       Bootstrap();
     }
     memcpy(a.data() + data_offset, a_.data() + buff_used_num_,
-           require_num * sizeof(internal::PTy));
+           require_num * sizeof(T));
     memcpy(b.data() + data_offset, b_.data() + buff_used_num_,
-           require_num * sizeof(internal::PTy));
+           require_num * sizeof(T));
     buff_used_num_ += require_num;
   }
 }
 
-void WolverineVoleAdapter::Bootstrap() {
+template <typename T>
+void BasicWolverineVoleAdapter<T>::Bootstrap() {
   YACL_ENFORCE(vole_param_.base_vole_num_ == reserve_num_);
   auto ot_num = vole_param_.mp_vole_ot_num_;
 
@@ -199,9 +371,9 @@ void WolverineVoleAdapter::Bootstrap() {
     auto send_store =
         yc::MakeCompactOtSendStore(std::move(send_msgs), ot_ptr_->GetDelta());
     // Copy
-    std::vector<internal::PTy> tmp_c(c_.begin(), c_.begin() + reserve_num_);
+    std::vector<T> tmp_c(c_.begin(), c_.begin() + reserve_num_);
 
-    WolverineVoleSend(conn_, send_store, vole_param_, delta_,
+    WolverineVoleSend(conn_, send_store, vole_param_, this->delta_,
                       absl::MakeSpan(tmp_c), absl::MakeSpan(c_));
   } else {
     // prepare OT
@@ -210,8 +382,8 @@ void WolverineVoleAdapter::Bootstrap() {
     ot_ptr_->recv_rcot(absl::MakeSpan(recv_msgs), choices);
     auto recv_store = yc::MakeOtRecvStore(choices, std::move(recv_msgs));
     // Copy
-    std::vector<internal::PTy> tmp_a(a_.begin(), a_.begin() + reserve_num_);
-    std::vector<internal::PTy> tmp_b(b_.begin(), b_.begin() + reserve_num_);
+    std::vector<T> tmp_a(a_.begin(), a_.begin() + reserve_num_);
+    std::vector<T> tmp_b(b_.begin(), b_.begin() + reserve_num_);
     // Wolverine
     vole_param_.mp_param_.GenIndexes();
     WolverineVoleRecv(conn_, recv_store, vole_param_, absl::MakeSpan(tmp_a),
@@ -223,8 +395,9 @@ void WolverineVoleAdapter::Bootstrap() {
   buff_upper_bound_ = vole_param_.vole_num_;
 }
 
-void WolverineVoleAdapter::BootstrapInplaceSend(absl::Span<internal::PTy> pre_c,
-                                                absl::Span<internal::PTy> c) {
+template <typename T>
+void BasicWolverineVoleAdapter<T>::BootstrapInplaceSend(absl::Span<T> pre_c,
+                                                        absl::Span<T> c) {
   YACL_ENFORCE(is_sender_ == true);
   YACL_ENFORCE(pre_c.size() >= vole_param_.base_vole_num_);
   auto ot_num = vole_param_.mp_vole_ot_num_;
@@ -234,17 +407,18 @@ void WolverineVoleAdapter::BootstrapInplaceSend(absl::Span<internal::PTy> pre_c,
   auto send_store =
       yc::MakeCompactOtSendStore(std::move(send_msgs), ot_ptr_->GetDelta());
   // Copy
-  std::vector<internal::PTy> tmp_c(pre_c.begin(),
+  std::vector<T> tmp_c(pre_c.begin(),
                                    pre_c.begin() + vole_param_.base_vole_num_);
 
-  WolverineVoleSend(conn_, send_store, vole_param_, delta_,
+  WolverineVoleSend(conn_, send_store, vole_param_, this->delta_,
                     absl::MakeSpan(tmp_c), absl::MakeSpan(c));
 }
 
-void WolverineVoleAdapter::BootstrapInplaceRecv(absl::Span<internal::PTy> pre_a,
-                                                absl::Span<internal::PTy> pre_b,
-                                                absl::Span<internal::PTy> a,
-                                                absl::Span<internal::PTy> b) {
+template <typename T>
+void BasicWolverineVoleAdapter<T>::BootstrapInplaceRecv(absl::Span<T> pre_a,
+                                                        absl::Span<T> pre_b,
+                                                        absl::Span<T> a,
+                                                        absl::Span<T> b) {
   YACL_ENFORCE(is_sender_ == true);
   YACL_ENFORCE(pre_a.size() >= vole_param_.base_vole_num_);
   YACL_ENFORCE(pre_b.size() >= vole_param_.base_vole_num_);
@@ -255,10 +429,10 @@ void WolverineVoleAdapter::BootstrapInplaceRecv(absl::Span<internal::PTy> pre_a,
   ot_ptr_->recv_rcot(absl::MakeSpan(recv_msgs), choices);
   auto recv_store = yc::MakeOtRecvStore(choices, std::move(recv_msgs));
   // Copy
-  std::vector<internal::PTy> tmp_a(pre_a.begin(),
-                                   pre_a.begin() + vole_param_.base_vole_num_);
-  std::vector<internal::PTy> tmp_b(pre_b.begin(),
-                                   pre_b.begin() + vole_param_.base_vole_num_);
+  std::vector<T> tmp_a(pre_a.begin(),
+                       pre_a.begin() + vole_param_.base_vole_num_);
+  std::vector<T> tmp_b(pre_b.begin(),
+                       pre_b.begin() + vole_param_.base_vole_num_);
   // Wolverine
   vole_param_.mp_param_.GenIndexes();
   WolverineVoleRecv(conn_, recv_store, vole_param_, absl::MakeSpan(tmp_a),
@@ -266,4 +440,7 @@ void WolverineVoleAdapter::BootstrapInplaceRecv(absl::Span<internal::PTy> pre_a,
                     absl::MakeSpan(b));
 }
 
+template class BasicWolverineVoleAdapter<kFp128>;
+template class BasicWolverineVoleAdapter<kFp256>;
+
 }  // namespace mcpsi::vole
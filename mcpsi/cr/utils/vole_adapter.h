@@ -13,77 +13,89 @@ namespace mcpsi::vole {
 namespace yc = yacl::crypto;
 namespace yl = yacl::link;
 
-class VoleAdapter {
+// VOLE over the field T, kFp256 (internal::PTy) for the SPDZ instance of the
+// keys && kFp128 (internal::PayTy) for the one of the payloads
+template <typename T>
+class BasicVoleAdapter {
  public:
-  VoleAdapter() = default;
-  virtual ~VoleAdapter() = default;
+  BasicVoleAdapter() = default;
+  virtual ~BasicVoleAdapter() = default;
 
-  virtual void rsend(absl::Span<internal::PTy> c) = 0;
-  virtual void rrecv(absl::Span<internal::PTy> a,
-                     absl::Span<internal::PTy> b) = 0;
+  virtual void rsend(absl::Span<T> c) = 0;
+  virtual void rrecv(absl::Span<T> a, absl::Span<T> b) = 0;
 
   virtual void OneTimeSetup() = 0;
 
-  internal::PTy delta_{0};
-  virtual internal::PTy GetDelta() const { return delta_; }
+  T delta_{0};
+  virtual T GetDelta() const { return delta_; }
 };
 
-class WolverineVoleAdapter : public VoleAdapter {
+template <typename T>
+class BasicWolverineVoleAdapter : public BasicVoleAdapter<T> {
  public:
-  WolverineVoleAdapter(const std::shared_ptr<Connection>& conn,
-                       std::shared_ptr<ot::OtAdapter> ot_ptr,
-                       internal::PTy delta) {
+  BasicWolverineVoleAdapter(const std::shared_ptr<Connection>& conn,
+                            std::shared_ptr<ot::OtAdapter> ot_ptr, T delta) {
     ot_ptr_ = ot_ptr;
     conn_ = conn;
     is_sender_ = ot_ptr_->IsSender();
     YACL_ENFORCE(is_sender_ == true);  // Vole Sender has delta
-    delta_ = delta;
+    this->delta_ = delta;
     vole_param_ = VoleParam(LpnParam::GetDefault(), true);
 
-    // a_ = std::vector<internal::PTy>(vole_param_.vole_num_, 0);
-    // b_ = std::vector<internal::PTy>(vole_param_.vole_num_, 0);
-    c_ = std::vector<internal::PTy>(vole_param_.vole_num_, 0);
+    // a_ = std::vector<T>(vole_param_.vole_num_, 0);
+    // b_ = std::vector<T>(vole_param_.vole_num_, 0);
+    c_ = std::vector<T>(vole_param_.vole_num_, 0);
   }
 
-  WolverineVoleAdapter(const std::shared_ptr<Connection>& conn,
-                       std::shared_ptr<ot::OtAdapter> ot_ptr) {
+  BasicWolverineVoleAdapter(const std::shared_ptr<Connection>& conn,
+                            std::shared_ptr<ot::OtAdapter> ot_ptr) {
     ot_ptr_ = ot_ptr;
     conn_ = conn;
     is_sender_ = ot_ptr_->IsSender();
     YACL_ENFORCE(is_sender_ == false);  // Vole Receiver
     vole_param_ = VoleParam(LpnParam::GetDefault(), true);
 
-    a_ = std::vector<internal::PTy>(vole_param_.vole_num_, 0);
-    b_ = std::vector<internal::PTy>(vole_param_.vole_num_, 0);
-    // c_ = std::vector<internal::PTy>(vole_param_.vole_num_, 0);
+    a_ = std::vector<T>(vole_param_.vole_num_, 0);
+    b_ = std::vector<T>(vole_param_.vole_num_, 0);
+    // c_ = std::vector<T>(vole_param_.vole_num_, 0);
   }
 
-  void rsend(absl::Span<internal::PTy> c) override;
-  void rrecv(absl::Span<internal::PTy> a, absl::Span<internal::PTy> b) override;
+  void rsend(absl::Span<T> c) override;
+  void rrecv(absl::Span<T> a, absl::Span<T> b) override;
 
+  // base VOLEs by OtHelper (PTy), or by a plain Gilboa multiplication (others)
   void OneTimeSetup() override;
 
+  // set up from given base VOLEs (e.g. of a warm-start snapshot), skip the
+  // OT-based base VOLE, SetupVoleNum() for each
+  void OneTimeSetup(absl::Span<const T> pre_c);
+  void OneTimeSetup(absl::Span<const T> pre_a, absl::Span<const T> pre_b);
+
+  // number of base VOLEs in OneTimeSetup
+  static size_t SetupVoleNum() {
+    return VoleParam(LpnParam::GetPreDefault(), true).base_vole_num_;
+  }
+
   // Bootstrap would refresh Vole Buffer && Status
   void Bootstrap();
   // BoostrapInplace would generate voles in the span
-  void BootstrapInplaceSend(absl::Span<internal::PTy> pre_c,
-                            absl::Span<internal::PTy> c);
+  void BootstrapInplaceSend(absl::Span<T> pre_c, absl::Span<T> c);
 
-  void BootstrapInplaceRecv(absl::Span<internal::PTy> pre_a,
-                            absl::Span<internal::PTy> pre_b,
-                            absl::Span<internal::PTy> a,
-                            absl::Span<internal::PTy> b);
+  void BootstrapInplaceRecv(absl::Span<T> pre_a, absl::Span<T> pre_b,
+                            absl::Span<T> a, absl::Span<T> b);
 
  private:
+  void FinishSetup(const VoleParam& setup_param);
+
   bool is_sender_{false};
   bool is_setup_{false};
   // Ot Adapter
   std::shared_ptr<Connection> conn_{nullptr};
   std::shared_ptr<ot::OtAdapter> ot_ptr_{nullptr};
   // Vole Buffer
-  std::vector<internal::PTy> a_;
-  std::vector<internal::PTy> b_;
-  std::vector<internal::PTy> c_;
+  std::vector<T> a_;
+  std::vector<T> b_;
+  std::vector<T> c_;
   // Vole Status
   uint64_t reserve_num_{0};
   uint64_t buff_used_num_{0};
@@ -91,4 +103,10 @@ class WolverineVoleAdapter : public VoleAdapter {
   VoleParam vole_param_;
 };
 
+using VoleAdapter = BasicVoleAdapter<internal::PTy>;
+using WolverineVoleAdapter = BasicWolverineVoleAdapter<internal::PTy>;
+
+using PayVoleAdapter = BasicVoleAdapter<internal::PayTy>;
+using PayWolverineVoleAdapter = BasicWolverineVoleAdapter<internal::PayTy>;
+
 }  // namespace mcpsi::vole
@@ -86,4 +86,43 @@ INSTANTIATE_TEST_SUITE_P(Works, VoleAdapterTest,
                          testing::Values(VoleTestParam{2}, VoleTestParam{10},
                                          VoleTestParam{1000},
                                          VoleTestParam{1 << 20}));
+
+// VOLE over the payload field, base VOLEs by Gilboa multiplication
+TEST(VoleAdapterTest, PayWork) {
+  const size_t vole_num = 1000;
+  auto delta = internal::PayTy(yc::SecureRandU128());
+
+  auto lctxs = SetupWorld(2);
+  auto rank0 = std::async([&] {
+    auto conn = std::make_shared<Connection>(*lctxs[0]);
+    auto otSender = std::make_shared<ot::YaclSsOtAdapter>(lctxs[0], true);
+    otSender->OneTimeSetup();
+
+    auto voleSender =
+        std::make_shared<PayWolverineVoleAdapter>(conn, otSender, delta);
+    std::vector<internal::PayTy> c(vole_num);
+    voleSender->rsend(absl::MakeSpan(c));
+    return c;
+  });
+  auto rank1 = std::async([&] {
+    auto conn = std::make_shared<Connection>(*lctxs[1]);
+    auto otReceiver = std::make_shared<ot::YaclSsOtAdapter>(lctxs[1], false);
+    otReceiver->OneTimeSetup();
+
+    auto voleReceiver =
+        std::make_shared<PayWolverineVoleAdapter>(conn, otReceiver);
+    std::vector<internal::PayTy> a(vole_num);
+    std::vector<internal::PayTy> b(vole_num);
+    voleReceiver->rrecv(absl::MakeSpan(a), absl::MakeSpan(b));
+    return std::make_pair(a, b);
+  });
+
+  auto c = rank0.get();
+  auto [a, b] = rank1.get();
+
+  for (size_t i = 0; i < vole_num; ++i) {
+    EXPECT_EQ(a[i] * delta + b[i], c[i]);
+  }
+}
+
 }  // namespace mcpsi::vole
@@ -0,0 +1,487 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <random>
+#include <unordered_set>
+
+#include "absl/strings/str_split.h"
+#include "llvm/Support/CommandLine.h"
+#include "mcpsi/context/register.h"
+#include "mcpsi/cr/utils/snapshot.h"
+#include "mcpsi/ss/oprf_store.h"
+#include "mcpsi/ss/protocol.h"
+#include "mcpsi/utils/stream.h"
+#include "mcpsi/utils/test_util.h"
+#include "mcpsi/utils/vec_op.h"
+#include "yacl/crypto/utils/rand.h"
+#include "yacl/link/link.h"
+#include "yacl/utils/parallel.h"
+
+using namespace mcpsi;
+
+// -------- MACRO ---------
+
+#define TIMER_START(name) \
+  auto name##_begin = std::chrono::high_resolution_clock::now();
+
+#define TIMER_END(name) \
+  auto name##_end = std::chrono::high_resolution_clock::now();
+
+#define TIMER_PRINT(name)                                                  \
+  auto name##_elapse = name##_end - name##_begin;                          \
+  double name##_ms =                                                       \
+      std::chrono::duration_cast<std::chrono::milliseconds>(name##_elapse) \
+          .count();                                                        \
+  SPDLOG_INFO("[P{}] (TIMER) {} need {} ms (or {} s)", rank,               \
+              std::string(#name), name##_ms, name##_ms / 1000);
+
+// ---------- CL -----------
+
+llvm::cl::opt<std::string> cl_parties(
+    "parties", llvm::cl::init("127.0.0.1:39530,127.0.0.1:39531"),
+    llvm::cl::desc("server list, format: host1:port1[,host2:port2, ...]"));
+llvm::cl::opt<uint32_t> cl_rank("rank", llvm::cl::init(0),
+                                llvm::cl::desc("self rank"));
+llvm::cl::opt<uint32_t> cl_CR(
+    "CR", llvm::cl::init(0),
+    llvm::cl::desc("0 for prg-based correlated randomness, 1 for real "
+                   "correlated randomness"));
+llvm::cl::opt<uint32_t> cl_mode(
+    "mode", llvm::cl::init(0),
+    llvm::cl::desc("0 for memory mode, 1 for socket mode"));
+llvm::cl::opt<std::string> cl_input(
+    "input", llvm::cl::init(""),
+    llvm::cl::desc("binary file of the set (32 bytes per item), socket mode "
+                   "only"));
+llvm::cl::opt<std::string> cl_payload(
+    "payload", llvm::cl::init(""),
+    llvm::cl::desc("binary file of the payload (32 bytes per item, party1 "
+                   "only), socket mode only, use all-one payload if empty"));
+llvm::cl::opt<std::string> cl_store(
+    "store", llvm::cl::init("/tmp/mcpsi_oprf"),
+    llvm::cl::desc("directory of the persisted DY-PRF session (one "
+                   "sub-directory per party)"));
+llvm::cl::opt<std::string> cl_store_secret(
+    "store_secret", llvm::cl::init(""),
+    llvm::cl::desc("file of the local secret sealing the stored key shares "
+                   "(created if missing), must be outside of --store"));
+llvm::cl::opt<uint32_t> cl_max_runs(
+    "max_runs", llvm::cl::init(30),
+    llvm::cl::desc("rotate the DY-PRF key after so many runs"));
+llvm::cl::opt<uint64_t> cl_max_age(
+    "max_age", llvm::cl::init(7 * 24 * 3600),
+    llvm::cl::desc("rotate the DY-PRF key after so many seconds"));
+llvm::cl::opt<double> cl_max_change(
+    "max_change", llvm::cl::init(0.5),
+    llvm::cl::desc("rotate the DY-PRF key if the ratio of changed items of "
+                   "set0 is beyond it (cost only)"));
+llvm::cl::opt<uint32_t> cl_min_insert(
+    "min_insert", llvm::cl::init(1024),
+    llvm::cl::desc("pad a smaller (non-empty) insertion of set0 with random "
+                   "dummy items up to it"));
+llvm::cl::opt<uint32_t> cl_days(
+    "days", llvm::cl::init(3),
+    llvm::cl::desc("the number of (daily) runs, memory mode only"));
+llvm::cl::opt<double> cl_churn(
+    "churn", llvm::cl::init(0.02),
+    llvm::cl::desc("the ratio of set0 replaced between two runs, memory "
+                   "mode only"));
+llvm::cl::opt<uint32_t> cl_size0("set0", llvm::cl::init(100000),
+                                 llvm::cl::desc("the size of set0"));
+llvm::cl::opt<uint32_t> cl_size1("set1", llvm::cl::init(100000),
+                                 llvm::cl::desc("the size of set1"));
+llvm::cl::opt<uint32_t> cl_interset_size(
+    "interset", llvm::cl::init(1000),
+    llvm::cl::desc("the size of intersection"));
+llvm::cl::opt<uint32_t> cl_thread("thread", llvm::cl::init(1),
+                                  llvm::cl::desc("the number of threads"));
+
+namespace {
+
+uint64_t Now() {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// random ids of new items, distinct from each other && the stored ones
+std::vector<uint64_t> DrawIds(const OprfStore &store, size_t num) {
+  std::unordered_set<uint64_t> drawn;
+  std::vector<uint64_t> ret;
+  ret.reserve(num);
+  while (ret.size() < num) {
+    auto id = yacl::crypto::SecureRandU64();
+    if (!store.ContainsId(id) && drawn.emplace(id).second) {
+      ret.emplace_back(id);
+    }
+  }
+  return ret;
+}
+
+template <typename T>
+std::vector<T> ToVector(const yacl::Buffer &buf) {
+  YACL_ENFORCE(buf.size() % sizeof(T) == 0);
+  auto ptr = buf.data<T>();
+  return std::vector<T>(ptr, ptr + buf.size() / sizeof(T));
+}
+
+}  // namespace
+
+// Incremental Malicious Circuit PSI (sum of payloads in intersection)
+//
+// The DY-PRF key (with the SPDZ key) and the revealed OPRF values of set0 are
+// persisted: the key shares are sealed in `store_dir`/keys (SetupSnapshot
+// under `store_secret`, never-reuse counter in `counter_path`), the OPRF
+// values in `store_dir` (OprfStore). On later
+// runs, only the items inserted into set0 are evaluated (DyExp && A2G), and
+// the deleted ones are removed through their ids. Set1 is evaluated from
+// scratch in every run.
+//
+// Set0 is shuffled by party1 (secret shuffle, together with fresh random ids
+// drawn by party0) before its OPRF values are revealed, and only party1
+// learns the shuffled ids. So party0, who also sees reveal1, can't link a
+// stored OPRF value to its item:
+//  - an insertion smaller than `policy.min_insert` is padded with random
+//    dummy items (stored as usual, so they are deleted in the next run);
+//  - on deletion, party1 drops the fingerprints locally && only sends back
+//    the count, party0 never learns which ones are gone.
+// Thus only party1 knows the current fingerprints of set0 && selects the
+// intersection; party0 checks every selected index against the fingerprints
+// revealed in the session (deleted ones included).
+//
+// The key is rotated (and all OPRF values of set0 are recomputed) when either
+// party has no session, the sessions or the sealed keys mismatch, or `policy`
+// asks for it (too many runs, too old, or a change so large that a full
+// recomputation is cheaper).
+//
+// NOTE: party0 can't tell a dropped match from a missing one, so party1 may
+// leave out some matches (like removing them from set1), but can't add a
+// non-matching item.
+auto incremental_psi(const std::shared_ptr<yacl::link::Context> &lctx,
+                     const std::vector<PTy> &set,
+                     const std::vector<PTy> &val, const std::string &store_dir,
+                     uint128_t store_secret, const std::string &counter_path,
+                     const KeyRotationPolicy &policy, bool CR_mode = false) {
+  auto rank = lctx->Rank();
+  auto context = std::make_shared<Context>(lctx);
+  auto conn = context->GetConnection();
+
+  // ---- 0. session ----
+  OprfStore store(store_dir, rank);
+  SetupSnapshot keys(store_dir + "/keys", rank, store_secret, counter_path);
+  bool loaded = store.Load();
+  std::vector<PTy> inserted;
+  std::vector<PTy> deleted;
+  if (rank == 0 && loaded) {
+    std::unordered_set<PTy, OprfStore::ItemHash, OprfStore::ItemEq> current(
+        set.begin(), set.end());
+    for (const auto &item : set) {
+      if (!store.Contains(item)) {
+        inserted.emplace_back(item);
+      }
+    }
+    for (const auto &item : store.Items()) {
+      if (current.count(item) == 0) {
+        deleted.emplace_back(item);
+      }
+    }
+  }
+  uint64_t rotate = !loaded || store.NeedRotate(
+                                   policy, inserted.size() + deleted.size());
+  rotate |= conn->Exchange(rotate);
+  uint128_t session_id = loaded ? store.GetMeta().session_id : 0;
+  rotate |= (conn->Exchange(session_id) != session_id);
+
+  TIMER_START(setup);
+  SnapshotPayload payload;
+  // a sealed key is loaded at most once, rotate if it is gone
+  if (!rotate && !keys.Load(conn, &payload)) {
+    rotate = 1;
+  }
+  if (rotate) {
+    SetupContext(context, CR_mode);
+    OprfSessionMeta meta;
+    meta.session_id = conn->SyncSeed();
+    meta.created = Now();
+    meta.runs = 0;
+    store.Reset(meta);
+    inserted = rank == 0 ? set : std::vector<PTy>();
+    deleted.clear();
+  } else {
+    auto key = payload.NextOne<PTy>();
+    auto dy_key = payload.NextOne<PTy>();
+    SetupContext(context, CR_mode, &key, &dy_key);
+  }
+  // dummies are stored as usual && deleted in the next run
+  if (rank == 0 && !inserted.empty() && inserted.size() < policy.min_insert) {
+    auto dummy = OP::Rand(policy.min_insert - inserted.size());
+    inserted.insert(inserted.end(), dummy.begin(), dummy.end());
+  }
+  auto prot = context->GetState<Protocol>();
+  auto Ggroup = prot->GetGroup();
+  TIMER_END(setup);
+  TIMER_PRINT(setup);
+  SPDLOG_INFO("[P{}] {} session, run {}", rank, rotate ? "new" : "persisted",
+              store.GetMeta().runs);
+
+  // ---- 1. update the stored OPRF values of set0 ----
+  TIMER_START(update);
+  // party0's update sizes are public
+  uint64_t insert_num = inserted.size();
+  uint64_t peer_num = conn->Exchange(insert_num);
+  insert_num = rank == 0 ? insert_num : peer_num;
+  size_t delete_num = deleted.size();
+  {
+    // deletion: ids in random order (party0 --> party1), party1 drops the
+    // fingerprints && only answers the count
+    if (rank == 0) {
+      std::mt19937_64 rng(std::random_device{}());
+      std::vector<uint64_t> ids;
+      for (const auto &item : deleted) {
+        ids.emplace_back(store.Erase(item));
+      }
+      std::shuffle(ids.begin(), ids.end(), rng);
+      conn->SendAsync(
+          conn->NextRank(),
+          yacl::ByteContainerView(ids.data(), ids.size() * sizeof(uint64_t)),
+          "OprfStore:Delete");
+      auto count = ToVector<uint64_t>(
+          conn->Recv(conn->NextRank(), "OprfStore:Delete"));
+      YACL_ENFORCE(count.size() == 1 && count[0] == ids.size());
+    } else {
+      auto ids = ToVector<uint64_t>(
+          conn->Recv(conn->NextRank(), "OprfStore:Delete"));
+      for (const auto &id : ids) {
+        store.Erase(id);
+      }
+      uint64_t count = ids.size();
+      conn->SendAsync(conn->NextRank(),
+                      yacl::ByteContainerView(&count, sizeof(uint64_t)),
+                      "OprfStore:Delete");
+      delete_num = ids.size();
+    }
+  }
+  {
+    // insertion: secret shuffle of (item, id) by party1
+    std::vector<uint64_t> ids;
+    std::vector<PTy> ids_p;
+    if (rank == 0) {
+      ids = DrawIds(store, insert_num);
+      ids_p.assign(ids.begin(), ids.end());
+    }
+    auto share = rank == 0 ? prot->DyExpSet(inserted)
+                           : prot->DyExpGet(insert_num);
+    auto id_share = rank == 0 ? prot->SetA(ids_p) : prot->GetA(insert_num);
+    auto [shuffle0, shuffle_id] =
+        (rank == 1 ? prot->ShuffleASet(share, id_share)
+                   : prot->ShuffleAGet(share, id_share));
+    auto fps = OprfFingerprint(Ggroup, prot->A2G(shuffle0));
+    // reveal the shuffled ids to party1 only, a wrong share (without MAC
+    // check) only breaks the later deletions of party0
+    if (rank == 0) {
+      std::vector<PTy> vals;
+      for (const auto &s : shuffle_id) {
+        vals.emplace_back(s.val);
+      }
+      conn->SendAsync(
+          conn->NextRank(),
+          yacl::ByteContainerView(vals.data(), vals.size() * sizeof(PTy)),
+          "OprfStore:Insert");
+      for (size_t i = 0; i < insert_num; ++i) {
+        store.Insert(inserted[i], ids[i]);
+        store.InsertFp(fps[i]);
+      }
+    } else {
+      auto vals =
+          ToVector<PTy>(conn->Recv(conn->NextRank(), "OprfStore:Insert"));
+      YACL_ENFORCE(vals.size() == insert_num);
+      for (size_t i = 0; i < insert_num; ++i) {
+        auto id = (shuffle_id[i].val + vals[i]).GetVal();
+        store.Insert(static_cast<uint64_t>(Uint256Low128(id)), fps[i]);
+      }
+    }
+  }
+  SPDLOG_INFO("[P{}] set0 stored {}, inserted {}, deleted {}", rank,
+              store.Size(), insert_num, delete_num);
+  TIMER_END(update);
+  TIMER_PRINT(update);
+
+  // ---- 2. OPRF of set1 (from scratch) ----
+  TIMER_START(oprf1);
+  uint64_t size1 = set.size();
+  uint64_t peer_size = conn->Exchange(size1);
+  size1 = rank == 1 ? size1 : peer_size;
+  auto share1 = rank == 1 ? prot->DyExpSet(set) : prot->DyExpGet(size1);
+  auto secret = rank == 1 ? prot->SetA(val.empty() ? OP::Ones(size1) : val)
+                          : prot->GetA(size1);
+  auto [shuffle1, shuffle_secret] =
+      (rank == 1 ? prot->ShuffleASet(share1, secret)
+                 : prot->ShuffleAGet(share1, secret));
+  auto reveal1 = OprfFingerprint(Ggroup, prot->A2G(shuffle1));
+  TIMER_END(oprf1);
+  TIMER_PRINT(oprf1);
+
+  // ---- 3. intersection && sum ----
+  TIMER_START(result_sum);
+  // party1 selects the matches (it alone knows the current fingerprints),
+  // party0 checks them against all fingerprints of the session
+  auto fps0 = store.Fingerprints();
+  std::vector<size_t> indexes;
+  if (rank == 1) {
+    std::vector<uint64_t> selected;
+    for (size_t i = 0; i < reveal1.size(); ++i) {
+      if (fps0.count(reveal1[i])) {
+        indexes.emplace_back(i);
+        selected.emplace_back(i);
+      }
+    }
+    conn->SendAsync(conn->NextRank(),
+                    yacl::ByteContainerView(
+                        selected.data(), selected.size() * sizeof(uint64_t)),
+                    "OprfStore:Match");
+  } else {
+    auto selected =
+        ToVector<uint64_t>(conn->Recv(conn->NextRank(), "OprfStore:Match"));
+    for (const auto &i : selected) {
+      YACL_ENFORCE(i < reveal1.size() && fps0.count(reveal1[i]) > 0 &&
+                       (indexes.empty() || i > indexes.back()),
+                   "bad match from party1");
+      indexes.emplace_back(i);
+    }
+  }
+  SPDLOG_INFO("[P{}] interset size {}", rank, indexes.size());
+  auto selected = prot->FilterA(shuffle_secret, indexes);
+  auto result_p = prot->A2P(prot->SumA(selected));
+  TIMER_END(result_sum);
+  TIMER_PRINT(result_sum);
+
+  // persist only after the run succeeds (all MAC checks passed), the keys
+  // are sealed again as a new generation
+  SnapshotPayload sealed;
+  sealed.AppendOne(prot->GetKey());
+  sealed.AppendOne(prot->GetPrfK());
+  keys.Save(conn, sealed);
+  store.FinishRun();
+  store.Save();
+
+  SPDLOG_INFO("[P{}] sum is {}", rank, result_p[0].GetVal());
+  return result_p[0].GetVal();
+}
+
+// the local secret is kept outside of the store, so that a copy of the store
+// alone can't unseal the key shares
+uint128_t LoadSecret(const std::string &path, const std::string &store_dir) {
+  namespace fs = std::filesystem;
+  YACL_ENFORCE(!path.empty(), "--store_secret is needed");
+  auto file = fs::weakly_canonical(path);
+  auto dir = fs::weakly_canonical(store_dir);
+  YACL_ENFORCE(std::mismatch(dir.begin(), dir.end(), file.begin(), file.end())
+                       .first != dir.end(),
+               "--store_secret {} is inside of --store {}", path, store_dir);
+  if (fs::exists(file)) {
+    ChunkReader<uint128_t> reader(file.string());
+    YACL_ENFORCE(reader.Size() == 1, "broken secret {}", path);
+    return reader.Next(1)[0];
+  }
+  uint128_t secret = yacl::crypto::SecureRandU128();
+  ChunkWriter<uint128_t> writer(file.string());
+  writer.Write(absl::MakeConstSpan(&secret, 1));
+  writer.Close();
+  fs::permissions(file, fs::perms::owner_read | fs::perms::owner_write);
+  return secret;
+}
+
+std::vector<PTy> LoadSet(const std::string &path) {
+  ChunkReader<PTy> reader(path);
+  return reader.Next(reader.Size());
+}
+
+std::shared_ptr<yacl::link::Context> MakeLink(const std::string &parties,
+                                              size_t rank) {
+  yacl::link::ContextDesc lctx_desc;
+  std::vector<std::string> hosts = absl::StrSplit(parties, ',');
+  for (size_t rank = 0; rank < hosts.size(); rank++) {
+    const auto id = fmt::format("party{}", rank);
+    lctx_desc.parties.emplace_back(id, hosts[rank]);
+  }
+  lctx_desc.throttle_window_size = 0;
+  lctx_desc.http_timeout_ms = 120 * 1000;  // 2 min
+  auto lctx = yacl::link::FactoryBrpc().CreateContext(lctx_desc, rank);
+  lctx->ConnectToMesh();
+  return lctx;
+}
+
+int main(int argc, char **argv) {
+  llvm::cl::ParseCommandLineOptions(argc, argv);
+
+  bool mem_mode = cl_mode.getValue() == 0;
+  bool CR_mode = cl_CR.getValue();
+  KeyRotationPolicy policy;
+  policy.max_runs = cl_max_runs.getValue();
+  policy.max_age = cl_max_age.getValue();
+  policy.max_change = cl_max_change.getValue();
+  policy.min_insert = cl_min_insert.getValue();
+  std::string store_dir = cl_store.getValue();
+  auto secret = LoadSecret(cl_store_secret.getValue(), store_dir);
+  // the never-reuse counters of the sealed keys live next to the secret
+  auto counter_path = [&](size_t rank) {
+    return fmt::format("{}.p{}.counter", cl_store_secret.getValue(), rank);
+  };
+
+  yacl::set_num_threads(cl_thread.getValue());
+
+  if (mem_mode == true) {
+    size_t size0 = cl_size0.getValue();
+    size_t size1 = cl_size1.getValue();
+    size_t interset_size =
+        std::min<size_t>(cl_interset_size.getValue(), std::min(size0, size1));
+    auto set0 = OP::Rand(size0);
+    auto set1 = OP::Rand(size1);
+    for (size_t i = 0; i < interset_size; ++i) {
+      set1[i] = set0[i];
+    }
+
+    auto lctxs = SetupWorld(2);
+    for (size_t day = 0; day < cl_days.getValue(); ++day) {
+      if (day > 0) {
+        // replace `churn` of set0 (keep the intersection)
+        size_t churn = static_cast<size_t>(cl_churn.getValue() * size0);
+        churn = std::min(churn, size0 - interset_size);
+        auto fresh = OP::Rand(churn);
+        for (size_t i = 0; i < churn; ++i) {
+          set0[size0 - 1 - i] = fresh[i];
+        }
+      }
+      std::cout << "---- day " << day << " ----" << std::endl;
+      auto task0 = std::async([&] {
+        return incremental_psi(lctxs[0], set0, {}, store_dir + "/p0", secret,
+                               counter_path(0), policy, CR_mode);
+      });
+      auto task1 = std::async([&] {
+        return incremental_psi(lctxs[1], set1, {}, store_dir + "/p1", secret,
+                               counter_path(1), policy, CR_mode);
+      });
+      auto result0 = task0.get();
+      auto result1 = task1.get();
+      std::cout << "P0 result (sum): " << result0 << std::endl;
+      std::cout << "P1 result (sum): " << result1 << std::endl;
+    }
+  } else {
+    YACL_ENFORCE(!cl_input.getValue().empty(), "--input is needed");
+    auto lctx = MakeLink(cl_parties.getValue(), cl_rank.getValue());
+    auto set = LoadSet(cl_input.getValue());
+    std::vector<PTy> val;
+    if (lctx->Rank() == 1 && !cl_payload.getValue().empty()) {
+      val = LoadSet(cl_payload.getValue());
+      YACL_ENFORCE(val.size() == set.size());
+    }
+    auto dir = fmt::format("{}/p{}", store_dir, lctx->Rank());
+    auto res = incremental_psi(lctx, set, val, dir, secret,
+                               counter_path(lctx->Rank()), policy, CR_mode);
+    std::cout << "P" << cl_rank.getValue() << " result (sum): " << res
+              << std::endl;
+  }
+
+  return 0;
+}
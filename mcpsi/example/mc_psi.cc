@@ -1,10 +1,13 @@
 #include <chrono>
+#include <cmath>
 #include <future>
 #include <random>
 
 #include "llvm/Support/CommandLine.h"
 #include "mcpsi/context/register.h"
+#include "mcpsi/ss/payload.h"
 #include "mcpsi/ss/protocol.h"
+#include "mcpsi/utils/input.h"
 #include "mcpsi/utils/test_util.h"
 #include "mcpsi/utils/vec_op.h"
 #include "yacl/link/link.h"
@@ -68,10 +71,22 @@ llvm::cl::opt<uint32_t> cl_cache(
         "0 for no cache, 1 for cache (pre-compute offline randomness)"));
 llvm::cl::opt<uint32_t> cl_fairness(
     "fairness", llvm::cl::init(0),
-    llvm::cl::desc("0 for no fairness, 1 for fairness (DY-PRF)"));
+    llvm::cl::desc("0 for no fairness, k > 0 for fairness (DY-PRF) releasing "
+                   "k bits per round"));
 llvm::cl::opt<uint32_t> cl_mode(
     "mode", llvm::cl::init(0),
-    llvm::cl::desc("0 for memory mode, 1 for socket mode"));
+    llvm::cl::desc("0 for memory mode, 1 for socket mode, 2 for memory mode "
+                   "with WAN emulation (see --latency/--bandwidth/--jitter)"));
+llvm::cl::opt<double> cl_latency(
+    "latency", llvm::cl::init(20.0),
+    llvm::cl::desc("one-way latency (ms) for WAN emulation (mode 2)"));
+llvm::cl::opt<double> cl_bandwidth(
+    "bandwidth", llvm::cl::init(100.0),
+    llvm::cl::desc("bandwidth (Mbps) for WAN emulation (mode 2), 0 for "
+                   "unlimited"));
+llvm::cl::opt<double> cl_jitter(
+    "jitter", llvm::cl::init(0.0),
+    llvm::cl::desc("jitter (ms) for WAN emulation (mode 2)"));
 llvm::cl::opt<uint32_t> cl_size0("set0", llvm::cl::init(10000),
                                  llvm::cl::desc("the size of set0"));
 llvm::cl::opt<uint32_t> cl_size1("set1", llvm::cl::init(10000),
@@ -82,17 +97,54 @@ llvm::cl::opt<uint32_t> cl_interset_size(
 
 llvm::cl::opt<uint32_t> cl_thread("thread", llvm::cl::init(1),
                                   llvm::cl::desc("the number of threads"));
+llvm::cl::opt<uint32_t> cl_bucket(
+    "bucket", llvm::cl::init(1),
+    llvm::cl::desc("the number of buckets (each bucket runs an independent "
+                   "Circuit-PSI on its own link && thread), 1 for no bucket, "
+                   "see --bucket_leakage"));
+llvm::cl::opt<uint32_t> cl_bucket_leakage(
+    "bucket_leakage", llvm::cl::init(0),
+    llvm::cl::desc("1 to accept the leakage of --bucket > 1: both parties "
+                   "learn the intersection size of every bucket (instead of "
+                   "the total one)"));
+llvm::cl::opt<std::string> cl_input(
+    "input", llvm::cl::init(""),
+    llvm::cl::desc("own input file (identifiers [&& payloads]) instead of a "
+                   "random set, socket mode only, both parties should give "
+                   "one"));
+llvm::cl::opt<uint32_t> cl_binary(
+    "binary", llvm::cl::init(0),
+    llvm::cl::desc("0 for csv input, 1 for binary input (fixed-size "
+                   "records: identifier [|| 64-bit payload])"));
+llvm::cl::opt<uint32_t> cl_payload(
+    "payload", llvm::cl::init(0),
+    llvm::cl::desc("1 if the input (of party1) has payloads, all-one "
+                   "otherwise"));
+llvm::cl::opt<uint32_t> cl_header(
+    "header", llvm::cl::init(0),
+    llvm::cl::desc("1 to skip the first line of csv input"));
+llvm::cl::opt<uint32_t> cl_key_col(
+    "key_col", llvm::cl::init(0),
+    llvm::cl::desc("identifier column of csv input"));
+llvm::cl::opt<uint32_t> cl_payload_col(
+    "payload_col", llvm::cl::init(1),
+    llvm::cl::desc("payload column of csv input"));
+llvm::cl::opt<uint32_t> cl_key_bytes(
+    "key_bytes", llvm::cl::init(16),
+    llvm::cl::desc("identifier bytes per record of binary input"));
 
 // Malicious Circuit PSI
 // set0     --> Party0's set
 // set1     --> Party1's set
-// val1     --> Party1's value
+// val1     --> Party1's value (< 2^64, summed in the payload field)
 // offline  --> true for Real Correlated Randomness
 // cache    --> pre-compute correlated randomness or not
-// fairness --> true for fair DY-PRF, false for DY-PRF
+// fairness --> k > 0 for fair DY-PRF (k bits per round), 0 for DY-PRF
+// net      --> WAN emulation (shared by all parties), nullptr for none
 auto mc_psi(const std::shared_ptr<yacl::link::Context> &lctx,
             absl::Span<PTy> set0, absl::Span<PTy> set1, absl::Span<PTy> val1,
-            bool CR_mode = false, bool cache = true, bool fairness = false) {
+            bool CR_mode = false, bool cache = true, uint32_t fairness = 0,
+            std::shared_ptr<NetworkModel> net = nullptr) {
   auto rank = lctx->Rank();
 
   SPDLOG_INFO("[P{}] works with {} threads", rank, yacl::get_num_threads());
@@ -119,8 +171,15 @@ auto mc_psi(const std::shared_ptr<yacl::link::Context> &lctx,
   COMM_START(setup);
   TIMER_START(setup);
   auto context = std::make_shared<Context>(lctx);
+  context->GetConnection()->SetNetworkModel(net);
   SetupContext(context, CR_mode);
+  // payloads live in the payload SPDZ instance (over PayTy)
+  SetupPayloadContext(context, CR_mode);
   auto prot = context->GetState<Protocol>();
+  auto pay_prot = context->GetState<PayloadProtocol>();
+  if (fairness) {
+    prot->SetFairBits(fairness);
+  }
   TIMER_END(setup);
   TIMER_PRINT(setup);
   COMM_END(setup);
@@ -146,32 +205,29 @@ auto mc_psi(const std::shared_ptr<yacl::link::Context> &lctx,
 
   // --- BEGIN CACHE ---
   // For your information, "cache mode" would try to pre-compute the correlated
-  // randomness for Circuit-PSI
+  // randomness for Circuit-PSI. The payload instance has no cache mode, only
+  // the (key) permutation of the joint shuffle is cached.
   if (cache) {
     std::vector<PTy> empty_set0(set0.size());
     std::vector<PTy> empty_set1(set1.size());
-    std::vector<PTy> empty_val1(val1.size());
-    // auto result_s = prot->CPSI(share0, share1, secret, true);
-    // same as CPSI with cache
-    auto secret = (rank == 1 ? prot->SetA(empty_val1, true)
-                             : prot->GetA(empty_val1.size(), true));
 
     // reveal G-share
     if (fairness) {
-      auto share0 = (rank == 0 ? prot->SetA(empty_set0, true)
-                               : prot->GetA(empty_set0.size(), true));
-      auto share1 = (rank == 1 ? prot->SetA(empty_set1, true)
-                               : prot->GetA(empty_set1.size(), true));
+      auto [scalar_a, bits] = prot->RandFairA(1, true);
+      auto share0 =
+          (rank == 0
+               ? prot->ScalarDyExpSet(scalar_a[0], empty_set0, true)
+               : prot->ScalarDyExpGet(scalar_a[0], empty_set0.size(), true));
+      auto share1 = (rank == 1 ? prot->DyExpSet(empty_set1, true)
+                               : prot->DyExpGet(empty_set1.size(), true));
       auto shuffle0 = (rank == 0 ? prot->ShuffleASet(share0, true)
                                  : prot->ShuffleAGet(share0, true));
-      auto [shuffle1, shuffle_data] =
-          (rank == 1 ? prot->ShuffleASet(share1, secret, true)
-                     : prot->ShuffleAGet(share1, secret, true));
-
-      auto [scalar_a, bits] = prot->RandFairA(1, true);
+      // repeat 2, as the joint shuffle of the keys && the payloads
+      auto shuffle1 = (rank == 1 ? prot->ShuffleASet(share1, share1, true)
+                                 : prot->ShuffleAGet(share1, share1, true))[0];
 
-      auto reveal0 = prot->ScalarDyOprf(scalar_a[0], shuffle0, true);
-      auto reveal1 = prot->DyOprf(shuffle1, true);
+      auto reveal0 = prot->A2G(shuffle0, true);
+      auto reveal1 = prot->A2G(shuffle1, true);
       auto scalar_p = prot->FairA2P(scalar_a, bits, true);
     } else {
       auto share0 = (rank == 0 ? prot->DyExpSet(empty_set0, true)
@@ -180,25 +236,12 @@ auto mc_psi(const std::shared_ptr<yacl::link::Context> &lctx,
                                : prot->DyExpGet(empty_set1.size(), true));
       auto shuffle0 = (rank == 0 ? prot->ShuffleASet(share0, true)
                                  : prot->ShuffleAGet(share0, true));
-      auto [shuffle1, shuffle_data] =
-          (rank == 1 ? prot->ShuffleASet(share1, secret, true)
-                     : prot->ShuffleAGet(share1, secret, true));
+      // repeat 2, as the joint shuffle of the keys && the payloads
+      auto shuffle1 = (rank == 1 ? prot->ShuffleASet(share1, share1, true)
+                                 : prot->ShuffleAGet(share1, share1, true))[0];
       auto reveal0 = prot->A2G(shuffle0, true);
       auto reveal1 = prot->A2G(shuffle1, true);
     }
-
-    auto s_data = prot->ZerosA(secret.size(), true);
-
-    auto indexes = std::vector<size_t>(secret.size());
-    auto result_s = prot->FilterA(absl::MakeConstSpan(s_data),
-                                  absl::MakeConstSpan(indexes), true);
-    auto sum_s = prot->SumA(result_s, true);
-    [[maybe_unused]] auto result_p = prot->A2P(sum_s, true);
-
-    // auto square_result = prot->Mul(absl::MakeConstSpan(result_s),
-    //                                absl::MakeConstSpan(result_s), true);
-    // auto sum_square_s = prot->SumA(square_result, true);
-    // [[maybe_unused]] auto sum_square_p = prot->A2P(sum_square_s, true);
     SPDLOG_INFO("[P{}] start cache all correlation", rank);
 
     // ---- MARK ----
@@ -217,18 +260,31 @@ auto mc_psi(const std::shared_ptr<yacl::link::Context> &lctx,
   COMM_START(online);
   TIMER_START(online);
   SPDLOG_INFO("[P{}] uploading data", rank);
-  auto secret = (rank == 1 ? prot->SetA(val1) : prot->GetA(val1.size()));
+  auto secret = (rank == 1 ? pay_prot->SetA(ToPayTy(val1))
+                           : pay_prot->GetA(val1.size()));
   SPDLOG_INFO("[P{}] Then, executing Circuit-PSI, set0 {} && set1 {}", rank,
               set0.size(), set1.size());
 
   // auto result_s = prot->CPSI(share0, share1, secret);
   // same as CPSI
   std::vector<size_t> indexes;
-  auto s_data = prot->ZerosA(val1.size());
+  std::vector<PayATy> s_data;
 
   if (fairness) {
-    auto share0 = (rank == 0 ? prot->SetA(set0) : prot->GetA(set0.size()));
-    auto share1 = (rank == 1 ? prot->SetA(set1) : prot->GetA(set1.size()));
+    // ----- MARK -----
+    // DyExp times and communication, party0's items are scaled by the fair
+    // scalar (ScalarDyBeaver correlations)
+    COMM_START(DyExp);
+    TIMER_START(DyExp);
+    auto [scalar_a, bits] = prot->RandFairA(1);
+    auto share0 = (rank == 0 ? prot->ScalarDyExpSet(scalar_a[0], set0)
+                             : prot->ScalarDyExpGet(scalar_a[0], set0.size()));
+    auto share1 =
+        (rank == 1 ? prot->DyExpSet(set1) : prot->DyExpGet(set1.size()));
+    TIMER_END(DyExp);
+    TIMER_PRINT(DyExp);
+    COMM_END(DyExp);
+    COMM_PRINT(DyExp);
     // ----- MARK -----
     // Shuffle times and communication
     COMM_START(shuffle);
@@ -236,8 +292,8 @@ auto mc_psi(const std::shared_ptr<yacl::link::Context> &lctx,
     auto shuffle0 =
         (rank == 0 ? prot->ShuffleASet(share0) : prot->ShuffleAGet(share0));
     auto [shuffle1, shuffle_data] =
-        (rank == 1 ? prot->ShuffleASet(share1, secret)
-                   : prot->ShuffleAGet(share1, secret));
+        (rank == 1 ? pay_prot->ShuffleASet(share1, secret)
+                   : pay_prot->ShuffleAGet(share1, secret));
     s_data = std::move(shuffle_data);
     TIMER_END(shuffle);
     TIMER_PRINT(shuffle);
@@ -246,14 +302,10 @@ auto mc_psi(const std::shared_ptr<yacl::link::Context> &lctx,
     // ---- MARK ----
     COMM_START(DyOprf);   // start
     TIMER_START(DyOprf);  // start a2g_timer
-    auto [scalar_a, bits] = prot->RandFairA(1);
-    auto reveal0 = prot->ScalarDyOprf(scalar_a[0], shuffle0);
-    auto reveal1 = prot->DyOprf(shuffle1);
+    auto reveal0 = prot->A2G(shuffle0);
+    auto reveal1 = prot->A2G(shuffle1);
     auto scalar_p = prot->FairA2P(scalar_a, bits);
-    auto scalar_mp = ym::MPInt(scalar_p[0].GetVal());
-    for (size_t i = 0; i < reveal1.size(); ++i) {
-      Ggroup->MulInplace(&reveal1[i], scalar_mp);
-    }
+    reveal1 = prot->ScalarMulPG(scalar_p[0], reveal1);
     TIMER_END(DyOprf);    // stop a2g_timer
     COMM_END(DyOprf);     // stop
     TIMER_PRINT(DyOprf);  // print info
@@ -287,8 +339,8 @@ auto mc_psi(const std::shared_ptr<yacl::link::Context> &lctx,
     auto shuffle0 =
         (rank == 0 ? prot->ShuffleASet(share0) : prot->ShuffleAGet(share0));
     auto [shuffle1, shuffle_data] =
-        (rank == 1 ? prot->ShuffleASet(share1, secret)
-                   : prot->ShuffleAGet(share1, secret));
+        (rank == 1 ? pay_prot->ShuffleASet(share1, secret)
+                   : pay_prot->ShuffleAGet(share1, secret));
     s_data = std::move(shuffle_data);
     TIMER_END(shuffle);
     TIMER_PRINT(shuffle);
@@ -314,14 +366,14 @@ auto mc_psi(const std::shared_ptr<yacl::link::Context> &lctx,
       }
     }
   }
-  auto result_s =
-      prot->FilterA(absl::MakeConstSpan(s_data), absl::MakeConstSpan(indexes));
+  auto result_s = pay_prot->FilterA(absl::MakeConstSpan(s_data),
+                                    absl::MakeConstSpan(indexes));
 
   SPDLOG_INFO("[P{}] interset size {}", rank, result_s.size());
   COMM_START(result_sum);   // start
   TIMER_START(result_sum);  // start result_sum_timer
-  auto sum_s = prot->SumA(result_s);
-  auto result_p = prot->A2P(sum_s);
+  auto sum_s = pay_prot->SumA(result_s);
+  auto result_p = pay_prot->A2P(sum_s);
   TIMER_END(result_sum);    // stop result_sum_timer
   COMM_END(result_sum);     // stop
   TIMER_PRINT(result_sum);  // print info
@@ -354,6 +406,250 @@ auto mc_psi(const std::shared_ptr<yacl::link::Context> &lctx,
   return ret;
 }
 
+// ---------- Bucket -----------
+
+// bucket index of item (should be the same for all parties)
+size_t BucketIndex(const PTy &item, size_t bucket_num) {
+  auto val = item.GetVal();
+  uint64_t limbs[4] = {
+      static_cast<uint64_t>(Uint256Low128(val)),
+      static_cast<uint64_t>(Uint256Low128(val) >> 64),
+      static_cast<uint64_t>(Uint256High128(val)),
+      static_cast<uint64_t>(Uint256High128(val) >> 64),
+  };
+  // splitmix64
+  uint64_t h = 0;
+  for (auto limb : limbs) {
+    h ^= limb;
+    h += 0x9e3779b97f4a7c15ULL;
+    h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+    h ^= (h >> 31);
+  }
+  return h % bucket_num;
+}
+
+// public capacity of each bucket, depending on set size only
+// (mean + 6 * sigma), such that the real size of each bucket is hidden
+size_t BucketCapacity(size_t num, size_t bucket_num) {
+  double mean = static_cast<double>(num) / bucket_num;
+  return static_cast<size_t>(mean + 6 * std::sqrt(mean)) + 16;
+}
+
+// hash items (and payloads) into buckets, then pad each bucket with dummies
+// (random items with zero payload)
+std::vector<std::vector<PTy>> HashToBuckets(
+    absl::Span<const PTy> set, absl::Span<const PTy> val, size_t bucket_num,
+    size_t capacity, std::vector<std::vector<PTy>> *val_buckets = nullptr) {
+  std::vector<std::vector<PTy>> set_buckets(bucket_num);
+  if (val_buckets != nullptr) {
+    YACL_ENFORCE(set.size() == val.size());
+    val_buckets->assign(bucket_num, std::vector<PTy>());
+  }
+  for (size_t i = 0; i < set.size(); ++i) {
+    auto idx = BucketIndex(set[i], bucket_num);
+    set_buckets[idx].emplace_back(set[i]);
+    if (val_buckets != nullptr) {
+      (*val_buckets)[idx].emplace_back(val[i]);
+    }
+  }
+  for (size_t b = 0; b < bucket_num; ++b) {
+    const size_t real = set_buckets[b].size();
+    YACL_ENFORCE(real <= capacity,
+                 "bucket {} overflow ({} > {}), try less buckets", b, real,
+                 capacity);
+    auto dummy = OP::Rand(capacity - real);
+    set_buckets[b].insert(set_buckets[b].end(), dummy.begin(), dummy.end());
+    if (val_buckets != nullptr) {
+      (*val_buckets)[b].resize(capacity, PTy::Zero());
+    }
+  }
+  return set_buckets;
+}
+
+// CPSI (see Protocol::CPSI && FairCPSI) with the payloads in the payload
+// instance of `ctx` (as mc_psi), return the a-shares of the matched payloads
+std::vector<PayATy> PayloadCPSI(const std::shared_ptr<Context> &ctx,
+                                absl::Span<const ATy> set0,
+                                absl::Span<const ATy> set1,
+                                absl::Span<const PayATy> data, bool fairness) {
+  auto prot = ctx->GetState<Protocol>();
+  auto pay_prot = ctx->GetState<PayloadProtocol>();
+  auto Ggroup = prot->GetGroup();
+
+  auto shuffle0 = prot->ShuffleA(set0);
+  auto [shuffle1, shuffle_data] = pay_prot->ShuffleA(set1, data);
+
+  std::vector<GTy> reveal0;
+  std::vector<GTy> reveal1;
+  if (fairness) {
+    auto [scalar_a, bits] = prot->RandFairA(1);
+    reveal0 = prot->ScalarDyOprf(scalar_a[0], shuffle0);
+    reveal1 = prot->DyOprf(shuffle1);
+    auto scalar_p = prot->FairA2P(scalar_a, bits);
+    reveal1 = prot->ScalarMulPG(scalar_p[0], reveal1);
+  } else {
+    reveal0 = prot->DyOprf(shuffle0);
+    reveal1 = prot->DyOprf(shuffle1);
+  }
+
+  auto group_hash = [&Ggroup](const GTy &val) {
+    return Ggroup->HashPoint(val);
+  };
+  auto group_equal = [&Ggroup](const GTy &lhs, const GTy &rhs) {
+    return Ggroup->PointEqual(lhs, rhs);
+  };
+  std::unordered_set<GTy, decltype(group_hash), decltype(group_equal)> lhs(
+      reveal0.begin(), reveal0.end(), 2, group_hash, group_equal);
+
+  std::vector<size_t> indexes;
+  for (size_t i = 0; i < reveal1.size(); ++i) {
+    if (lhs.count(reveal1[i])) {
+      indexes.emplace_back(i);
+    }
+  }
+  return pay_prot->FilterA(absl::MakeConstSpan(shuffle_data),
+                           absl::MakeConstSpan(indexes));
+}
+
+// Hash-bucketed Malicious Circuit PSI
+// Both parties hash their items into `bucket_num` buckets, each bucket runs an
+// independent Context/Protocol on its own spawned link && thread. All contexts
+// are sub-contexts of the main one (SetupSubContexts): a single one-time setup,
+// && the same SPDZ keys, thus the per-bucket payload sums are combined by
+// `SumA` (and opened by `A2P`) in the main context. As mc_psi, the payloads
+// live in the payload SPDZ instance (over PayTy) of each context.
+//
+// NOTE: it leaks more than mc_psi. The bucket of an item is a public hash of
+// it, && the matching of each bucket is done on its own, so both parties learn
+// the intersection size of every bucket (mc_psi reveals the total one only).
+// Hence it is gated by --bucket_leakage.
+auto mc_psi_bucket(const std::shared_ptr<yacl::link::Context> &lctx,
+                   absl::Span<PTy> set0, absl::Span<PTy> set1,
+                   absl::Span<PTy> val1, bool CR_mode = false,
+                   bool cache = true, uint32_t fairness = 0,
+                   size_t bucket_num = 1,
+                   std::shared_ptr<NetworkModel> net = nullptr) {
+  auto rank = lctx->Rank();
+  SPDLOG_INFO("[P{}] works with {} buckets && {} threads", rank, bucket_num,
+              yacl::get_num_threads());
+
+  // ---- MARK ----
+  COMM_START(setup);
+  TIMER_START(setup);
+  auto context = std::make_shared<Context>(lctx);
+  context->GetConnection()->SetNetworkModel(net);
+  SetupContext(context, CR_mode);
+  SetupPayloadContext(context, CR_mode);
+  auto pay_prot = context->GetState<PayloadProtocol>();
+
+  // spawn links in the same order for all parties
+  std::vector<std::shared_ptr<Context>> bucket_ctxs(bucket_num);
+  for (size_t b = 0; b < bucket_num; ++b) {
+    bucket_ctxs[b] = std::make_shared<Context>(lctx->Spawn());
+    bucket_ctxs[b]->GetConnection()->SetNetworkModel(net);
+  }
+  SetupSubContexts(context, bucket_ctxs);
+  SetupPayloadSubContexts(context, bucket_ctxs, CR_mode);
+  if (fairness) {
+    for (auto &bctx : bucket_ctxs) {
+      bctx->GetState<Protocol>()->SetFairBits(fairness);
+    }
+  }
+  TIMER_END(setup);
+  TIMER_PRINT(setup);
+  COMM_END(setup);
+  COMM_PRINT(setup);
+
+  const size_t cap0 = BucketCapacity(set0.size(), bucket_num);
+  const size_t cap1 = BucketCapacity(set1.size(), bucket_num);
+  std::vector<std::vector<PTy>> set0_buckets;
+  std::vector<std::vector<PTy>> set1_buckets;
+  std::vector<std::vector<PTy>> val1_buckets;
+  if (rank == 0) {
+    set0_buckets = HashToBuckets(set0, {}, bucket_num, cap0);
+  } else {
+    set1_buckets = HashToBuckets(set1, val1, bucket_num, cap1, &val1_buckets);
+  }
+
+  // per-bucket Circuit-PSI, return the (a-share) payload sum
+  auto bucket_psi = [&](size_t b) {
+    auto &bctx = bucket_ctxs[b];
+    auto bprot = bctx->GetState<Protocol>();
+    auto bpay_prot = bctx->GetState<PayloadProtocol>();
+    if (cache) {
+      // the keys only, the payload instance has no cache mode (see mc_psi)
+      std::vector<PTy> empty0(cap0);
+      std::vector<PTy> empty1(cap1);
+      auto share0 = (rank == 0 ? bprot->SetA(empty0, true)
+                               : bprot->GetA(cap0, true));
+      auto share1 = (rank == 1 ? bprot->SetA(empty1, true)
+                               : bprot->GetA(cap1, true));
+      auto shuffle0 = bprot->ShuffleA(share0, true);
+      // repeat 2, as the joint shuffle of the keys && the payloads
+      auto shuffle1 = bprot->ShuffleA(share1, share1, true)[0];
+      if (fairness) {
+        auto [scalar_a, bits] = bprot->RandFairA(1, true);
+        bprot->ScalarDyOprf(scalar_a[0], shuffle0, true);
+        bprot->DyOprf(shuffle1, true);
+        bprot->FairA2P(scalar_a, bits, true);
+      } else {
+        bprot->DyOprf(shuffle0, true);
+        bprot->DyOprf(shuffle1, true);
+      }
+      bctx->GetState<Correlation>()->force_cache();
+    }
+    auto share0 = (rank == 0 ? bprot->SetA(set0_buckets[b])
+                             : bprot->GetA(cap0));
+    auto share1 = (rank == 1 ? bprot->SetA(set1_buckets[b])
+                             : bprot->GetA(cap1));
+    auto secret = (rank == 1 ? bpay_prot->SetA(ToPayTy(val1_buckets[b]))
+                             : bpay_prot->GetA(cap1));
+    auto result = PayloadCPSI(bctx, share0, share1, secret, fairness);
+    return std::make_pair(bpay_prot->SumA(result)[0], result.size());
+  };
+
+  // --- MARK
+  COMM_START(online);
+  TIMER_START(online);
+  std::vector<std::future<std::pair<PayATy, size_t>>> tasks;
+  for (size_t b = 0; b < bucket_num; ++b) {
+    tasks.emplace_back(std::async(std::launch::async, bucket_psi, b));
+  }
+  std::vector<PayATy> bucket_sums(bucket_num);
+  size_t interset_size = 0;
+  for (size_t b = 0; b < bucket_num; ++b) {
+    auto [sum, size] = tasks[b].get();
+    bucket_sums[b] = sum;
+    interset_size += size;
+  }
+  SPDLOG_INFO("[P{}] interset size {}", rank, interset_size);
+
+  auto sum_s = pay_prot->SumA(bucket_sums);
+  auto result_p = pay_prot->A2P(sum_s);
+
+  typedef decltype(std::declval<internal::PTy>().GetVal()) INTEGER;
+  auto ret = std::vector<INTEGER>(2);
+  ret[0] = result_p[0].GetVal();
+  SPDLOG_INFO("[P{}] sum is {}", rank, ret[0]);
+  TIMER_END(online);
+  TIMER_PRINT(online);
+  COMM_END(online);
+  COMM_PRINT(online);
+  return ret;
+}
+
+auto run_psi(const std::shared_ptr<yacl::link::Context> &lctx,
+             absl::Span<PTy> set0, absl::Span<PTy> set1, absl::Span<PTy> val1,
+             bool CR_mode, bool cache, uint32_t fairness, size_t bucket_num,
+             std::shared_ptr<NetworkModel> net = nullptr) {
+  if (bucket_num > 1) {
+    return mc_psi_bucket(lctx, set0, set1, val1, CR_mode, cache, fairness,
+                         bucket_num, net);
+  }
+  return mc_psi(lctx, set0, set1, val1, CR_mode, cache, fairness, net);
+}
+
 struct ArgPack {
   uint32_t size0;
   uint32_t size1;
@@ -361,12 +657,14 @@ struct ArgPack {
   uint32_t CR_mode;
   uint32_t cache;
   uint32_t fairness;
+  uint32_t bucket;
   uint128_t seed;
 
   bool operator==(const ArgPack &other) const {
     return (size0 == other.size0) && (size1 == other.size1) &&
            (interset_size == other.interset_size) &&
-           (CR_mode == other.CR_mode) && (cache == other.cache);
+           (CR_mode == other.CR_mode) && (cache == other.cache) &&
+           (bucket == other.bucket);
   }
 
   bool operator!=(const ArgPack &other) const { return !(*this == other); }
@@ -374,10 +672,11 @@ struct ArgPack {
 
 bool SyncTask(const std::shared_ptr<yacl::link::Context> &lctx, uint32_t size0,
               uint32_t size1, uint32_t interset_size, uint32_t CR_mode,
-              uint32_t cache, uint32_t fairness, uint128_t &seed) {
+              uint32_t cache, uint32_t fairness, uint32_t bucket,
+              uint128_t &seed) {
   uint128_t tmp_seed = yacl::crypto::SecureRandU128();
   ArgPack tmp = {size0, size1,    interset_size, CR_mode,
-                 cache, fairness, tmp_seed};
+                 cache, fairness, bucket,        tmp_seed};
   auto bv = yacl::ByteContainerView(&tmp, sizeof(tmp));
 
   ArgPack remote;
@@ -400,6 +699,36 @@ bool SyncTask(const std::shared_ptr<yacl::link::Context> &lctx, uint32_t size0,
   return true;
 }
 
+uint64_t ExchangeSize(const std::shared_ptr<yacl::link::Context> &lctx,
+                      uint64_t size) {
+  lctx->SendAsync(lctx->NextRank(),
+                  yacl::ByteContainerView(&size, sizeof(size)), "Size");
+  auto buf = lctx->Recv(lctx->NextRank(), "Size");
+  YACL_ENFORCE(buf.size() == sizeof(uint64_t));
+  uint64_t ret = 0;
+  memcpy(&ret, buf.data(), sizeof(ret));
+  return ret;
+}
+
+// load && hash the input file, identifiers are hashed into PTy
+InputTable LoadTable(size_t rank) {
+  InputOptions options;
+  options.binary = cl_binary.getValue();
+  options.key_bytes = cl_key_bytes.getValue();
+  options.payload = cl_payload.getValue();
+  options.key_col = cl_key_col.getValue();
+  options.payload_col = cl_payload_col.getValue();
+  options.header = cl_header.getValue();
+
+  TIMER_START(load);
+  auto table = LoadInput(cl_input.getValue(), options);
+  TIMER_END(load);
+  TIMER_PRINT(load);
+  SPDLOG_INFO("[P{}] load {} rows from {}", rank, table.keys.size(),
+              cl_input.getValue());
+  return table;
+}
+
 std::shared_ptr<yacl::link::Context> MakeLink(const std::string &parties,
                                               size_t rank) {
   yacl::link::ContextDesc lctx_desc;
@@ -418,15 +747,23 @@ std::shared_ptr<yacl::link::Context> MakeLink(const std::string &parties,
 int main(int argc, char **argv) {
   llvm::cl::ParseCommandLineOptions(argc, argv);
 
-  bool mem_mode = cl_mode.getValue() == 0;
+  bool mem_mode = cl_mode.getValue() == 0 || cl_mode.getValue() == 2;
+  bool wan_mode = cl_mode.getValue() == 2;
   bool CR_mode = cl_CR.getValue();
   bool cache = cl_cache.getValue();
-  bool fairness = cl_fairness.getValue();
+  uint32_t fairness = cl_fairness.getValue();
 
   size_t size0 = cl_size0.getValue();
   size_t size1 = cl_size1.getValue();
   size_t interset_size = cl_interset_size.getValue();
   size_t thread = cl_thread.getValue();
+  size_t bucket = std::max<uint32_t>(cl_bucket.getValue(), 1);
+  YACL_ENFORCE(bucket == 1 || cl_bucket_leakage.getValue() != 0,
+               "--bucket > 1 reveals the intersection size of every bucket, "
+               "set --bucket_leakage=1 to accept it");
+  // the yacl OT extension (CR=1) talks on raw links, out of the emulation
+  YACL_ENFORCE(!wan_mode || !CR_mode,
+               "--mode=2 can't emulate the OT extension of --CR=1");
 
   yacl::set_num_threads(thread);
 
@@ -456,14 +793,29 @@ int main(int argc, char **argv) {
     memcpy(key0.data(), interset.data(), interset.size() * sizeof(PTy));
     memcpy(key1.data(), interset.data(), interset.size() * sizeof(PTy));
 
+    std::shared_ptr<NetworkModel> net = nullptr;
+    if (wan_mode) {
+      NetworkConfig config;
+      config.latency_ms = cl_latency.getValue();
+      config.bandwidth_mbps = cl_bandwidth.getValue();
+      config.jitter_ms = cl_jitter.getValue();
+      net = std::make_shared<NetworkModel>(config, 2);
+      std::cout << "WAN emulation --> latency " << config.latency_ms
+                << " ms && bandwidth " << config.bandwidth_mbps
+                << " Mbps && jitter " << config.jitter_ms << " ms"
+                << std::endl;
+    }
+
     auto lctxs = SetupWorld(2);
     auto task0 = std::async([&] {
-      return mc_psi(lctxs[0], absl::MakeSpan(key0), absl::MakeSpan(key1),
-                    absl::MakeSpan(data), CR_mode, cache, fairness);
+      return run_psi(lctxs[0], absl::MakeSpan(key0), absl::MakeSpan(key1),
+                     absl::MakeSpan(data), CR_mode, cache, fairness, bucket,
+                     net);
     });
     auto task1 = std::async([&] {
-      return mc_psi(lctxs[1], absl::MakeSpan(key0), absl::MakeSpan(key1),
-                    absl::MakeSpan(data), CR_mode, cache, fairness);
+      return run_psi(lctxs[1], absl::MakeSpan(key0), absl::MakeSpan(key1),
+                     absl::MakeSpan(data), CR_mode, cache, fairness, bucket,
+                     net);
     });
     auto result0 = task0.get();
     auto result1 = task1.get();
@@ -471,26 +823,48 @@ int main(int argc, char **argv) {
     std::cout << "P1 result (sum): " << result1[0] << std::endl;
   } else {
     auto lctx = MakeLink(cl_parties.getValue(), cl_rank.getValue());
+    const size_t rank = lctx->Rank();
+    InputTable table;
+    if (!cl_input.getValue().empty()) {
+      // the sizes come from the inputs
+      table = LoadTable(rank);
+      uint64_t self_size = table.keys.size();
+      uint64_t peer_size = ExchangeSize(lctx, self_size);
+      size0 = rank == 0 ? self_size : peer_size;
+      size1 = rank == 1 ? self_size : peer_size;
+      interset_size = 0;
+    }
     uint128_t seed = 0;
     YACL_ENFORCE(SyncTask(lctx, size0, size1, interset_size, CR_mode, cache,
-                          fairness, seed));
-    auto interset = OP::Rand(seed, interset_size);
-    auto key0 = OP::Rand(size0);
-    auto key1 = OP::Rand(size1);
-    auto data = OP::Ones(size1);
-
-    std::random_device rd;
-    std::mt19937 g(rd());
-    if (lctx->Rank() == 0) {
-      memcpy(key0.data(), interset.data(), interset.size() * sizeof(PTy));
-      std::shuffle(key0.begin(), key0.end(), g);
+                          fairness, bucket, seed));
+    std::vector<PTy> key0;
+    std::vector<PTy> key1;
+    std::vector<PTy> data;
+    if (!cl_input.getValue().empty()) {
+      // no copy, the peer's set is only used for its size
+      key0 = rank == 0 ? std::move(table.keys) : std::vector<PTy>(size0);
+      key1 = rank == 1 ? std::move(table.keys) : std::vector<PTy>(size1);
+      data = rank == 1 && !table.payloads.empty() ? std::move(table.payloads)
+                                                  : OP::Ones(size1);
     } else {
-      memcpy(key1.data(), interset.data(), interset.size() * sizeof(PTy));
-      std::shuffle(key1.begin(), key1.end(), g);
+      auto interset = OP::Rand(seed, interset_size);
+      key0 = OP::Rand(size0);
+      key1 = OP::Rand(size1);
+      data = OP::Ones(size1);
+
+      std::random_device rd;
+      std::mt19937 g(rd());
+      if (rank == 0) {
+        memcpy(key0.data(), interset.data(), interset.size() * sizeof(PTy));
+        std::shuffle(key0.begin(), key0.end(), g);
+      } else {
+        memcpy(key1.data(), interset.data(), interset.size() * sizeof(PTy));
+        std::shuffle(key1.begin(), key1.end(), g);
+      }
     }
 
-    auto res = mc_psi(lctx, absl::MakeSpan(key0), absl::MakeSpan(key1),
-                      absl::MakeSpan(data), CR_mode, cache, fairness);
+    auto res = run_psi(lctx, absl::MakeSpan(key0), absl::MakeSpan(key1),
+                       absl::MakeSpan(data), CR_mode, cache, fairness, bucket);
     std::cout << "P" << cl_rank.getValue() << " result (sum): " << res[0]
               << std::endl;
   }
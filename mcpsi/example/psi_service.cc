@@ -0,0 +1,477 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <thread>
+#include <unordered_set>
+
+#include "absl/strings/str_split.h"
+#include "llvm/Support/CommandLine.h"
+#include "mcpsi/context/register.h"
+#include "mcpsi/cr/utils/snapshot.h"
+#include "mcpsi/ss/payload.h"
+#include "mcpsi/ss/protocol.h"
+#include "mcpsi/utils/stream.h"
+#include "mcpsi/utils/test_util.h"
+#include "mcpsi/utils/vec_op.h"
+#include "yacl/crypto/base/hash/hash_utils.h"
+#include "yacl/crypto/utils/rand.h"
+#include "yacl/link/link.h"
+#include "yacl/utils/parallel.h"
+
+using namespace mcpsi;
+
+// -------- MACRO ---------
+
+#define TIMER_START(name) \
+  auto name##_begin = std::chrono::high_resolution_clock::now();
+
+#define TIMER_END(name) \
+  auto name##_end = std::chrono::high_resolution_clock::now();
+
+#define TIMER_PRINT(name)                                                  \
+  auto name##_elapse = name##_end - name##_begin;                          \
+  double name##_ms =                                                       \
+      std::chrono::duration_cast<std::chrono::milliseconds>(name##_elapse) \
+          .count();                                                        \
+  SPDLOG_INFO("[P{}] (TIMER) {} need {} ms (or {} s)", rank,               \
+              std::string(#name), name##_ms, name##_ms / 1000);
+
+// ---------- CL -----------
+
+llvm::cl::opt<std::string> cl_parties(
+    "parties", llvm::cl::init("127.0.0.1:39530,127.0.0.1:39531"),
+    llvm::cl::desc("server list, format: host1:port1[,host2:port2, ...]"));
+llvm::cl::opt<uint32_t> cl_rank("rank", llvm::cl::init(0),
+                                llvm::cl::desc("self rank"));
+llvm::cl::opt<uint32_t> cl_CR(
+    "CR", llvm::cl::init(0),
+    llvm::cl::desc("0 for prg-based correlated randomness, 1 for real "
+                   "correlated randomness"));
+llvm::cl::opt<uint32_t> cl_mode(
+    "mode", llvm::cl::init(0),
+    llvm::cl::desc("0 for memory mode, 1 for socket mode"));
+llvm::cl::opt<std::string> cl_queue(
+    "queue", llvm::cl::init("/tmp/mcpsi_jobs"),
+    llvm::cl::desc("job queue, a text file appended by local clients, one "
+                   "job per line: <job_id> <set file> [<payload file>], "
+                   "\"quit\" stops the service, socket mode only"));
+llvm::cl::opt<std::string> cl_output(
+    "output", llvm::cl::init("/tmp/mcpsi_results"),
+    llvm::cl::desc("results are appended to it, one job per line: <job_id> "
+                   "<sum> (or \"error\"), socket mode only"));
+llvm::cl::opt<uint32_t> cl_poll("poll", llvm::cl::init(100),
+                                llvm::cl::desc("queue polling interval (ms)"));
+llvm::cl::opt<uint32_t> cl_epoch_jobs(
+    "epoch_jobs", llvm::cl::init(30),
+    llvm::cl::desc("rotate the DY-PRF key after so many jobs"));
+llvm::cl::opt<uint64_t> cl_epoch_age(
+    "epoch_age", llvm::cl::init(24 * 3600),
+    llvm::cl::desc("rotate the DY-PRF key after so many seconds"));
+llvm::cl::opt<std::string> cl_snapshot(
+    "snapshot", llvm::cl::init(""),
+    llvm::cl::desc("warm-start snapshot directory, empty to disable, CR=1 && "
+                   "socket mode only"));
+llvm::cl::opt<std::string> cl_snapshot_secret(
+    "snapshot_secret", llvm::cl::init(""),
+    llvm::cl::desc("file of the local snapshot secret (created if missing), "
+                   "needed with --snapshot, neither inside of nor next to "
+                   "it"));
+llvm::cl::opt<uint32_t> cl_jobs(
+    "jobs", llvm::cl::init(3),
+    llvm::cl::desc("the number of (random) jobs, memory mode only"));
+llvm::cl::opt<uint32_t> cl_size0("set0", llvm::cl::init(100000),
+                                 llvm::cl::desc("the size of set0"));
+llvm::cl::opt<uint32_t> cl_size1("set1", llvm::cl::init(100000),
+                                 llvm::cl::desc("the size of set1"));
+llvm::cl::opt<uint32_t> cl_interset_size(
+    "interset", llvm::cl::init(1000),
+    llvm::cl::desc("the size of intersection"));
+llvm::cl::opt<uint32_t> cl_thread("thread", llvm::cl::init(1),
+                                  llvm::cl::desc("the number of threads"));
+
+namespace {
+
+uint64_t Now() {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// 128-bit local secret in `path`, a fresh one is created if missing. It is
+// kept away from the snapshot (neither inside of nor next to it), so that a
+// copy of the snapshot directory (or of its parent) can't unseal it.
+uint128_t LoadSecret(const std::string &path, const std::string &snapshot_dir) {
+  namespace fs = std::filesystem;
+  YACL_ENFORCE(!path.empty(), "--snapshot_secret is needed");
+  auto file = fs::weakly_canonical(path);
+  auto dir = fs::weakly_canonical(snapshot_dir);
+  if (dir.filename().empty()) {
+    dir = dir.parent_path();
+  }
+  auto parent = dir.parent_path();
+  YACL_ENFORCE(std::mismatch(dir.begin(), dir.end(), file.begin(), file.end())
+                       .first != dir.end(),
+               "--snapshot_secret {} is inside of --snapshot {}", path,
+               snapshot_dir);
+  YACL_ENFORCE(file.parent_path() != parent,
+               "--snapshot_secret {} is next to --snapshot {}", path,
+               snapshot_dir);
+  if (fs::exists(file)) {
+    ChunkReader<uint128_t> reader(file.string());
+    YACL_ENFORCE(reader.Size() == 1, "broken secret {}", path);
+    return reader.Next(1)[0];
+  }
+  uint128_t secret = yacl::crypto::SecureRandU128();
+  ChunkWriter<uint128_t> writer(file.string());
+  writer.Write(absl::MakeConstSpan(&secret, 1));
+  writer.Close();
+  fs::permissions(file, fs::perms::owner_read | fs::perms::owner_write);
+  return secret;
+}
+
+// 256-bit records, reduced mod p (a non-canonical record would never match
+// its canonical twin)
+std::vector<PTy> LoadSet(const std::string &path) {
+  ChunkReader<uint256_t> reader(path);
+  auto raw = reader.Next(reader.Size());
+  std::vector<PTy> ret(raw.size());
+  yacl::parallel_for(0, raw.size(), 4096, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      ret[i] = PTy(raw[i]);
+    }
+  });
+  return ret;
+}
+
+// stable across builds (unlike std::hash), both parties compare it
+uint64_t JobHash(const std::string &id) {
+  auto digest = yacl::crypto::Sm3(id);
+  uint64_t ret = 0;
+  memcpy(&ret, digest.data(), sizeof(ret));
+  return ret;
+}
+
+struct Job {
+  std::string id;
+  std::vector<PTy> set;
+  // party1 only (< 2^64, in the payload field), all-one if empty
+  std::vector<PayTy> val;
+};
+
+// Text file appended by local clients, read line by line. A line is taken
+// only once it is complete (ends with '\n').
+class JobQueue {
+ public:
+  JobQueue(const std::string &path, uint32_t poll_ms)
+      : path_(path), poll_ms_(poll_ms) {}
+
+  // block until the next (non-empty) line
+  std::string Next() {
+    while (true) {
+      std::ifstream in(path_);
+      if (in) {
+        in.seekg(offset_);
+        std::string line;
+        while (std::getline(in, line) && !in.eof()) {
+          offset_ = in.tellg();
+          if (!line.empty()) {
+            return line;
+          }
+        }
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(poll_ms_));
+    }
+  }
+
+ private:
+  std::string path_;
+  uint32_t poll_ms_;
+  std::streamoff offset_{0};
+};
+
+// parse "<job_id> <set file> [<payload file>]" and load the files, return
+// false if the line or the files are broken
+bool ParseJob(const std::string &line, size_t rank, Job &job) {
+  std::vector<std::string> fields =
+      absl::StrSplit(line, ' ', absl::SkipWhitespace());
+  if (fields.size() < 2 || fields.size() > 3) {
+    SPDLOG_ERROR("[P{}] broken job line: {}", rank, line);
+    return false;
+  }
+  job.id = fields[0];
+  try {
+    job.set = LoadSet(fields[1]);
+    if (rank == 1 && fields.size() == 3) {
+      job.val = ToPayTy(LoadSet(fields[2]));
+      YACL_ENFORCE(job.val.size() == job.set.size(),
+                   "payload size mismatch");
+    }
+  } catch (const std::exception &e) {
+    SPDLOG_ERROR("[P{}] job {}: {}", rank, job.id, e.what());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+// Long-running Malicious Circuit PSI service (sum of payloads in intersection)
+//
+// The context (SPDZ key, OT && VOLE adapters) is set up once, then jobs are
+// taken one after another. Each job runs the (non-fair) circuit PSI of
+// mc_psi.cc on the same context. NOTE: correlations are still generated per
+// job (on demand), there is no pool shared across jobs.
+//
+// Key epoch: the DY-PRF key is rotated after `epoch_jobs` jobs or
+// `epoch_age` seconds, since a reused key makes the revealed OPRF values
+// linkable across jobs. Rotation only rebuilds the DY-key VOLE adapters
+// (see RotateDyKey), the SPDZ key and the other adapters are kept.
+//
+// Warm start: with a snapshot, a restarted service loads the keys && the
+// base OTs / base VOLEs of the last run instead of the one-time setup. The
+// snapshot is sealed again on every key rotation. The DY-PRF key of the last
+// run is rotated before the first job, since its epoch is lost.
+class PsiService {
+ public:
+  PsiService(const std::shared_ptr<yacl::link::Context> &lctx, bool CR_mode,
+             uint32_t epoch_jobs, uint64_t epoch_age,
+             SetupSnapshot *snapshot = nullptr)
+      : rank_(lctx->Rank()),
+        epoch_jobs_(epoch_jobs),
+        epoch_age_(epoch_age),
+        snapshot_(snapshot),
+        context_(std::make_shared<Context>(lctx)) {
+    auto rank = rank_;
+    TIMER_START(setup);
+    if (snapshot_ != nullptr) {
+      YACL_ENFORCE(CR_mode, "warm start needs real correlated randomness");
+      SetupContext(context_, *snapshot_);
+      // the epoch of a warm-started DY-PRF key (jobs && age) is unknown,
+      // rotate it before the first job
+      stale_key_ = true;
+    } else {
+      SetupContext(context_, CR_mode);
+    }
+    // payloads live in the payload SPDZ instance (over PayTy)
+    SetupPayloadContext(context_, CR_mode);
+    epoch_begin_ = Now();
+    TIMER_END(setup);
+    TIMER_PRINT(setup);
+  }
+
+  // both parties should call it with the same job (id), return the sum
+  uint256_t Run(const Job &job) {
+    auto rank = rank_;
+    auto conn = context_->GetConnection();
+    auto prot = context_->GetState<Protocol>();
+    auto pay_prot = context_->GetState<PayloadProtocol>();
+
+    // ---- 0. agreement && key epoch ----
+    uint64_t job_hash = JobHash(job.id);
+    YACL_ENFORCE(conn->Exchange(job_hash) == job_hash,
+                 "job id mismatch, self is {}", job.id);
+    uint64_t rotate = stale_key_ || epoch_runs_ >= epoch_jobs_ ||
+                      Now() >= epoch_begin_ + epoch_age_;
+    rotate |= conn->Exchange(rotate);
+    if (rotate) {
+      TIMER_START(rotate);
+      RotateDyKey(context_);
+      if (snapshot_ != nullptr) {
+        SaveSnapshot();
+      }
+      stale_key_ = false;
+      epoch_runs_ = 0;
+      epoch_begin_ = Now();
+      TIMER_END(rotate);
+      TIMER_PRINT(rotate);
+    }
+
+    // ---- 1. circuit psi ----
+    TIMER_START(job);
+    auto Ggroup = prot->GetGroup();
+    auto group_hash = [&Ggroup](const GTy &val) {
+      return Ggroup->HashPoint(val);
+    };
+    auto group_equal = [&Ggroup](const GTy &lhs, const GTy &rhs) {
+      return Ggroup->PointEqual(lhs, rhs);
+    };
+
+    uint64_t self_size = job.set.size();
+    uint64_t peer_size = conn->Exchange(self_size);
+    size_t size0 = rank == 0 ? self_size : peer_size;
+    size_t size1 = rank == 1 ? self_size : peer_size;
+
+    auto val = job.val.empty() ? std::vector<PayTy>(size1, PayTy::One())
+                               : job.val;
+    auto secret = (rank == 1 ? pay_prot->SetA(val) : pay_prot->GetA(size1));
+    auto share0 =
+        (rank == 0 ? prot->DyExpSet(job.set) : prot->DyExpGet(size0));
+    auto share1 =
+        (rank == 1 ? prot->DyExpSet(job.set) : prot->DyExpGet(size1));
+    auto shuffle0 =
+        (rank == 0 ? prot->ShuffleASet(share0) : prot->ShuffleAGet(share0));
+    auto [shuffle1, shuffle_secret] =
+        (rank == 1 ? pay_prot->ShuffleASet(share1, secret)
+                   : pay_prot->ShuffleAGet(share1, secret));
+    auto reveal0 = prot->A2G(shuffle0);
+    auto reveal1 = prot->A2G(shuffle1);
+
+    std::unordered_set<GTy, decltype(group_hash), decltype(group_equal)> lhs(
+        reveal0.begin(), reveal0.end(), 2, group_hash, group_equal);
+    std::vector<size_t> indexes;
+    for (size_t i = 0; i < reveal1.size(); ++i) {
+      if (lhs.count(reveal1[i])) {
+        indexes.emplace_back(i);
+      }
+    }
+    auto selected = pay_prot->FilterA(shuffle_secret, indexes);
+    auto result_p = pay_prot->A2P(pay_prot->SumA(selected));
+    TIMER_END(job);
+    TIMER_PRINT(job);
+
+    ++epoch_runs_;
+    SPDLOG_INFO("[P{}] job {}: interset size {}, sum is {}", rank, job.id,
+                indexes.size(), result_p[0].GetVal());
+    return result_p[0].GetVal();
+  }
+
+  // take jobs from `queue` until "quit", append results into `output`
+  void Serve(JobQueue &queue, const std::string &output) {
+    auto conn = context_->GetConnection();
+    std::ofstream out(output, std::ios::app);
+    YACL_ENFORCE(out.is_open(), "can not open {}", output);
+    while (true) {
+      auto line = queue.Next();
+      uint64_t quit = (line == "quit");
+      if (conn->Exchange(quit) != quit) {
+        SPDLOG_WARN("[P{}] peer {} the service", rank_,
+                    quit ? "continues" : "stops");
+        quit = 1;
+      }
+      if (quit) {
+        break;
+      }
+
+      Job job;
+      uint64_t ok = ParseJob(line, rank_, job);
+      // the queues went out of step, fail the job rather than the service
+      uint64_t job_hash = JobHash(job.id);
+      if (conn->Exchange(job_hash) != job_hash) {
+        SPDLOG_ERROR("[P{}] job id mismatch, self is {}", rank_, job.id);
+        ok = 0;
+      }
+      ok &= conn->Exchange(ok);
+      if (!ok) {
+        // the job id may be unknown, skip the line on both sides
+        out << (job.id.empty() ? line : job.id) << " error" << std::endl;
+        continue;
+      }
+      auto sum = Run(job);
+      out << job.id << " " << sum << std::endl;
+    }
+  }
+
+ private:
+  // seal the current keys (&& fresh base OTs / VOLEs), the older snapshot
+  // can't be loaded anymore
+  void SaveSnapshot() {
+    auto true_cr = std::dynamic_pointer_cast<TrueCorrelation>(
+        context_->GetState<Correlation>());
+    true_cr->SaveSnapshot(*snapshot_);
+  }
+
+  size_t rank_;
+  uint32_t epoch_jobs_;
+  uint64_t epoch_age_;
+  SetupSnapshot *snapshot_;
+  std::shared_ptr<Context> context_;
+  // current key epoch
+  uint32_t epoch_runs_{0};
+  uint64_t epoch_begin_{0};
+  bool stale_key_{false};
+};
+
+std::shared_ptr<yacl::link::Context> MakeLink(const std::string &parties,
+                                              size_t rank) {
+  yacl::link::ContextDesc lctx_desc;
+  std::vector<std::string> hosts = absl::StrSplit(parties, ',');
+  for (size_t rank = 0; rank < hosts.size(); rank++) {
+    const auto id = fmt::format("party{}", rank);
+    lctx_desc.parties.emplace_back(id, hosts[rank]);
+  }
+  lctx_desc.throttle_window_size = 0;
+  // jobs may be far apart
+  lctx_desc.recv_timeout_ms = 24 * 3600 * 1000;
+  lctx_desc.http_timeout_ms = 120 * 1000;  // 2 min
+  auto lctx = yacl::link::FactoryBrpc().CreateContext(lctx_desc, rank);
+  lctx->ConnectToMesh();
+  return lctx;
+}
+
+int main(int argc, char **argv) {
+  llvm::cl::ParseCommandLineOptions(argc, argv);
+
+  bool mem_mode = cl_mode.getValue() == 0;
+  bool CR_mode = cl_CR.getValue();
+  uint32_t epoch_jobs = cl_epoch_jobs.getValue();
+  uint64_t epoch_age = cl_epoch_age.getValue();
+
+  yacl::set_num_threads(cl_thread.getValue());
+
+  if (mem_mode == true) {
+    // random jobs on a single (in-memory) service pair
+    size_t size0 = cl_size0.getValue();
+    size_t size1 = cl_size1.getValue();
+    size_t interset_size =
+        std::min<size_t>(cl_interset_size.getValue(), std::min(size0, size1));
+
+    auto lctxs = SetupWorld(2);
+    auto service0 = std::async([&] {
+      return std::make_unique<PsiService>(lctxs[0], CR_mode, epoch_jobs,
+                                          epoch_age);
+    });
+    auto service1 = std::async([&] {
+      return std::make_unique<PsiService>(lctxs[1], CR_mode, epoch_jobs,
+                                          epoch_age);
+    });
+    auto s0 = service0.get();
+    auto s1 = service1.get();
+
+    for (size_t i = 0; i < cl_jobs.getValue(); ++i) {
+      Job job0;
+      Job job1;
+      job0.id = job1.id = fmt::format("job{}", i);
+      job0.set = OP::Rand(size0);
+      job1.set = OP::Rand(size1);
+      for (size_t j = 0; j < interset_size; ++j) {
+        job1.set[j] = job0.set[j];
+      }
+      auto task0 = std::async([&] { return s0->Run(job0); });
+      auto task1 = std::async([&] { return s1->Run(job1); });
+      auto result0 = task0.get();
+      auto result1 = task1.get();
+      std::cout << job0.id << " P0 result (sum): " << result0 << std::endl;
+      std::cout << job1.id << " P1 result (sum): " << result1 << std::endl;
+    }
+  } else {
+    auto lctx = MakeLink(cl_parties.getValue(), cl_rank.getValue());
+    std::unique_ptr<SetupSnapshot> snapshot = nullptr;
+    if (!cl_snapshot.getValue().empty()) {
+      // the never-reuse counter lives next to the secret
+      snapshot = std::make_unique<SetupSnapshot>(
+          cl_snapshot.getValue(), lctx->Rank(),
+          LoadSecret(cl_snapshot_secret.getValue(), cl_snapshot.getValue()),
+          fmt::format("{}.p{}.counter", cl_snapshot_secret.getValue(),
+                      lctx->Rank()));
+    }
+    PsiService service(lctx, CR_mode, epoch_jobs, epoch_age, snapshot.get());
+    JobQueue queue(cl_queue.getValue(), cl_poll.getValue());
+    service.Serve(queue, cl_output.getValue());
+  }
+
+  return 0;
+}
@@ -0,0 +1,478 @@
+#include <array>
+#include <chrono>
+#include <future>
+#include <random>
+
+#include "llvm/Support/CommandLine.h"
+#include "mcpsi/context/register.h"
+#include "mcpsi/ss/protocol.h"
+#include "mcpsi/utils/stream.h"
+#include "mcpsi/utils/test_util.h"
+#include "mcpsi/utils/vec_op.h"
+#include "yacl/crypto/base/hash/hash_utils.h"
+#include "yacl/crypto/tools/prg.h"
+#include "yacl/crypto/utils/rand.h"
+#include "yacl/link/link.h"
+#include "yacl/utils/parallel.h"
+
+using namespace mcpsi;
+
+// -------- MACRO ---------
+
+#define TIMER_START(name) \
+  auto name##_begin = std::chrono::high_resolution_clock::now();
+
+#define TIMER_END(name) \
+  auto name##_end = std::chrono::high_resolution_clock::now();
+
+#define TIMER_PRINT(name)                                                  \
+  auto name##_elapse = name##_end - name##_begin;                          \
+  double name##_ms =                                                       \
+      std::chrono::duration_cast<std::chrono::milliseconds>(name##_elapse) \
+          .count();                                                        \
+  SPDLOG_INFO("[P{}] (TIMER) {} need {} ms (or {} s)", rank,               \
+              std::string(#name), name##_ms, name##_ms / 1000);
+
+// ---------- CL -----------
+
+llvm::cl::opt<std::string> cl_parties(
+    "parties", llvm::cl::init("127.0.0.1:39530,127.0.0.1:39531"),
+    llvm::cl::desc("server list, format: host1:port1[,host2:port2, ...]"));
+llvm::cl::opt<uint32_t> cl_rank("rank", llvm::cl::init(0),
+                                llvm::cl::desc("self rank"));
+llvm::cl::opt<uint32_t> cl_CR(
+    "CR", llvm::cl::init(0),
+    llvm::cl::desc("0 for prg-based correlated randomness, 1 for real "
+                   "correlated randomness"));
+llvm::cl::opt<uint32_t> cl_mode(
+    "mode", llvm::cl::init(0),
+    llvm::cl::desc("0 for memory mode, 1 for socket mode"));
+llvm::cl::opt<std::string> cl_input(
+    "input", llvm::cl::init(""),
+    llvm::cl::desc("binary file of the set (32 bytes per item), socket mode "
+                   "only, generate random set if empty"));
+llvm::cl::opt<std::string> cl_payload(
+    "payload", llvm::cl::init(""),
+    llvm::cl::desc("binary file of the payload (32 bytes per item, party1 "
+                   "only), socket mode only, use all-one payload if empty"));
+llvm::cl::opt<std::string> cl_tmp(
+    "tmp", llvm::cl::init("/tmp"),
+    llvm::cl::desc("directory for spilled shares && sorted runs"));
+llvm::cl::opt<uint32_t> cl_memory(
+    "memory", llvm::cl::init(256),
+    llvm::cl::desc("memory budget (MB) for the chunked stages"));
+llvm::cl::opt<uint32_t> cl_size0("set0", llvm::cl::init(100000),
+                                 llvm::cl::desc("the size of set0"));
+llvm::cl::opt<uint32_t> cl_size1("set1", llvm::cl::init(100000),
+                                 llvm::cl::desc("the size of set1"));
+llvm::cl::opt<uint32_t> cl_interset_size(
+    "interset", llvm::cl::init(1000),
+    llvm::cl::desc("the size of intersection"));
+llvm::cl::opt<uint32_t> cl_thread("thread", llvm::cl::init(1),
+                                  llvm::cl::desc("the number of threads"));
+
+namespace {
+
+// rough memory cost of one element in the chunked stages (input, a-share,
+// DyExp temporaries and revealed point)
+constexpr size_t kChunkBytesPerElem = 1024;
+
+// rough memory cost of one element in the bucket shuffle (a-shares &&
+// payloads, input && output, with the shuffle temporaries)
+constexpr size_t kShuffleBytesPerElem = 8 * sizeof(ATy);
+
+// number of shuffle buckets, half of the budget on average, so that a bucket
+// beyond the budget is negligible
+size_t BucketNum(size_t size, size_t budget) {
+  const size_t max_bucket = std::max<size_t>(budget / kShuffleBytesPerElem, 1);
+  return std::max<size_t>((2 * size + max_bucket - 1) / max_bucket, 1);
+}
+
+// Level one of the out-of-core shuffle (see stream_psi): the owner assigns
+// each item (&& its payload) to a uniformly random bucket, and concatenates
+// the buckets into `out_set` (&& `out_val`). Return the bucket sizes.
+// NOTE: one open file per bucket (two with payloads).
+template <typename Tmp>
+std::vector<uint64_t> ScatterSet(const std::string &set_path,
+                                 const std::string &val_path,
+                                 const std::string &out_set,
+                                 const std::string &out_val,
+                                 size_t bucket_num, size_t chunk, Tmp &&tmp) {
+  ChunkReader<PTy> set_reader(set_path);
+  std::unique_ptr<ChunkReader<PTy>> val_reader;
+  if (!val_path.empty()) {
+    val_reader = std::make_unique<ChunkReader<PTy>>(val_path);
+    YACL_ENFORCE(val_reader->Size() == set_reader.Size());
+  }
+  auto bucket_path = [&](const char *name, size_t i) {
+    return tmp(fmt::format("{}.b{}", name, i));
+  };
+
+  std::vector<std::unique_ptr<ChunkWriter<PTy>>> set_writers(bucket_num);
+  std::vector<std::unique_ptr<ChunkWriter<PTy>>> val_writers(bucket_num);
+  for (size_t i = 0; i < bucket_num; ++i) {
+    set_writers[i] = std::make_unique<ChunkWriter<PTy>>(bucket_path("set", i));
+    if (val_reader) {
+      val_writers[i] =
+          std::make_unique<ChunkWriter<PTy>>(bucket_path("val", i));
+    }
+  }
+  yacl::crypto::Prg<uint64_t> prg(yacl::crypto::SecureRandU128());
+  std::vector<std::vector<PTy>> set_buckets(bucket_num);
+  std::vector<std::vector<PTy>> val_buckets(bucket_num);
+  while (set_reader.Remain() > 0) {
+    auto items = set_reader.Next(chunk);
+    std::vector<PTy> vals;
+    if (val_reader) {
+      vals = val_reader->Next(chunk);
+    }
+    for (size_t j = 0; j < items.size(); ++j) {
+      auto i = prg() % bucket_num;
+      set_buckets[i].emplace_back(items[j]);
+      if (val_reader) {
+        val_buckets[i].emplace_back(vals[j]);
+      }
+    }
+    for (size_t i = 0; i < bucket_num; ++i) {
+      set_writers[i]->Write(set_buckets[i]);
+      set_buckets[i].clear();
+      if (val_reader) {
+        val_writers[i]->Write(val_buckets[i]);
+        val_buckets[i].clear();
+      }
+    }
+  }
+
+  std::vector<uint64_t> sizes(bucket_num);
+  auto concat = [&](const char *name, const std::string &out) {
+    ChunkWriter<PTy> writer(out);
+    for (size_t i = 0; i < bucket_num; ++i) {
+      ChunkReader<PTy> reader(bucket_path(name, i));
+      sizes[i] = reader.Size();
+      while (reader.Remain() > 0) {
+        writer.Write(reader.Next(chunk));
+      }
+      std::remove(bucket_path(name, i).c_str());
+    }
+  };
+  for (size_t i = 0; i < bucket_num; ++i) {
+    set_writers[i]->Close();
+    if (val_reader) {
+      val_writers[i]->Close();
+    }
+  }
+  concat("set", out_set);
+  if (val_reader) {
+    concat("val", out_val);
+  }
+  return sizes;
+}
+
+// fingerprint of revealed point, the first 128 bits of Sm3(point)
+std::vector<Fingerprint> ToFingerprint(
+    const std::shared_ptr<yacl::crypto::EcGroup> &group,
+    absl::Span<const GTy> in, size_t offset) {
+  const size_t num = in.size();
+  const size_t GTy_size = group->GetSerializeLength(internal::kOctetFormat);
+  std::vector<Fingerprint> ret(num);
+  yacl::parallel_for(0, num, [&](uint64_t bg, uint64_t ed) {
+    std::vector<uint8_t> buf(GTy_size);
+    for (auto i = bg; i < ed; ++i) {
+      group->SerializePoint(in[i], internal::kOctetFormat, buf.data(),
+                            GTy_size);
+      auto digest = yacl::crypto::Sm3(buf);
+      memcpy(&ret[i].fp, digest.data(), sizeof(uint128_t));
+      ret[i].idx = offset + i;
+    }
+  });
+  return ret;
+}
+
+}  // namespace
+
+// Streaming Malicious Circuit PSI (sum of payloads in intersection)
+//
+// 0. (local)   the owner scatters its set into random buckets
+// 1. (chunked) SetA / DyExp, spill a-shares into disk
+// 2. (bucket)  shuffle within each bucket, spill shuffled a-shares
+// 3. (chunked) A2G, spill fingerprints into sorted runs
+// 4. external-merge intersection
+// 5. (chunked) filter && sum the shuffled payloads
+//
+// Steps 0 && 2 form a two-level out-of-core shuffle: a uniformly random
+// bucket per item, then a uniform shuffle within each bucket, i.e. a
+// uniformly random permutation known only to the owner, the same as one
+// shuffle over the full set. The bucket sizes are public, but independent of
+// the items.
+//
+// NOTE: all steps are bounded by `memory_mb` (a bucket beyond it aborts the
+// run, which is negligible). Each chunk (bucket) runs the complete
+// (maliciously secure) sub-protocol, including its MAC check.
+auto stream_psi(const std::shared_ptr<yacl::link::Context> &lctx,
+                const std::string &set_path, const std::string &val_path,
+                const std::string &tmp_dir, size_t memory_mb,
+                bool CR_mode = false) {
+  auto rank = lctx->Rank();
+  const size_t budget = memory_mb * 1024 * 1024;
+  const size_t chunk = std::max<size_t>(budget / kChunkBytesPerElem, 1024);
+  const size_t run_size = std::max<size_t>(budget / sizeof(Fingerprint), 1024);
+  auto tmp = [&](const std::string &name) {
+    return fmt::format("{}/stream_psi.p{}.{}", tmp_dir, rank, name);
+  };
+  SPDLOG_INFO("[P{}] memory budget {} MB, chunk size {}, run size {}", rank,
+              memory_mb, chunk, run_size);
+
+  TIMER_START(setup);
+  auto context = std::make_shared<Context>(lctx);
+  SetupContext(context, CR_mode);
+  auto prot = context->GetState<Protocol>();
+  auto conn = context->GetConnection();
+  auto Ggroup = prot->GetGroup();
+  TIMER_END(setup);
+  TIMER_PRINT(setup);
+
+  // set sizes are public
+  uint64_t self_size = ChunkReader<PTy>(set_path).Size();
+  uint64_t other_size = conn->Exchange(self_size);
+  const size_t size0 = rank == 0 ? self_size : other_size;
+  const size_t size1 = rank == 1 ? self_size : other_size;
+
+  // ---- 0. scatter into buckets ----
+  TIMER_START(scatter);
+  std::array<std::vector<uint64_t>, 2> buckets;
+  {
+    auto self_buckets =
+        ScatterSet(set_path, rank == 1 ? val_path : "", tmp("set"), tmp("val"),
+                   BucketNum(self_size, budget), chunk, tmp);
+    auto buf = conn->Exchange(yacl::ByteContainerView(
+        self_buckets.data(), self_buckets.size() * sizeof(uint64_t)));
+    auto ptr = buf.data<uint64_t>();
+    std::vector<uint64_t> other_buckets(ptr,
+                                        ptr + buf.size() / sizeof(uint64_t));
+    buckets[rank] = std::move(self_buckets);
+    buckets[1 - rank] = std::move(other_buckets);
+  }
+  const size_t max_bucket = std::max<size_t>(budget / kShuffleBytesPerElem, 1);
+  for (size_t i = 0; i < 2; ++i) {
+    const size_t size = i == 0 ? size0 : size1;
+    YACL_ENFORCE(buckets[i].size() == BucketNum(size, budget));
+    size_t sum = 0;
+    for (const auto &num : buckets[i]) {
+      YACL_ENFORCE(num <= max_bucket, "shuffle bucket {} beyond the budget",
+                   num);
+      sum += num;
+    }
+    YACL_ENFORCE(sum == size);
+  }
+  SPDLOG_INFO("[P{}] shuffle buckets {} && {}", rank, buckets[0].size(),
+              buckets[1].size());
+  ChunkReader<PTy> set_reader(tmp("set"));
+  TIMER_END(scatter);
+  TIMER_PRINT(scatter);
+
+  // ---- 1. SetA && DyExp ----
+  TIMER_START(dyexp);
+  {
+    ChunkWriter<ATy> share0_writer(tmp("share0"));
+    ChunkWriter<ATy> share1_writer(tmp("share1"));
+    ChunkWriter<ATy> data_writer(tmp("data"));
+    for (size_t pos = 0; pos < size0; pos += chunk) {
+      const size_t num = std::min(chunk, size0 - pos);
+      auto share = rank == 0 ? prot->DyExpSet(set_reader.Next(num))
+                             : prot->DyExpGet(num);
+      share0_writer.Write(share);
+    }
+    std::unique_ptr<ChunkReader<PTy>> val_reader;
+    if (rank == 1 && !val_path.empty()) {
+      val_reader = std::make_unique<ChunkReader<PTy>>(tmp("val"));
+      YACL_ENFORCE(val_reader->Size() == size1);
+    }
+    for (size_t pos = 0; pos < size1; pos += chunk) {
+      const size_t num = std::min(chunk, size1 - pos);
+      auto share = rank == 1 ? prot->DyExpSet(set_reader.Next(num))
+                             : prot->DyExpGet(num);
+      share1_writer.Write(share);
+      std::vector<ATy> data;
+      if (rank == 1) {
+        auto val = val_reader ? val_reader->Next(num) : OP::Ones(num);
+        data = prot->SetA(val);
+      } else {
+        data = prot->GetA(num);
+      }
+      data_writer.Write(data);
+    }
+  }
+  TIMER_END(dyexp);
+  TIMER_PRINT(dyexp);
+
+  // ---- 2. Shuffle (within each bucket) ----
+  TIMER_START(shuffle);
+  {
+    ChunkReader<ATy> reader(tmp("share0"));
+    ChunkWriter<ATy> writer(tmp("shuffle0"));
+    for (const auto &num : buckets[0]) {
+      auto share0 = reader.Next(num);
+      writer.Write(rank == 0 ? prot->ShuffleASet(share0)
+                             : prot->ShuffleAGet(share0));
+    }
+  }
+  {
+    ChunkReader<ATy> share1_reader(tmp("share1"));
+    ChunkReader<ATy> data_reader(tmp("data"));
+    ChunkWriter<ATy> share1_writer(tmp("shuffle1"));
+    ChunkWriter<ATy> data_writer(tmp("shuffle_data"));
+    for (const auto &num : buckets[1]) {
+      auto share1 = share1_reader.Next(num);
+      auto data = data_reader.Next(num);
+      auto [shuffle1, shuffle_data] =
+          (rank == 1 ? prot->ShuffleASet(share1, data)
+                     : prot->ShuffleAGet(share1, data));
+      share1_writer.Write(shuffle1);
+      data_writer.Write(shuffle_data);
+    }
+  }
+  TIMER_END(shuffle);
+  TIMER_PRINT(shuffle);
+
+  // ---- 3. A2G && sorted runs ----
+  TIMER_START(a2g);
+  ExternalSorter sorter0(tmp("fp0"), run_size);
+  ExternalSorter sorter1(tmp("fp1"), run_size);
+  auto reveal = [&](const std::string &path, ExternalSorter &sorter) {
+    ChunkReader<ATy> reader(path);
+    size_t pos = 0;
+    while (reader.Remain() > 0) {
+      auto share = reader.Next(chunk);
+      auto points = prot->A2G(share);
+      sorter.Add(ToFingerprint(Ggroup, points, pos));
+      pos += share.size();
+    }
+    sorter.Finish();
+  };
+  reveal(tmp("shuffle0"), sorter0);
+  reveal(tmp("shuffle1"), sorter1);
+  TIMER_END(a2g);
+  TIMER_PRINT(a2g);
+
+  // ---- 4. external-merge intersection ----
+  TIMER_START(intersection);
+  auto indexes = MergeJoin(sorter0, sorter1);
+  SPDLOG_INFO("[P{}] interset size {}", rank, indexes.size());
+  TIMER_END(intersection);
+  TIMER_PRINT(intersection);
+
+  // ---- 5. filter && sum ----
+  TIMER_START(result_sum);
+  auto sum_s = prot->ZerosA(1);
+  {
+    ChunkReader<ATy> reader(tmp("shuffle_data"));
+    size_t pos = 0;
+    size_t cur = 0;
+    while (reader.Remain() > 0) {
+      auto data = reader.Next(chunk);
+      std::vector<size_t> local;
+      while (cur < indexes.size() && indexes[cur] < pos + data.size()) {
+        local.emplace_back(indexes[cur] - pos);
+        ++cur;
+      }
+      auto selected = prot->FilterA(data, local);
+      sum_s = prot->Add(sum_s, prot->SumA(selected));
+      pos += data.size();
+    }
+  }
+  auto result_p = prot->A2P(sum_s);
+  TIMER_END(result_sum);
+  TIMER_PRINT(result_sum);
+
+  for (const auto &name : {"set", "val", "share0", "share1", "data",
+                           "shuffle0", "shuffle1", "shuffle_data"}) {
+    std::remove(tmp(name).c_str());
+  }
+
+  SPDLOG_INFO("[P{}] sum is {}", rank, result_p[0].GetVal());
+  return result_p[0].GetVal();
+}
+
+// random set with the first `interset_size` items from `interset`
+void GenerateSet(const std::string &path, absl::Span<const PTy> interset,
+                 size_t size, size_t chunk) {
+  ChunkWriter<PTy> writer(path);
+  writer.Write(interset);
+  for (size_t pos = interset.size(); pos < size; pos += chunk) {
+    writer.Write(OP::Rand(std::min(chunk, size - pos)));
+  }
+}
+
+std::shared_ptr<yacl::link::Context> MakeLink(const std::string &parties,
+                                              size_t rank) {
+  yacl::link::ContextDesc lctx_desc;
+  std::vector<std::string> hosts = absl::StrSplit(parties, ',');
+  for (size_t rank = 0; rank < hosts.size(); rank++) {
+    const auto id = fmt::format("party{}", rank);
+    lctx_desc.parties.emplace_back(id, hosts[rank]);
+  }
+  lctx_desc.throttle_window_size = 0;
+  lctx_desc.http_timeout_ms = 120 * 1000;  // 2 min
+  auto lctx = yacl::link::FactoryBrpc().CreateContext(lctx_desc, rank);
+  lctx->ConnectToMesh();
+  return lctx;
+}
+
+int main(int argc, char **argv) {
+  llvm::cl::ParseCommandLineOptions(argc, argv);
+
+  bool mem_mode = cl_mode.getValue() == 0;
+  bool CR_mode = cl_CR.getValue();
+  size_t size0 = cl_size0.getValue();
+  size_t size1 = cl_size1.getValue();
+  size_t interset_size =
+      std::min<size_t>(cl_interset_size.getValue(), std::min(size0, size1));
+  size_t memory_mb = cl_memory.getValue();
+  std::string tmp_dir = cl_tmp.getValue();
+  const size_t chunk = 1 << 16;
+
+  yacl::set_num_threads(cl_thread.getValue());
+
+  if (mem_mode == true) {
+    auto interset = OP::Rand(interset_size);
+    auto path0 = fmt::format("{}/stream_psi.set0", tmp_dir);
+    auto path1 = fmt::format("{}/stream_psi.set1", tmp_dir);
+    GenerateSet(path0, interset, size0, chunk);
+    GenerateSet(path1, interset, size1, chunk);
+
+    auto lctxs = SetupWorld(2);
+    auto task0 = std::async([&] {
+      return stream_psi(lctxs[0], path0, "", tmp_dir, memory_mb, CR_mode);
+    });
+    auto task1 = std::async([&] {
+      return stream_psi(lctxs[1], path1, "", tmp_dir, memory_mb, CR_mode);
+    });
+    auto result0 = task0.get();
+    auto result1 = task1.get();
+    std::cout << "P0 result (sum): " << result0 << std::endl;
+    std::cout << "P1 result (sum): " << result1 << std::endl;
+    std::remove(path0.c_str());
+    std::remove(path1.c_str());
+  } else {
+    auto lctx = MakeLink(cl_parties.getValue(), cl_rank.getValue());
+    auto set_path = cl_input.getValue();
+    bool generated = set_path.empty();
+    if (generated) {
+      // both parties share the intersection from a common seed
+      auto seed = std::make_shared<Context>(lctx)->GetConnection()->SyncSeed();
+      auto interset = OP::Rand(seed, interset_size);
+      set_path = fmt::format("{}/stream_psi.set{}", tmp_dir, lctx->Rank());
+      GenerateSet(set_path, interset, lctx->Rank() == 0 ? size0 : size1,
+                  chunk);
+    }
+    auto res = stream_psi(lctx, set_path, cl_payload.getValue(), tmp_dir,
+                          memory_mb, CR_mode);
+    std::cout << "P" << cl_rank.getValue() << " result (sum): " << res
+              << std::endl;
+    if (generated) {
+      std::remove(set_path.c_str());
+    }
+  }
+
+  return 0;
+}
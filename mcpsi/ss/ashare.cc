@@ -2,28 +2,36 @@
 
 #include <vector>
 
+#include "mcpsi/context/arena.h"
 #include "mcpsi/cr/cr.h"
 #include "mcpsi/cr/fake_cr.h"
 #include "mcpsi/ss/protocol.h"
 #include "mcpsi/utils/field.h"
 #include "mcpsi/utils/vec_op.h"
+#include "yacl/utils/parallel.h"
 
 namespace mcpsi::internal {
 
 // --------------- AA ------------------
 
-std::vector<ATy> AddAA([[maybe_unused]] std::shared_ptr<Context>& ctx,
+std::vector<ATy> AddAA(std::shared_ptr<Context>& ctx,
                        absl::Span<const ATy> lhs, absl::Span<const ATy> rhs) {
+  std::vector<ATy> ret(lhs.size());
+  AddAA(ctx, lhs, rhs, absl::MakeSpan(ret));
+  return ret;
+}
+
+void AddAA([[maybe_unused]] std::shared_ptr<Context>& ctx,
+           absl::Span<const ATy> lhs, absl::Span<const ATy> rhs,
+           absl::Span<ATy> out) {
   YACL_ENFORCE(lhs.size() == rhs.size());
+  YACL_ENFORCE(lhs.size() == out.size());
   const size_t size = lhs.size();
-  std::vector<ATy> ret(size);
 
   op::Add(
       absl::MakeConstSpan(reinterpret_cast<const PTy*>(lhs.data()), size * 2),
       absl::MakeConstSpan(reinterpret_cast<const PTy*>(rhs.data()), size * 2),
-      absl::MakeSpan(reinterpret_cast<PTy*>(ret.data()), size * 2));
-
-  return ret;
+      absl::MakeSpan(reinterpret_cast<PTy*>(out.data()), size * 2));
 }
 
 std::vector<ATy> AddAA_cache([[maybe_unused]] std::shared_ptr<Context>& ctx,
@@ -34,18 +42,24 @@ std::vector<ATy> AddAA_cache([[maybe_unused]] std::shared_ptr<Context>& ctx,
   return std::vector<ATy>(size);
 }
 
-std::vector<ATy> SubAA([[maybe_unused]] std::shared_ptr<Context>& ctx,
+std::vector<ATy> SubAA(std::shared_ptr<Context>& ctx,
                        absl::Span<const ATy> lhs, absl::Span<const ATy> rhs) {
+  std::vector<ATy> ret(lhs.size());
+  SubAA(ctx, lhs, rhs, absl::MakeSpan(ret));
+  return ret;
+}
+
+void SubAA([[maybe_unused]] std::shared_ptr<Context>& ctx,
+           absl::Span<const ATy> lhs, absl::Span<const ATy> rhs,
+           absl::Span<ATy> out) {
   YACL_ENFORCE(lhs.size() == rhs.size());
+  YACL_ENFORCE(lhs.size() == out.size());
   const size_t size = lhs.size();
-  std::vector<ATy> ret(size);
 
   op::Sub(
       absl::MakeConstSpan(reinterpret_cast<const PTy*>(lhs.data()), size * 2),
       absl::MakeConstSpan(reinterpret_cast<const PTy*>(rhs.data()), size * 2),
-      absl::MakeSpan(reinterpret_cast<PTy*>(ret.data()), size * 2));
-
-  return ret;
+      absl::MakeSpan(reinterpret_cast<PTy*>(out.data()), size * 2));
 }
 
 std::vector<ATy> SubAA_cache([[maybe_unused]] std::shared_ptr<Context>& ctx,
@@ -58,23 +72,44 @@ std::vector<ATy> SubAA_cache([[maybe_unused]] std::shared_ptr<Context>& ctx,
 
 std::vector<ATy> MulAA(std::shared_ptr<Context>& ctx, absl::Span<const ATy> lhs,
                        absl::Span<const ATy> rhs) {
+  std::vector<ATy> ret(lhs.size());
+  MulAA(ctx, lhs, rhs, absl::MakeSpan(ret));
+  return ret;
+}
+
+void MulAA(std::shared_ptr<Context>& ctx, absl::Span<const ATy> lhs,
+           absl::Span<const ATy> rhs, absl::Span<ATy> out) {
   YACL_ENFORCE(lhs.size() == rhs.size());
+  YACL_ENFORCE(lhs.size() == out.size());
   const size_t size = lhs.size();
-  auto [a, b, c] = ctx->GetState<Correlation>()->BeaverTriple(size);
-  auto u = SubAA(ctx, lhs, a);  // x-a
-  auto v = SubAA(ctx, rhs, b);  // y-b
-  auto u_p = A2P_delay(ctx, u);
-  auto v_p = A2P_delay(ctx, v);
+  auto* arena = ctx->GetArena();
+  Arena::Scope scope(arena);
+
+  auto a = arena->Alloc<ATy>(size);
+  auto b = arena->Alloc<ATy>(size);
+  auto c = arena->Alloc<ATy>(size);
+  ctx->GetStateRaw<Correlation>()->FillBeaverTriple(a, b, c);
+  // a && b are not needed after the masking, reuse them
+  auto& u = a;
+  auto& v = b;
+  SubAA(ctx, lhs, a, u);  // x-a
+  SubAA(ctx, rhs, b, v);  // y-b
+  auto u_p = arena->Alloc<PTy>(size);
+  auto v_p = arena->Alloc<PTy>(size);
+  A2P_delay(ctx, u, u_p);
+  A2P_delay(ctx, v, v_p);
 
   // ret = c + x(y-b) + (x-a)y - (x-a)(y-b)
-  auto xyb = MulAP(ctx, lhs, v_p);
-  auto xay = MulPA(ctx, u_p, rhs);
-  auto xayb = MulPP(ctx, u_p, v_p);
-  auto oooo = P2A(ctx, absl::MakeSpan(xayb));
-  c = AddAA(ctx, absl::MakeSpan(c), absl::MakeSpan(xyb));
-  c = AddAA(ctx, absl::MakeSpan(c), absl::MakeSpan(xay));
-  c = SubAA(ctx, absl::MakeSpan(c), absl::MakeSpan(oooo));
-  return c;
+  auto tmp = u;
+  MulAP(ctx, lhs, v_p, tmp);
+  AddAA(ctx, c, tmp, c);
+  MulPA(ctx, u_p, rhs, tmp);
+  AddAA(ctx, c, tmp, c);
+  auto xayb = arena->Alloc<PTy>(size);
+  op::Mul(u_p, v_p, xayb);
+  P2A(ctx, xayb, tmp);
+  // NOTE: the last step, `out` could alias `lhs` or `rhs`
+  SubAA(ctx, c, tmp, out);
 }
 
 std::vector<ATy> MulAA_cache([[maybe_unused]] std::shared_ptr<Context>& ctx,
@@ -82,7 +117,7 @@ std::vector<ATy> MulAA_cache([[maybe_unused]] std::shared_ptr<Context>& ctx,
                              absl::Span<const ATy> rhs) {
   YACL_ENFORCE(lhs.size() == rhs.size());
   const size_t size = lhs.size();
-  ctx->GetState<Correlation>()->BeaverTriple_cache(size);
+  ctx->GetStateRaw<Correlation>()->BeaverTriple_cache(size);
   std::vector<ATy> a(size);
   std::vector<ATy> b(size);
   std::vector<ATy> c(size);
@@ -119,14 +154,20 @@ std::vector<ATy> DivAA_cache(std::shared_ptr<Context>& ctx,
   return MulAA_cache(ctx, absl::MakeConstSpan(lhs), absl::MakeConstSpan(inv));
 }
 
-std::vector<ATy> NegA([[maybe_unused]] std::shared_ptr<Context>& ctx,
+std::vector<ATy> NegA(std::shared_ptr<Context>& ctx,
                       absl::Span<const ATy> in) {
+  std::vector<ATy> ret(in.size());
+  NegA(ctx, in, absl::MakeSpan(ret));
+  return ret;
+}
+
+void NegA([[maybe_unused]] std::shared_ptr<Context>& ctx,
+          absl::Span<const ATy> in, absl::Span<ATy> out) {
   const size_t size = in.size();
-  std::vector<ATy> ret(size);
+  YACL_ENFORCE(size == out.size());
   op::Neg(
       absl::MakeConstSpan(reinterpret_cast<const PTy*>(in.data()), 2 * size),
-      absl::MakeSpan(reinterpret_cast<PTy*>(ret.data()), 2 * size));
-  return ret;
+      absl::MakeSpan(reinterpret_cast<PTy*>(out.data()), 2 * size));
 }
 
 std::vector<ATy> NegA_cache([[maybe_unused]] std::shared_ptr<Context>& ctx,
@@ -166,16 +207,21 @@ std::vector<ATy> InvA_cache(std::shared_ptr<Context>& ctx,
 
 std::vector<ATy> ZerosA(std::shared_ptr<Context>& ctx, size_t num) {
   std::vector<ATy> ret(num);
+  ZerosA(ctx, absl::MakeSpan(ret));
+  return ret;
+}
+
+void ZerosA(std::shared_ptr<Context>& ctx, absl::Span<ATy> out) {
+  const size_t num = out.size();
 
-  auto prg_ptr = ctx->GetState<Prg>();
+  auto prg_ptr = ctx->GetStateRaw<Prg>();
   op::Rand(*prg_ptr,
-           absl::MakeSpan(reinterpret_cast<PTy*>(ret.data()), num * 2));
+           absl::MakeSpan(reinterpret_cast<PTy*>(out.data()), num * 2));
   if (ctx->GetRank() == 0) {
     op::Neg(
-        absl::MakeConstSpan(reinterpret_cast<const PTy*>(ret.data()), num * 2),
-        absl::MakeSpan(reinterpret_cast<PTy*>(ret.data()), num * 2));
+        absl::MakeConstSpan(reinterpret_cast<const PTy*>(out.data()), num * 2),
+        absl::MakeSpan(reinterpret_cast<PTy*>(out.data()), num * 2));
   }
-  return ret;
 }
 
 std::vector<ATy> ZerosA_cache([[maybe_unused]] std::shared_ptr<Context>& ctx,
@@ -184,11 +230,11 @@ std::vector<ATy> ZerosA_cache([[maybe_unused]] std::shared_ptr<Context>& ctx,
 }
 
 std::vector<ATy> RandA(std::shared_ptr<Context>& ctx, size_t num) {
-  return ctx->GetState<Correlation>()->RandomAuth(num).data;
+  return ctx->GetStateRaw<Correlation>()->RandomAuth(num).data;
 }
 
 std::vector<ATy> RandA_cache(std::shared_ptr<Context>& ctx, size_t num) {
-  ctx->GetState<Correlation>()->RandomAuth_cache(num);
+  ctx->GetStateRaw<Correlation>()->RandomAuth_cache(num);
   return std::vector<ATy>(num);
 }
 
@@ -204,8 +250,8 @@ std::vector<ATy> AddAP([[maybe_unused]] std::shared_ptr<Context>& ctx,
     op::AddInplace(absl::MakeSpan(val), absl::MakeConstSpan(rhs));
   }
   std::vector<PTy> rhs_mac(size);
-  op::ScalarMul(ctx->GetState<Protocol>()->GetKey(), absl::MakeConstSpan(rhs),
-                absl::MakeSpan(rhs_mac));
+  op::ScalarMul(ctx->GetStateRaw<Protocol>()->GetKey(),
+                absl::MakeConstSpan(rhs), absl::MakeSpan(rhs_mac));
   // mac += rhs_mac
   op::AddInplace(absl::MakeSpan(mac), absl::MakeConstSpan(rhs_mac));
   return Pack(absl::MakeSpan(val), absl::MakeSpan(mac));
@@ -236,14 +282,27 @@ std::vector<ATy> SubAP_cache([[maybe_unused]] std::shared_ptr<Context>& ctx,
   return AddAP_cache(ctx, lhs, neg_rhs);
 }
 
-std::vector<ATy> MulAP([[maybe_unused]] std::shared_ptr<Context>& ctx,
+std::vector<ATy> MulAP(std::shared_ptr<Context>& ctx,
                        absl::Span<const ATy> lhs, absl::Span<const PTy> rhs) {
+  std::vector<ATy> ret(lhs.size());
+  MulAP(ctx, lhs, rhs, absl::MakeSpan(ret));
+  return ret;
+}
+
+void MulAP(std::shared_ptr<Context>& ctx, absl::Span<const ATy> lhs,
+           absl::Span<const PTy> rhs, absl::Span<ATy> out) {
   const size_t size = lhs.size();
   YACL_ENFORCE(size == rhs.size());
-  auto [val, mac] = Unpack(absl::MakeConstSpan(lhs));
-  op::MulInplace(absl::MakeSpan(val), absl::MakeConstSpan(rhs));
-  op::MulInplace(absl::MakeSpan(mac), absl::MakeConstSpan(rhs));
-  return Pack(absl::MakeSpan(val), absl::MakeSpan(mac));
+  YACL_ENFORCE(size == out.size());
+  auto* arena = ctx->GetArena();
+  Arena::Scope scope(arena);
+
+  auto val = arena->Alloc<PTy>(size);
+  auto mac = arena->Alloc<PTy>(size);
+  Unpack(lhs, val, mac);
+  op::MulInplace(val, rhs);
+  op::MulInplace(mac, rhs);
+  Pack(val, mac, out);
 }
 
 std::vector<ATy> MulAP_cache([[maybe_unused]] std::shared_ptr<Context>& ctx,
@@ -305,6 +364,11 @@ std::vector<ATy> MulPA([[maybe_unused]] std::shared_ptr<Context>& ctx,
   return MulAP(ctx, rhs, lhs);
 }
 
+void MulPA(std::shared_ptr<Context>& ctx, absl::Span<const PTy> lhs,
+           absl::Span<const ATy> rhs, absl::Span<ATy> out) {
+  MulAP(ctx, rhs, lhs, out);
+}
+
 std::vector<ATy> MulPA_cache([[maybe_unused]] std::shared_ptr<Context>& ctx,
                              absl::Span<const PTy> lhs,
                              absl::Span<const ATy> rhs) {
@@ -334,7 +398,7 @@ std::vector<PTy> A2P(std::shared_ptr<Context>& ctx, absl::Span<const ATy> in) {
   // TEST ME: whether is secure enough ???
   const size_t size = in.size();
   auto [val, mac] = Unpack(absl::MakeSpan(in));
-  auto conn = ctx->GetState<Connection>();
+  auto conn = ctx->GetStateRaw<Connection>();
   auto val_bv = yacl::ByteContainerView(val.data(), size * sizeof(PTy));
   std::vector<PTy> real_val(size);
 
@@ -343,14 +407,14 @@ std::vector<PTy> A2P(std::shared_ptr<Context>& ctx, absl::Span<const ATy> in) {
           absl::MakeConstSpan(val), absl::MakeSpan(real_val));
 
   // Generate Sync Seed After Open Value
-  auto sync_seed = conn->SyncSeed();
+  auto sync_seed = conn->DrawCoin();
   auto coef = op::Rand(sync_seed, size);
   // linear combination
   auto real_val_affine =
       op::InPro(absl::MakeSpan(coef), absl::MakeSpan(real_val));
   auto mac_affine = op::InPro(absl::MakeSpan(coef), absl::MakeSpan(mac));
 
-  auto key = ctx->GetState<Protocol>()->GetKey();
+  auto key = ctx->GetStateRaw<Protocol>()->GetKey();
   auto zero_mac = mac_affine - real_val_affine * key;
 
   auto remote_mac_int = conn->ExchangeWithCommit(zero_mac.GetVal());
@@ -363,7 +427,7 @@ std::vector<PTy> A2P_cache(std::shared_ptr<Context>& ctx,
   // TEST ME: whether is secure enough ???
   const size_t size = in.size();
   auto [val, mac] = Unpack(absl::MakeSpan(in));
-  auto conn = ctx->GetState<Connection>();
+  auto conn = ctx->GetStateRaw<Connection>();
   auto val_bv = yacl::ByteContainerView(val.data(), size * sizeof(PTy));
   std::vector<PTy> real_val(size);
 
@@ -372,14 +436,14 @@ std::vector<PTy> A2P_cache(std::shared_ptr<Context>& ctx,
           absl::MakeConstSpan(val), absl::MakeSpan(real_val));
 
   // Generate Sync Seed After Open Value
-  auto sync_seed = conn->SyncSeed();
+  auto sync_seed = conn->DrawCoin();
   auto coef = op::Rand(sync_seed, size);
   // linear combination
   auto real_val_affine =
       op::InPro(absl::MakeSpan(coef), absl::MakeSpan(real_val));
   auto mac_affine = op::InPro(absl::MakeSpan(coef), absl::MakeSpan(mac));
 
-  auto key = ctx->GetState<Protocol>()->GetKey();
+  auto key = ctx->GetStateRaw<Protocol>()->GetKey();
   auto zero_mac = mac_affine - real_val_affine * key;
 
   auto remote_mac_int = conn->ExchangeWithCommit(zero_mac.GetVal());
@@ -388,17 +452,31 @@ std::vector<PTy> A2P_cache(std::shared_ptr<Context>& ctx,
 }
 
 std::vector<ATy> P2A(std::shared_ptr<Context>& ctx, absl::Span<const PTy> in) {
+  std::vector<ATy> ret(in.size());
+  P2A(ctx, in, absl::MakeSpan(ret));
+  return ret;
+}
+
+void P2A(std::shared_ptr<Context>& ctx, absl::Span<const PTy> in,
+         absl::Span<ATy> out) {
   const size_t size = in.size();
-  auto zero = ZerosA(ctx, size);
-  auto [zero_val, zero_mac] = Unpack(zero);
+  YACL_ENFORCE(size == out.size());
+  auto* arena = ctx->GetArena();
+  Arena::Scope scope(arena);
+
+  ZerosA(ctx, out);
+  auto zero_val = arena->Alloc<PTy>(size);
+  auto zero_mac = arena->Alloc<PTy>(size);
+  Unpack(absl::MakeConstSpan(out), zero_val, zero_mac);
   if (ctx->GetRank() == 0) {
     // zero_val += in
-    op::AddInplace(absl::MakeSpan(zero_val), absl::MakeConstSpan(in));
+    op::AddInplace(zero_val, in);
   }
-  auto in_mac = op::ScalarMul(ctx->GetState<Protocol>()->GetKey(), in);
+  auto in_mac = arena->Alloc<PTy>(size);
+  op::ScalarMul(ctx->GetStateRaw<Protocol>()->GetKey(), in, in_mac);
   // zero_mac += in_mac
-  op::AddInplace(absl::MakeSpan(zero_mac), absl::MakeConstSpan(in_mac));
-  return Pack(absl::MakeSpan(zero_val), absl::MakeSpan(zero_mac));
+  op::AddInplace(zero_mac, in_mac);
+  Pack(zero_val, zero_mac, out);
 }
 
 std::vector<ATy> P2A_cache(std::shared_ptr<Context>& ctx,
@@ -410,7 +488,7 @@ std::vector<ATy> P2A_cache(std::shared_ptr<Context>& ctx,
     // zero_val += in
     op::AddInplace(absl::MakeSpan(zero_val), absl::MakeConstSpan(in));
   }
-  auto in_mac = op::ScalarMul(ctx->GetState<Protocol>()->GetKey(), in);
+  auto in_mac = op::ScalarMul(ctx->GetStateRaw<Protocol>()->GetKey(), in);
   // zero_mac += in_mac
   op::AddInplace(absl::MakeSpan(zero_mac), absl::MakeConstSpan(in_mac));
   return Pack(absl::MakeSpan(zero_val), absl::MakeSpan(zero_mac));
@@ -423,7 +501,7 @@ std::vector<ATy> ShuffleAGet(std::shared_ptr<Context>& ctx,
   const size_t num = in.size();
   // correlation
   // [Warning] low efficiency!!! optimize it
-  auto [_a, _b] = ctx->GetState<Correlation>()->ShuffleGet(num, 2);
+  auto [_a, _b] = ctx->GetStateRaw<Correlation>()->ShuffleGet(num, 2);
   auto val_a = absl::MakeSpan(_a).subspan(0, num);
   auto val_b = absl::MakeSpan(_b).subspan(0, num);
   auto mac_a = absl::MakeSpan(_a).subspan(num, num);
@@ -434,7 +512,7 @@ std::vector<ATy> ShuffleAGet(std::shared_ptr<Context>& ctx,
   op::AddInplace(absl::MakeSpan(val_a), absl::MakeConstSpan(val_in));
   op::AddInplace(absl::MakeSpan(mac_a), absl::MakeConstSpan(mac_in));
 
-  auto conn = ctx->GetConnection();
+  auto conn = ctx->GetStateRaw<Connection>();
   conn->SendAsync(
       ctx->NextRank(),
       yacl::ByteContainerView(val_a.data(), val_a.size() * sizeof(PTy)),
@@ -452,7 +530,7 @@ std::vector<ATy> ShuffleAGet_cache(std::shared_ptr<Context>& ctx,
   const size_t num = in.size();
   // correlation
   // [Warning] low efficiency!!! optimize it
-  ctx->GetState<Correlation>()->ShuffleGet_cache(num, 2);
+  ctx->GetStateRaw<Correlation>()->ShuffleGet_cache(num, 2);
   return std::vector<ATy>(num);
 }
 
@@ -461,11 +539,11 @@ std::vector<ATy> ShuffleASet(std::shared_ptr<Context>& ctx,
   const size_t num = in.size();
   // correlation
   // [Warning] low efficiency!!! optimize it
-  auto [_delta, perm] = ctx->GetState<Correlation>()->ShuffleSet(num, 2);
+  auto [_delta, perm] = ctx->GetStateRaw<Correlation>()->ShuffleSet(num, 2);
   auto val_delta = absl::MakeSpan(_delta).subspan(0, num);
   auto mac_delta = absl::MakeSpan(_delta).subspan(num, num);
 
-  auto conn = ctx->GetConnection();
+  auto conn = ctx->GetStateRaw<Connection>();
   auto val_buf = conn->Recv(ctx->NextRank(), "send:a");
   auto mac_buf = conn->Recv(ctx->NextRank(), "send:b");
 
@@ -490,7 +568,7 @@ std::vector<ATy> ShuffleASet_cache(std::shared_ptr<Context>& ctx,
   const size_t num = in.size();
   // correlation
   // [Warning] low efficiency!!! optimize it
-  ctx->GetState<Correlation>()->ShuffleSet_cache(num, 2);
+  ctx->GetStateRaw<Correlation>()->ShuffleSet_cache(num, 2);
   return std::vector<ATy>(num);
 }
 
@@ -522,7 +600,7 @@ std::array<std::vector<ATy>, 2> ShuffleAGet(std::shared_ptr<Context>& ctx,
   YACL_ENFORCE(in1.size() == num);
   // correlation
   // [Warning] low efficiency!!! optimize it
-  auto [_a, _b] = ctx->GetState<Correlation>()->ShuffleGet(num, 4);
+  auto [_a, _b] = ctx->GetStateRaw<Correlation>()->ShuffleGet(num, 4);
   auto val_a0 = absl::MakeSpan(_a).subspan(0 * num, num);
   auto val_b0 = absl::MakeSpan(_b).subspan(0 * num, num);
   auto mac_a0 = absl::MakeSpan(_a).subspan(1 * num, num);
@@ -541,7 +619,7 @@ std::array<std::vector<ATy>, 2> ShuffleAGet(std::shared_ptr<Context>& ctx,
   op::AddInplace(absl::MakeSpan(val_a1), absl::MakeConstSpan(val_in1));
   op::AddInplace(absl::MakeSpan(mac_a1), absl::MakeConstSpan(mac_in1));
 
-  auto conn = ctx->GetConnection();
+  auto conn = ctx->GetStateRaw<Connection>();
   conn->SendAsync(
       ctx->NextRank(),
       yacl::ByteContainerView(val_a0.data(), val_a0.size() * sizeof(PTy)),
@@ -570,7 +648,7 @@ std::array<std::vector<ATy>, 2> ShuffleAGet_cache(std::shared_ptr<Context>& ctx,
   YACL_ENFORCE(in1.size() == num);
   // correlation
   // [Warning] low efficiency!!! optimize it
-  ctx->GetState<Correlation>()->ShuffleGet_cache(num, 4);
+  ctx->GetStateRaw<Correlation>()->ShuffleGet_cache(num, 4);
   return {std::vector<ATy>(num), std::vector<ATy>(num)};
 }
 
@@ -581,13 +659,13 @@ std::array<std::vector<ATy>, 2> ShuffleASet(std::shared_ptr<Context>& ctx,
   YACL_ENFORCE(num == in1.size());
   // correlation
   // [Warning] low efficiency!!! optimize it
-  auto [_delta, perm] = ctx->GetState<Correlation>()->ShuffleSet(num, 4);
+  auto [_delta, perm] = ctx->GetStateRaw<Correlation>()->ShuffleSet(num, 4);
   auto val_delta0 = absl::MakeSpan(_delta).subspan(0 * num, num);
   auto mac_delta0 = absl::MakeSpan(_delta).subspan(1 * num, num);
   auto val_delta1 = absl::MakeSpan(_delta).subspan(2 * num, num);
   auto mac_delta1 = absl::MakeSpan(_delta).subspan(3 * num, num);
 
-  auto conn = ctx->GetConnection();
+  auto conn = ctx->GetStateRaw<Connection>();
   auto val_buf0 = conn->Recv(ctx->NextRank(), "send:a0");
   auto mac_buf0 = conn->Recv(ctx->NextRank(), "send:b0");
   auto val_buf1 = conn->Recv(ctx->NextRank(), "send:a1");
@@ -624,7 +702,7 @@ std::array<std::vector<ATy>, 2> ShuffleASet_cache(std::shared_ptr<Context>& ctx,
   YACL_ENFORCE(num == in1.size());
   // correlation
   // [Warning] low efficiency!!! optimize it
-  ctx->GetState<Correlation>()->ShuffleSet_cache(num, 4);
+  ctx->GetStateRaw<Correlation>()->ShuffleSet_cache(num, 4);
   return {std::vector<ATy>(num), std::vector<ATy>(num)};
 }
 
@@ -659,11 +737,11 @@ std::vector<ATy> SetA(std::shared_ptr<Context>& ctx, absl::Span<const PTy> in) {
   auto [val, mac] = Unpack(absl::MakeConstSpan(rand));
   // reuse, diff = in - val
   auto diff = op::Sub(absl::MakeConstSpan(in), absl::MakeConstSpan(val));
-  ctx->GetConnection()->SendAsync(
+  ctx->GetStateRaw<Connection>()->SendAsync(
       ctx->NextRank(), yacl::ByteContainerView(diff.data(), num * sizeof(PTy)),
       "SetA");
   // extra = diff * key
-  auto diff_mac = op::ScalarMul(ctx->GetState<Protocol>()->GetKey(),
+  auto diff_mac = op::ScalarMul(ctx->GetStateRaw<Protocol>()->GetKey(),
                                 absl::MakeConstSpan(diff));
   // mac = diff_mac + mac
   op::AddInplace(absl::MakeSpan(mac), absl::MakeConstSpan(diff_mac));
@@ -679,10 +757,10 @@ std::vector<ATy> SetA_cache(std::shared_ptr<Context>& ctx,
 std::vector<ATy> GetA(std::shared_ptr<Context>& ctx, size_t num) {
   auto zero = RandAGet(ctx, num);
   auto [val, mac] = Unpack(absl::MakeConstSpan(zero));
-  auto buff = ctx->GetConnection()->Recv(ctx->NextRank(), "SetA");
+  auto buff = ctx->GetStateRaw<Connection>()->Recv(ctx->NextRank(), "SetA");
   // diff
   auto diff = absl::MakeSpan(reinterpret_cast<PTy*>(buff.data()), num);
-  auto diff_mac = op::ScalarMul(ctx->GetState<Protocol>()->GetKey(),
+  auto diff_mac = op::ScalarMul(ctx->GetStateRaw<Protocol>()->GetKey(),
                                 absl::MakeConstSpan(diff));
   // mac = diff_mac + mac
   op::AddInplace(absl::MakeSpan(mac), absl::MakeConstSpan(diff_mac));
@@ -694,20 +772,20 @@ std::vector<ATy> GetA_cache(std::shared_ptr<Context>& ctx, size_t num) {
 }
 
 std::vector<ATy> RandASet(std::shared_ptr<Context>& ctx, size_t num) {
-  return ctx->GetState<Correlation>()->RandomSet(num).data;
+  return ctx->GetStateRaw<Correlation>()->RandomSet(num).data;
 }
 
 std::vector<ATy> RandASet_cache(std::shared_ptr<Context>& ctx, size_t num) {
-  ctx->GetState<Correlation>()->RandomSet_cache(num);
+  ctx->GetStateRaw<Correlation>()->RandomSet_cache(num);
   return std::vector<ATy>(num);
 }
 
 std::vector<ATy> RandAGet(std::shared_ptr<Context>& ctx, size_t num) {
-  return ctx->GetState<Correlation>()->RandomGet(num).data;
+  return ctx->GetStateRaw<Correlation>()->RandomGet(num).data;
 }
 
 std::vector<ATy> RandAGet_cache(std::shared_ptr<Context>& ctx, size_t num) {
-  ctx->GetState<Correlation>()->RandomGet_cache(num);
+  ctx->GetStateRaw<Correlation>()->RandomGet_cache(num);
   return std::vector<ATy>(num);
 }
 
@@ -755,14 +833,21 @@ std::vector<ATy> ZeroOneA(std::shared_ptr<Context>& ctx, size_t num) {
   auto s = MulAA(ctx, r, r);
   // reveal s
   auto p = A2P_delay(ctx, s);
-  auto root = op::Sqrt(absl::MakeSpan(p));
 
-  auto tmp = DivAP(ctx, r, root);
-  auto one = OnesP(ctx, num);
-  auto res = AddAP(ctx, tmp, one);
-
-  auto inv_two = PTy::Inv(PTy(2));
-  return ScalarMulPA(ctx, inv_two, res);
+  // bit = ( r / sqrt(s) + 1 ) / 2, where 1 / sqrt(s) = s^{(p-3)/4}
+  // i.e. bit = r * c + 1/2 with c = s^{(p-3)/4} / 2, in a single pass
+  const auto inv_two = PTy::Inv(PTy(2));
+  const auto half_val = ctx->GetRank() == 0 ? inv_two : PTy::Zero();
+  const auto half_mac = ctx->GetStateRaw<Protocol>()->GetKey() * inv_two;
+  op::InvSqrt(absl::MakeConstSpan(p), absl::MakeSpan(p));
+  yacl::parallel_for(0, num, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      const auto c = p[i] * inv_two;
+      r[i].val = r[i].val * c + half_val;
+      r[i].mac = r[i].mac * c + half_mac;
+    }
+  });
+  return r;
 }
 
 std::vector<ATy> ZeroOneA_cache(std::shared_ptr<Context>& ctx, size_t num) {
@@ -770,15 +855,8 @@ std::vector<ATy> ZeroOneA_cache(std::shared_ptr<Context>& ctx, size_t num) {
   // s = r * r
   auto s = MulAA_cache(ctx, r, r);
   // reveal s
-  auto p = A2P_delay_cache(ctx, s);
-  auto root = op::Sqrt(absl::MakeSpan(p));
-
-  auto tmp = DivAP_cache(ctx, r, root);
-  auto one = OnesP_cache(ctx, num);
-  auto res = AddAP_cache(ctx, tmp, one);
-
-  auto inv_two = PTy::Inv(PTy(2));
-  return ScalarMulPA_cache(ctx, inv_two, res);
+  [[maybe_unused]] auto p = A2P_delay_cache(ctx, s);
+  return r;
 }
 
 std::vector<ATy> ScalarMulPA([[maybe_unused]] std::shared_ptr<Context>& ctx,
@@ -811,24 +889,41 @@ std::vector<ATy> ScalarMulAP_cache(
   return std::vector<ATy>(num);
 }
 
+namespace {
+
+// \sum 2^i * bits_i, where bits_i = bits[i * num, (i + 1) * num)
+// Horner's rule from the highest bit, i.e. additions only
+std::vector<ATy> ComposeBitsA(absl::Span<const ATy> bits, size_t num) {
+  if (num == 0) {
+    return {};
+  }
+  YACL_ENFORCE(bits.size() % num == 0);
+  const size_t bit_len = bits.size() / num;
+  std::vector<ATy> ret(num, {PTy::Zero(), PTy::Zero()});
+  yacl::parallel_for(0, num, [&](uint64_t bg, uint64_t ed) {
+    for (auto j = bg; j < ed; ++j) {
+      auto val = PTy::Zero();
+      auto mac = PTy::Zero();
+      for (size_t i = bit_len; i > 0; --i) {
+        const auto& bit = bits[(i - 1) * num + j];
+        val = val + val + bit.val;
+        mac = mac + mac + bit.mac;
+      }
+      ret[j] = {val, mac};
+    }
+  });
+  return ret;
+}
+
+}  // namespace
+
 std::pair<std::vector<ATy>, std::vector<ATy>> RandFairA(
     std::shared_ptr<Context>& ctx, size_t num) {
   typedef decltype(std::declval<internal::PTy>().GetVal()) INTEGER;
 
   const size_t bits_num = num * sizeof(INTEGER) * 8;
   auto bits = ZeroOneA(ctx, bits_num);
-  auto bits_span = absl::MakeSpan(bits);
-  std::vector<ATy> ret(num, {PTy::Zero(), PTy::Zero()});
-
-  auto scalar = PTy::One();
-  for (size_t i = 0; i < sizeof(INTEGER) * 8; ++i) {
-    auto cur_bits = bits_span.subspan(i * num, num);
-    auto tmp = ScalarMulPA(ctx, scalar, cur_bits);
-    op::AddInplace(
-        absl::MakeSpan(reinterpret_cast<PTy*>(ret.data()), 2 * num),
-        absl::MakeConstSpan(reinterpret_cast<const PTy*>(tmp.data()), 2 * num));
-    scalar = scalar * PTy(2);
-  }
+  auto ret = ComposeBitsA(bits, num);
   return {ret, bits};
 }
 
@@ -838,39 +933,53 @@ std::pair<std::vector<ATy>, std::vector<ATy>> RandFairA_cache(
 
   const size_t bits_num = num * sizeof(INTEGER) * 8;
   auto bits = ZeroOneA_cache(ctx, bits_num);
-  auto bits_span = absl::MakeSpan(bits);
   std::vector<ATy> ret(num, {PTy::Zero(), PTy::Zero()});
-
-  auto scalar = PTy::One();
-  for (size_t i = 0; i < sizeof(INTEGER) * 8; ++i) {
-    auto cur_bits = bits_span.subspan(i * num, num);
-    [[maybe_unused]] auto tmp = ScalarMulPA_cache(ctx, scalar, cur_bits);
-  }
   return {ret, bits};
 }
 
+// Reveal `in` gradually, from the lowest bit to the highest bit, where `bits`
+// is the bit decomposition given by `RandFairA`. Each round opens the next
+// `GetFairBits()` bit positions (of all elements) by a single `A2P`, i.e. a
+// single exchange && a single batched MAC check.
+//
+// The consistency check ( in - \sum 2^i * bits_i == 0 ) is linear, thus it is
+// opened together with the first group, before any bit is released.
 std::vector<PTy> FairA2P(std::shared_ptr<Context>& ctx,
                          absl::Span<const ATy> in, absl::Span<const ATy> bits) {
   typedef decltype(std::declval<internal::PTy>().GetVal()) INTEGER;
   const size_t num = in.size();
-  YACL_ENFORCE(num * sizeof(INTEGER) * 8 == bits.size());
+  const size_t bit_len = sizeof(INTEGER) * 8;
+  YACL_ENFORCE(num * bit_len == bits.size());
+  const size_t group = ctx->GetStateRaw<Protocol>()->GetFairBits();
+  YACL_ENFORCE(group > 0);
+
+  // check = in - \sum 2^i * bits_i
+  auto check = SubAA(ctx, in, ComposeBitsA(bits, num));
 
   std::vector<PTy> ret(num, PTy::Zero());
   auto scalar = PTy::One();
-  for (size_t i = 0; i < sizeof(INTEGER) * 8; ++i) {
-    auto bits_p = A2P(ctx, bits.subspan(num * i, num));
-    for (const auto& bit_p : bits_p) {
-      YACL_ENFORCE(bit_p == PTy::One() || bit_p == PTy::Zero());
+  for (size_t i = 0; i < bit_len; i += group) {
+    const size_t cur = std::min(group, bit_len - i);
+    std::vector<ATy> to_open(bits.begin() + num * i,
+                             bits.begin() + num * (i + cur));
+    if (i == 0) {
+      to_open.insert(to_open.end(), check.begin(), check.end());
+    }
+    auto open = A2P(ctx, to_open);
+    for (size_t j = 0; j < cur; ++j) {
+      auto bits_p = absl::MakeConstSpan(open).subspan(num * j, num);
+      for (const auto& bit_p : bits_p) {
+        YACL_ENFORCE(bit_p == PTy::One() || bit_p == PTy::Zero());
+      }
+      auto tmp = op::ScalarMul(scalar, bits_p);
+      scalar = scalar * PTy(2);
+      op::AddInplace(absl::MakeSpan(ret), absl::MakeConstSpan(tmp));
+    }
+    if (i == 0) {
+      for (size_t j = num * cur; j < open.size(); ++j) {
+        YACL_ENFORCE(open[j] == PTy::Zero());
+      }
     }
-    auto tmp = op::ScalarMul(scalar, bits_p);
-    scalar = scalar * PTy(2);
-    op::AddInplace(absl::MakeSpan(ret), absl::MakeConstSpan(tmp));
-  }
-
-  auto check = SubAP(ctx, in, ret);
-  auto zeros = A2P(ctx, check);
-  for (const auto& zero : zeros) {
-    YACL_ENFORCE(zero == PTy::Zero());
   }
 
   return ret;
@@ -881,15 +990,17 @@ std::vector<PTy> FairA2P_cache(std::shared_ptr<Context>& ctx,
                                absl::Span<const ATy> bits) {
   typedef decltype(std::declval<internal::PTy>().GetVal()) INTEGER;
   const size_t num = in.size();
-  YACL_ENFORCE(num * sizeof(INTEGER) * 8 == bits.size());
+  const size_t bit_len = sizeof(INTEGER) * 8;
+  YACL_ENFORCE(num * bit_len == bits.size());
+  const size_t group = ctx->GetStateRaw<Protocol>()->GetFairBits();
+  YACL_ENFORCE(group > 0);
 
   std::vector<PTy> ret(num, PTy::Zero());
-  for (size_t i = 0; i < sizeof(INTEGER) * 8; ++i) {
-    [[maybe_unused]] auto bits_p = A2P_cache(ctx, bits.subspan(num * i, num));
+  for (size_t i = 0; i < bit_len; i += group) {
+    const size_t cur = std::min(group, bit_len - i);
+    const size_t open_num = num * cur + (i == 0 ? num : 0);
+    [[maybe_unused]] auto open = A2P_cache(ctx, std::vector<ATy>(open_num));
   }
-
-  auto check = SubAP_cache(ctx, in, ret);
-  [[maybe_unused]] auto zeros = A2P_cache(ctx, check);
   return ret;
 }
 
@@ -898,7 +1009,7 @@ std::vector<ATy> MulAASet(std::shared_ptr<Context>& ctx,
                           absl::Span<const ATy> rhs) {
   YACL_ENFORCE(lhs.size() == rhs.size());
   const size_t size = lhs.size();
-  auto [a, b, c] = ctx->GetState<Correlation>()->BeaverTriple(size);
+  auto [a, b, c] = ctx->GetStateRaw<Correlation>()->BeaverTriple(size);
   auto u = SubAA(ctx, lhs, a);  // x-a
   auto v = SubAA(ctx, rhs, b);  // y-b
   auto u_p = A2P_delay(ctx, u);
@@ -920,7 +1031,7 @@ std::vector<ATy> MulAASet_cache([[maybe_unused]] std::shared_ptr<Context>& ctx,
                                 absl::Span<const ATy> rhs) {
   YACL_ENFORCE(lhs.size() == rhs.size());
   const size_t size = lhs.size();
-  ctx->GetState<Correlation>()->BeaverTriple_cache(size);
+  ctx->GetStateRaw<Correlation>()->BeaverTriple_cache(size);
   std::vector<ATy> a(size);
   std::vector<ATy> b(size);
   std::vector<ATy> c(size);
@@ -945,7 +1056,7 @@ std::vector<ATy> MulAAGet(std::shared_ptr<Context>& ctx,
                           absl::Span<const ATy> rhs) {
   YACL_ENFORCE(lhs.size() == rhs.size());
   const size_t size = lhs.size();
-  auto [a, b, c] = ctx->GetState<Correlation>()->BeaverTriple(size);
+  auto [a, b, c] = ctx->GetStateRaw<Correlation>()->BeaverTriple(size);
   auto u = SubAA(ctx, lhs, a);  // x-a
   auto v = SubAA(ctx, rhs, b);  // y-b
   auto u_p = A2P_delay(ctx, u);
@@ -967,7 +1078,7 @@ std::vector<ATy> MulAAGet_cache([[maybe_unused]] std::shared_ptr<Context>& ctx,
                                 absl::Span<const ATy> rhs) {
   YACL_ENFORCE(lhs.size() == rhs.size());
   const size_t size = lhs.size();
-  ctx->GetState<Correlation>()->BeaverTriple_cache(size);
+  ctx->GetStateRaw<Correlation>()->BeaverTriple_cache(size);
   std::vector<ATy> a(size);
   std::vector<ATy> b(size);
   std::vector<ATy> c(size);
@@ -989,11 +1100,24 @@ std::vector<ATy> MulAAGet_cache([[maybe_unused]] std::shared_ptr<Context>& ctx,
 
 std::vector<PTy> A2P_delay(std::shared_ptr<Context>& ctx,
                            absl::Span<const ATy> in) {
+  std::vector<PTy> ret(in.size());
+  A2P_delay(ctx, in, absl::MakeSpan(ret));
+  return ret;
+}
+
+void A2P_delay(std::shared_ptr<Context>& ctx, absl::Span<const ATy> in,
+               absl::Span<PTy> out) {
   const size_t size = in.size();
-  auto [val, mac] = Unpack(absl::MakeSpan(in));
-  auto conn = ctx->GetState<Connection>();
+  YACL_ENFORCE(size == out.size());
+  auto* arena = ctx->GetArena();
+  Arena::Scope scope(arena);
+
+  auto val = arena->Alloc<PTy>(size);
+  auto mac = arena->Alloc<PTy>(size);
+  Unpack(in, val, mac);
+  auto conn = ctx->GetStateRaw<Connection>();
   auto val_bv = yacl::ByteContainerView(val.data(), size * sizeof(PTy));
-  std::vector<PTy> real_val(size);
+  auto real_val = out;
 
   auto buf = conn->Exchange(val_bv);
   op::Add(absl::MakeConstSpan(reinterpret_cast<const PTy*>(buf.data()), size),
@@ -1001,7 +1125,8 @@ std::vector<PTy> A2P_delay(std::shared_ptr<Context>& ctx,
 
   typedef decltype(std::declval<internal::PTy>().GetVal()) INTEGER;
 
-  std::vector<INTEGER> randomness(size, 0);
+  auto randomness = arena->Alloc<INTEGER>(size);
+  std::fill(randomness.begin(), randomness.end(), INTEGER(0));
   std::transform(randomness.begin(), randomness.end(),
                  reinterpret_cast<INTEGER*>(val.data()), randomness.begin(),
                  std::bit_xor<INTEGER>());
@@ -1015,9 +1140,11 @@ std::vector<PTy> A2P_delay(std::shared_ptr<Context>& ctx,
   auto seeds = yacl::crypto::Sm3(yacl::ByteContainerView(
       randomness.data(), randomness.size() * sizeof(INTEGER)));
   uint128_t sync_seed = 0;
-  std::memcpy(&seeds, &sync_seed, sizeof(uint128_t));
+  std::memcpy(&sync_seed, seeds.data(), sizeof(uint128_t));
 
-  auto coef = internal::op::Rand(sync_seed, size);
+  auto coef = arena->Alloc<PTy>(size);
+  auto prg = yacl::crypto::Prg<uint8_t>(sync_seed);
+  internal::op::Rand(prg, coef);
 
   // linear combination
   auto real_val_affine =
@@ -1025,16 +1152,15 @@ std::vector<PTy> A2P_delay(std::shared_ptr<Context>& ctx,
   auto mac_affine =
       internal::op::InPro(absl::MakeSpan(coef), absl::MakeSpan(mac));
 
-  auto key = ctx->GetState<Protocol>()->GetKey();
+  auto key = ctx->GetStateRaw<Protocol>()->GetKey();
   auto zero_mac = mac_affine - real_val_affine * key;
 
   // Append to Buffer
   if (ctx->GetRank() == 0) {
-    ctx->GetState<Protocol>()->CheckBufferAppend(zero_mac);
+    ctx->GetStateRaw<Protocol>()->CheckBufferAppend(zero_mac);
   } else {
-    ctx->GetState<Protocol>()->CheckBufferAppend(PTy::Neg(zero_mac));
+    ctx->GetStateRaw<Protocol>()->CheckBufferAppend(PTy::Neg(zero_mac));
   }
-  return real_val;
 }
 
 std::vector<PTy> A2P_delay_cache([[maybe_unused]] std::shared_ptr<Context>& ctx,
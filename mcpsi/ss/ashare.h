@@ -217,4 +217,25 @@ std::vector<PTy> A2P_delay(std::shared_ptr<Context>& ctx,
 std::vector<PTy> A2P_delay_cache(std::shared_ptr<Context>& ctx,
                                  absl::Span<const ATy> in);
 
+// the same, into the given storage (e.g. the arena of the context), without
+// allocating && zero-initializing the result
+// NOTE: `out` could alias the A-share inputs
+void AddAA(std::shared_ptr<Context>& ctx, absl::Span<const ATy> lhs,
+           absl::Span<const ATy> rhs, absl::Span<ATy> out);
+void SubAA(std::shared_ptr<Context>& ctx, absl::Span<const ATy> lhs,
+           absl::Span<const ATy> rhs, absl::Span<ATy> out);
+void MulAA(std::shared_ptr<Context>& ctx, absl::Span<const ATy> lhs,
+           absl::Span<const ATy> rhs, absl::Span<ATy> out);
+void NegA(std::shared_ptr<Context>& ctx, absl::Span<const ATy> in,
+          absl::Span<ATy> out);
+void ZerosA(std::shared_ptr<Context>& ctx, absl::Span<ATy> out);
+void MulAP(std::shared_ptr<Context>& ctx, absl::Span<const ATy> lhs,
+           absl::Span<const PTy> rhs, absl::Span<ATy> out);
+void MulPA(std::shared_ptr<Context>& ctx, absl::Span<const PTy> lhs,
+           absl::Span<const ATy> rhs, absl::Span<ATy> out);
+void P2A(std::shared_ptr<Context>& ctx, absl::Span<const PTy> in,
+         absl::Span<ATy> out);
+void A2P_delay(std::shared_ptr<Context>& ctx, absl::Span<const ATy> in,
+               absl::Span<PTy> out);
+
 }  // namespace mcpsi::internal
@@ -0,0 +1,99 @@
+#include "benchmark/benchmark.h"
+#include "mcpsi/ss/protocol.h"
+#include "mcpsi/utils/bench_util.h"
+
+namespace mcpsi {
+
+namespace {
+
+void BM_RandA(benchmark::State& state) {
+  const size_t num = state.range(0);
+  yacl::set_num_threads(state.range(1));
+  auto& ctxs = bench::GetBenchContext();
+  auto begin = bench::GetCommStats(ctxs[0]);
+  for (auto _ : state) {
+    bench::RunParties(ctxs, [&](std::shared_ptr<Context>& ctx) {
+      return ctx->GetState<Protocol>()->RandA(num);
+    });
+  }
+  bench::ReportCounters(state, num, begin, bench::GetCommStats(ctxs[0]));
+}
+
+void BM_MulAA(benchmark::State& state) {
+  const size_t num = state.range(0);
+  yacl::set_num_threads(state.range(1));
+  auto& ctxs = bench::GetBenchContext();
+  // inputs are generated outside the timed loop
+  auto rand = [&](std::shared_ptr<Context>& ctx) {
+    return ctx->GetState<Protocol>()->RandA(num);
+  };
+  auto lhs = bench::RunPartiesAll(ctxs, rand);
+  auto rhs = bench::RunPartiesAll(ctxs, rand);
+  auto begin = bench::GetCommStats(ctxs[0]);
+  for (auto _ : state) {
+    bench::RunParties(ctxs, [&](std::shared_ptr<Context>& ctx) {
+      auto rank = ctx->GetRank();
+      return ctx->GetState<Protocol>()->Mul(lhs[rank], rhs[rank]);
+    });
+  }
+  bench::ReportCounters(state, num, begin, bench::GetCommStats(ctxs[0]));
+}
+
+void BM_A2P(benchmark::State& state) {
+  const size_t num = state.range(0);
+  yacl::set_num_threads(state.range(1));
+  auto& ctxs = bench::GetBenchContext();
+  // inputs are generated outside the timed loop
+  auto in = bench::RunPartiesAll(ctxs, [&](std::shared_ptr<Context>& ctx) {
+    return ctx->GetState<Protocol>()->RandA(num);
+  });
+  auto begin = bench::GetCommStats(ctxs[0]);
+  for (auto _ : state) {
+    bench::RunParties(ctxs, [&](std::shared_ptr<Context>& ctx) {
+      return ctx->GetState<Protocol>()->A2P(in[ctx->GetRank()]);
+    });
+  }
+  bench::ReportCounters(state, num, begin, bench::GetCommStats(ctxs[0]));
+}
+
+void BM_SetGetA(benchmark::State& state) {
+  const size_t num = state.range(0);
+  yacl::set_num_threads(state.range(1));
+  auto& ctxs = bench::GetBenchContext();
+  auto in = OP::Rand(num);
+  auto begin = bench::GetCommStats(ctxs[0]);
+  for (auto _ : state) {
+    bench::RunParties(ctxs, [&](std::shared_ptr<Context>& ctx) {
+      auto prot = ctx->GetState<Protocol>();
+      return ctx->GetRank() == 0 ? prot->SetA(in) : prot->GetA(num);
+    });
+  }
+  bench::ReportCounters(state, num, begin, bench::GetCommStats(ctxs[0]));
+}
+
+void BM_ShuffleA(benchmark::State& state) {
+  const size_t num = state.range(0);
+  yacl::set_num_threads(state.range(1));
+  auto& ctxs = bench::GetBenchContext();
+  // inputs are generated outside the timed loop
+  auto in = bench::RunPartiesAll(ctxs, [&](std::shared_ptr<Context>& ctx) {
+    return ctx->GetState<Protocol>()->RandA(num);
+  });
+  auto begin = bench::GetCommStats(ctxs[0]);
+  for (auto _ : state) {
+    bench::RunParties(ctxs, [&](std::shared_ptr<Context>& ctx) {
+      return ctx->GetState<Protocol>()->ShuffleA(in[ctx->GetRank()]);
+    });
+  }
+  bench::ReportCounters(state, num, begin, bench::GetCommStats(ctxs[0]));
+}
+
+}  // namespace
+
+BENCHMARK(BM_RandA)->Apply(bench::SizeAndThreadArgs);
+BENCHMARK(BM_MulAA)->Apply(bench::SizeAndThreadArgs);
+BENCHMARK(BM_A2P)->Apply(bench::SizeAndThreadArgs);
+BENCHMARK(BM_SetGetA)->Apply(bench::SizeAndThreadArgs);
+BENCHMARK(BM_ShuffleA)->Apply(bench::SizeAndThreadArgs);
+
+}  // namespace mcpsi
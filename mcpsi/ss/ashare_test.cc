@@ -394,4 +394,37 @@ TEST(ProtocolTest, FairnessTest) {
   }
 }
 
+TEST(ProtocolTest, FairnessGroupTest) {
+  auto context = TestParam::GetContext();
+  size_t num = 100;
+  // 7 does not divide 256, the last round releases the remaining bits
+  for (size_t fair_bits : {7, 64}) {
+    auto rank0 = std::async([&] {
+      auto prot = context[0]->GetState<Protocol>();
+      prot->SetFairBits(fair_bits);
+      auto [rand_a, bits] = prot->RandFairA(num);
+      auto rand_p = prot->FairA2P(rand_a, bits);
+      auto ret_p = prot->A2P(rand_a);
+      prot->SetFairBits(1);
+      return std::make_pair(rand_p, ret_p);
+    });
+    auto rank1 = std::async([&] {
+      auto prot = context[1]->GetState<Protocol>();
+      prot->SetFairBits(fair_bits);
+      auto [rand_a, bits] = prot->RandFairA(num);
+      auto rand_p = prot->FairA2P(rand_a, bits);
+      auto ret_p = prot->A2P(rand_a);
+      prot->SetFairBits(1);
+      return std::make_pair(rand_p, ret_p);
+    });
+    auto [r0, p0] = rank0.get();
+    auto [r1, p1] = rank1.get();
+
+    for (size_t i = 0; i < num; ++i) {
+      EXPECT_EQ(r0[i], r1[i]);
+      EXPECT_EQ(r0[i], p0[i]);
+    }
+  }
+}
+
 };  // namespace mcpsi
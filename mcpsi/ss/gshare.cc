@@ -3,6 +3,7 @@
 #include <unordered_set>
 #include <vector>
 
+#include "mcpsi/context/arena.h"
 #include "mcpsi/cr/cr.h"
 #include "mcpsi/ss/protocol.h"
 #include "yacl/base/byte_container_view.h"
@@ -15,7 +16,7 @@ namespace mcpsi::internal {
 std::vector<ATy> DyExp(std::shared_ptr<Context> &ctx,
                        absl::Span<const ATy> in) {
   const size_t num = in.size();
-  auto prot = ctx->GetState<Protocol>();
+  auto prot = ctx->GetStateRaw<Protocol>();
 
   // DY-PRF = g^{1/(k+x)}
   auto prf_k = prot->GetPrfK();  // distributed key for PRF (A-share)
@@ -28,7 +29,7 @@ std::vector<ATy> DyExp(std::shared_ptr<Context> &ctx,
 std::vector<ATy> DyExp_cache(std::shared_ptr<Context> &ctx,
                              absl::Span<const ATy> in) {
   const size_t num = in.size();
-  auto prot = ctx->GetState<Protocol>();
+  auto prot = ctx->GetStateRaw<Protocol>();
 
   // DY-PRF = g^{1/(k+x)}
   auto prf_k = prot->GetPrfK();  // distributed key for PRF (A-share)
@@ -41,39 +42,51 @@ std::vector<ATy> DyExp_cache(std::shared_ptr<Context> &ctx,
 std::vector<ATy> DyExpGet(std::shared_ptr<Context> &ctx, size_t num) {
   // auto inA = GetA(ctx, num);
   // return DyExp(ctx, inA);
-  auto prot = ctx->GetState<Protocol>();
-  auto conn = ctx->GetState<Connection>();
-  auto cr = ctx->GetState<Correlation>();
-  auto [a, b, c, r, prf_k] = cr->DyBeaverTripleGet(num);
+  auto prot = ctx->GetStateRaw<Protocol>();
+  auto conn = ctx->GetStateRaw<Connection>();
+  auto cr = ctx->GetStateRaw<Correlation>();
+  auto *arena = ctx->GetArena();
+  Arena::Scope scope(arena);
+
+  auto a = arena->Alloc<ATy>(num);
+  auto b = arena->Alloc<ATy>(num);
+  auto c = arena->Alloc<ATy>(num);
+  auto r = arena->Alloc<ATy>(num);
+  auto prf_k = cr->FillDyBeaverTripleGet(a, b, c, r);
 
   YACL_ENFORCE(prf_k.val == prot->GetPrfK().val);
 
-  auto [b_val, b_mac] = Unpack(b);
-  auto [c_val, c_mac] = Unpack(c);
+  auto b_val = arena->Alloc<PTy>(num);
+  auto b_mac = arena->Alloc<PTy>(num);
+  auto c_val = arena->Alloc<PTy>(num);
+  auto c_mac = arena->Alloc<PTy>(num);
+  Unpack(absl::MakeConstSpan(b), b_val, b_mac);
+  Unpack(absl::MakeConstSpan(c), c_val, c_mac);
 
   auto buff = conn->Recv(ctx->NextRank(), "DyExpSetGet");
   auto diff = absl::MakeSpan(reinterpret_cast<PTy *>(buff.data()), num);
 
-  auto new_b_mac = MulPP(ctx, b_mac, diff);
-  Pack(absl::MakeConstSpan(b_val), absl::MakeConstSpan(new_b_mac),
-       absl::MakeSpan(b));
+  op::MulInplace(b_mac, diff);
+  Pack(b_val, b_mac, b);
   prot->AShareBufferAppend(b);
 
-  auto new_c_val = MulPP(ctx, c_val, diff);
-  auto new_c_mac = MulPP(ctx, c_mac, diff);
-
-  Pack(absl::MakeConstSpan(new_c_val), absl::MakeConstSpan(new_c_mac),
-       absl::MakeSpan(c));
+  op::MulInplace(c_val, diff);
+  op::MulInplace(c_mac, diff);
+  Pack(c_val, c_mac, c);
 
-  auto val = AddAA(ctx, r, c);
-  auto val_p = A2P(ctx, val);
-  auto inv_p = InvP(ctx, val_p);
+  // c <- r + c
+  AddAA(ctx, r, c, c);
+  auto val_p = A2P(ctx, c);
+  auto inv_p = arena->Alloc<PTy>(num);
+  op::Inv(val_p, inv_p);
 
-  return MulAP(ctx, a, inv_p);
+  std::vector<ATy> ret(num);
+  MulAP(ctx, a, inv_p, absl::MakeSpan(ret));
+  return ret;
 }
 
 std::vector<ATy> DyExpGet_cache(std::shared_ptr<Context> &ctx, size_t num) {
-  auto cr = ctx->GetState<Correlation>();
+  auto cr = ctx->GetStateRaw<Correlation>();
 
   cr->DyBeaverTripleGet_cache(num);
   auto inv_p = ZerosA_cache(ctx, num);
@@ -84,46 +97,59 @@ std::vector<ATy> DyExpSet(std::shared_ptr<Context> &ctx,
                           absl::Span<const PTy> in) {
   // auto inA = SetA(ctx, in);
   const size_t num = in.size();
-  auto prot = ctx->GetState<Protocol>();
-  auto conn = ctx->GetState<Connection>();
-  auto cr = ctx->GetState<Correlation>();
-  auto [a, b, c, r, prf_k] = cr->DyBeaverTripleSet(num);
+  auto prot = ctx->GetStateRaw<Protocol>();
+  auto conn = ctx->GetStateRaw<Connection>();
+  auto cr = ctx->GetStateRaw<Correlation>();
+  auto *arena = ctx->GetArena();
+  Arena::Scope scope(arena);
+
+  auto a = arena->Alloc<ATy>(num);
+  auto b = arena->Alloc<ATy>(num);
+  auto c = arena->Alloc<ATy>(num);
+  auto r = arena->Alloc<ATy>(num);
+  auto prf_k = cr->FillDyBeaverTripleSet(a, b, c, r);
 
   YACL_ENFORCE(prf_k.val == prot->GetPrfK().val);
 
-  auto [b_val, b_mac] = Unpack(b);
-  auto [c_val, c_mac] = Unpack(c);
+  auto b_val = arena->Alloc<PTy>(num);
+  auto b_mac = arena->Alloc<PTy>(num);
+  auto c_val = arena->Alloc<PTy>(num);
+  auto c_mac = arena->Alloc<PTy>(num);
+  Unpack(absl::MakeConstSpan(b), b_val, b_mac);
+  Unpack(absl::MakeConstSpan(c), c_val, c_mac);
 
-  auto diff = DivPP(ctx, in, b_val);
+  auto diff = arena->Alloc<PTy>(num);
+  op::Div(in, b_val, diff);
 
   conn->SendAsync(
       conn->NextRank(),
       yacl::ByteContainerView(diff.data(), diff.size() * sizeof(PTy)),
       "DyExpSetGet");
 
-  auto new_b_mac = MulPP(ctx, b_mac, diff);
-  Pack(absl::MakeConstSpan(in), absl::MakeConstSpan(new_b_mac),
-       absl::MakeSpan(b));
+  op::MulInplace(b_mac, diff);
+  Pack(in, b_mac, b);
   prot->AShareBufferAppend(b);
 
-  auto new_c_val = MulPP(ctx, c_val, diff);
-  auto new_c_mac = MulPP(ctx, c_mac, diff);
-
-  Pack(absl::MakeConstSpan(new_c_val), absl::MakeConstSpan(new_c_mac),
-       absl::MakeSpan(c));
+  op::MulInplace(c_val, diff);
+  op::MulInplace(c_mac, diff);
+  Pack(c_val, c_mac, c);
 
-  auto val = AddAA(ctx, r, c);
-  auto val_p = A2P(ctx, val);
-  auto inv_p = InvP(ctx, val_p);
+  // c <- r + c
+  AddAA(ctx, r, c, c);
+  auto val_p = A2P(ctx, c);
+  auto inv_p = arena->Alloc<PTy>(num);
+  op::Inv(val_p, inv_p);
 
-  return MulAP(ctx, a, inv_p);
+  std::vector<ATy> ret(num);
+  MulAP(ctx, a, inv_p, absl::MakeSpan(ret));
+  return ret;
   // return DyExp(ctx, inA);
 }
 
 std::vector<ATy> DyExpSet_cache(std::shared_ptr<Context> &ctx,
                                 absl::Span<const PTy> in) {
   const size_t num = in.size();
-  auto cr = ctx->GetState<Correlation>();
+  auto cr = ctx->GetStateRaw<Correlation>();
   cr->DyBeaverTripleSet_cache(num);
   auto zeros = ZerosA_cache(ctx, num);
 
@@ -134,7 +160,7 @@ std::vector<ATy> DyExpSet_cache(std::shared_ptr<Context> &ctx,
 std::vector<ATy> ScalarDyExp(std::shared_ptr<Context> &ctx, const ATy &scalar,
                              absl::Span<const ATy> in) {
   const size_t num = in.size();
-  auto prot = ctx->GetState<Protocol>();
+  auto prot = ctx->GetStateRaw<Protocol>();
   auto prf_k = prot->GetPrfK();  // distributed key for PRF (A-share)
 
   // in + k
@@ -157,7 +183,7 @@ std::vector<ATy> ScalarDyExp_cache(std::shared_ptr<Context> &ctx,
                                    const ATy &scalar,
                                    absl::Span<const ATy> in) {
   const size_t num = in.size();
-  auto prot = ctx->GetState<Protocol>();
+  auto prot = ctx->GetStateRaw<Protocol>();
   auto prf_k = prot->GetPrfK();  // distributed key for PRF (A-share)
 
   // in + k
@@ -176,32 +202,127 @@ std::vector<ATy> ScalarDyExp_cache(std::shared_ptr<Context> &ctx,
                      absl::MakeConstSpan(scalar_inv_pub));
 }
 
+namespace {
+
+// open scalar / t, where t is a (fresh) random mask, reveals nothing
+PTy MaskedScalar(std::shared_ptr<Context> &ctx, const ATy &scalar,
+                 const ATy &t) {
+  auto inv_t = InvA(ctx, absl::MakeConstSpan(&t, 1));
+  auto mul = MulAA(ctx, absl::MakeConstSpan(&scalar, 1), inv_t);
+  return A2P(ctx, mul)[0];
+}
+
+void MaskedScalar_cache(std::shared_ptr<Context> &ctx, const ATy &scalar,
+                        const ATy &t) {
+  auto inv_t = InvA_cache(ctx, absl::MakeConstSpan(&t, 1));
+  auto mul = MulAA_cache(ctx, absl::MakeConstSpan(&scalar, 1), inv_t);
+  A2P_cache(ctx, mul);
+}
+
+}  // namespace
+
+// scalar / (x + k) = (a * t) * (scalar / t) * (a * (x + k))^{-1}, only O(1)
+// more than DyExpGet / DyExpSet
 std::vector<ATy> ScalarDyExpGet(std::shared_ptr<Context> &ctx,
                                 const ATy &scalar, size_t num) {
-  auto inA = GetA(ctx, num);
-  return ScalarDyExp(ctx, scalar, inA);
+  auto prot = ctx->GetStateRaw<Protocol>();
+  auto conn = ctx->GetStateRaw<Connection>();
+  auto cr = ctx->GetStateRaw<Correlation>();
+  auto [a, b, c, r, prf_k, s, t] = cr->ScalarDyBeaverTripleGet(num);
+
+  YACL_ENFORCE(prf_k.val == prot->GetPrfK().val);
+
+  auto [b_val, b_mac] = Unpack(b);
+  auto [c_val, c_mac] = Unpack(c);
+
+  auto buff = conn->Recv(ctx->NextRank(), "ScalarDyExpSetGet");
+  auto diff = absl::MakeSpan(reinterpret_cast<PTy *>(buff.data()), num);
+
+  auto new_b_mac = MulPP(ctx, b_mac, diff);
+  Pack(absl::MakeConstSpan(b_val), absl::MakeConstSpan(new_b_mac),
+       absl::MakeSpan(b));
+  prot->AShareBufferAppend(b);
+
+  auto new_c_val = MulPP(ctx, c_val, diff);
+  auto new_c_mac = MulPP(ctx, c_mac, diff);
+
+  Pack(absl::MakeConstSpan(new_c_val), absl::MakeConstSpan(new_c_mac),
+       absl::MakeSpan(c));
+
+  auto val = AddAA(ctx, r, c);
+  auto val_p = A2P(ctx, val);
+  auto inv_p = InvP(ctx, val_p);
+
+  auto ratio = MaskedScalar(ctx, scalar, t);
+  op::ScalarMulInplace(ratio, absl::MakeSpan(inv_p));
+  return MulAP(ctx, s, inv_p);
 }
+
 std::vector<ATy> ScalarDyExpGet_cache(std::shared_ptr<Context> &ctx,
                                       const ATy &scalar, size_t num) {
-  auto inA = GetA_cache(ctx, num);
-  return ScalarDyExp_cache(ctx, scalar, inA);
+  auto cr = ctx->GetStateRaw<Correlation>();
+
+  cr->ScalarDyBeaverTripleGet_cache(num);
+  auto t = ZerosA_cache(ctx, 1);
+  MaskedScalar_cache(ctx, scalar, t[0]);
+  return ZerosA_cache(ctx, num);
 }
 
 std::vector<ATy> ScalarDyExpSet(std::shared_ptr<Context> &ctx,
                                 const ATy &scalar, absl::Span<const PTy> in) {
-  auto inA = SetA(ctx, in);
-  return ScalarDyExp(ctx, scalar, inA);
+  const size_t num = in.size();
+  auto prot = ctx->GetStateRaw<Protocol>();
+  auto conn = ctx->GetStateRaw<Connection>();
+  auto cr = ctx->GetStateRaw<Correlation>();
+  auto [a, b, c, r, prf_k, s, t] = cr->ScalarDyBeaverTripleSet(num);
+
+  YACL_ENFORCE(prf_k.val == prot->GetPrfK().val);
+
+  auto [b_val, b_mac] = Unpack(b);
+  auto [c_val, c_mac] = Unpack(c);
+
+  auto diff = DivPP(ctx, in, b_val);
+
+  conn->SendAsync(
+      conn->NextRank(),
+      yacl::ByteContainerView(diff.data(), diff.size() * sizeof(PTy)),
+      "ScalarDyExpSetGet");
+
+  auto new_b_mac = MulPP(ctx, b_mac, diff);
+  Pack(absl::MakeConstSpan(in), absl::MakeConstSpan(new_b_mac),
+       absl::MakeSpan(b));
+  prot->AShareBufferAppend(b);
+
+  auto new_c_val = MulPP(ctx, c_val, diff);
+  auto new_c_mac = MulPP(ctx, c_mac, diff);
+
+  Pack(absl::MakeConstSpan(new_c_val), absl::MakeConstSpan(new_c_mac),
+       absl::MakeSpan(c));
+
+  auto val = AddAA(ctx, r, c);
+  auto val_p = A2P(ctx, val);
+  auto inv_p = InvP(ctx, val_p);
+
+  auto ratio = MaskedScalar(ctx, scalar, t);
+  op::ScalarMulInplace(ratio, absl::MakeSpan(inv_p));
+  return MulAP(ctx, s, inv_p);
 }
+
 std::vector<ATy> ScalarDyExpSet_cache(std::shared_ptr<Context> &ctx,
                                       const ATy &scalar,
                                       absl::Span<const PTy> in) {
-  auto inA = SetA_cache(ctx, in);
-  return ScalarDyExp_cache(ctx, scalar, inA);
+  const size_t num = in.size();
+  auto cr = ctx->GetStateRaw<Correlation>();
+
+  cr->ScalarDyBeaverTripleSet_cache(num);
+  auto t = ZerosA_cache(ctx, 1);
+  MaskedScalar_cache(ctx, scalar, t[0]);
+  return ZerosA_cache(ctx, num);
 }
 
 std::vector<MTy> A2M(std::shared_ptr<Context> &ctx, absl::Span<const ATy> in) {
   const size_t num = in.size();
-  auto prot = ctx->GetState<Protocol>();
+  auto prot = ctx->GetStateRaw<Protocol>();
   auto Ggroup = prot->GetGroup();
 
   auto ret = std::vector<MTy>(num);
@@ -229,9 +350,9 @@ std::vector<MTy> A2M_cache([[maybe_unused]] std::shared_ptr<Context> &ctx,
 
 std::vector<GTy> M2G(std::shared_ptr<Context> &ctx, absl::Span<const MTy> in) {
   const size_t num = in.size();
-  auto spdz_key = ctx->GetState<Protocol>()->GetKey();
+  auto spdz_key = ctx->GetStateRaw<Protocol>()->GetKey();
 
-  auto prot = ctx->GetState<Protocol>();
+  auto prot = ctx->GetStateRaw<Protocol>();
   auto Ggroup = prot->GetGroup();
   auto prf_zero = Ggroup->Sub(Ggroup->GetGenerator(), Ggroup->GetGenerator());
   // auto prf_g = prot->GetPrfG();  // generator for PRF
@@ -253,7 +374,7 @@ std::vector<GTy> M2G(std::shared_ptr<Context> &ctx, absl::Span<const MTy> in) {
   //                          GTy_size);
   // }
 
-  auto conn = ctx->GetConnection();
+  auto conn = ctx->GetStateRaw<Connection>();
   yacl::Buffer buf;
 
   if (ctx->GetRank() == 0) {
@@ -282,7 +403,7 @@ std::vector<GTy> M2G(std::shared_ptr<Context> &ctx, absl::Span<const MTy> in) {
   //   Ggroup->AddInplace(&ret[i], in[i].val);
   // }
 
-  auto sync_seed = conn->SyncSeed();
+  auto sync_seed = conn->DrawCoin();
   auto coef = op::Rand(sync_seed, num);
 
   GTy real_val_affine = Ggroup->CopyPoint(prf_zero);  // zero
@@ -400,6 +521,29 @@ std::vector<GTy> A2G_cache(std::shared_ptr<Context> &ctx,
   return M2G_cache(ctx, in_m);
 }
 
+std::vector<GTy> ScalarMulPG(std::shared_ptr<Context> &ctx, const PTy &scalar,
+                             absl::Span<const GTy> in) {
+  const size_t num = in.size();
+  auto Ggroup = ctx->GetStateRaw<Protocol>()->GetGroup();
+  // convert the scalar once, shared by all threads
+  const auto scalar_mp = ym::MPInt(scalar.GetVal());
+
+  std::vector<GTy> ret(num);
+  yacl::parallel_for(0, num, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      ret[i] = Ggroup->Mul(in[i], scalar_mp);
+    }
+  });
+  return ret;
+}
+
+std::vector<GTy> ScalarMulPG_cache(
+    [[maybe_unused]] std::shared_ptr<Context> &ctx,
+    [[maybe_unused]] const PTy &scalar, absl::Span<const GTy> in) {
+  const size_t num = in.size();
+  return std::vector<GTy>(num);
+}
+
 // DY-OPRF
 std::vector<GTy> DyOprf(std::shared_ptr<Context> &ctx,
                         absl::Span<const ATy> in) {
@@ -474,7 +618,7 @@ std::vector<GTy> ScalarDyOprfSet_cache(std::shared_ptr<Context> &ctx,
 std::vector<ATy> CPSI(std::shared_ptr<Context> &ctx, absl::Span<const ATy> set0,
                       absl::Span<const ATy> set1, absl::Span<const ATy> data) {
   YACL_ENFORCE(set1.size() == data.size());
-  auto prot = ctx->GetState<Protocol>();
+  auto prot = ctx->GetStateRaw<Protocol>();
   auto Ggroup = prot->GetGroup();
 
   auto shuffle0 = ShuffleA(ctx, set0);
@@ -533,7 +677,7 @@ std::vector<ATy> FairCPSI(std::shared_ptr<Context> &ctx,
                           absl::Span<const ATy> set1,
                           absl::Span<const ATy> data) {
   YACL_ENFORCE(set1.size() == data.size());
-  auto prot = ctx->GetState<Protocol>();
+  auto prot = ctx->GetStateRaw<Protocol>();
   auto Ggroup = prot->GetGroup();
 
   auto shuffle0 = ShuffleA(ctx, set0);
@@ -546,10 +690,7 @@ std::vector<ATy> FairCPSI(std::shared_ptr<Context> &ctx,
   auto reveal1 = DyOprf(ctx, shuffle1);
 
   auto scalar_p = FairA2P(ctx, scalar_a, bits);
-  auto scalar_mp = ym::MPInt(scalar_p[0].GetVal());
-  for (size_t i = 0; i < reveal1.size(); ++i) {
-    Ggroup->MulInplace(&reveal1[i], scalar_mp);
-  }
+  reveal1 = ScalarMulPG(ctx, scalar_p[0], reveal1);
 
   auto group_hash = [&Ggroup](const GTy &val) {
     return Ggroup->HashPoint(val);
@@ -30,6 +30,7 @@ std::vector<ATy> ScalarDyExp(std::shared_ptr<Context>& ctx, const ATy& scalar,
 std::vector<ATy> ScalarDyExp_cache(std::shared_ptr<Context>& ctx,
                                    const ATy& scalar, absl::Span<const ATy> in);
 
+// from ScalarDyBeaver correlations, one opening per item as DyExpGet / DyExpSet
 std::vector<ATy> ScalarDyExpGet(std::shared_ptr<Context>& ctx,
                                 const ATy& scalar, size_t num);
 std::vector<ATy> ScalarDyExpGet_cache(std::shared_ptr<Context>& ctx,
@@ -55,6 +56,13 @@ std::vector<GTy> A2G(std::shared_ptr<Context>& ctx, absl::Span<const ATy> in);
 std::vector<GTy> A2G_cache(std::shared_ptr<Context>& ctx,
                            absl::Span<const ATy> in);
 
+// public scalar * public points (same scalar for all points), e.g. unblind
+// the revealed DY-OPRF values in fair CPSI
+std::vector<GTy> ScalarMulPG(std::shared_ptr<Context>& ctx, const PTy& scalar,
+                             absl::Span<const GTy> in);
+std::vector<GTy> ScalarMulPG_cache(std::shared_ptr<Context>& ctx,
+                                   const PTy& scalar, absl::Span<const GTy> in);
+
 // DY-OPRF = DY-exponent + A2M + M2G
 std::vector<GTy> DyOprf(std::shared_ptr<Context>& ctx,
                         absl::Span<const ATy> in);
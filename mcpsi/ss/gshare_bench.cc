@@ -0,0 +1,88 @@
+#include "benchmark/benchmark.h"
+#include "mcpsi/ss/protocol.h"
+#include "mcpsi/utils/bench_util.h"
+
+namespace mcpsi {
+
+namespace {
+
+void BM_DyExpSetGet(benchmark::State& state) {
+  const size_t num = state.range(0);
+  yacl::set_num_threads(state.range(1));
+  auto& ctxs = bench::GetBenchContext();
+  auto in = OP::Rand(num);
+  auto begin = bench::GetCommStats(ctxs[0]);
+  for (auto _ : state) {
+    bench::RunParties(ctxs, [&](std::shared_ptr<Context>& ctx) {
+      auto prot = ctx->GetState<Protocol>();
+      return ctx->GetRank() == 0 ? prot->DyExpSet(in) : prot->DyExpGet(num);
+    });
+  }
+  bench::ReportCounters(state, num, begin, bench::GetCommStats(ctxs[0]));
+}
+
+void BM_A2G(benchmark::State& state) {
+  const size_t num = state.range(0);
+  yacl::set_num_threads(state.range(1));
+  auto& ctxs = bench::GetBenchContext();
+  // inputs are generated outside the timed loop
+  auto in = bench::RunPartiesAll(ctxs, [&](std::shared_ptr<Context>& ctx) {
+    return ctx->GetState<Protocol>()->RandA(num);
+  });
+  auto begin = bench::GetCommStats(ctxs[0]);
+  for (auto _ : state) {
+    bench::RunParties(ctxs, [&](std::shared_ptr<Context>& ctx) {
+      return ctx->GetState<Protocol>()->A2G(in[ctx->GetRank()]);
+    });
+  }
+  bench::ReportCounters(state, num, begin, bench::GetCommStats(ctxs[0]));
+}
+
+void BM_DyOprf(benchmark::State& state) {
+  const size_t num = state.range(0);
+  yacl::set_num_threads(state.range(1));
+  auto& ctxs = bench::GetBenchContext();
+  // inputs are generated outside the timed loop
+  auto in = bench::RunPartiesAll(ctxs, [&](std::shared_ptr<Context>& ctx) {
+    return ctx->GetState<Protocol>()->RandA(num);
+  });
+  auto begin = bench::GetCommStats(ctxs[0]);
+  for (auto _ : state) {
+    bench::RunParties(ctxs, [&](std::shared_ptr<Context>& ctx) {
+      return ctx->GetState<Protocol>()->DyOprf(in[ctx->GetRank()]);
+    });
+  }
+  bench::ReportCounters(state, num, begin, bench::GetCommStats(ctxs[0]));
+}
+
+// end-to-end circuit PSI (P0 owns set0, P1 owns set1 && data)
+void BM_CPSI(benchmark::State& state) {
+  const size_t num = state.range(0);
+  yacl::set_num_threads(state.range(1));
+  auto& ctxs = bench::GetBenchContext();
+  auto set0 = OP::Rand(num);
+  auto set1 = OP::Rand(num);
+  auto data = OP::Ones(num);
+  memcpy(set1.data(), set0.data(), num / 2 * sizeof(PTy));
+  auto begin = bench::GetCommStats(ctxs[0]);
+  for (auto _ : state) {
+    bench::RunParties(ctxs, [&](std::shared_ptr<Context>& ctx) {
+      auto prot = ctx->GetState<Protocol>();
+      auto rank = ctx->GetRank();
+      auto share0 = rank == 0 ? prot->SetA(set0) : prot->GetA(num);
+      auto share1 = rank == 1 ? prot->SetA(set1) : prot->GetA(num);
+      auto secret = rank == 1 ? prot->SetA(data) : prot->GetA(num);
+      return prot->CPSI(share0, share1, secret);
+    });
+  }
+  bench::ReportCounters(state, num, begin, bench::GetCommStats(ctxs[0]));
+}
+
+}  // namespace
+
+BENCHMARK(BM_DyExpSetGet)->Apply(bench::SizeAndThreadArgs);
+BENCHMARK(BM_A2G)->Apply(bench::SizeAndThreadArgs);
+BENCHMARK(BM_DyOprf)->Apply(bench::SizeAndThreadArgs);
+BENCHMARK(BM_CPSI)->Apply(bench::SizeAndThreadArgs);
+
+}  // namespace mcpsi
@@ -107,6 +107,26 @@ TEST(ProtocolTest, ScalarDyOprfTest) {
   }
 };
 
+TEST(ProtocolTest, ScalarMulPGTest) {
+  auto context = TestParam::GetContext();
+  size_t num = 1000;
+  auto prot = context[0]->GetState<Protocol>();
+  auto group = prot->GetGroup();
+  auto r_p = internal::op::Rand(num + 1);
+
+  std::vector<GTy> points(num);
+  for (size_t i = 0; i < num; ++i) {
+    points[i] = group->MulBase(ym::MPInt(r_p[i].GetVal()));
+  }
+  auto ret = prot->ScalarMulPG(r_p[num], points);
+
+  auto scalar = ym::MPInt(r_p[num].GetVal());
+  EXPECT_EQ(ret.size(), num);
+  for (size_t i = 0; i < num; ++i) {
+    EXPECT_TRUE(group->PointEqual(group->Mul(points[i], scalar), ret[i]));
+  }
+};
+
 TEST(ProtocolTest, DyOprfGetSetTest) {
   auto context = TestParam::GetContext();
   size_t num = 10000;
@@ -137,4 +157,34 @@ TEST(ProtocolTest, DyOprfGetSetTest) {
   }
 };
 
+TEST(ProtocolTest, ScalarDyOprfGetSetTest) {
+  auto context = TestParam::GetContext();
+  size_t num = 10000;
+  auto r_p = internal::op::Rand(num + 1);
+  auto items = absl::MakeConstSpan(r_p).subspan(0, num);
+  auto rank0 = std::async([&] {
+    auto prot = context[0]->GetState<Protocol>();
+    auto scalar = prot->P2A(absl::MakeConstSpan(r_p).subspan(num, 1));
+    auto ret0 = prot->DyOprfSet(items);
+    auto ret1 = prot->ScalarDyOprfSet(scalar[0], items);
+    return std::make_pair(ret0, ret1);
+  });
+  auto rank1 = std::async([&] {
+    auto prot = context[1]->GetState<Protocol>();
+    auto scalar = prot->P2A(absl::MakeConstSpan(r_p).subspan(num, 1));
+    auto ret0 = prot->DyOprfGet(num);
+    auto ret1 = prot->ScalarDyOprfGet(scalar[0], num);
+    return std::make_pair(ret0, ret1);
+  });
+  auto [ret0, ret1] = rank0.get();
+  rank1.get();
+
+  auto group = yc::EcGroupFactory::Instance().Create(
+      internal::kCurveName, yacl::ArgLib = internal::kCurveLib);
+  auto scalar = ym::MPInt(r_p[num].GetVal());
+  for (size_t i = 0; i < num; ++i) {
+    EXPECT_TRUE(group->PointEqual(group->Mul(ret0[i], scalar), ret1[i]));
+  }
+};
+
 }  // namespace mcpsi
\ No newline at end of file
@@ -0,0 +1,245 @@
+#include "mcpsi/ss/oprf_store.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+#include "mcpsi/utils/stream.h"
+#include "yacl/base/exception.h"
+#include "yacl/crypto/base/hash/hash_utils.h"
+#include "yacl/utils/parallel.h"
+
+namespace mcpsi {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// records of rank 0
+struct ItemRecord {
+  internal::PTy item;
+  uint64_t id;
+};
+
+// records of rank 1
+struct IdRecord {
+  uint64_t id;
+  uint128_t fp;
+};
+
+uint64_t Now() {
+  return std::chrono::duration_cast<std::chrono::seconds>(
+             std::chrono::system_clock::now().time_since_epoch())
+      .count();
+}
+
+// write into "path.tmp" first, then rename it (keep the old file if crashed)
+template <typename T>
+void AtomicWrite(const std::string& path, absl::Span<const T> in) {
+  auto tmp = path + ".tmp";
+  ChunkWriter<T> writer(tmp);
+  writer.Write(in);
+  writer.Close();
+  fs::permissions(tmp, fs::perms::owner_read | fs::perms::owner_write);
+  fs::rename(tmp, path);
+}
+
+}  // namespace
+
+std::vector<uint128_t> OprfFingerprint(
+    const std::shared_ptr<yacl::crypto::EcGroup>& group,
+    absl::Span<const internal::GTy> in) {
+  const size_t num = in.size();
+  const size_t GTy_size = group->GetSerializeLength(internal::kOctetFormat);
+  std::vector<uint128_t> ret(num);
+  yacl::parallel_for(0, num, [&](uint64_t bg, uint64_t ed) {
+    std::vector<uint8_t> buf(GTy_size);
+    for (auto i = bg; i < ed; ++i) {
+      group->SerializePoint(in[i], internal::kOctetFormat, buf.data(),
+                            GTy_size);
+      auto digest = yacl::crypto::Sm3(buf);
+      memcpy(&ret[i], digest.data(), sizeof(uint128_t));
+    }
+  });
+  return ret;
+}
+
+size_t OprfStore::ItemHash::operator()(const internal::PTy& item) const {
+  auto val = item.GetVal();
+  auto low = Uint256Low128(val);
+  auto high = Uint256High128(val);
+  return static_cast<size_t>(low ^ (low >> 64) ^ high ^ (high >> 64));
+}
+
+OprfStore::OprfStore(const std::string& dir, size_t rank)
+    : dir_(dir), rank_(rank) {
+  YACL_ENFORCE(rank_ < 2);
+}
+
+bool OprfStore::Load() {
+  items_.clear();
+  ids_.clear();
+  fps_.clear();
+  entries_.clear();
+  const auto meta_path = dir_ + "/meta";
+  const auto entry_path = dir_ + "/entries";
+  const auto fp_path = dir_ + "/fps";
+  if (!fs::exists(meta_path) || !fs::exists(entry_path) ||
+      (rank_ == 0 && !fs::exists(fp_path))) {
+    return false;
+  }
+
+  ChunkReader<OprfSessionMeta> meta_reader(meta_path);
+  YACL_ENFORCE(meta_reader.Size() == 1, "broken meta in {}", dir_);
+  meta_ = meta_reader.Next(1)[0];
+
+  if (rank_ == 0) {
+    ChunkReader<ItemRecord> reader(entry_path);
+    items_.reserve(reader.Size());
+    ids_.reserve(reader.Size());
+    while (reader.Remain() > 0) {
+      for (const auto& record : reader.Next(1 << 16)) {
+        items_.emplace(record.item, record.id);
+        ids_.emplace(record.id);
+      }
+    }
+    ChunkReader<uint128_t> fp_reader(fp_path);
+    YACL_ENFORCE(fp_reader.Size() >= items_.size(), "broken store {}", dir_);
+    fps_.reserve(fp_reader.Size());
+    while (fp_reader.Remain() > 0) {
+      for (const auto& fp : fp_reader.Next(1 << 16)) {
+        fps_.emplace(fp);
+      }
+    }
+  } else {
+    ChunkReader<IdRecord> reader(entry_path);
+    entries_.reserve(reader.Size());
+    while (reader.Remain() > 0) {
+      for (const auto& record : reader.Next(1 << 16)) {
+        entries_.emplace(record.id, record.fp);
+      }
+    }
+  }
+  return true;
+}
+
+void OprfStore::Save() const {
+  fs::create_directories(dir_);
+  if (rank_ == 0) {
+    std::vector<ItemRecord> records;
+    records.reserve(items_.size());
+    for (const auto& [item, id] : items_) {
+      records.push_back({item, id});
+    }
+    AtomicWrite<ItemRecord>(dir_ + "/entries", records);
+    std::vector<uint128_t> fps(fps_.begin(), fps_.end());
+    AtomicWrite<uint128_t>(dir_ + "/fps", fps);
+  } else {
+    std::vector<IdRecord> records;
+    records.reserve(entries_.size());
+    for (const auto& [id, fp] : entries_) {
+      records.push_back({id, fp});
+    }
+    AtomicWrite<IdRecord>(dir_ + "/entries", records);
+  }
+  AtomicWrite<OprfSessionMeta>(dir_ + "/meta",
+                               absl::MakeConstSpan(&meta_, 1));
+}
+
+void OprfStore::Reset(const OprfSessionMeta& meta) {
+  meta_ = meta;
+  if (meta_.created == 0) {
+    meta_.created = Now();
+  }
+  items_.clear();
+  ids_.clear();
+  fps_.clear();
+  entries_.clear();
+}
+
+bool OprfStore::NeedRotate(const KeyRotationPolicy& policy,
+                           size_t change_num) const {
+  if (meta_.runs >= policy.max_runs) {
+    return true;
+  }
+  if (Now() >= meta_.created + policy.max_age) {
+    return true;
+  }
+  return change_num > policy.max_change * std::max<size_t>(Size(), 1);
+}
+
+size_t OprfStore::Size() const {
+  return rank_ == 0 ? items_.size() : entries_.size();
+}
+
+bool OprfStore::Contains(const internal::PTy& item) const {
+  YACL_ENFORCE(rank_ == 0);
+  return items_.count(item) > 0;
+}
+
+bool OprfStore::ContainsId(uint64_t id) const {
+  YACL_ENFORCE(rank_ == 0);
+  return ids_.count(id) > 0;
+}
+
+void OprfStore::Insert(const internal::PTy& item, uint64_t id) {
+  YACL_ENFORCE(rank_ == 0);
+  YACL_ENFORCE(ids_.emplace(id).second, "duplicated id");
+  YACL_ENFORCE(items_.emplace(item, id).second, "duplicated item");
+}
+
+uint64_t OprfStore::Erase(const internal::PTy& item) {
+  YACL_ENFORCE(rank_ == 0);
+  auto iter = items_.find(item);
+  YACL_ENFORCE(iter != items_.end());
+  auto id = iter->second;
+  items_.erase(iter);
+  ids_.erase(id);
+  return id;
+}
+
+std::vector<internal::PTy> OprfStore::Items() const {
+  YACL_ENFORCE(rank_ == 0);
+  std::vector<internal::PTy> ret;
+  ret.reserve(items_.size());
+  for (const auto& [item, fp] : items_) {
+    ret.emplace_back(item);
+  }
+  return ret;
+}
+
+void OprfStore::InsertFp(uint128_t fp) {
+  YACL_ENFORCE(rank_ == 0);
+  fps_.emplace(fp);
+}
+
+void OprfStore::Insert(uint64_t id, uint128_t fp) {
+  YACL_ENFORCE(rank_ == 1);
+  YACL_ENFORCE(entries_.emplace(id, fp).second, "duplicated id");
+}
+
+uint128_t OprfStore::Erase(uint64_t id) {
+  YACL_ENFORCE(rank_ == 1);
+  auto iter = entries_.find(id);
+  YACL_ENFORCE(iter != entries_.end(), "unknown id");
+  auto fp = iter->second;
+  entries_.erase(iter);
+  return fp;
+}
+
+std::unordered_set<uint128_t, OprfStore::FpHash> OprfStore::Fingerprints()
+    const {
+  if (rank_ == 0) {
+    return fps_;
+  }
+  std::unordered_set<uint128_t, FpHash> ret;
+  ret.reserve(entries_.size());
+  for (const auto& [id, fp] : entries_) {
+    ret.emplace(fp);
+  }
+  return ret;
+}
+
+}  // namespace mcpsi
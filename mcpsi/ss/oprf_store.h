@@ -0,0 +1,137 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "mcpsi/ss/type.h"
+#include "yacl/base/int128.h"
+#include "yacl/crypto/base/ecc/ecc_spi.h"
+
+namespace mcpsi {
+
+// 128-bit fingerprint of revealed OPRF values, the first 128 bits of
+// Sm3(point)
+std::vector<uint128_t> OprfFingerprint(
+    const std::shared_ptr<yacl::crypto::EcGroup>& group,
+    absl::Span<const internal::GTy> in);
+
+// When to drop the persisted DY-PRF key and recompute every OPRF value.
+//
+// Reusing the key makes the revealed OPRF values of the same item linkable
+// across runs (e.g. party0 sees which items of party1 stay the same), so the
+// key should be rotated regularly.
+//
+// A small update is the linkable one (party0 sees the few fingerprints of its
+// few new items), so it is padded up to `min_insert` instead of being left
+// as is; `max_change` is a cost knob only.
+struct KeyRotationPolicy {
+  // maximum number of runs with the same key
+  uint32_t max_runs{30};
+  // maximum age of the key (seconds)
+  uint64_t max_age{7 * 24 * 3600};
+  // maximum ratio of changed (inserted + deleted) items to stored items, a
+  // full recomputation is cheaper beyond it
+  double max_change{0.5};
+  // minimum number of items inserted in a run, a smaller (non-empty) batch is
+  // padded with random dummy items
+  uint32_t min_insert{1024};
+};
+
+// Persisted session of a DY-PRF key
+// NOTE: the key shares are NOT here, they are sealed on their own (see
+// SetupSnapshot)
+struct OprfSessionMeta {
+  // random id agreed by both parties
+  uint128_t session_id{0};
+  // unix time (seconds) when the key is generated
+  uint64_t created{0};
+  // the number of finished runs with the key
+  uint32_t runs{0};
+};
+
+// Indexed store of revealed OPRF values for a stable set of party0
+//
+//  rank 0 (owner of the stable set): item --> id, && the fingerprints revealed
+//                                    in the session (deleted ones included)
+//  rank 1                          : id --> fingerprint
+//
+// An id is a random handle drawn by party0 for each stored item. The OPRF
+// values are shuffled by party1 (secret shuffle) before they are revealed, so
+// neither party alone could link a fingerprint to an item: party0 knows the
+// items but not the permutation, party1 knows the permutation (&& the ids)
+// but not the items. Deletion goes through the ids, party1 drops the
+// fingerprints on its own, so party0 never learns which ones are gone.
+//
+// Layout of `dir`: "meta" (OprfSessionMeta) && "entries" (one record per
+// stored item) && "fps" (rank 0 only).
+class OprfStore {
+ public:
+  OprfStore(const std::string& dir, size_t rank);
+
+  // return false if there is no (complete) session in `dir`
+  bool Load();
+
+  void Save() const;
+
+  // start a new session, drop all entries
+  void Reset(const OprfSessionMeta& meta);
+
+  bool NeedRotate(const KeyRotationPolicy& policy, size_t change_num) const;
+
+  const OprfSessionMeta& GetMeta() const { return meta_; }
+
+  void FinishRun() { ++meta_.runs; }
+
+  size_t Size() const;
+
+  // rank 0
+  bool Contains(const internal::PTy& item) const;
+  bool ContainsId(uint64_t id) const;
+  void Insert(const internal::PTy& item, uint64_t id);
+  // return the id of the erased item
+  uint64_t Erase(const internal::PTy& item);
+  std::vector<internal::PTy> Items() const;
+  void InsertFp(uint128_t fp);
+
+  // rank 1
+  void Insert(uint64_t id, uint128_t fp);
+  // return the fingerprint of the erased id
+  uint128_t Erase(uint64_t id);
+
+  // rank 0: all fingerprints revealed in the session (a superset of the
+  // stored items' ones), rank 1: fingerprints of the stored items
+  struct FpHash {
+    size_t operator()(uint128_t fp) const {
+      return static_cast<size_t>(fp ^ (fp >> 64));
+    }
+  };
+  std::unordered_set<uint128_t, FpHash> Fingerprints() const;
+
+  // hash set/map of items
+  struct ItemHash {
+    size_t operator()(const internal::PTy& item) const;
+  };
+  struct ItemEq {
+    bool operator()(const internal::PTy& lhs, const internal::PTy& rhs) const {
+      return lhs == rhs;
+    }
+  };
+
+ private:
+  std::string dir_;
+  size_t rank_;
+  OprfSessionMeta meta_;
+
+  // rank 0
+  std::unordered_map<internal::PTy, uint64_t, ItemHash, ItemEq> items_;
+  std::unordered_set<uint64_t> ids_;
+  std::unordered_set<uint128_t, FpHash> fps_;
+  // rank 1
+  std::unordered_map<uint64_t, uint128_t> entries_;
+};
+
+}  // namespace mcpsi
@@ -0,0 +1,82 @@
+#include "mcpsi/ss/oprf_store.h"
+
+#include <filesystem>
+
+#include "gtest/gtest.h"
+#include "mcpsi/utils/vec_op.h"
+
+namespace mcpsi {
+
+TEST(OprfStoreTest, PersistWork) {
+  const std::string dir = "oprf_store_test";
+  size_t num = 1000;
+  auto items = internal::op::Rand(num);
+  auto meta = OprfSessionMeta();
+  meta.session_id = 0x1234;
+
+  OprfStore store0(dir + "/p0", 0);
+  OprfStore store1(dir + "/p1", 1);
+  EXPECT_FALSE(store0.Load());
+  EXPECT_FALSE(store1.Load());
+  store0.Reset(meta);
+  store1.Reset(meta);
+  // id (i + 100) && fingerprint i
+  for (size_t i = 0; i < num; ++i) {
+    store0.Insert(items[i], i + 100);
+    store0.InsertFp(i);
+    store1.Insert(i + 100, i);
+  }
+  // delete the first half, by item (rank 0) --> id (rank 1), rank 0 keeps
+  // the fingerprints
+  for (size_t i = 0; i < num / 2; ++i) {
+    EXPECT_EQ(store1.Erase(store0.Erase(items[i])), i);
+  }
+  store0.FinishRun();
+  store1.FinishRun();
+  store0.Save();
+  store1.Save();
+
+  OprfStore load0(dir + "/p0", 0);
+  OprfStore load1(dir + "/p1", 1);
+  EXPECT_TRUE(load0.Load());
+  EXPECT_TRUE(load1.Load());
+  EXPECT_TRUE(load0.GetMeta().session_id == meta.session_id);
+  EXPECT_EQ(load1.GetMeta().runs, 1U);
+  EXPECT_EQ(load0.Size(), num - num / 2);
+  EXPECT_EQ(load1.Size(), num - num / 2);
+  for (size_t i = 0; i < num; ++i) {
+    EXPECT_EQ(load0.Contains(items[i]), i >= num / 2);
+    EXPECT_EQ(load0.ContainsId(i + 100), i >= num / 2);
+  }
+  auto fps0 = load0.Fingerprints();
+  EXPECT_EQ(fps0.size(), num);
+  for (const auto& fp : load1.Fingerprints()) {
+    EXPECT_TRUE(fps0.count(fp) > 0);
+  }
+
+  std::filesystem::remove_all(dir);
+}
+
+TEST(OprfStoreTest, RotateWork) {
+  OprfStore store("oprf_store_test", 1);
+  store.Reset(OprfSessionMeta());
+  for (size_t i = 0; i < 100; ++i) {
+    store.Insert(i, i);
+  }
+
+  KeyRotationPolicy policy;
+  policy.max_runs = 2;
+  policy.max_change = 0.1;
+  EXPECT_FALSE(store.NeedRotate(policy, 10));
+  EXPECT_TRUE(store.NeedRotate(policy, 11));
+
+  store.FinishRun();
+  store.FinishRun();
+  EXPECT_TRUE(store.NeedRotate(policy, 0));
+
+  policy.max_runs = 30;
+  policy.max_age = 0;
+  EXPECT_TRUE(store.NeedRotate(policy, 0));
+}
+
+}  // namespace mcpsi
@@ -0,0 +1,385 @@
+#include "mcpsi/ss/payload.h"
+
+#include "mcpsi/cr/cr.h"
+#include "mcpsi/cr/payload_cr.h"
+#include "mcpsi/utils/vec_op.h"
+#include "yacl/crypto/tools/prg.h"
+#include "yacl/crypto/utils/rand.h"
+
+namespace mcpsi {
+
+namespace {
+
+using PayOp = internal::FieldOp<PayTy>;
+
+// bits of the masks in ToKeyField, 64-bit values && 40-bit statistical hiding
+constexpr size_t kMaskBits = 104;
+// CheckBits: up to 2^40 bits, each check catches a bad bit w.p. >= 1/2, &&
+// the blinding masks hide the subset sums with 40-bit statistical hiding
+constexpr size_t kMaxBitNumBits = 40;
+constexpr size_t kBitChecks = 40;
+constexpr size_t kBitBlindBits = kMaxBitNumBits + 40;
+
+std::vector<PayATy> AddA(absl::Span<const PayATy> lhs,
+                         absl::Span<const PayATy> rhs) {
+  YACL_ENFORCE(lhs.size() == rhs.size());
+  const size_t size = lhs.size();
+  std::vector<PayATy> ret(size);
+  PayOp::Add(
+      absl::MakeConstSpan(reinterpret_cast<const PayTy*>(lhs.data()), size * 2),
+      absl::MakeConstSpan(reinterpret_cast<const PayTy*>(rhs.data()), size * 2),
+      absl::MakeSpan(reinterpret_cast<PayTy*>(ret.data()), size * 2));
+  return ret;
+}
+
+// a-shares of sum_j 2^j * bits[i * kMaskBits + j], for each i
+template <typename T>
+std::vector<internal::AShare<T>> Compose(
+    absl::Span<const internal::AShare<T>> bits) {
+  YACL_ENFORCE(bits.size() % kMaskBits == 0);
+  const size_t num = bits.size() / kMaskBits;
+  std::vector<internal::AShare<T>> ret(num);
+  for (size_t i = 0; i < num; ++i) {
+    internal::AShare<T> acc{T::Zero(), T::Zero()};
+    for (size_t j = kMaskBits; j-- > 0;) {
+      const auto& bit = bits[i * kMaskBits + j];
+      acc.val = acc.val + acc.val + bit.val;
+      acc.mac = acc.mac + acc.mac + bit.mac;
+    }
+    ret[i] = acc;
+  }
+  return ret;
+}
+
+// shuffle (get side) : send `in` + a (vals, then macs) to the permuting
+// party, keep b as the shuffled share
+template <typename T>
+std::vector<internal::AShare<T>> MaskAndSend(
+    std::shared_ptr<Context>& ctx, absl::Span<const internal::AShare<T>> in,
+    absl::Span<T> a, absl::Span<const T> b, std::string_view tag) {
+  const size_t num = in.size();
+  YACL_ENFORCE(a.size() == num * 2);
+  YACL_ENFORCE(b.size() == num * 2);
+  auto [val, mac] = internal::Unpack<T>(in);
+  internal::FieldOp<T>::AddInplace(a.subspan(0, num), val);
+  internal::FieldOp<T>::AddInplace(a.subspan(num, num), mac);
+  ctx->GetStateRaw<Connection>()->SendAsync(
+      ctx->NextRank(), yacl::ByteContainerView(a.data(), a.size() * sizeof(T)),
+      tag);
+  return internal::Pack<T>(b.subspan(0, num), b.subspan(num, num));
+}
+
+// shuffle (set side) : receive x + a, return \Pi(x + a) + delta, where
+// delta = - \Pi(a) - b
+template <typename T>
+std::vector<internal::AShare<T>> RecvAndPermute(
+    std::shared_ptr<Context>& ctx, absl::Span<const internal::AShare<T>> in,
+    absl::Span<const size_t> perm, absl::Span<T> delta, std::string_view tag) {
+  const size_t num = in.size();
+  YACL_ENFORCE(perm.size() == num);
+  YACL_ENFORCE(delta.size() == num * 2);
+  auto buf = ctx->GetStateRaw<Connection>()->Recv(ctx->NextRank(), tag);
+  YACL_ENFORCE(static_cast<size_t>(buf.size()) == num * 2 * sizeof(T));
+  auto tmp = absl::MakeSpan(reinterpret_cast<T*>(buf.data()), num * 2);
+  auto [val, mac] = internal::Unpack<T>(in);
+  internal::FieldOp<T>::AddInplace(tmp.subspan(0, num), val);
+  internal::FieldOp<T>::AddInplace(tmp.subspan(num, num), mac);
+  for (size_t i = 0; i < num; ++i) {
+    delta[i] = delta[i] + tmp[perm[i]];
+    delta[num + i] = delta[num + i] + tmp[num + perm[i]];
+  }
+  return internal::Pack<T>(delta.subspan(0, num), delta.subspan(num, num));
+}
+
+}  // namespace
+
+// register string
+const std::string PayloadProtocol::id = std::string("PayloadProtocol");
+
+PayloadProtocol::PayloadProtocol(std::shared_ptr<Context> ctx) : ctx_(ctx) {
+  // SPDZ key setup
+  key_ = PayTy(yacl::crypto::SecureRandU128());
+}
+
+std::vector<PayATy> PayloadProtocol::RandA(size_t num) {
+  std::vector<PayATy> ret(num);
+  ctx_->GetStateRaw<PayloadCorrelation>()->RandomAuth(absl::MakeSpan(ret));
+  return ret;
+}
+
+// A-share Setter, return A-share ( in , in * key + r )
+std::vector<PayATy> PayloadProtocol::SetA(absl::Span<const PayTy> in) {
+  const size_t num = in.size();
+  std::vector<PayATy> rand(num);
+  ctx_->GetStateRaw<PayloadCorrelation>()->RandomSet(absl::MakeSpan(rand));
+  auto [val, mac] = internal::Unpack<PayTy>(rand);
+  // diff = in - val
+  auto diff = PayOp::Sub(in, absl::MakeConstSpan(val));
+  ctx_->GetStateRaw<Connection>()->SendAsync(
+      ctx_->NextRank(),
+      yacl::ByteContainerView(diff.data(), num * sizeof(PayTy)),
+      "PayloadSetA");
+  // mac = diff * key + mac
+  auto diff_mac = PayOp::ScalarMul(key_, absl::MakeConstSpan(diff));
+  PayOp::AddInplace(absl::MakeSpan(mac), absl::MakeConstSpan(diff_mac));
+  return internal::Pack<PayTy>(in, mac);
+}
+
+// A-share Getter, return A-share ( 0 , in * key - r )
+std::vector<PayATy> PayloadProtocol::GetA(size_t num) {
+  std::vector<PayATy> zero(num);
+  ctx_->GetStateRaw<PayloadCorrelation>()->RandomGet(absl::MakeSpan(zero));
+  auto [val, mac] = internal::Unpack<PayTy>(zero);
+  auto buf = ctx_->GetStateRaw<Connection>()->Recv(ctx_->NextRank(),
+                                                   "PayloadSetA");
+  YACL_ENFORCE(static_cast<size_t>(buf.size()) == num * sizeof(PayTy));
+  auto diff = absl::MakeConstSpan(reinterpret_cast<PayTy*>(buf.data()), num);
+  // mac = diff * key + mac
+  auto diff_mac = PayOp::ScalarMul(key_, diff);
+  PayOp::AddInplace(absl::MakeSpan(mac), absl::MakeConstSpan(diff_mac));
+  return internal::Pack<PayTy>(val, mac);
+}
+
+std::vector<PayATy> PayloadProtocol::SumA(absl::Span<const PayATy> in) {
+  std::vector<PayATy> ret(1, {0, 0});
+  for (const auto& item : in) {
+    ret[0].val = ret[0].val + item.val;
+    ret[0].mac = ret[0].mac + item.mac;
+  }
+  return ret;
+}
+
+std::vector<PayATy> PayloadProtocol::FilterA(
+    absl::Span<const PayATy> in, absl::Span<const size_t> indexes) {
+  YACL_ENFORCE(indexes.size() <= in.size());
+  std::vector<PayATy> ret(indexes.size());
+  for (size_t i = 0; i < indexes.size(); ++i) {
+    ret[i] = in[indexes[i]];
+  }
+  return ret;
+}
+
+std::vector<PayTy> PayloadProtocol::A2P(absl::Span<const PayATy> in) {
+  const size_t size = in.size();
+  auto [val, mac] = internal::Unpack<PayTy>(in);
+  auto conn = ctx_->GetStateRaw<Connection>();
+  auto buf = conn->Exchange(
+      yacl::ByteContainerView(val.data(), size * sizeof(PayTy)));
+  std::vector<PayTy> real_val(size);
+  PayOp::Add(
+      absl::MakeConstSpan(reinterpret_cast<const PayTy*>(buf.data()), size),
+      absl::MakeConstSpan(val), absl::MakeSpan(real_val));
+
+  // Generate Sync Seed After Open Value
+  auto sync_seed = conn->DrawCoin();
+  auto coef = PayOp::Rand(sync_seed, size);
+  // linear combination
+  auto real_val_affine =
+      PayOp::InPro(absl::MakeSpan(coef), absl::MakeSpan(real_val));
+  auto mac_affine = PayOp::InPro(absl::MakeSpan(coef), absl::MakeSpan(mac));
+
+  auto zero_mac = mac_affine - real_val_affine * key_;
+  auto remote_mac_int = conn->ExchangeWithCommit(zero_mac.GetVal());
+  YACL_ENFORCE(zero_mac + PayTy(remote_mac_int) == PayTy::Zero());
+  return real_val;
+}
+
+std::pair<std::vector<ATy>, std::vector<PayATy>> PayloadProtocol::ShuffleA(
+    absl::Span<const ATy> keys, absl::Span<const PayATy> payloads) {
+  if (ctx_->GetRank() == 0) {
+    auto [tmp_keys, tmp_payloads] = ShuffleASet(keys, payloads);
+    return ShuffleAGet(tmp_keys, tmp_payloads);
+  }
+  auto [tmp_keys, tmp_payloads] = ShuffleAGet(keys, payloads);
+  return ShuffleASet(tmp_keys, tmp_payloads);
+}
+
+std::pair<std::vector<ATy>, std::vector<PayATy>> PayloadProtocol::ShuffleASet(
+    absl::Span<const ATy> keys, absl::Span<const PayATy> payloads) {
+  const size_t num = keys.size();
+  YACL_ENFORCE(num == payloads.size());
+  // the permutation of the keys, reused by the payloads
+  auto [key_delta, perm] = ctx_->GetStateRaw<Correlation>()->ShuffleSet(num, 2);
+  std::vector<PayTy> pay_delta(num * 2);
+  ctx_->GetStateRaw<PayloadCorrelation>()->ShuffleSet(
+      perm, absl::MakeSpan(pay_delta), 2);
+
+  auto ret_keys = RecvAndPermute<PTy>(ctx_, keys, perm,
+                                      absl::MakeSpan(key_delta), "ShuffleKeys");
+  auto ret_payloads = RecvAndPermute<PayTy>(
+      ctx_, payloads, perm, absl::MakeSpan(pay_delta), "ShufflePayloads");
+  return {std::move(ret_keys), std::move(ret_payloads)};
+}
+
+std::pair<std::vector<ATy>, std::vector<PayATy>> PayloadProtocol::ShuffleAGet(
+    absl::Span<const ATy> keys, absl::Span<const PayATy> payloads) {
+  const size_t num = keys.size();
+  YACL_ENFORCE(num == payloads.size());
+  auto [key_a, key_b] = ctx_->GetStateRaw<Correlation>()->ShuffleGet(num, 2);
+  std::vector<PayTy> pay_a(num * 2);
+  std::vector<PayTy> pay_b(num * 2);
+  ctx_->GetStateRaw<PayloadCorrelation>()->ShuffleGet(
+      absl::MakeSpan(pay_a), absl::MakeSpan(pay_b), 2);
+
+  auto ret_keys =
+      MaskAndSend<PTy>(ctx_, keys, absl::MakeSpan(key_a),
+                       absl::MakeConstSpan(key_b), "ShuffleKeys");
+  auto ret_payloads =
+      MaskAndSend<PayTy>(ctx_, payloads, absl::MakeSpan(pay_a),
+                         absl::MakeConstSpan(pay_b), "ShufflePayloads");
+  return {std::move(ret_keys), std::move(ret_payloads)};
+}
+
+std::vector<PayTy> ToPayTy(absl::Span<const PTy> in) {
+  std::vector<PayTy> ret(in.size());
+  for (size_t i = 0; i < in.size(); ++i) {
+    auto val = in[i].GetVal();
+    YACL_ENFORCE(Uint256High128(val) == 0 && (Uint256Low128(val) >> 64) == 0,
+                 "payload out of range");
+    ret[i] = PayTy(static_cast<uint64_t>(Uint256Low128(val)));
+  }
+  return ret;
+}
+
+void PayloadProtocol::CheckBits(absl::Span<const PayATy> pay_bits,
+                                absl::Span<const ATy> key_bits) {
+  const size_t num = pay_bits.size();
+  YACL_ENFORCE(num == key_bits.size());
+  YACL_ENFORCE((num >> kMaxBitNumBits) == 0);
+  auto prot = ctx_->GetStateRaw<Protocol>();
+  auto conn = ctx_->GetStateRaw<Connection>();
+
+  // ---- b * (b - 1) == 0 in the key field ----
+  {
+    std::vector<PTy> ones(num, PTy(uint64_t(1)));
+    auto minus = prot->Sub(key_bits, absl::MakeConstSpan(ones));
+    auto prod = prot->Mul(key_bits, absl::MakeConstSpan(minus));
+    // the openings inside Mul
+    YACL_ENFORCE(prot->AShareDelayCheck());
+    auto coef = internal::op::Rand(conn->DrawCoin(), num);
+    ATy sum{PTy::Zero(), PTy::Zero()};
+    for (size_t i = 0; i < num; ++i) {
+      sum.val = sum.val + coef[i] * prod[i].val;
+      sum.mac = sum.mac + coef[i] * prod[i].mac;
+    }
+    auto zero = prot->A2P(absl::MakeConstSpan(&sum, 1))[0];
+    YACL_ENFORCE(zero == PTy::Zero(), "the masks are not bits");
+  }
+
+  // ---- the same bits in both fields ----
+  // kBitChecks subset sums of the bits, with public random subsets drawn
+  // after the bits && the blinding masks are input, opened in both fields &&
+  // compared over the integers. Honest sums are < 2^(kBitBlindBits + 2), far
+  // below both primes. For a bit that differs between the fields (e.g. by a
+  // multiple of the prime of PayTy), a subset sum && the one flipping the bit
+  // can not both pass, so each check catches it w.p. >= 1/2.
+  std::vector<PayTy> pay_blind(kBitChecks);
+  std::vector<PTy> key_blind(kBitChecks);
+  for (size_t k = 0; k < kBitChecks; ++k) {
+    const uint128_t blind =
+        yacl::crypto::SecureRandU128() >> (128 - kBitBlindBits);
+    pay_blind[k] = PayTy(blind);
+    key_blind[k] = PTy(blind);
+  }
+  auto [pay_sum, key_sum] = InputBoth(pay_blind, key_blind);
+  pay_sum = AddA(absl::MakeConstSpan(pay_sum).subspan(0, kBitChecks),
+                 absl::MakeConstSpan(pay_sum).subspan(kBitChecks));
+  key_sum = prot->Add(absl::MakeConstSpan(key_sum).subspan(0, kBitChecks),
+                      absl::MakeConstSpan(key_sum).subspan(kBitChecks));
+
+  static_assert(kBitChecks <= 64);
+  yacl::crypto::Prg<uint64_t> subset_prg(conn->DrawCoin());
+  for (size_t i = 0; i < num; ++i) {
+    // bit k: whether bit i is in the k-th subset
+    const uint64_t subsets = subset_prg();
+    for (size_t k = 0; k < kBitChecks; ++k) {
+      if ((subsets >> k) & 1) {
+        pay_sum[k].val = pay_sum[k].val + pay_bits[i].val;
+        pay_sum[k].mac = pay_sum[k].mac + pay_bits[i].mac;
+        key_sum[k].val = key_sum[k].val + key_bits[i].val;
+        key_sum[k].mac = key_sum[k].mac + key_bits[i].mac;
+      }
+    }
+  }
+  auto pay_open = A2P(pay_sum);
+  auto key_open = prot->A2P(key_sum);
+  for (size_t k = 0; k < kBitChecks; ++k) {
+    const auto key_val = key_open[k].GetVal();
+    YACL_ENFORCE(Uint256High128(key_val) == 0 &&
+                     Uint256Low128(key_val) == pay_open[k].GetVal() &&
+                     (pay_open[k].GetVal() >> (kBitBlindBits + 2)) == 0,
+                 "inconsistent bits between the fields");
+  }
+}
+
+std::pair<std::vector<PayATy>, std::vector<ATy>> PayloadProtocol::InputBoth(
+    absl::Span<const PayTy> pay_in, absl::Span<const PTy> key_in) {
+  const size_t num = pay_in.size();
+  YACL_ENFORCE(num == key_in.size());
+  auto prot = ctx_->GetStateRaw<Protocol>();
+  std::vector<PayATy> pay0;
+  std::vector<PayATy> pay1;
+  std::vector<ATy> key0;
+  std::vector<ATy> key1;
+  if (ctx_->GetRank() == 0) {
+    pay0 = SetA(pay_in);
+    pay1 = GetA(num);
+    key0 = prot->SetA(key_in);
+    key1 = prot->GetA(num);
+  } else {
+    pay0 = GetA(num);
+    pay1 = SetA(pay_in);
+    key0 = prot->GetA(num);
+    key1 = prot->SetA(key_in);
+  }
+  pay0.insert(pay0.end(), pay1.begin(), pay1.end());
+  key0.insert(key0.end(), key1.begin(), key1.end());
+  return {std::move(pay0), std::move(key0)};
+}
+
+std::vector<ATy> PayloadProtocol::ToKeyField(absl::Span<const PayATy> in) {
+  const size_t num = in.size();
+  auto prot = ctx_->GetStateRaw<Protocol>();
+
+  YACL_ENFORCE((num >> 32) == 0);
+
+  // random bits of the masks, the same values in both fields
+  const size_t bit_num = num * kMaskBits;
+  std::vector<PayTy> pay_bits(bit_num);
+  std::vector<PTy> key_bits(bit_num);
+  yacl::crypto::Prg<uint64_t> prg(yacl::crypto::SecureRandU128());
+  uint64_t word = 0;
+  for (size_t i = 0; i < bit_num; ++i) {
+    if (i % 64 == 0) {
+      word = prg();
+    }
+    const uint64_t bit = (word >> (i % 64)) & 1;
+    pay_bits[i] = PayTy(bit);
+    key_bits[i] = PTy(bit);
+  }
+  auto [pay_b, key_b] = InputBoth(pay_bits, key_bits);
+  CheckBits(pay_b, key_b);
+
+  // r = r0 + r1, r_p = sum_j 2^j * b_{p, j} (the bits of party p) in both
+  // fields, i.e. the same integer < 2^(kMaskBits + 1)
+  auto pay_r0 = Compose<PayTy>(absl::MakeConstSpan(pay_b).subspan(0, bit_num));
+  auto pay_r1 = Compose<PayTy>(absl::MakeConstSpan(pay_b).subspan(bit_num));
+  auto key_r0 = Compose<PTy>(absl::MakeConstSpan(key_b).subspan(0, bit_num));
+  auto key_r1 = Compose<PTy>(absl::MakeConstSpan(key_b).subspan(bit_num));
+  auto pay_r = AddA(pay_r0, pay_r1);
+  auto key_r =
+      prot->Add(absl::MakeConstSpan(key_r0), absl::MakeConstSpan(key_r1));
+
+  // x + r < 2^64 + 2^(kMaskBits + 1) < PayTy::GetPrime(), no wrap-around
+  auto masked = A2P(AddA(in, pay_r));
+  std::vector<PTy> masked_key(num);
+  for (size_t i = 0; i < num; ++i) {
+    YACL_ENFORCE((masked[i].GetVal() >> (kMaskBits + 2)) == 0,
+                 "payload out of range");
+    masked_key[i] = PTy(masked[i].GetVal());
+  }
+  return prot->Sub(absl::MakeConstSpan(masked_key),
+                   absl::MakeConstSpan(key_r));
+}
+
+}  // namespace mcpsi
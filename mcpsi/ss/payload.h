@@ -0,0 +1,83 @@
+#pragma once
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "mcpsi/context/context.h"
+#include "mcpsi/context/state.h"
+#include "mcpsi/ss/protocol.h"
+#include "mcpsi/ss/type.h"
+
+namespace mcpsi {
+
+using PayTy = internal::PayTy;
+using PayATy = internal::PayATy;
+
+// SPDZ instance of the payloads, over PayTy (kFp128). Payloads are only
+// summed, filtered && shuffled (along with the keys), so they do not need
+// the field of the DY-PRF, each a-share is half the size of an ATy.
+//
+// NOTE: no cache mode, the correlations are drawn on demand
+class PayloadProtocol : public State {
+ private:
+  std::shared_ptr<Context> ctx_;
+  // SPDZ key
+  PayTy key_;
+
+ public:
+  static const std::string id;
+  static constexpr StateSlot slot = StateSlot::kPayloadProtocol;
+
+  PayloadProtocol(std::shared_ptr<Context> ctx);
+
+  PayTy GetKey() const { return key_; }
+  // NOTE: only before the correlation is built (see SetupPayloadContext)
+  void SetKey(const PayTy& key) { key_ = key; }
+
+  std::vector<PayATy> RandA(size_t num);
+  std::vector<PayATy> SetA(absl::Span<const PayTy> in);
+  std::vector<PayATy> GetA(size_t num);
+  std::vector<PayATy> SumA(absl::Span<const PayATy> in);
+  std::vector<PayATy> FilterA(absl::Span<const PayATy> in,
+                              absl::Span<const size_t> indexes);
+  // open && check the MACs
+  std::vector<PayTy> A2P(absl::Span<const PayATy> in);
+
+  // shuffle the keys (A-shares of the Protocol) && the payloads with the
+  // same permutation, party0 permutes first
+  std::pair<std::vector<ATy>, std::vector<PayATy>> ShuffleA(
+      absl::Span<const ATy> keys, absl::Span<const PayATy> payloads);
+  std::pair<std::vector<ATy>, std::vector<PayATy>> ShuffleASet(
+      absl::Span<const ATy> keys, absl::Span<const PayATy> payloads);
+  std::pair<std::vector<ATy>, std::vector<PayATy>> ShuffleAGet(
+      absl::Span<const ATy> keys, absl::Span<const PayATy> payloads);
+
+  // [x] over PTy from [x] over PayTy, for x < 2^64 (e.g. a sum of payloads
+  // to be compared in the key field). Open x + r over PayTy, where r is the
+  // sum of random masks (< 2^104, 40-bit statistical hiding) input by both
+  // parties in both fields, then [x] = (x + r) - [r]. Each mask is composed
+  // of bits input in both fields (see CheckBits), so the masks are the same
+  // integers in both fields.
+  // NOTE: at most 2^32 values per call
+  std::vector<ATy> ToKeyField(absl::Span<const PayATy> in);
+
+  // check that `pay_bits` && `key_bits` are the same bits (i.e. daBits):
+  // b * (b - 1) == 0 is checked in the key field, then 40 random subset sums
+  // of the bits, blinded, are opened in both fields && compared over the
+  // integers. Bad bits pass w.p. <= 2^-40.
+  // NOTE: at most 2^40 bits per call
+  void CheckBits(absl::Span<const PayATy> pay_bits,
+                 absl::Span<const ATy> key_bits);
+
+ private:
+  // both parties input their values in both fields, return the a-shares of
+  // the inputs of party0, then the ones of party1
+  std::pair<std::vector<PayATy>, std::vector<ATy>> InputBoth(
+      absl::Span<const PayTy> pay_in, absl::Span<const PTy> key_in);
+};
+
+// payloads (< 2^64, e.g. parsed from the input) from the key field into
+// PayTy, so that sums of up to 2^61 payloads do not wrap around
+std::vector<PayTy> ToPayTy(absl::Span<const PTy> in);
+
+}  // namespace mcpsi
@@ -0,0 +1,165 @@
+#include "mcpsi/ss/payload.h"
+
+#include <future>
+#include <set>
+
+#include "gtest/gtest.h"
+#include "mcpsi/context/register.h"
+#include "mcpsi/utils/test_util.h"
+
+namespace mcpsi {
+
+class TestParam {
+ public:
+  static std::vector<std::shared_ptr<Context>> ctx;
+
+  // Getter
+  static std::vector<std::shared_ptr<Context>>& GetContext() {
+    if (ctx.empty()) {
+      ctx = Setup();
+    }
+    return ctx;
+  }
+
+  static std::vector<std::shared_ptr<Context>> Setup() {
+    auto ctx = MockContext(2);
+    MockSetupContext(ctx);
+    SetupPayloadContext(ctx[0]);
+    SetupPayloadContext(ctx[1]);
+    return ctx;
+  }
+};
+
+std::vector<std::shared_ptr<Context>> TestParam::ctx =
+    std::vector<std::shared_ptr<Context>>();
+
+// rank0 inputs the payloads, both parties open them
+std::vector<PayTy> InputAndOpen(std::shared_ptr<Context> ctx,
+                                absl::Span<const PayTy> in) {
+  auto prot = ctx->GetState<PayloadProtocol>();
+  auto shares = ctx->GetRank() == 0 ? prot->SetA(in) : prot->GetA(in.size());
+  return prot->A2P(shares);
+}
+
+TEST(PayloadTest, SetAWork) {
+  const size_t num = 10000;
+  auto context = TestParam::GetContext();
+  std::vector<PayTy> in(num);
+  for (size_t i = 0; i < num; ++i) {
+    in[i] = PayTy(uint64_t(i * 7));
+  }
+  auto rank0 = std::async([&] { return InputAndOpen(context[0], in); });
+  auto rank1 = std::async([&] { return InputAndOpen(context[1], in); });
+  auto ret0 = rank0.get();
+  auto ret1 = rank1.get();
+  for (size_t i = 0; i < num; ++i) {
+    EXPECT_EQ(ret0[i], in[i]);
+    EXPECT_EQ(ret1[i], in[i]);
+  }
+}
+
+TEST(PayloadTest, ShuffleAWork) {
+  const size_t num = 1000;
+  auto context = TestParam::GetContext();
+  auto task = [&](std::shared_ptr<Context> ctx) {
+    auto prot = ctx->GetState<Protocol>();
+    auto pay_prot = ctx->GetState<PayloadProtocol>();
+    // key i comes with payload i
+    std::vector<PTy> keys(num);
+    std::vector<PayTy> payloads(num);
+    for (size_t i = 0; i < num; ++i) {
+      keys[i] = PTy(uint64_t(i));
+      payloads[i] = PayTy(uint64_t(i));
+    }
+    auto keys_a = prot->P2A(keys);
+    auto payloads_a = ctx->GetRank() == 0 ? pay_prot->SetA(payloads)
+                                          : pay_prot->GetA(num);
+    auto [keys_s, payloads_s] = pay_prot->ShuffleA(keys_a, payloads_a);
+    return std::make_pair(prot->A2P(keys_s), pay_prot->A2P(payloads_s));
+  };
+  auto rank0 = std::async([&] { return task(context[0]); });
+  auto rank1 = std::async([&] { return task(context[1]); });
+  auto [keys0, payloads0] = rank0.get();
+  auto [keys1, payloads1] = rank1.get();
+
+  std::set<uint64_t> seen;
+  bool moved = false;
+  for (size_t i = 0; i < num; ++i) {
+    EXPECT_EQ(keys0[i], keys1[i]);
+    EXPECT_EQ(payloads0[i], payloads1[i]);
+    auto key = static_cast<uint64_t>(keys0[i].GetVal());
+    EXPECT_EQ(static_cast<uint64_t>(payloads0[i].GetVal()), key);
+    seen.insert(key);
+    moved |= (key != i);
+  }
+  EXPECT_EQ(seen.size(), num);
+  EXPECT_TRUE(moved);
+}
+
+TEST(PayloadTest, ToKeyFieldWork) {
+  const size_t num = 1000;
+  auto context = TestParam::GetContext();
+  std::vector<PayTy> in(num);
+  for (size_t i = 0; i < num; ++i) {
+    in[i] = PayTy(~uint64_t(0) - i);
+  }
+  auto task = [&](std::shared_ptr<Context> ctx) {
+    auto prot = ctx->GetState<Protocol>();
+    auto pay_prot = ctx->GetState<PayloadProtocol>();
+    auto shares =
+        ctx->GetRank() == 0 ? pay_prot->SetA(in) : pay_prot->GetA(num);
+    auto sum = pay_prot->SumA(shares);
+    auto keys = pay_prot->ToKeyField(absl::MakeConstSpan(shares).subspan(0, 2));
+    return std::make_pair(prot->A2P(keys), pay_prot->A2P(sum));
+  };
+  auto rank0 = std::async([&] { return task(context[0]); });
+  auto rank1 = std::async([&] { return task(context[1]); });
+  auto [keys0, sum0] = rank0.get();
+  auto [keys1, sum1] = rank1.get();
+
+  EXPECT_EQ(keys0[0], PTy(~uint64_t(0)));
+  EXPECT_EQ(keys0[1], PTy(~uint64_t(0) - 1));
+  EXPECT_EQ(keys1[0], keys0[0]);
+  PayTy expect(0);
+  for (const auto& val : in) {
+    expect = expect + val;
+  }
+  EXPECT_EQ(sum0[0], expect);
+  EXPECT_EQ(sum1[0], expect);
+}
+
+TEST(PayloadTest, CheckBitsRejectTamper) {
+  const size_t num = 100;
+  // rank0 inputs a bit that differs between the fields: 1 + the prime of
+  // PayTy in the key field (the same value mod that prime), or 1 in the
+  // payload field only
+  for (bool tamper_key : {true, false}) {
+    // fresh contexts, the check aborts halfway
+    auto context = TestParam::Setup();
+    auto task = [&](std::shared_ptr<Context> ctx) {
+      auto prot = ctx->GetState<Protocol>();
+      auto pay_prot = ctx->GetState<PayloadProtocol>();
+      std::vector<PayTy> pay_bits(num);
+      std::vector<PTy> key_bits(num);
+      for (size_t i = 0; i < num; ++i) {
+        pay_bits[i] = PayTy(uint64_t(i & 1));
+        key_bits[i] = PTy(uint64_t(i & 1));
+      }
+      if (tamper_key) {
+        key_bits[1] = key_bits[1] + PTy(PayTy::GetPrime());
+      } else {
+        pay_bits[0] = PayTy(uint64_t(1));
+      }
+      auto pay_a = ctx->GetRank() == 0 ? pay_prot->SetA(pay_bits)
+                                       : pay_prot->GetA(num);
+      auto key_a = ctx->GetRank() == 0 ? prot->SetA(key_bits) : prot->GetA(num);
+      pay_prot->CheckBits(pay_a, key_a);
+    };
+    auto rank0 = std::async([&] { return task(context[0]); });
+    auto rank1 = std::async([&] { return task(context[1]); });
+    EXPECT_ANY_THROW(rank0.get());
+    EXPECT_ANY_THROW(rank1.get());
+  }
+}
+
+}  // namespace mcpsi
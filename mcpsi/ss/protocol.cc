@@ -176,6 +176,11 @@ std::vector<ATy> Protocol::ScalarMulAP(const ATy& scalar,
   DispatchAll(ScalarMulAP, scalar, in);
 }
 
+std::vector<GTy> Protocol::ScalarMulPG(const PTy& scalar,
+                                       absl::Span<const GTy> in, bool cache) {
+  DispatchAll(ScalarMulPG, scalar, in);
+}
+
 std::pair<std::vector<ATy>, std::vector<ATy>> Protocol::RandFairA(size_t num,
                                                                   bool cache) {
   DispatchAll(RandFairA, num);
@@ -286,8 +291,7 @@ bool Protocol::AShareDelayCheck() {
   }
   const size_t seed_len = val_buff_.size();
 
-  auto conn = ctx_->GetConnection();
-  auto sync_seed = conn->SyncSeed();
+  auto sync_seed = conn_->DrawCoin();
 
   auto prg = yacl::crypto::Prg<uint128_t>(sync_seed);
   std::vector<uint128_t> ext_seed(seed_len);
@@ -310,7 +314,7 @@ bool Protocol::AShareDelayCheck() {
     r_mac = r_mac + mac_affine;
   }
 
-  auto remote_r_val = conn->Exchange(r_val.GetVal());
+  auto remote_r_val = conn_->Exchange(r_val.GetVal());
   auto real_val = r_val + PTy(remote_r_val);
   auto zero_mac = r_mac - real_val * key_;
 
@@ -319,7 +323,7 @@ bool Protocol::AShareDelayCheck() {
   }
 
   auto bv = yacl::ByteContainerView(&zero_mac, sizeof(PTy));
-  auto remote_bv = conn->ExchangeWithCommit(bv);
+  auto remote_bv = conn_->ExchangeWithCommit(bv);
   bool flag = (bv == yacl::ByteContainerView(remote_bv));
   SPDLOG_INFO("AShareDelayCheck is {}", flag);
 
@@ -341,13 +345,11 @@ bool Protocol::DelayCheck() {
   if (check_buff_.size() == 0) {
     return true;
   }
-  auto conn = ctx_->GetConnection();
-
   auto hash_val = yacl::crypto::Sm3(yacl::ByteContainerView(
       check_buff_.data(), check_buff_.size() * sizeof(internal::PTy)));
   check_buff_.clear();
 
-  auto remote_hash_val = conn->ExchangeWithCommit(
+  auto remote_hash_val = conn_->ExchangeWithCommit(
       yacl::ByteContainerView(hash_val.data(), hash_val.size()));
   auto flag = (yacl::ByteContainerView(hash_val.data(), hash_val.size()) ==
                yacl::ByteContainerView(remote_hash_val));
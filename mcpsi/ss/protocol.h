@@ -24,6 +24,8 @@ using OP = internal::op;
 class Protocol : public State {
  private:
   std::shared_ptr<Context> ctx_;
+  // cached handle, owned by ctx_
+  Connection* conn_{nullptr};
   // SPDZ key
   PTy key_;
 
@@ -33,6 +35,9 @@ class Protocol : public State {
   GTy g_;  // the generator for PRF
   ATy k_;  // the distributed key for PRF
 
+  // fair reveal: the number of bits released per round (see FairA2P)
+  size_t fair_bits_{1};
+
   // plaintext check buffer
   std::vector<PTy> check_buff_;
   // a-share check buffer
@@ -41,13 +46,17 @@ class Protocol : public State {
 
  public:
   static const std::string id;
+  static constexpr StateSlot slot = StateSlot::kProtocol;
 
-  Protocol(std::shared_ptr<Context> ctx) : ctx_(ctx) {
+  Protocol(std::shared_ptr<Context> ctx)
+      : ctx_(ctx), conn_(ctx->GetStateRaw<Connection>()) {
     // SPDZ key setup
     key_ = PTy(yacl::crypto::SecureRandU128());
   }
   // SPDZ key
   PTy GetKey() const { return key_; }
+  // NOTE: only before the correlation is built (see SetupContext)
+  void SetKey(const PTy& key) { key_ = key; }
 
   // DY-PRF
   void SetupPrf() {
@@ -84,6 +93,14 @@ class Protocol : public State {
   ATy GetPrfK() const { return k_; }
   void RefreshPrfK() { k_ = RandA(1)[0]; }
 
+  // fair reveal, larger value means fewer rounds but coarser fairness
+  // NOTE: both parties should use the same value
+  size_t GetFairBits() const { return fair_bits_; }
+  void SetFairBits(size_t fair_bits) {
+    YACL_ENFORCE(fair_bits > 0);
+    fair_bits_ = fair_bits;
+  }
+
   // PP evaluation
   std::vector<PTy> Add(absl::Span<const PTy> lhs, absl::Span<const PTy> rhs,
                        bool cache = false);
@@ -130,6 +147,8 @@ class Protocol : public State {
   std::vector<MTy> A2M(absl::Span<const ATy> in, bool cache = false);
   std::vector<GTy> M2G(absl::Span<const MTy> in, bool cache = false);
   std::vector<GTy> A2G(absl::Span<const ATy> in, bool cache = false);
+  std::vector<GTy> ScalarMulPG(const PTy& scalar, absl::Span<const GTy> in,
+                               bool cache = false);
 
   // others
   std::vector<PTy> Inv(absl::Span<const PTy> in, bool cache = false);
@@ -38,7 +38,7 @@ REG_Num(Ones);
 REG_Num(Zeros);
 
 std::vector<PTy> RandP(std::shared_ptr<Context>& ctx, size_t num) {
-  return op::Rand(*ctx->GetState<Prg>(), num);
+  return op::Rand(*ctx->GetStateRaw<Prg>(), num);
 }
 
 #define REG_Bi_Cache(name)                                    \
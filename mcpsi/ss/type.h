@@ -22,16 +22,50 @@ using PTy = kFp256;
 using op = op256;
 using GTy = yc::EcPoint;
 
+// Field of the payload SPDZ instance (see payload.h), sums of 64-bit payloads
+// fit in it. The keys stay in PTy (the FourQ order) for the DY-PRF.
+using PayTy = kFp128;
+
+// vector operations (op64 / op128 / op256) of each field
+template <typename T>
+struct FieldTrait;
+
+template <>
+struct FieldTrait<kFp64> {
+  using Field = kFp64;
+  using Op = op64;
+};
+
+template <>
+struct FieldTrait<kFp128> {
+  using Field = kFp128;
+  using Op = op128;
+};
+
+template <>
+struct FieldTrait<kFp256> {
+  using Field = kFp256;
+  using Op = op256;
+};
+
+template <typename T>
+using FieldOp = typename FieldTrait<T>::Op;
+
+// T in a non-deduced context, i.e. T should be given (default PTy), so that
+// vectors still convert to spans
+template <typename T>
+using NonDeduced = typename FieldTrait<T>::Field;
 
 [[maybe_unused]] static auto kCurveName = std::string("fourq");
 [[maybe_unused]] static auto kCurveLib = std::string("FourQlib");
 [[maybe_unused]] static auto kOctetFormat = yc::PointOctetFormat::Autonomous;
 
 #pragma pack(8)
-// Distribute PTy with Mac (additive share)
-struct ATy {
-  PTy val;
-  PTy mac;
+// Distribute T with Mac (additive share)
+template <typename T>
+struct AShare {
+  T val;
+  T mac;
 };
 // Distribute GTy with Mac (multiplicative share)
 struct MTy {
@@ -40,63 +74,74 @@ struct MTy {
 };
 #pragma pack()
 
-void inline Pack(absl::Span<const PTy> val, absl::Span<const PTy> mac,
-                 absl::Span<ATy> ret) {
+using ATy = AShare<PTy>;
+using PayATy = AShare<PayTy>;
+
+template <typename T = PTy>
+void inline Pack(absl::Span<const NonDeduced<T>> val,
+                 absl::Span<const NonDeduced<T>> mac,
+                 absl::Span<AShare<NonDeduced<T>>> ret) {
   const size_t size = ret.size();
   YACL_ENFORCE(size == val.size());
   YACL_ENFORCE(size == mac.size());
-  auto ret_span = absl::MakeSpan(reinterpret_cast<PTy*>(ret.data()), size * 2);
+  auto ret_span = absl::MakeSpan(reinterpret_cast<T*>(ret.data()), size * 2);
   for (size_t i = 0; i < size; ++i) {
     ret_span[2 * i] = val[i];
     ret_span[2 * i + 1] = mac[i];
   }
 }
 
-std::vector<ATy> inline Pack(absl::Span<const PTy> val,
-                             absl::Span<const PTy> mac) {
+template <typename T = PTy>
+std::vector<AShare<T>> inline Pack(absl::Span<const NonDeduced<T>> val,
+                                   absl::Span<const NonDeduced<T>> mac) {
   const size_t size = val.size();
   YACL_ENFORCE(size == mac.size());
-  std::vector<ATy> ret(size);
-  Pack(val, mac, absl::MakeSpan(ret));
+  std::vector<AShare<T>> ret(size);
+  Pack<T>(val, mac, absl::MakeSpan(ret));
   return ret;
 }
 
-void inline Unpack(absl::Span<const ATy> in, absl::Span<PTy> val,
-                   absl::Span<PTy> mac) {
+template <typename T = PTy>
+void inline Unpack(absl::Span<const AShare<NonDeduced<T>>> in,
+                   absl::Span<NonDeduced<T>> val,
+                   absl::Span<NonDeduced<T>> mac) {
   const size_t size = in.size();
   auto in_span =
-      absl::MakeConstSpan(reinterpret_cast<const PTy*>(in.data()), size * 2);
+      absl::MakeConstSpan(reinterpret_cast<const T*>(in.data()), size * 2);
   for (size_t i = 0; i < size; ++i) {
     val[i] = in_span[i * 2];
     mac[i] = in_span[i * 2 + 1];
   }
 }
 
-std::pair<std::vector<PTy>, std::vector<PTy>> inline Unpack(
-    absl::Span<const ATy> in) {
+template <typename T = PTy>
+std::pair<std::vector<T>, std::vector<T>> inline Unpack(
+    absl::Span<const AShare<NonDeduced<T>>> in) {
   const size_t size = in.size();
-  std::vector<PTy> val(size);
-  std::vector<PTy> mac(size);
-  Unpack(in, absl::MakeSpan(val), absl::MakeSpan(mac));
+  std::vector<T> val(size);
+  std::vector<T> mac(size);
+  Unpack<T>(in, absl::MakeSpan(val), absl::MakeSpan(mac));
   return std::make_pair(val, mac);
 }
 
-std::vector<PTy> inline ExtractVal(absl::Span<const ATy> in) {
+template <typename T = PTy>
+std::vector<T> inline ExtractVal(absl::Span<const AShare<NonDeduced<T>>> in) {
   const size_t size = in.size();
-  std::vector<PTy> val(size);
+  std::vector<T> val(size);
   auto in_span =
-      absl::MakeConstSpan(reinterpret_cast<const PTy*>(in.data()), size * 2);
+      absl::MakeConstSpan(reinterpret_cast<const T*>(in.data()), size * 2);
   for (size_t i = 0; i < size; ++i) {
     val[i] = in_span[i * 2];
   }
   return val;
 }
 
-std::vector<PTy> inline ExtractMac(absl::Span<const ATy> in) {
+template <typename T = PTy>
+std::vector<T> inline ExtractMac(absl::Span<const AShare<NonDeduced<T>>> in) {
   const size_t size = in.size();
-  std::vector<PTy> mac(size);
+  std::vector<T> mac(size);
   auto in_span =
-      absl::MakeConstSpan(reinterpret_cast<const PTy*>(in.data()), size * 2);
+      absl::MakeConstSpan(reinterpret_cast<const T*>(in.data()), size * 2);
   for (size_t i = 0; i < size; ++i) {
     mac[i] = in_span[i * 2 + 1];
   }
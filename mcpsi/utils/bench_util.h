@@ -0,0 +1,118 @@
+#pragma once
+
+#include <array>
+#include <cstdlib>
+#include <future>
+#include <map>
+
+#include "benchmark/benchmark.h"
+#include "mcpsi/context/register.h"
+#include "mcpsi/utils/test_util.h"
+#include "yacl/utils/parallel.h"
+
+namespace mcpsi::bench {
+
+// Benchmark arguments: {size, threads}
+inline void SizeAndThreadArgs(benchmark::internal::Benchmark* b) {
+  b->ArgNames({"size", "threads"});
+  for (int64_t size : {1 << 10, 1 << 14, 1 << 16}) {
+    for (int64_t thread : {1, 4}) {
+      b->Args({size, thread});
+    }
+  }
+  b->Unit(benchmark::kMillisecond)->UseRealTime();
+}
+
+// WAN emulation from environment variables, e.g.
+// MCPSI_LATENCY_MS=20 MCPSI_BANDWIDTH_MBPS=100 MCPSI_JITTER_MS=2
+inline NetworkConfig GetBenchNetwork() {
+  auto get_env = [](const char* name) {
+    const char* val = std::getenv(name);
+    return val == nullptr ? 0.0 : std::atof(val);
+  };
+  NetworkConfig config;
+  config.latency_ms = get_env("MCPSI_LATENCY_MS");
+  config.bandwidth_mbps = get_env("MCPSI_BANDWIDTH_MBPS");
+  config.jitter_ms = get_env("MCPSI_JITTER_MS");
+  return config;
+}
+
+// Two in-memory parties (SetupWorld), setup once for each CR mode
+inline std::vector<std::shared_ptr<Context>>& GetBenchContext(
+    bool CR_mode = false) {
+  static std::map<bool, std::vector<std::shared_ptr<Context>>> ctxs;
+  auto iter = ctxs.find(CR_mode);
+  if (iter != ctxs.end()) {
+    return iter->second;
+  }
+  auto ctx = MockContext(2, GetBenchNetwork());
+  auto task0 = std::async([&] { SetupContext(ctx[0], CR_mode); });
+  auto task1 = std::async([&] { SetupContext(ctx[1], CR_mode); });
+  task0.get();
+  task1.get();
+  return ctxs.emplace(CR_mode, std::move(ctx)).first->second;
+}
+
+// Run the same routine for both parties, return the result of P0
+template <typename Func>
+auto RunParties(std::vector<std::shared_ptr<Context>>& ctxs, Func&& func) {
+  auto task0 = std::async([&] { return func(ctxs[0]); });
+  auto task1 = std::async([&] { return func(ctxs[1]); });
+  task1.get();
+  return task0.get();
+}
+
+// Run the same routine for both parties, return the results of both, e.g.
+// to generate the (per-party) inputs before the timed loop
+template <typename Func>
+auto RunPartiesAll(std::vector<std::shared_ptr<Context>>& ctxs, Func&& func) {
+  auto task0 = std::async([&] { return func(ctxs[0]); });
+  auto task1 = std::async([&] { return func(ctxs[1]); });
+  return std::array{task0.get(), task1.get()};
+}
+
+struct CommStats {
+  int64_t sent_bytes{0};
+  int64_t sent_actions{0};
+};
+
+// stats of a link && of all links spawned from it (e.g. OT extension && VOLE
+// in TrueCorrelation)
+inline CommStats GetCommStats(const std::shared_ptr<Connection>& conn) {
+  auto stats = conn->GetStats();
+  CommStats ret = {static_cast<int64_t>(stats->sent_bytes),
+                   static_cast<int64_t>(stats->sent_actions)};
+  for (const auto& link : conn->Spawned()) {
+    auto sub = GetCommStats(link);
+    ret.sent_bytes += sub.sent_bytes;
+    ret.sent_actions += sub.sent_actions;
+  }
+  return ret;
+}
+
+inline CommStats GetCommStats(const std::shared_ptr<Context>& ctx) {
+  return GetCommStats(ctx->GetConnection());
+}
+
+// ops/s       --> elements processed per second (both parties in parallel)
+// bytes/elem  --> bytes sent by P0 per element, spawned links included
+// sends       --> messages sent by P0 per iteration, spawned links included
+//                 (NOT rounds: messages sent back to back, or in parallel on
+//                 spawned links, count one by one)
+inline void ReportCounters(benchmark::State& state, size_t num,
+                           const CommStats& begin, const CommStats& end) {
+  const double iters = static_cast<double>(state.iterations());
+  const double elems = iters * num;
+  state.SetItemsProcessed(static_cast<int64_t>(elems));
+  state.counters["ops/s"] =
+      benchmark::Counter(elems, benchmark::Counter::kIsRate);
+  state.counters["bytes/elem"] = (end.sent_bytes - begin.sent_bytes) / elems;
+  state.counters["sends"] = (end.sent_actions - begin.sent_actions) / iters;
+}
+
+// local kernels, no communication
+inline void ReportCounters(benchmark::State& state, size_t num) {
+  ReportCounters(state, num, CommStats(), CommStats());
+}
+
+}  // namespace mcpsi::bench
@@ -1,15 +1,17 @@
 #pragma once
 
+#include <tuple>
+
 // #include "gmp.h"
-#include "boost/multiprecision/cpp_int.hpp"
 #include "mcpsi/utils/config.h"
+#include "mcpsi/utils/uint512.h"
 #include "yacl/base/int128.h"
 #include "yacl/crypto/utils/rand.h"
 
 namespace mcpsi {
 
 // using uint256_t = boost::multiprecision::uint256_t;
-using uint512_t = boost::multiprecision::uint512_t;
+using uint512_t = uint512;
 
 namespace {
 
@@ -68,36 +70,186 @@ inline uint512_t ToUint512(const uint128_t &val128) {
 }
 
 inline uint512_t ToUint512(const uint256_t &val256) {
-  return ToUint512(uint128_t(val256)) +
-         (ToUint512(uint128_t(val256 >> 128)) << 128);
+  return uint512_t(val256);
 }
 
 inline uint256_t ToUint256(const uint512_t &val512) {
-  auto low128 = static_cast<uint128_t>(val512);
-  auto high128 = static_cast<uint128_t>(val512 >> 128);
-  return uint256_t(high128, low128);
+  return Uint512Low256(val512);
+}
+
+// Division-free (Barrett) reduction for kFp64, kFp128 && kFp256, specialized
+// for Prime64, Prime128 && Prime256 at compile time
+// > x mod p = x - floor(floor(x / 2^(n-1)) * mu / 2^(n+1)) * p, then at most
+//   two conditional subtractions, for x < 2^(2n)
+// > p has n bits, mu = floor(2^(2n) / p)
+// larger inputs fold their top half first, 2^64 (2^128, 2^256) = R (mod p)
+// kFp256 works on the native limbs (see limb.h)
+namespace reduce {
+
+// 128 x 128 --> 256 bits
+void inline MulWide(uint128_t a, uint128_t b, uint128_t &hi, uint128_t &lo) {
+  const uint128_t mask = ~uint64_t(0);
+  const uint128_t p00 = (a & mask) * (b & mask);
+  const uint128_t p01 = (a & mask) * (b >> 64);
+  const uint128_t p10 = (a >> 64) * (b & mask);
+  const uint128_t p11 = (a >> 64) * (b >> 64);
+  const uint128_t mid = (p00 >> 64) + (p01 & mask) + (p10 & mask);
+  lo = (mid << 64) | (p00 & mask);
+  hi = p11 + (p01 >> 64) + (p10 >> 64) + (mid >> 64);
+}
+
+// floor(2^(2 * bits) / prime), long division
+constexpr uint128_t BarrettMu(uint128_t prime, size_t bits) {
+  uint128_t q = 0;
+  uint128_t r = 1;
+  for (size_t i = 0; i < 2 * bits; ++i) {
+    r <<= 1;
+    q <<= 1;
+    if (r >= prime) {
+      r -= prime;
+      q |= 1;
+    }
+  }
+  return q;
+}
+
+constexpr size_t kBits64 = 62;
+constexpr uint64_t kMu64 = static_cast<uint64_t>(BarrettMu(Prime64, kBits64));
+constexpr uint64_t kR64 = static_cast<uint64_t>((uint128_t(1) << 64) % Prime64);
+
+constexpr size_t kBits128 = 126;
+constexpr uint128_t kMu128 = BarrettMu(Prime128, kBits128);
+constexpr uint128_t kR128 = (~uint128_t(0)) % Prime128 + 1;
+
+constexpr size_t kBits256 = 246;
+constexpr limb::Limbs<4> kPrime256 = Uint256ToLimbs(Prime256);
+
+// floor(2^bits / Prime256) (or 2^bits mod Prime256), at compile time
+constexpr limb::Limbs<4> Pow2DivMod256(size_t bits, bool quotient) {
+  limb::Limbs<8> pow{};
+  pow[bits / 64] = uint64_t(1) << (bits % 64);
+  limb::Limbs<8> q{};
+  limb::Limbs<8> r{};
+  limb::DivMod(pow,
+               limb::Limbs<8>{kPrime256[0], kPrime256[1], kPrime256[2],
+                              kPrime256[3], 0, 0, 0, 0},
+               q, r);
+  const auto &ret = quotient ? q : r;
+  return {ret[0], ret[1], ret[2], ret[3]};
+}
+
+constexpr limb::Limbs<4> kMu256 = Pow2DivMod256(2 * kBits256, true);
+constexpr limb::Limbs<4> kR256 = Pow2DivMod256(256, false);
+
+static_assert((Prime64 >> (kBits64 - 1)) == 1);
+static_assert((Prime128 >> (kBits128 - 1)) == 1);
+// single-step Mod128: 2^126 + 3d < 2p, where d = 2^126 - p
+static_assert(5 * ((uint128_t(1) << kBits128) - Prime128) <
+              (uint128_t(1) << kBits128));
+static_assert(limb::BitLength(kPrime256) == kBits256);
+
+// x mod Prime64
+uint64_t inline Mod64(uint128_t x) {
+  if ((x >> (2 * kBits64)) != 0) {
+    x = static_cast<uint128_t>(Mod64(x >> 64)) * kR64 +
+        static_cast<uint64_t>(x);
+  }
+  const auto q = static_cast<uint64_t>(((x >> (kBits64 - 1)) * kMu64) >>
+                                       (kBits64 + 1));
+  // x - q * p < 3p < 2^64
+  auto r = static_cast<uint64_t>(x) - q * Prime64;
+  r = r >= Prime64 ? r - Prime64 : r;
+  return r >= Prime64 ? r - Prime64 : r;
 }
 
+// x mod Prime128, any x < 2^128 (> 4p, as p = 2^126 - d, d ~ 2^95): with
+// q = x >> 126, x - q * p = (x mod 2^126) + q * d < 2^126 + 3d < 2p
+uint128_t inline Mod128(uint128_t x) {
+  x -= (x >> kBits128) * Prime128;
+  return x >= Prime128 ? x - Prime128 : x;
+}
+
+// (hi * 2^128 + lo) mod Prime128
+uint128_t inline Mod128(uint128_t hi, uint128_t lo) {
+  if ((hi >> (2 * kBits128 - 128)) != 0) {
+    uint128_t fold_hi = 0;
+    uint128_t fold_lo = 0;
+    MulWide(Mod128(hi), kR128, fold_hi, fold_lo);
+    lo += fold_lo;
+    hi = fold_hi + (lo < fold_lo);
+  }
+  const uint128_t t = (hi << (128 - kBits128 + 1)) | (lo >> (kBits128 - 1));
+  uint128_t q_hi = 0;
+  uint128_t q_lo = 0;
+  MulWide(t, kMu128, q_hi, q_lo);
+  const uint128_t q =
+      (q_hi << (128 - kBits128 - 1)) | (q_lo >> (kBits128 + 1));
+  // lo - q * p < 3p < 2^128
+  auto r = lo - q * Prime128;
+  r = r >= Prime128 ? r - Prime128 : r;
+  return r >= Prime128 ? r - Prime128 : r;
+}
+
+// x mod Prime256, x is a 512-bit integer
+inline uint256_t Mod256(limb::Limbs<8> x) {
+  if (limb::ShiftRight<1>(x, 2 * kBits256)[0] != 0) {
+    const auto hi =
+        Mod256(limb::Limbs<8>{x[4], x[5], x[6], x[7], 0, 0, 0, 0});
+    // hi * R + lo < p^2 + 2^256 < 2^492
+    const auto fold = limb::Mul(Uint256ToLimbs(hi), kR256);
+    limb::Add(fold, limb::Limbs<8>{x[0], x[1], x[2], x[3], 0, 0, 0, 0}, x);
+  }
+  const auto t = limb::ShiftRight<4>(x, kBits256 - 1);
+  const auto q = limb::ShiftRight<4>(limb::Mul(t, kMu256), kBits256 + 1);
+  // x - q * p < 3p < 2^256
+  limb::Limbs<4> r{};
+  limb::Sub(limb::Limbs<4>{x[0], x[1], x[2], x[3]}, limb::MulLow(q, kPrime256),
+            r);
+  for (size_t i = 0; i < 2; ++i) {
+    limb::Limbs<4> diff{};
+    if (limb::Sub(r, kPrime256, diff) == 0) {
+      r = diff;
+    }
+  }
+  return Uint256FromLimbs(r);
+}
+
+inline uint256_t Mod256(const uint256_t &x) {
+  const auto limbs = Uint256ToLimbs(x);
+  return Mod256(
+      limb::Limbs<8>{limbs[0], limbs[1], limbs[2], limbs[3], 0, 0, 0, 0});
+}
+
+}  // namespace reduce
+
 class kFp64 {
  public:
   kFp64() : val_(0) {}
 
   kFp64(int val) : val_(val % Prime64) {}
 
-  kFp64(uint64_t val) : val_(val % Prime64) {}
+  kFp64(uint64_t val) : val_(reduce::Mod64(val)) {}
 
-  kFp64(uint128_t val) : val_(val % Prime64) {}
+  kFp64(uint128_t val) : val_(reduce::Mod64(val)) {}
 
-  kFp64 operator+(const kFp64 &rhs) const { return kFp64(val_ + rhs.val_); }
+  kFp64 operator+(const kFp64 &rhs) const {
+    kFp64 ret;
+    ret.val_ = val_ + rhs.val_;  // < 2p
+    ret.val_ = ret.val_ >= Prime64 ? ret.val_ - Prime64 : ret.val_;
+    return ret;
+  }
 
   kFp64 operator-(const kFp64 &rhs) const {
-    return kFp64(val_ - rhs.val_ + Prime64);
+    kFp64 ret;
+    ret.val_ = val_ - rhs.val_ + Prime64;  // < 2p
+    ret.val_ = ret.val_ >= Prime64 ? ret.val_ - Prime64 : ret.val_;
+    return ret;
   }
 
   kFp64 operator*(const kFp64 &rhs) const {
-    uint128_t l = val_;
-    uint128_t r = rhs.val_;
-    return kFp64(l * r);
+    kFp64 ret;
+    ret.val_ = reduce::Mod64(static_cast<uint128_t>(val_) * rhs.val_);
+    return ret;
   }
 
   kFp64 operator/(const kFp64 &rhs) const { return (*this) * Inv(rhs); }
@@ -151,20 +303,33 @@ class kFp128 {
 
   kFp128(uint64_t val) : val_(yacl::MakeUint128(0, val)) {}
 
-  kFp128(uint128_t val) : val_(val % Prime128) {}
+  kFp128(uint128_t val) : val_(reduce::Mod128(val)) {}
 
-  kFp128(uint256_t val) : val_(val % Prime128) {}
+  kFp128(uint256_t val)
+      : val_(reduce::Mod128(static_cast<uint128_t>(Uint256High128(val)),
+                            static_cast<uint128_t>(Uint256Low128(val)))) {}
 
-  kFp128 operator+(const kFp128 &rhs) const { return kFp128(val_ + rhs.val_); }
+  kFp128 operator+(const kFp128 &rhs) const {
+    kFp128 ret;
+    ret.val_ = val_ + rhs.val_;  // < 2p
+    ret.val_ = ret.val_ >= Prime128 ? ret.val_ - Prime128 : ret.val_;
+    return ret;
+  }
 
   kFp128 operator-(const kFp128 &rhs) const {
-    return kFp128(val_ + Prime128 - rhs.val_);
+    kFp128 ret;
+    ret.val_ = val_ + Prime128 - rhs.val_;  // < 2p
+    ret.val_ = ret.val_ >= Prime128 ? ret.val_ - Prime128 : ret.val_;
+    return ret;
   }
 
   kFp128 operator*(const kFp128 &rhs) const {
-    uint256_t l = val_;
-    uint256_t r = rhs.val_;
-    return kFp128(l * r);
+    uint128_t hi = 0;
+    uint128_t lo = 0;
+    reduce::MulWide(val_, rhs.val_, hi, lo);
+    kFp128 ret;
+    ret.val_ = reduce::Mod128(hi, lo);
+    return ret;
   }
 
   kFp128 operator/(const kFp128 &rhs) const { return (*this) * Inv(rhs); }
@@ -220,24 +385,29 @@ class kFp256 {
 
   kFp256(uint128_t val) : val_(val) {}
 
-  kFp256(uint256_t val) : val_(val % Prime256) {}
+  kFp256(uint256_t val) : val_(reduce::Mod256(val)) {}
 
-  kFp256(uint512_t val) {
-    uint512_t _prime = ToUint512(Prime256);
-    uint512_t val512 = val % _prime;
-    val_ = ToUint256(val512);
-  }
+  kFp256(uint512_t val) : val_(reduce::Mod256(val.limbs())) {}
 
-  kFp256 operator+(const kFp256 &rhs) const { return kFp256(val_ + rhs.val_); }
+  kFp256 operator+(const kFp256 &rhs) const {
+    kFp256 ret;
+    ret.val_ = val_ + rhs.val_;  // < 2p
+    ret.val_ = ret.val_ >= Prime256 ? ret.val_ - Prime256 : ret.val_;
+    return ret;
+  }
 
   kFp256 operator-(const kFp256 &rhs) const {
-    return kFp256(val_ + Prime256 - rhs.val_);
+    kFp256 ret;
+    ret.val_ = val_ + Prime256 - rhs.val_;  // < 2p
+    ret.val_ = ret.val_ >= Prime256 ? ret.val_ - Prime256 : ret.val_;
+    return ret;
   }
 
   kFp256 operator*(const kFp256 &rhs) const {
-    auto l = ToUint512(val_);
-    auto r = ToUint512(rhs.val_);
-    return kFp256(l * r);
+    kFp256 ret;
+    ret.val_ = reduce::Mod256(
+        limb::Mul(Uint256ToLimbs(val_), Uint256ToLimbs(rhs.val_)));
+    return ret;
   }
 
   kFp256 operator/(const kFp256 &rhs) const { return (*this) * Inv(rhs); }
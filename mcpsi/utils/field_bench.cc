@@ -0,0 +1,99 @@
+#include "benchmark/benchmark.h"
+#include "mcpsi/utils/bench_util.h"
+#include "mcpsi/utils/vec_op.h"
+
+namespace mcpsi {
+
+namespace {
+
+template <typename OpTy>
+void BM_Add(benchmark::State& state) {
+  const size_t num = state.range(0);
+  yacl::set_num_threads(state.range(1));
+  auto lhs = OpTy::Rand(num);
+  auto rhs = OpTy::Rand(num);
+  auto out = OpTy::Zeros(num);
+  for (auto _ : state) {
+    OpTy::Add(absl::MakeConstSpan(lhs), absl::MakeConstSpan(rhs),
+              absl::MakeSpan(out));
+    benchmark::DoNotOptimize(out.data());
+  }
+  bench::ReportCounters(state, num);
+}
+
+template <typename OpTy>
+void BM_Mul(benchmark::State& state) {
+  const size_t num = state.range(0);
+  yacl::set_num_threads(state.range(1));
+  auto lhs = OpTy::Rand(num);
+  auto rhs = OpTy::Rand(num);
+  auto out = OpTy::Zeros(num);
+  for (auto _ : state) {
+    OpTy::Mul(absl::MakeConstSpan(lhs), absl::MakeConstSpan(rhs),
+              absl::MakeSpan(out));
+    benchmark::DoNotOptimize(out.data());
+  }
+  bench::ReportCounters(state, num);
+}
+
+template <typename OpTy>
+void BM_Inv(benchmark::State& state) {
+  const size_t num = state.range(0);
+  yacl::set_num_threads(state.range(1));
+  auto in = OpTy::Rand(num);
+  auto out = OpTy::Zeros(num);
+  for (auto _ : state) {
+    OpTy::Inv(absl::MakeConstSpan(in), absl::MakeSpan(out));
+    benchmark::DoNotOptimize(out.data());
+  }
+  bench::ReportCounters(state, num);
+}
+
+template <typename OpTy>
+void BM_Rand(benchmark::State& state) {
+  const size_t num = state.range(0);
+  yacl::set_num_threads(state.range(1));
+  auto out = OpTy::Zeros(num);
+  for (auto _ : state) {
+    OpTy::Rand(absl::MakeSpan(out));
+    benchmark::DoNotOptimize(out.data());
+  }
+  bench::ReportCounters(state, num);
+}
+
+template <typename OpTy>
+void BM_InPro(benchmark::State& state) {
+  const size_t num = state.range(0);
+  yacl::set_num_threads(state.range(1));
+  auto lhs = OpTy::Rand(num);
+  auto rhs = OpTy::Rand(num);
+  for (auto _ : state) {
+    auto ret = OpTy::InPro(absl::MakeConstSpan(lhs), absl::MakeConstSpan(rhs));
+    benchmark::DoNotOptimize(ret);
+  }
+  bench::ReportCounters(state, num);
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_Add, op64)->Apply(bench::SizeAndThreadArgs);
+BENCHMARK_TEMPLATE(BM_Add, op128)->Apply(bench::SizeAndThreadArgs);
+BENCHMARK_TEMPLATE(BM_Add, op256)->Apply(bench::SizeAndThreadArgs);
+
+BENCHMARK_TEMPLATE(BM_Mul, op64)->Apply(bench::SizeAndThreadArgs);
+BENCHMARK_TEMPLATE(BM_Mul, op128)->Apply(bench::SizeAndThreadArgs);
+BENCHMARK_TEMPLATE(BM_Mul, op256)->Apply(bench::SizeAndThreadArgs);
+
+BENCHMARK_TEMPLATE(BM_Inv, op64)->Apply(bench::SizeAndThreadArgs);
+BENCHMARK_TEMPLATE(BM_Inv, op128)->Apply(bench::SizeAndThreadArgs);
+BENCHMARK_TEMPLATE(BM_Inv, op256)->Apply(bench::SizeAndThreadArgs);
+
+BENCHMARK_TEMPLATE(BM_Rand, op64)->Apply(bench::SizeAndThreadArgs);
+BENCHMARK_TEMPLATE(BM_Rand, op128)->Apply(bench::SizeAndThreadArgs);
+BENCHMARK_TEMPLATE(BM_Rand, op256)->Apply(bench::SizeAndThreadArgs);
+
+BENCHMARK_TEMPLATE(BM_InPro, op64)->Apply(bench::SizeAndThreadArgs);
+BENCHMARK_TEMPLATE(BM_InPro, op128)->Apply(bench::SizeAndThreadArgs);
+BENCHMARK_TEMPLATE(BM_InPro, op256)->Apply(bench::SizeAndThreadArgs);
+
+}  // namespace mcpsi
@@ -1,5 +1,8 @@
 #include "field.h"
 
+#include <vector>
+
+#include "boost/multiprecision/cpp_int.hpp"
 #include "gtest/gtest.h"
 namespace mcpsi {
 
@@ -113,6 +116,66 @@ TEST(kFp128Test, InvWork) {
   EXPECT_EQ(ret3, kFp128(1));
 }
 
+TEST(BarrettTest, kFp64Work) {
+  const uint64_t prime = kFp64::GetPrime();
+  std::vector<uint128_t> in = {0, prime - 1, prime, ~uint64_t(0),
+                               static_cast<uint128_t>(prime - 1) * (prime - 1),
+                               ~uint128_t(0)};
+  for (size_t i = 0; i < 1000; ++i) {
+    uint128_t val = kFp64::Rand().GetVal();
+    in.push_back((val << 64) | kFp64::Rand().GetVal());
+  }
+  for (const auto &val : in) {
+    EXPECT_EQ(kFp64(val).GetVal(), static_cast<uint64_t>(val % prime));
+  }
+  EXPECT_EQ(kFp64(prime - 1) * kFp64(prime - 1), kFp64(1));
+}
+
+TEST(BarrettTest, kFp128Work) {
+  const uint128_t prime = kFp128::GetPrime();
+  EXPECT_EQ(kFp128(~uint128_t(0)).GetVal(), ~uint128_t(0) % prime);
+  EXPECT_EQ(kFp128(prime - 1) * kFp128(prime - 1), kFp128(1));
+  EXPECT_EQ(kFp128(~uint256_t(0)).GetVal(),
+            static_cast<uint128_t>(~uint256_t(0) % uint256_t(prime)));
+  for (size_t i = 0; i < 1000; ++i) {
+    auto lhs = kFp128::Rand();
+    auto rhs = kFp128::Rand();
+    auto expect = uint256_t(lhs.GetVal()) * uint256_t(rhs.GetVal()) %
+                  uint256_t(prime);
+    EXPECT_EQ((lhs * rhs).GetVal(), static_cast<uint128_t>(expect));
+  }
+}
+
+TEST(BarrettTest, kFp256Work) {
+  // boost is only the oracle
+  using BoostUint = boost::multiprecision::uint1024_t;
+  auto to_boost = [](const uint512_t &val) {
+    BoostUint ret = 0;
+    for (size_t i = 8; i-- > 0;) {
+      ret = (ret << 64) | val.limbs()[i];
+    }
+    return ret;
+  };
+  const BoostUint prime = to_boost(ToUint512(kFp256::GetPrime()));
+  const uint256_t prime256 = kFp256::GetPrime();
+
+  EXPECT_EQ(kFp256(prime256 - 1) * kFp256(prime256 - 1), kFp256(1));
+  EXPECT_EQ(to_boost(ToUint512(kFp256(Uint256Max()).GetVal())),
+            to_boost(ToUint512(Uint256Max())) % prime);
+  EXPECT_EQ(to_boost(ToUint512(kFp256(~uint512_t()).GetVal())),
+            to_boost(~uint512_t()) % prime);
+  for (size_t i = 0; i < 1000; ++i) {
+    auto lhs = kFp256::Rand();
+    auto rhs = kFp256::Rand();
+    auto expect = to_boost(ToUint512(lhs.GetVal())) *
+                  to_boost(ToUint512(rhs.GetVal())) % prime;
+    EXPECT_EQ(to_boost(ToUint512((lhs * rhs).GetVal())), expect);
+    auto wide = uint512_t(lhs.GetVal(), rhs.GetVal());
+    EXPECT_EQ(to_boost(ToUint512(kFp256(wide).GetVal())),
+              to_boost(wide) % prime);
+  }
+}
+
 TEST(kFp256Test, AddWork) {
   auto lhs = kFp256::Rand();
   auto rhs = kFp256::Rand();
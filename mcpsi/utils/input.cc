@@ -0,0 +1,211 @@
+#include "mcpsi/utils/input.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+
+#include "yacl/base/exception.h"
+#include "yacl/crypto/base/hash/hash_utils.h"
+#include "yacl/utils/parallel.h"
+
+namespace mcpsi {
+
+namespace {
+
+// bytes per csv chunk (at least)
+constexpr size_t kMinChunk = 1 << 16;
+// keep the first 245 bits, 2^245 < p
+constexpr uint64_t kTopMask = (uint64_t(1) << 53) - 1;
+
+uint256_t Hash(std::string_view id) {
+  auto digest =
+      yacl::crypto::Blake3(yacl::ByteContainerView(id.data(), id.size()));
+  uint64_t words[4];
+  memcpy(words, digest.data(), sizeof(words));
+  return uint256_t(absl::MakeUint128(words[3] & kTopMask, words[2]),
+                   absl::MakeUint128(words[1], words[0]));
+}
+
+std::string_view Trim(std::string_view in) {
+  const char* space = " \t\r";
+  auto bg = in.find_first_not_of(space);
+  if (bg == std::string_view::npos) {
+    return {};
+  }
+  auto ed = in.find_last_not_of(space);
+  return in.substr(bg, ed - bg + 1);
+}
+
+// call `func` on each non-empty line of `text`
+template <typename Func>
+void ForEachLine(std::string_view text, Func&& func) {
+  while (!text.empty()) {
+    auto pos = text.find('\n');
+    auto line = Trim(text.substr(0, pos));
+    if (!line.empty()) {
+      func(line);
+    }
+    if (pos == std::string_view::npos) {
+      break;
+    }
+    text.remove_prefix(pos + 1);
+  }
+}
+
+std::string_view Field(std::string_view line, char delim, size_t col) {
+  for (size_t i = 0; i < col; ++i) {
+    auto pos = line.find(delim);
+    YACL_ENFORCE(pos != std::string_view::npos, "no column {} in row: {}", col,
+                 line);
+    line.remove_prefix(pos + 1);
+  }
+  return Trim(line.substr(0, line.find(delim)));
+}
+
+uint64_t ParsePayload(std::string_view field) {
+  uint64_t ret = 0;
+  const char* end = field.data() + field.size();
+  auto [ptr, ec] = std::from_chars(field.data(), end, ret);
+  YACL_ENFORCE(ec == std::errc() && ptr == end, "broken payload: {}", field);
+  return ret;
+}
+
+InputTable LoadCsv(std::string_view text, const InputOptions& options) {
+  if (options.header) {
+    auto pos = text.find('\n');
+    text.remove_prefix(pos == std::string_view::npos ? text.size() : pos + 1);
+  }
+
+  // split at line boundaries
+  const size_t chunk_num = std::max<size_t>(
+      1, std::min<size_t>(text.size() / kMinChunk,
+                          yacl::get_num_threads() * 4));
+  std::vector<size_t> bounds(chunk_num + 1, text.size());
+  bounds[0] = 0;
+  for (size_t i = 1; i < chunk_num; ++i) {
+    auto pos = text.find('\n', std::max(i * text.size() / chunk_num,
+                                        bounds[i - 1]));
+    bounds[i] = pos == std::string_view::npos ? text.size() : pos + 1;
+  }
+  auto chunk = [&](size_t i) {
+    return text.substr(bounds[i], bounds[i + 1] - bounds[i]);
+  };
+
+  // 1. count rows of each chunk
+  std::vector<size_t> offsets(chunk_num + 1, 0);
+  yacl::parallel_for(0, chunk_num, 1, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      ForEachLine(chunk(i), [&](std::string_view) { ++offsets[i + 1]; });
+    }
+  });
+  for (size_t i = 0; i < chunk_num; ++i) {
+    offsets[i + 1] += offsets[i];
+  }
+
+  // 2. parse && hash rows into their places
+  InputTable table;
+  table.keys.resize(offsets[chunk_num]);
+  if (options.payload) {
+    table.payloads.resize(offsets[chunk_num]);
+  }
+  auto keys = reinterpret_cast<uint256_t*>(table.keys.data());
+  yacl::parallel_for(0, chunk_num, 1, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      size_t idx = offsets[i];
+      ForEachLine(chunk(i), [&](std::string_view line) {
+        keys[idx] = Hash(Field(line, options.delim, options.key_col));
+        if (options.payload) {
+          table.payloads[idx] = kFp256(
+              ParsePayload(Field(line, options.delim, options.payload_col)));
+        }
+        ++idx;
+      });
+    }
+  });
+  return table;
+}
+
+InputTable LoadBinary(std::string_view data, const InputOptions& options) {
+  const size_t record =
+      options.key_bytes + (options.payload ? sizeof(uint64_t) : 0);
+  YACL_ENFORCE(options.key_bytes > 0);
+  YACL_ENFORCE(data.size() % record == 0, "broken binary input");
+  const size_t num = data.size() / record;
+
+  InputTable table;
+  table.keys.resize(num);
+  if (options.payload) {
+    table.payloads.resize(num);
+  }
+  auto keys = reinterpret_cast<uint256_t*>(table.keys.data());
+  yacl::parallel_for(0, num, 4096, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      auto row = data.substr(i * record, record);
+      keys[i] = Hash(row.substr(0, options.key_bytes));
+      if (options.payload) {
+        uint64_t val = 0;
+        memcpy(&val, row.data() + options.key_bytes, sizeof(val));
+        table.payloads[i] = kFp256(val);
+      }
+    }
+  });
+  return table;
+}
+
+}  // namespace
+
+MappedFile::MappedFile(const std::string& path) {
+  fd_ = ::open(path.c_str(), O_RDONLY);
+  YACL_ENFORCE(fd_ >= 0, "cannot open {}", path);
+  struct stat st;
+  YACL_ENFORCE(::fstat(fd_, &st) == 0, "cannot stat {}", path);
+  size_ = static_cast<size_t>(st.st_size);
+  if (size_ == 0) {
+    return;
+  }
+  auto ptr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+  YACL_ENFORCE(ptr != MAP_FAILED, "cannot mmap {}", path);
+  ::madvise(ptr, size_, MADV_SEQUENTIAL);
+  data_ = static_cast<const char*>(ptr);
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    ::munmap(const_cast<char*>(data_), size_);
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+void HashToField(absl::Span<const std::string_view> ids,
+                 absl::Span<kFp256> out) {
+  YACL_ENFORCE(ids.size() == out.size());
+  auto out256 = reinterpret_cast<uint256_t*>(out.data());
+  yacl::parallel_for(0, ids.size(), 4096, [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      out256[i] = Hash(ids[i]);
+    }
+  });
+}
+
+kFp256 HashToField(std::string_view id) {
+  kFp256 ret;
+  *reinterpret_cast<uint256_t*>(&ret) = Hash(id);
+  return ret;
+}
+
+InputTable LoadInput(const std::string& path, const InputOptions& options) {
+  MappedFile file(path);
+  if (options.binary) {
+    return LoadBinary(file.View(), options);
+  }
+  return LoadCsv(file.View(), options);
+}
+
+}  // namespace mcpsi
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "mcpsi/utils/field.h"
+
+namespace mcpsi {
+
+// Read-only memory map of a whole file
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& path);
+
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  std::string_view View() const { return {data_, size_}; }
+
+  size_t Size() const { return size_; }
+
+ private:
+  int fd_{-1};
+  const char* data_{nullptr};
+  size_t size_{0};
+};
+
+// Hash identifiers into kFp256 (in parallel), the first 245 bits of
+// Blake3(id). 2^245 < p, so no modular reduction is needed.
+void HashToField(absl::Span<const std::string_view> ids,
+                 absl::Span<kFp256> out);
+
+kFp256 HashToField(std::string_view id);
+
+struct InputOptions {
+  // binary: fixed-size records, `key_bytes` bytes of identifier followed by
+  //         a 64-bit payload (little-endian) if `payload`
+  // csv   : one row per line, no quoted fields
+  bool binary{false};
+  size_t key_bytes{16};
+  bool payload{false};
+  // csv only
+  char delim{','};
+  size_t key_col{0};
+  size_t payload_col{1};
+  bool header{false};
+};
+
+// rows of an input file
+struct InputTable {
+  // hashed identifiers
+  std::vector<kFp256> keys;
+  // payloads, empty if no payload column
+  std::vector<kFp256> payloads;
+};
+
+// Memory-map `path`, then parse && hash it in parallel. Rows are split into
+// chunks (at line boundaries for csv), each chunk writes its rows into the
+// output directly.
+InputTable LoadInput(const std::string& path, const InputOptions& options);
+
+}  // namespace mcpsi
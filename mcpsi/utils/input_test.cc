@@ -0,0 +1,77 @@
+#include "mcpsi/utils/input.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "gtest/gtest.h"
+
+namespace mcpsi {
+
+TEST(InputTest, CsvWork) {
+  const std::string path = "input_test.csv";
+  size_t num = 20000;
+  {
+    std::ofstream out(path);
+    out << "id,amount" << std::endl;
+    for (size_t i = 0; i < num; ++i) {
+      out << "user" << i << ", " << i * 3 << "\r\n";
+      if (i % 1000 == 0) {
+        out << std::endl;  // empty line
+      }
+    }
+  }
+
+  InputOptions options;
+  options.header = true;
+  options.payload = true;
+  auto table = LoadInput(path, options);
+  EXPECT_EQ(table.keys.size(), num);
+  EXPECT_EQ(table.payloads.size(), num);
+  for (size_t i = 0; i < num; ++i) {
+    EXPECT_TRUE(table.keys[i] == HashToField("user" + std::to_string(i)));
+    EXPECT_TRUE(table.payloads[i] == kFp256(uint64_t(i * 3)));
+  }
+  EXPECT_TRUE(table.keys[0] != table.keys[1]);
+
+  std::remove(path.c_str());
+}
+
+TEST(InputTest, BinaryWork) {
+  const std::string path = "input_test.bin";
+  size_t num = 10000;
+  std::vector<std::string_view> ids;
+  std::vector<std::string> id_bufs(num);
+  {
+    std::ofstream out(path, std::ios::binary);
+    for (size_t i = 0; i < num; ++i) {
+      id_bufs[i] = std::string(16, 'a' + i % 26);
+      memcpy(id_bufs[i].data(), &i, sizeof(i));
+      uint64_t val = i + 1;
+      out.write(id_bufs[i].data(), id_bufs[i].size());
+      out.write(reinterpret_cast<const char*>(&val), sizeof(val));
+    }
+  }
+  for (const auto& id : id_bufs) {
+    ids.emplace_back(id);
+  }
+
+  InputOptions options;
+  options.binary = true;
+  options.key_bytes = 16;
+  options.payload = true;
+  auto table = LoadInput(path, options);
+  std::vector<kFp256> expect(num);
+  HashToField(ids, absl::MakeSpan(expect));
+  EXPECT_EQ(table.keys.size(), num);
+  for (size_t i = 0; i < num; ++i) {
+    EXPECT_TRUE(table.keys[i] == expect[i]);
+    EXPECT_TRUE(table.payloads[i] == kFp256(uint64_t(i + 1)));
+    // no reduction needed
+    EXPECT_TRUE(kFp256(expect[i].GetVal()) == expect[i]);
+  }
+
+  std::remove(path.c_str());
+}
+
+}  // namespace mcpsi
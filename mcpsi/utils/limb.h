@@ -0,0 +1,225 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "yacl/base/int128.h"
+
+namespace mcpsi {
+
+// Native multi-precision arithmetic over little-endian 64-bit limbs, the core
+// of uint256 && uint512 (&& of the kFp256 reduction). All of them are
+// constexpr, products && quotients of two limbs go through uint128_t.
+namespace limb {
+
+template <size_t N>
+using Limbs = std::array<uint64_t, N>;
+
+// out = a + b, returns the carry
+template <size_t N>
+constexpr uint64_t Add(const Limbs<N>& a, const Limbs<N>& b, Limbs<N>& out) {
+  uint64_t carry = 0;
+  for (size_t i = 0; i < N; ++i) {
+    const uint128_t sum = static_cast<uint128_t>(a[i]) + b[i] + carry;
+    out[i] = static_cast<uint64_t>(sum);
+    carry = static_cast<uint64_t>(sum >> 64);
+  }
+  return carry;
+}
+
+// out = a - b, returns the borrow
+template <size_t N>
+constexpr uint64_t Sub(const Limbs<N>& a, const Limbs<N>& b, Limbs<N>& out) {
+  uint64_t borrow = 0;
+  for (size_t i = 0; i < N; ++i) {
+    const uint64_t diff = a[i] - b[i];
+    const uint64_t next = (a[i] < b[i]) || (diff < borrow);
+    out[i] = diff - borrow;
+    borrow = next;
+  }
+  return borrow;
+}
+
+// full product, N x M --> N + M limbs (schoolbook)
+template <size_t N, size_t M>
+constexpr Limbs<N + M> Mul(const Limbs<N>& a, const Limbs<M>& b) {
+  Limbs<N + M> out{};
+  for (size_t i = 0; i < N; ++i) {
+    uint64_t carry = 0;
+    for (size_t j = 0; j < M; ++j) {
+      const uint128_t cur =
+          static_cast<uint128_t>(a[i]) * b[j] + out[i + j] + carry;
+      out[i + j] = static_cast<uint64_t>(cur);
+      carry = static_cast<uint64_t>(cur >> 64);
+    }
+    out[i + M] = carry;
+  }
+  return out;
+}
+
+// low half of the product, N x N --> N limbs (mod 2^(64N))
+template <size_t N>
+constexpr Limbs<N> MulLow(const Limbs<N>& a, const Limbs<N>& b) {
+  Limbs<N> out{};
+  for (size_t i = 0; i < N; ++i) {
+    uint64_t carry = 0;
+    for (size_t j = 0; i + j < N; ++j) {
+      const uint128_t cur =
+          static_cast<uint128_t>(a[i]) * b[j] + out[i + j] + carry;
+      out[i + j] = static_cast<uint64_t>(cur);
+      carry = static_cast<uint64_t>(cur >> 64);
+    }
+  }
+  return out;
+}
+
+// a << bits, truncated to N limbs
+template <size_t N>
+constexpr Limbs<N> ShiftLeft(const Limbs<N>& a, size_t bits) {
+  Limbs<N> out{};
+  const size_t limbs = bits / 64;
+  const size_t rem = bits % 64;
+  for (size_t i = N; i-- > limbs;) {
+    out[i] = a[i - limbs] << rem;
+    if (rem != 0 && i > limbs) {
+      out[i] |= a[i - limbs - 1] >> (64 - rem);
+    }
+  }
+  return out;
+}
+
+// a >> bits, into M limbs (e.g. the quotient of a power of two)
+template <size_t M, size_t N>
+constexpr Limbs<M> ShiftRight(const Limbs<N>& a, size_t bits) {
+  Limbs<M> out{};
+  const size_t limbs = bits / 64;
+  const size_t rem = bits % 64;
+  for (size_t i = 0; i < M && i + limbs < N; ++i) {
+    out[i] = a[i + limbs] >> rem;
+    if (rem != 0 && i + limbs + 1 < N) {
+      out[i] |= a[i + limbs + 1] << (64 - rem);
+    }
+  }
+  return out;
+}
+
+// -1, 0 or 1 for a < b, a == b or a > b
+template <size_t N>
+constexpr int Compare(const Limbs<N>& a, const Limbs<N>& b) {
+  for (size_t i = N; i-- > 0;) {
+    if (a[i] != b[i]) {
+      return a[i] < b[i] ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+// number of limbs without the leading zeros
+template <size_t N>
+constexpr size_t Size(const Limbs<N>& a) {
+  size_t size = N;
+  while (size > 0 && a[size - 1] == 0) {
+    --size;
+  }
+  return size;
+}
+
+template <size_t N>
+constexpr size_t BitLength(const Limbs<N>& a) {
+  const size_t size = Size(a);
+  return size == 0 ? 0 : 64 * size - __builtin_clzll(a[size - 1]);
+}
+
+// a = q * b + r, b != 0 (Knuth, TAOCP vol.2 4.3.1, algorithm D)
+// > one 128 / 64 division per quotient limb, instead of one subtraction per
+//   quotient bit
+template <size_t N>
+constexpr void DivMod(const Limbs<N>& a, const Limbs<N>& b, Limbs<N>& q,
+                      Limbs<N>& r) {
+  const size_t n = Size(b);
+  const size_t m = Size(a);
+  q = Limbs<N>{};
+  if (m < n) {
+    r = a;
+    return;
+  }
+  r = Limbs<N>{};
+  // short division
+  if (n == 1) {
+    uint128_t rem = 0;
+    for (size_t i = m; i-- > 0;) {
+      const uint128_t cur = (rem << 64) | a[i];
+      q[i] = static_cast<uint64_t>(cur / b[0]);
+      rem = cur % b[0];
+    }
+    r[0] = static_cast<uint64_t>(rem);
+    return;
+  }
+  // normalize, such that the top limb of the divisor has its msb set
+  const size_t shift = __builtin_clzll(b[n - 1]);
+  const Limbs<N> v = ShiftLeft(b, shift);
+  std::array<uint64_t, N + 1> u{};
+  for (size_t i = 0; i < m; ++i) {
+    u[i] = a[i] << shift;
+    if (shift != 0 && i > 0) {
+      u[i] |= a[i - 1] >> (64 - shift);
+    }
+  }
+  u[m] = shift == 0 ? 0 : a[m - 1] >> (64 - shift);
+
+  for (size_t j = m - n + 1; j-- > 0;) {
+    // estimate the quotient limb by the top two limbs, it is at most 2 more
+    const uint128_t top =
+        (static_cast<uint128_t>(u[j + n]) << 64) | u[j + n - 1];
+    uint128_t qhat = top / v[n - 1];
+    uint128_t rhat = top % v[n - 1];
+    while ((qhat >> 64) != 0 ||
+           qhat * v[n - 2] > ((rhat << 64) | u[j + n - 2])) {
+      --qhat;
+      rhat += v[n - 1];
+      if ((rhat >> 64) != 0) {
+        break;
+      }
+    }
+    // u[j..j+n] -= qhat * v
+    uint64_t carry = 0;
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+      const uint128_t prod = qhat * v[i] + carry;
+      carry = static_cast<uint64_t>(prod >> 64);
+      const auto low = static_cast<uint64_t>(prod);
+      const uint64_t diff = u[i + j] - low;
+      const uint64_t next = (u[i + j] < low) || (diff < borrow);
+      u[i + j] = diff - borrow;
+      borrow = next;
+    }
+    const uint64_t diff = u[j + n] - carry;
+    const bool negative = (u[j + n] < carry) || (diff < borrow);
+    u[j + n] = diff - borrow;
+    // the estimation was one too large, add back
+    if (negative) {
+      --qhat;
+      uint64_t add_carry = 0;
+      for (size_t i = 0; i < n; ++i) {
+        const uint128_t sum =
+            static_cast<uint128_t>(u[i + j]) + v[i] + add_carry;
+        u[i + j] = static_cast<uint64_t>(sum);
+        add_carry = static_cast<uint64_t>(sum >> 64);
+      }
+      u[j + n] += add_carry;
+    }
+    q[j] = static_cast<uint64_t>(qhat);
+  }
+  // unnormalize the remainder
+  for (size_t i = 0; i < n; ++i) {
+    r[i] = u[i] >> shift;
+    if (shift != 0) {
+      r[i] |= u[i + 1] << (64 - shift);
+    }
+  }
+}
+
+}  // namespace limb
+
+}  // namespace mcpsi
@@ -0,0 +1,113 @@
+#include "mcpsi/utils/sampler.h"
+
+#include <algorithm>
+#include <array>
+
+#include "yacl/crypto/base/aes/aes_intrinsics.h"
+#include "yacl/utils/parallel.h"
+
+namespace mcpsi::sampler {
+
+namespace yc = yacl::crypto;
+
+namespace {
+
+// AES blocks per batch of candidates
+constexpr size_t kBatch = 256;
+
+// candidates of each field, in 128-bit words
+// > Accept writes the raw value of the element && tells whether the
+//   candidate is kept
+template <typename T>
+struct Candidate;
+
+template <>
+struct Candidate<kFp64> {
+  using RawTy = uint64_t;
+  static constexpr size_t kWords = 1;
+
+  static bool Accept(const uint128_t* words, RawTy& out) {
+    out = reduce::Mod64(words[0]);
+    return true;
+  }
+};
+
+template <>
+struct Candidate<kFp128> {
+  using RawTy = uint128_t;
+  static constexpr size_t kWords = 1;
+  static constexpr uint128_t kMask = (uint128_t(1) << reduce::kBits128) - 1;
+
+  // p > 2^126 - 2^95, almost every candidate is kept
+  static bool Accept(const uint128_t* words, RawTy& out) {
+    out = words[0] & kMask;
+    return out < Prime128;
+  }
+};
+
+template <>
+struct Candidate<kFp256> {
+  using RawTy = uint256_t;
+  static constexpr size_t kWords = 2;
+  static constexpr uint128_t kMask =
+      (uint128_t(1) << (reduce::kBits256 - 128)) - 1;
+
+  // p ~ 0.65 * 2^246 (FourQ order), about 1.5 candidates per element;
+  // FillBlock draws batches until the block is full, the rate only costs
+  // AES calls
+  static bool Accept(const uint128_t* words, RawTy& out) {
+    const uint128_t top = words[1] & kMask;
+    out = Uint256FromLimbs({static_cast<uint64_t>(words[0]),
+                            static_cast<uint64_t>(words[0] >> 64),
+                            static_cast<uint64_t>(top),
+                            static_cast<uint64_t>(top >> 64)});
+    return out < Prime256;
+  }
+};
+
+// fill block `idx` from its own counter-mode stream
+template <typename T>
+void FillBlock(const yc::AES_KEY& key, uint64_t idx,
+               absl::Span<typename Candidate<T>::RawTy> out) {
+  constexpr size_t kWords = Candidate<T>::kWords;
+  std::array<uint128_t, kBatch * kWords> buf;
+  uint64_t ctr = 0;
+  size_t filled = 0;
+  while (filled < out.size()) {
+    for (auto& e : buf) {
+      e = (static_cast<uint128_t>(idx) << 64) | ctr++;
+    }
+    yc::AES_ecb_encrypt_blks(key, buf.data(), buf.size(), buf.data());
+    for (size_t i = 0; i < kBatch && filled < out.size(); ++i) {
+      filled += Candidate<T>::Accept(buf.data() + i * kWords, out[filled]);
+    }
+  }
+}
+
+template <typename T>
+void RandImpl(uint128_t seed, absl::Span<T> out) {
+  using RawTy = typename Candidate<T>::RawTy;
+  static_assert(sizeof(RawTy) == sizeof(T));
+
+  const size_t size = out.size();
+  const size_t num_blocks = (size + kBlockSize - 1) / kBlockSize;
+  const auto key = yc::AES_set_encrypt_key(seed);
+  auto raw = absl::MakeSpan(reinterpret_cast<RawTy*>(out.data()), size);
+  yacl::parallel_for(0, num_blocks, 1, [&](uint64_t bg, uint64_t ed) {
+    for (uint64_t idx = bg; idx < ed; ++idx) {
+      const size_t offset = idx * kBlockSize;
+      FillBlock<T>(key, idx,
+                   raw.subspan(offset, std::min(kBlockSize, size - offset)));
+    }
+  });
+}
+
+}  // namespace
+
+void Rand(uint128_t seed, absl::Span<kFp64> out) { RandImpl(seed, out); }
+
+void Rand(uint128_t seed, absl::Span<kFp128> out) { RandImpl(seed, out); }
+
+void Rand(uint128_t seed, absl::Span<kFp256> out) { RandImpl(seed, out); }
+
+}  // namespace mcpsi::sampler
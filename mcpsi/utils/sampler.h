@@ -0,0 +1,27 @@
+#pragma once
+
+#include "absl/types/span.h"
+#include "mcpsi/utils/field.h"
+#include "yacl/base/int128.h"
+
+namespace mcpsi {
+
+// Bulk sampler of uniform field elements, over AES in counter mode
+// > the output is cut into blocks of kBlockSize elements, block i is drawn
+//   from its own stream AES_seed((i << 64) | ctr), ctr = 0, 1, ...
+// > the blocks are sampled in parallel, while the output only depends on the
+//   seed (&& not on the number of threads), so two parties with the same seed
+//   get the same elements
+// > kFp64 reduces 128 random bits (wide reduction, distance < 2^-64), kFp128
+//   && kFp256 reject the candidates (of the bit length of p) beyond p
+namespace sampler {
+
+constexpr size_t kBlockSize = 4096;
+
+void Rand(uint128_t seed, absl::Span<kFp64> out);
+void Rand(uint128_t seed, absl::Span<kFp128> out);
+void Rand(uint128_t seed, absl::Span<kFp256> out);
+
+}  // namespace sampler
+
+}  // namespace mcpsi
@@ -0,0 +1,53 @@
+#include "mcpsi/utils/sampler.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "yacl/utils/parallel.h"
+
+namespace mcpsi {
+
+namespace {
+
+template <typename T>
+std::vector<T> Sample(uint128_t seed, size_t num) {
+  std::vector<T> ret(num);
+  sampler::Rand(seed, absl::MakeSpan(ret));
+  return ret;
+}
+
+template <typename T>
+void CheckDeterministic() {
+  const size_t num = 3 * sampler::kBlockSize + 7;
+  const uint128_t seed = yacl::MakeUint128(0x0123, 0x4567);
+
+  auto ret = Sample<T>(seed, num);
+  for (const auto& val : ret) {
+    EXPECT_TRUE(val.GetVal() < T::GetPrime());
+  }
+  // the same seed, the same elements
+  EXPECT_EQ(ret, Sample<T>(seed, num));
+  // the blocks do not depend on the size
+  auto prefix = Sample<T>(seed, sampler::kBlockSize + 1);
+  for (size_t i = 0; i < prefix.size(); ++i) {
+    EXPECT_EQ(prefix[i], ret[i]);
+  }
+  // nor on the number of threads
+  const auto num_threads = yacl::get_num_threads();
+  yacl::set_num_threads(1);
+  auto single = Sample<T>(seed, num);
+  yacl::set_num_threads(num_threads);
+  EXPECT_EQ(ret, single);
+  // another seed, other elements
+  EXPECT_NE(ret, Sample<T>(seed + 1, num));
+}
+
+}  // namespace
+
+TEST(SamplerTest, kFp64Work) { CheckDeterministic<kFp64>(); }
+
+TEST(SamplerTest, kFp128Work) { CheckDeterministic<kFp128>(); }
+
+TEST(SamplerTest, kFp256Work) { CheckDeterministic<kFp256>(); }
+
+}  // namespace mcpsi
@@ -0,0 +1,123 @@
+#include "mcpsi/utils/stream.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+
+#include "fmt/format.h"
+
+namespace mcpsi {
+
+namespace {
+// read the sorted runs in small pieces
+constexpr size_t kMergeBatch = 4096;
+
+// min-heap by fingerprint
+bool HeapCmp(const std::pair<Fingerprint, size_t>& lhs,
+             const std::pair<Fingerprint, size_t>& rhs) {
+  return rhs.first < lhs.first;
+}
+}  // namespace
+
+ExternalSorter::ExternalSorter(const std::string& prefix, size_t run_size)
+    : prefix_(prefix), run_size_(std::max<size_t>(run_size, 1)) {
+  buff_.reserve(run_size_);
+}
+
+ExternalSorter::~ExternalSorter() {
+  readers_.clear();
+  for (const auto& run : runs_) {
+    std::remove(run.c_str());
+  }
+}
+
+void ExternalSorter::Add(const Fingerprint& in) {
+  YACL_ENFORCE(finished_ == false);
+  buff_.emplace_back(in);
+  if (buff_.size() >= run_size_) {
+    Spill();
+  }
+}
+
+void ExternalSorter::Add(absl::Span<const Fingerprint> in) {
+  for (const auto& fp : in) {
+    Add(fp);
+  }
+}
+
+void ExternalSorter::Spill() {
+  if (buff_.empty()) {
+    return;
+  }
+  std::sort(buff_.begin(), buff_.end());
+  auto path = fmt::format("{}.run{}", prefix_, runs_.size());
+  ChunkWriter<Fingerprint> writer(path);
+  writer.Write(buff_);
+  writer.Close();
+  runs_.emplace_back(std::move(path));
+  buff_.clear();
+}
+
+void ExternalSorter::Finish() {
+  YACL_ENFORCE(finished_ == false);
+  Spill();
+  buff_.shrink_to_fit();
+  finished_ = true;
+
+  const size_t k = runs_.size();
+  readers_.resize(k);
+  heads_.resize(k);
+  offsets_.assign(k, 0);
+  for (size_t i = 0; i < k; ++i) {
+    readers_[i] = std::make_unique<ChunkReader<Fingerprint>>(runs_[i]);
+    heads_[i] = readers_[i]->Next(kMergeBatch);
+    if (!heads_[i].empty()) {
+      heap_.emplace_back(heads_[i][0], i);
+    }
+  }
+  std::make_heap(heap_.begin(), heap_.end(), HeapCmp);
+}
+
+bool ExternalSorter::Next(Fingerprint* out) {
+  YACL_ENFORCE(finished_ == true);
+  if (heap_.empty()) {
+    return false;
+  }
+  std::pop_heap(heap_.begin(), heap_.end(), HeapCmp);
+  auto [fp, i] = heap_.back();
+  heap_.pop_back();
+  *out = fp;
+
+  // refill from run i
+  if (++offsets_[i] == heads_[i].size()) {
+    heads_[i] = readers_[i]->Next(kMergeBatch);
+    offsets_[i] = 0;
+  }
+  if (offsets_[i] < heads_[i].size()) {
+    heap_.emplace_back(heads_[i][offsets_[i]], i);
+    std::push_heap(heap_.begin(), heap_.end(), HeapCmp);
+  }
+  return true;
+}
+
+std::vector<uint64_t> MergeJoin(ExternalSorter& lhs, ExternalSorter& rhs) {
+  std::vector<uint64_t> ret;
+  Fingerprint l;
+  Fingerprint r;
+  bool has_l = lhs.Next(&l);
+  bool has_r = rhs.Next(&r);
+  while (has_l && has_r) {
+    if (l.fp < r.fp) {
+      has_l = lhs.Next(&l);
+    } else if (r.fp < l.fp) {
+      has_r = rhs.Next(&r);
+    } else {
+      ret.emplace_back(r.idx);
+      has_r = rhs.Next(&r);
+    }
+  }
+  std::sort(ret.begin(), ret.end());
+  return ret;
+}
+
+}  // namespace mcpsi
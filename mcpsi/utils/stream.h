@@ -0,0 +1,129 @@
+#pragma once
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "yacl/base/exception.h"
+#include "yacl/base/int128.h"
+
+namespace mcpsi {
+
+// Write trivially copyable values into a binary file, chunk by chunk
+template <typename T>
+class ChunkWriter {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+ public:
+  explicit ChunkWriter(const std::string& path)
+      : out_(path, std::ios::binary | std::ios::trunc) {
+    YACL_ENFORCE(out_.is_open(), "cannot open {}", path);
+  }
+
+  void Write(absl::Span<const T> in) {
+    out_.write(reinterpret_cast<const char*>(in.data()), in.size() * sizeof(T));
+    YACL_ENFORCE(out_.good());
+    count_ += in.size();
+  }
+
+  size_t Count() const { return count_; }
+
+  void Close() { out_.close(); }
+
+ private:
+  std::ofstream out_;
+  size_t count_{0};
+};
+
+// Read trivially copyable values from a binary file, chunk by chunk
+template <typename T>
+class ChunkReader {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+ public:
+  explicit ChunkReader(const std::string& path)
+      : in_(path, std::ios::binary | std::ios::ate) {
+    YACL_ENFORCE(in_.is_open(), "cannot open {}", path);
+    auto bytes = static_cast<size_t>(in_.tellg());
+    YACL_ENFORCE(bytes % sizeof(T) == 0, "broken file {}", path);
+    size_ = bytes / sizeof(T);
+    in_.seekg(0);
+  }
+
+  // number of elements in file
+  size_t Size() const { return size_; }
+  // number of elements left
+  size_t Remain() const { return size_ - pos_; }
+
+  // read at most `max_num` elements, return empty vector at the end of file
+  std::vector<T> Next(size_t max_num) {
+    const size_t num = std::min(max_num, Remain());
+    std::vector<T> ret(num);
+    in_.read(reinterpret_cast<char*>(ret.data()), num * sizeof(T));
+    YACL_ENFORCE(in_.good() || num == 0);
+    pos_ += num;
+    return ret;
+  }
+
+ private:
+  std::ifstream in_;
+  size_t size_{0};
+  size_t pos_{0};
+};
+
+// (fingerprint, index) pair for external-merge intersection
+struct Fingerprint {
+  uint128_t fp;
+  uint64_t idx;
+
+  bool operator<(const Fingerprint& rhs) const {
+    return fp < rhs.fp || (fp == rhs.fp && idx < rhs.idx);
+  }
+};
+
+// External sorter, fingerprints are buffered in memory (at most `run_size`),
+// then sorted and spilled into a run file. Sorted runs are k-way merged when
+// reading.
+class ExternalSorter {
+ public:
+  ExternalSorter(const std::string& prefix, size_t run_size);
+
+  ~ExternalSorter();
+
+  void Add(const Fingerprint& in);
+
+  void Add(absl::Span<const Fingerprint> in);
+
+  // spill the rest && prepare for merging
+  void Finish();
+
+  // next fingerprint in order, return false at the end
+  bool Next(Fingerprint* out);
+
+  size_t RunNum() const { return runs_.size(); }
+
+ private:
+  void Spill();
+
+  std::string prefix_;
+  size_t run_size_;
+  bool finished_{false};
+
+  std::vector<Fingerprint> buff_;
+  std::vector<std::string> runs_;
+
+  // merging state
+  std::vector<std::unique_ptr<ChunkReader<Fingerprint>>> readers_;
+  std::vector<std::vector<Fingerprint>> heads_;
+  std::vector<size_t> offsets_;
+  std::vector<std::pair<Fingerprint, size_t>> heap_;
+};
+
+// Return the indexes of `rhs` whose fingerprint appears in `lhs` (in
+// ascending order). Both sorters should be finished.
+std::vector<uint64_t> MergeJoin(ExternalSorter& lhs, ExternalSorter& rhs);
+
+}  // namespace mcpsi
@@ -0,0 +1,70 @@
+#include "mcpsi/utils/stream.h"
+
+#include <cstdio>
+#include <random>
+#include <set>
+
+#include "gtest/gtest.h"
+
+namespace mcpsi {
+
+TEST(StreamTest, ChunkWork) {
+  const std::string path = "stream_test.chunk";
+  size_t num = 10000;
+  std::vector<uint64_t> data(num);
+  for (size_t i = 0; i < num; ++i) {
+    data[i] = i * i;
+  }
+
+  ChunkWriter<uint64_t> writer(path);
+  writer.Write(absl::MakeConstSpan(data).subspan(0, 3000));
+  writer.Write(absl::MakeConstSpan(data).subspan(3000));
+  writer.Close();
+  EXPECT_EQ(writer.Count(), num);
+
+  ChunkReader<uint64_t> reader(path);
+  EXPECT_EQ(reader.Size(), num);
+  std::vector<uint64_t> ret;
+  while (reader.Remain() > 0) {
+    auto chunk = reader.Next(999);
+    ret.insert(ret.end(), chunk.begin(), chunk.end());
+  }
+  EXPECT_TRUE(reader.Next(999).empty());
+  EXPECT_EQ(ret, data);
+  std::remove(path.c_str());
+}
+
+TEST(StreamTest, MergeJoinWork) {
+  size_t num = 10000;
+  size_t interset = 1000;
+  std::mt19937_64 rng(0);
+
+  std::vector<uint128_t> lhs(num);
+  std::vector<uint128_t> rhs(num);
+  for (size_t i = 0; i < num; ++i) {
+    lhs[i] = (static_cast<uint128_t>(rng()) << 64) | rng();
+    rhs[i] = (static_cast<uint128_t>(rng()) << 64) | rng();
+  }
+  std::set<uint64_t> expected;
+  for (size_t i = 0; i < interset; ++i) {
+    auto idx = rng() % num;
+    rhs[idx] = lhs[rng() % num];
+    expected.insert(idx);
+  }
+
+  // small run size, force several runs
+  ExternalSorter lhs_sorter("stream_test.lhs", 777);
+  ExternalSorter rhs_sorter("stream_test.rhs", 777);
+  for (size_t i = 0; i < num; ++i) {
+    lhs_sorter.Add({lhs[i], i});
+    rhs_sorter.Add({rhs[i], i});
+  }
+  lhs_sorter.Finish();
+  rhs_sorter.Finish();
+  EXPECT_GT(lhs_sorter.RunNum(), 1);
+
+  auto ret = MergeJoin(lhs_sorter, rhs_sorter);
+  EXPECT_EQ(ret, std::vector<uint64_t>(expected.begin(), expected.end()));
+}
+
+}  // namespace mcpsi
@@ -70,6 +70,19 @@ std::vector<std::shared_ptr<Context>> MockContext(size_t world_size,
   return result;
 }
 
+// Mock McPsi Context (in memory) with WAN emulation
+inline std::vector<std::shared_ptr<Context>> MockContext(
+    size_t world_size, const NetworkConfig& config) {
+  auto result = MockContext(world_size, true);
+  if (config.Enabled()) {
+    auto net = std::make_shared<NetworkModel>(config, world_size);
+    for (auto& ctx : result) {
+      ctx->GetConnection()->SetNetworkModel(net);
+    }
+  }
+  return result;
+}
+
 std::shared_ptr<Context> MakeContext(const std::string& parties, size_t rank) {
   yl::ContextDesc lctx_desc;
   std::vector<std::string> hosts = absl::StrSplit(parties, ',');
@@ -23,80 +23,17 @@
 #include "yacl/base/exception.h"
 
 namespace mcpsi {
-// Returns the 0-based position of the last set bit (i.e., most significant bit)
-// in the given uint64. The argument may not be 0.
-//
-// For example:
-//   Given: 5 (decimal) == 101 (binary)
-//   Returns: 2
-#define STEP(T, n, pos, sh)                   \
-  do {                                        \
-    if ((n) >= (static_cast<T>(1) << (sh))) { \
-      (n) = (n) >> (sh);                      \
-      (pos) |= (sh);                          \
-    }                                         \
-  } while (0)
-static inline int Fls64(Uint64 n) {
-  // DCHECK_NE(0, n);
-  int pos = 0;
-  STEP(Uint64, n, pos, 0x20);
-  Uint32 n32 = n;
-  STEP(Uint32, n32, pos, 0x10);
-  STEP(Uint32, n32, pos, 0x08);
-  STEP(Uint32, n32, pos, 0x04);
-  return pos + ((static_cast<Uint64>(0x3333333322221100) >> (n32 << 2)) & 0x3);
-}
-#undef STEP
-// Like Fls64() above, but returns the 0-based position of the last set bit
-// (i.e., most significant bit) in the given uint128. The argument may not be 0.
-static inline int Fls128(absl::uint128 n) {
-  if (Uint64 hi = absl::Uint128High64(n)) {
-    return Fls64(hi) + 64;
-  }
-  return Fls64(absl::Uint128Low64(n));
-}
-// Like Fls128() above, but returns the 0-based position of the last set bit
-// (i.e., most significant bit) in the given uint256. The argument may not be 0.
-static inline int Fls256(uint256 n) {
-  absl::uint128 hi = Uint256High128(n);
-  if (hi != 0) {
-    return Fls128(hi) + 128;
-  }
-  return Fls128(Uint256Low128(n));
-}
-// Long division/modulo for uint256 implemented using the shift-subtract
-// division algorithm adapted from:
-// http://stackoverflow.com/questions/5386377/division-without-using
+// Long division/modulo for uint256, over the native 64-bit limbs (Knuth's
+// algorithm D, see limb.h).
 void uint256::DivModImpl(uint256 dividend, uint256 divisor,
                          uint256* quotient_ret, uint256* remainder_ret) {
   YACL_ENFORCE(divisor != static_cast<uint256>(0));
-  if (divisor > dividend) {
-    *quotient_ret = 0;
-    *remainder_ret = dividend;
-    return;
-  }
-  if (divisor == dividend) {
-    *quotient_ret = 1;
-    *remainder_ret = 0;
-    return;
-  }
-  uint256 denominator = divisor;
-  uint256 quotient = 0;
-  // Left aligns the MSB of the denominator and the dividend.
-  const int shift = Fls256(dividend) - Fls256(denominator);
-  denominator <<= shift;
-  // Uses shift-subtract algorithm to divide dividend by denominator. The
-  // remainder will be left in dividend.
-  for (int i = 0; i <= shift; ++i) {
-    quotient <<= 1;
-    if (dividend >= denominator) {
-      dividend -= denominator;
-      quotient |= 1;
-    }
-    denominator >>= 1;
-  }
-  *quotient_ret = quotient;
-  *remainder_ret = dividend;
+  limb::Limbs<4> quotient{};
+  limb::Limbs<4> remainder{};
+  limb::DivMod(Uint256ToLimbs(dividend), Uint256ToLimbs(divisor), quotient,
+               remainder);
+  *quotient_ret = Uint256FromLimbs(quotient);
+  *remainder_ret = Uint256FromLimbs(remainder);
 }
 
 uint256& uint256::operator/=(const uint256& divisor) {
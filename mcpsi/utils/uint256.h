@@ -18,6 +18,7 @@
 #include <fmt/core.h>
 
 #include "absl/numeric/int128.h"
+#include "mcpsi/utils/limb.h"
 #include "yacl/base/int128.h"
 
 namespace mcpsi {
@@ -85,8 +86,8 @@ class uint256 {
   uint256& operator^=(const uint256& b);
   uint256& operator++();
   uint256& operator--();
-  friend absl::uint128 Uint256Low128(const uint256& v);
-  friend absl::uint128 Uint256High128(const uint256& v);
+  friend constexpr absl::uint128 Uint256Low128(const uint256& v);
+  friend constexpr absl::uint128 Uint256High128(const uint256& v);
   // We add "std::" to avoid including all of port.h.
   friend std::ostream& operator<<(std::ostream& o, const uint256& b);
 
@@ -129,8 +130,19 @@ extern std::ostream& operator<<(std::ostream& o, const uint256& b);
 // Methods to access low and high pieces of 256-bit value.
 // Defined externally from uint256 to facilitate conversion
 // to native 256-bit types when compilers support them.
-inline absl::uint128 Uint256Low128(const uint256& v) { return v.lo_; }
-inline absl::uint128 Uint256High128(const uint256& v) { return v.hi_; }
+constexpr absl::uint128 Uint256Low128(const uint256& v) { return v.lo_; }
+constexpr absl::uint128 Uint256High128(const uint256& v) { return v.hi_; }
+// Methods to convert from / to the native limbs (little-endian).
+constexpr limb::Limbs<4> Uint256ToLimbs(const uint256& v) {
+  return {absl::Uint128Low64(Uint256Low128(v)),
+          absl::Uint128High64(Uint256Low128(v)),
+          absl::Uint128Low64(Uint256High128(v)),
+          absl::Uint128High64(Uint256High128(v))};
+}
+constexpr uint256 Uint256FromLimbs(const limb::Limbs<4>& limbs) {
+  return uint256(absl::MakeUint128(limbs[3], limbs[2]),
+                 absl::MakeUint128(limbs[1], limbs[0]));
+}
 // --------------------------------------------------------------------------
 //                      Implementation details follow
 // --------------------------------------------------------------------------
@@ -335,31 +347,9 @@ inline uint256& uint256::operator-=(const uint256& b) {
   return *this;
 }
 inline uint256& uint256::operator*=(const uint256& b) {
-  // Computes the product c = a * b modulo 2^256.
-  //
-  // We have that
-  //   a = [a.hi_ || a.lo_] and b = [b.hi_ || b.lo_]
-  // where hi_, lo_ are 128-bit numbers. Further, we have that
-  //   a.lo_ = [a64 || a00] and b.lo_ = [b64 || b00]
-  // where a64, a00, b64, b00 are 64-bit numbers.
-  //
-  // The product c = (a * b mod 2^256) is equal to
-  //   (a.hi_ * b.lo_ + a64 * b64 + b.hi_ * a.lo_ mod 2^128) * 2^128 +
-  //   (a64 * b00 + a00 * b64) * 2^64 +
-  //   (a00 * b00)
-  //
-  // The first and last lines can be computed without worrying about the
-  // carries, and then we add the two elements from the second line.
-  absl::uint128 a64 = absl::Uint128High64(lo_);
-  absl::uint128 a00 = absl::Uint128Low64(lo_);
-  absl::uint128 b64 = absl::Uint128High64(b.lo_);
-  absl::uint128 b00 = absl::Uint128Low64(b.lo_);
-  // Compute the high order and low order part of c (safe to ignore carry bits).
-  this->hi_ = hi_ * b.lo_ + a64 * b64 + lo_ * b.hi_;
-  this->lo_ = a00 * b00;
-  // add middle term and capture carry
-  uint256 middle_term = uint256(a64 * b00) + uint256(a00 * b64);
-  *this += middle_term << 64;
+  // Computes the product c = a * b modulo 2^256, over the native limbs.
+  *this = Uint256FromLimbs(
+      limb::MulLow(Uint256ToLimbs(*this), Uint256ToLimbs(b)));
   return *this;
 }
 inline uint256 uint256::operator++(int) {
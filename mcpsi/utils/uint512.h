@@ -0,0 +1,131 @@
+#pragma once
+
+#include "mcpsi/utils/limb.h"
+#include "mcpsi/utils/uint256.h"
+#include "yacl/base/int128.h"
+
+namespace mcpsi {
+
+// An unsigned 512-bit integer type over the native limbs, e.g. the full
+// product of two uint256 (in place of boost::multiprecision::uint512_t).
+// Arithmetic wraps modulo 2^512.
+class uint512 {
+ public:
+  constexpr uint512() : limbs_{} {}
+  constexpr uint512(const limb::Limbs<8>& limbs) : limbs_(limbs) {}
+  constexpr uint512(const uint256& top, const uint256& bottom) : limbs_{} {
+    const auto lo = Uint256ToLimbs(bottom);
+    const auto hi = Uint256ToLimbs(top);
+    for (size_t i = 0; i < 4; ++i) {
+      limbs_[i] = lo[i];
+      limbs_[i + 4] = hi[i];
+    }
+  }
+  constexpr uint512(const uint256& bottom) : uint512(uint256(0), bottom) {}
+  uint512(uint128_t bottom) : uint512(uint256(bottom)) {}
+
+  // low 256 bits
+  constexpr explicit operator uint256() const { return Uint512Low256(*this); }
+  explicit operator uint128_t() const {
+    return yacl::MakeUint128(limbs_[1], limbs_[0]);
+  }
+  constexpr explicit operator bool() const { return limb::Size(limbs_) != 0; }
+
+  constexpr const limb::Limbs<8>& limbs() const { return limbs_; }
+
+  constexpr uint512& operator+=(const uint512& b) {
+    limb::Add(limbs_, b.limbs_, limbs_);
+    return *this;
+  }
+  constexpr uint512& operator-=(const uint512& b) {
+    limb::Sub(limbs_, b.limbs_, limbs_);
+    return *this;
+  }
+  constexpr uint512& operator*=(const uint512& b) {
+    limbs_ = limb::MulLow(limbs_, b.limbs_);
+    return *this;
+  }
+  constexpr uint512& operator/=(const uint512& b) {
+    const limb::Limbs<8> dividend = limbs_;
+    limb::Limbs<8> remainder{};
+    limb::DivMod(dividend, b.limbs_, limbs_, remainder);
+    return *this;
+  }
+  constexpr uint512& operator%=(const uint512& b) {
+    const limb::Limbs<8> dividend = limbs_;
+    limb::Limbs<8> quotient{};
+    limb::DivMod(dividend, b.limbs_, quotient, limbs_);
+    return *this;
+  }
+  constexpr uint512& operator<<=(int amount) {
+    limbs_ = limb::ShiftLeft(limbs_, amount);
+    return *this;
+  }
+  constexpr uint512& operator>>=(int amount) {
+    limbs_ = limb::ShiftRight<8>(limbs_, amount);
+    return *this;
+  }
+
+  friend constexpr uint256 Uint512Low256(const uint512& v) {
+    return Uint256FromLimbs({v.limbs_[0], v.limbs_[1], v.limbs_[2],
+                             v.limbs_[3]});
+  }
+  friend constexpr uint256 Uint512High256(const uint512& v) {
+    return Uint256FromLimbs({v.limbs_[4], v.limbs_[5], v.limbs_[6],
+                             v.limbs_[7]});
+  }
+
+ private:
+  limb::Limbs<8> limbs_;
+};
+
+constexpr bool operator==(const uint512& lhs, const uint512& rhs) {
+  return limb::Compare(lhs.limbs(), rhs.limbs()) == 0;
+}
+constexpr bool operator!=(const uint512& lhs, const uint512& rhs) {
+  return !(lhs == rhs);
+}
+constexpr bool operator<(const uint512& lhs, const uint512& rhs) {
+  return limb::Compare(lhs.limbs(), rhs.limbs()) < 0;
+}
+constexpr bool operator>(const uint512& lhs, const uint512& rhs) {
+  return rhs < lhs;
+}
+constexpr bool operator<=(const uint512& lhs, const uint512& rhs) {
+  return !(rhs < lhs);
+}
+constexpr bool operator>=(const uint512& lhs, const uint512& rhs) {
+  return !(lhs < rhs);
+}
+
+constexpr uint512 operator~(const uint512& val) {
+  limb::Limbs<8> out = val.limbs();
+  for (auto& e : out) {
+    e = ~e;
+  }
+  return uint512(out);
+}
+
+constexpr uint512 operator+(const uint512& lhs, const uint512& rhs) {
+  return uint512(lhs) += rhs;
+}
+constexpr uint512 operator-(const uint512& lhs, const uint512& rhs) {
+  return uint512(lhs) -= rhs;
+}
+constexpr uint512 operator*(const uint512& lhs, const uint512& rhs) {
+  return uint512(lhs) *= rhs;
+}
+constexpr uint512 operator/(const uint512& lhs, const uint512& rhs) {
+  return uint512(lhs) /= rhs;
+}
+constexpr uint512 operator%(const uint512& lhs, const uint512& rhs) {
+  return uint512(lhs) %= rhs;
+}
+constexpr uint512 operator<<(const uint512& val, int amount) {
+  return uint512(val) <<= amount;
+}
+constexpr uint512 operator>>(const uint512& val, int amount) {
+  return uint512(val) >>= amount;
+}
+
+}  // namespace mcpsi
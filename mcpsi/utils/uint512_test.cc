@@ -0,0 +1,94 @@
+#include "mcpsi/utils/uint512.h"
+
+#include <random>
+
+#include "boost/multiprecision/cpp_int.hpp"
+#include "gtest/gtest.h"
+
+namespace mcpsi {
+
+namespace {
+
+// boost is only the oracle
+using BoostUint = boost::multiprecision::uint1024_t;
+
+template <size_t N>
+BoostUint ToBoost(const limb::Limbs<N>& limbs) {
+  BoostUint ret = 0;
+  for (size_t i = N; i-- > 0;) {
+    ret = (ret << 64) | limbs[i];
+  }
+  return ret;
+}
+
+BoostUint ToBoost(const uint256& val) {
+  return ToBoost(Uint256ToLimbs(val));
+}
+
+BoostUint ToBoost(const uint512& val) { return ToBoost(val.limbs()); }
+
+// random limbs, with a random number of leading zero limbs && bits
+template <size_t N>
+limb::Limbs<N> RandLimbs(std::mt19937_64& gen) {
+  limb::Limbs<N> ret{};
+  const size_t size = 1 + gen() % N;
+  for (size_t i = 0; i < size; ++i) {
+    ret[i] = gen();
+  }
+  ret[size - 1] >>= gen() % 64;
+  return ret;
+}
+
+}  // namespace
+
+TEST(Uint256Test, DivModWork) {
+  std::mt19937_64 gen(0);
+  const BoostUint mod = BoostUint(1) << 256;
+  for (size_t i = 0; i < 10000; ++i) {
+    auto lhs = Uint256FromLimbs(RandLimbs<4>(gen));
+    auto rhs = Uint256FromLimbs(RandLimbs<4>(gen));
+    if (rhs == uint256(0)) {
+      continue;
+    }
+    EXPECT_EQ(ToBoost(lhs / rhs), ToBoost(lhs) / ToBoost(rhs));
+    EXPECT_EQ(ToBoost(lhs % rhs), ToBoost(lhs) % ToBoost(rhs));
+    EXPECT_EQ(ToBoost(lhs * rhs), ToBoost(lhs) * ToBoost(rhs) % mod);
+  }
+}
+
+TEST(Uint512Test, ArithWork) {
+  std::mt19937_64 gen(1);
+  const BoostUint mod = BoostUint(1) << 512;
+  for (size_t i = 0; i < 10000; ++i) {
+    uint512 lhs(RandLimbs<8>(gen));
+    uint512 rhs(RandLimbs<8>(gen));
+    const auto b_lhs = ToBoost(lhs);
+    const auto b_rhs = ToBoost(rhs);
+    const int shift = gen() % 512;
+    EXPECT_EQ(ToBoost(lhs + rhs), (b_lhs + b_rhs) % mod);
+    EXPECT_EQ(ToBoost(lhs - rhs), (b_lhs + mod - b_rhs) % mod);
+    EXPECT_EQ(ToBoost(lhs * rhs), b_lhs * b_rhs % mod);
+    EXPECT_EQ(ToBoost(lhs << shift), (b_lhs << shift) % mod);
+    EXPECT_EQ(ToBoost(lhs >> shift), b_lhs >> shift);
+    EXPECT_EQ(lhs < rhs, b_lhs < b_rhs);
+    if (rhs != uint512()) {
+      EXPECT_EQ(ToBoost(lhs / rhs), b_lhs / b_rhs);
+      EXPECT_EQ(ToBoost(lhs % rhs), b_lhs % b_rhs);
+    }
+  }
+}
+
+TEST(Uint512Test, MulWork) {
+  std::mt19937_64 gen(2);
+  for (size_t i = 0; i < 10000; ++i) {
+    auto lhs = RandLimbs<4>(gen);
+    auto rhs = RandLimbs<4>(gen);
+    EXPECT_EQ(ToBoost(limb::Mul(lhs, rhs)), ToBoost(lhs) * ToBoost(rhs));
+  }
+  // carries all the way up
+  const limb::Limbs<4> ones = {~uint64_t(0), ~uint64_t(0), ~uint64_t(0),
+                               ~uint64_t(0)};
+  EXPECT_EQ(ToBoost(limb::Mul(ones, ones)), ToBoost(ones) * ToBoost(ones));
+}
+
+}  // namespace mcpsi
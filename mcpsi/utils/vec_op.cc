@@ -1,10 +1,25 @@
 #include "mcpsi/utils/vec_op.h"
 
+#include <array>
+#include <utility>
+
 #include "field.h"
+#include "mcpsi/utils/sampler.h"
 #include "yacl/utils/parallel.h"
 
 namespace mcpsi {
 
+namespace {
+
+// a seed of the parallel sampler, the only bytes drawn from `prg`
+uint128_t DrawSeed(yacl::crypto::Prg<uint8_t> &prg) {
+  uint128_t seed = 0;
+  prg.Fill(absl::MakeSpan(&seed, 1));
+  return seed;
+}
+
+}  // namespace
+
 // -------------------
 //     Fp 64-bit
 // -------------------
@@ -38,11 +53,24 @@ void op64::Mul(absl::Span<const kFp64> lhs, absl::Span<const kFp64> rhs,
                  std::multiplies());
 }
 
+// Shoup's multiplication by a fixed scalar w, with w' = floor(w * 2^64 / p),
+// q = (w' * x) >> 64 is floor(w * x / p) or one less (p < 2^63)
 void op64::ScalarMul(const kFp64 scalar, absl::Span<const kFp64> in,
                      absl::Span<kFp64> out) {
   YACL_ENFORCE(out.size() == in.size());
-  std::transform(in.begin(), in.end(), out.begin(),
-                 [&scalar](kFp64 val) { return scalar * val; });
+  const uint64_t prime = kFp64::GetPrime();
+  const uint64_t w = scalar.GetVal();
+  const auto w_shoup =
+      static_cast<uint64_t>((static_cast<uint128_t>(w) << 64) / prime);
+  auto out64 =
+      absl::MakeSpan(reinterpret_cast<uint64_t *>(out.data()), out.size());
+  for (size_t i = 0; i < in.size(); ++i) {
+    const uint64_t x = in[i].GetVal();
+    const auto q =
+        static_cast<uint64_t>((static_cast<uint128_t>(w_shoup) * x) >> 64);
+    const uint64_t r = w * x - q * prime;  // < 2p
+    out64[i] = r >= prime ? r - prime : r;
+  }
 }
 
 void op64::Div(absl::Span<const kFp64> lhs, absl::Span<const kFp64> rhs,
@@ -124,29 +152,11 @@ void op64::Zeros(absl::Span<kFp64> out) {
 }
 
 void op64::Rand(absl::Span<kFp64> out) {
-  const uint64_t prime = kFp64::GetPrime();
-
-  auto out64 =
-      absl::MakeSpan(reinterpret_cast<uint64_t *>(out.data()), out.size());
-
-  auto prg = yacl::crypto::Prg<uint8_t>(yacl::crypto::SecureRandU128());
-  prg.Fill(out64);
-
-  for (auto &e : out64) {
-    e %= prime;
-  }
+  sampler::Rand(yacl::crypto::SecureRandU128(), out);
 }
 
 void op64::Rand(yacl::crypto::Prg<uint8_t> &prg, absl::Span<kFp64> out) {
-  const uint64_t prime = kFp64::GetPrime();
-
-  auto out64 =
-      absl::MakeSpan(reinterpret_cast<uint64_t *>(out.data()), out.size());
-  prg.Fill(out64);
-
-  for (auto &e : out64) {
-    e %= prime;
-  }
+  sampler::Rand(DrawSeed(prg), out);
 }
 
 // -------------------
@@ -332,38 +342,11 @@ void op128::Zeros(absl::Span<kFp128> out) {
 }
 
 void op128::Rand(absl::Span<kFp128> out) {
-  const uint128_t prime = kFp128::GetPrime();
-  const size_t size = out.size();
-
-  auto out128 = absl::MakeSpan(reinterpret_cast<uint128_t *>(out.data()), size);
-  auto prg = yacl::crypto::Prg<uint8_t>(yacl::crypto::SecureRandU128());
-  prg.Fill(out128);
-
-  yacl::parallel_for(0, size, 4096, [&](uint64_t bg, uint64_t ed) {
-    std::for_each(out128.begin() + bg, out128.begin() + ed,
-                  [&prime](uint128_t &val) { val %= prime; });
-  });
-
-  // for (auto &e : out128) {
-  //   e %= prime;
-  // }
+  sampler::Rand(yacl::crypto::SecureRandU128(), out);
 }
 
 void op128::Rand(yacl::crypto::Prg<uint8_t> &prg, absl::Span<kFp128> out) {
-  const uint128_t prime = kFp128::GetPrime();
-  const size_t size = out.size();
-
-  auto out128 = absl::MakeSpan(reinterpret_cast<uint128_t *>(out.data()), size);
-  prg.Fill(out128);
-
-  yacl::parallel_for(0, size, 4096, [&](uint64_t bg, uint64_t ed) {
-    std::for_each(out128.begin() + bg, out128.begin() + ed,
-                  [&prime](uint128_t &val) { val %= prime; });
-  });
-
-  // for (auto &e : out128) {
-  //   e %= prime;
-  // }
+  sampler::Rand(DrawSeed(prg), out);
 }
 
 // -------------------
@@ -442,31 +425,115 @@ void op256::Neg(absl::Span<const kFp256> in, absl::Span<kFp256> out) {
   // std::transform(in.begin(), in.end(), out.begin(), kFp256::Neg);
 }
 
+namespace {
+
+// x^e for a fixed exponent e, by a sliding-window addition chain
+//
+// The chain is built once, then every power costs (bit_len(e) - 1) squarings
+// && about bit_len(e) / (kWindow + 1) multiplications, all in native limbs
+// (instead of the MPInt conversion && SqrtModPrime).
+class FixedPow256 {
+ public:
+  explicit FixedPow256(const uint256_t &e) {
+    const uint256_t zero = 0;
+    YACL_ENFORCE(e != zero);
+    auto test_bit = [&e](int i) {
+      auto limb = i < 128 ? Uint256Low128(e) : Uint256High128(e);
+      return ((limb >> (i % 128)) & 1) != 0;
+    };
+    int i = 255;
+    while (!test_bit(i)) --i;
+
+    uint32_t square = 0;
+    while (i >= 0) {
+      if (!test_bit(i)) {
+        ++square;
+        --i;
+        continue;
+      }
+      // the longest window [low, i] (at most kWindow bits) ending with 1
+      int low = std::max(i - static_cast<int>(kWindow) + 1, 0);
+      while (!test_bit(low)) ++low;
+      uint32_t digit = 0;
+      for (int j = i; j >= low; --j) {
+        digit = (digit << 1) | static_cast<uint32_t>(test_bit(j));
+      }
+      square += i - low + 1;
+      steps_.emplace_back(square, digit);
+      square = 0;
+      i = low - 1;
+    }
+    if (square > 0) {
+      steps_.emplace_back(square, 0);
+    }
+  }
+
+  kFp256 operator()(const kFp256 &x) const {
+    // odd powers: x, x^3, ..., x^{2^kWindow - 1}
+    std::array<kFp256, (1 << (kWindow - 1))> odd;
+    odd[0] = x;
+    const auto x2 = x * x;
+    for (size_t k = 1; k < odd.size(); ++k) {
+      odd[k] = odd[k - 1] * x2;
+    }
+
+    // the first step is a bare window (no squaring)
+    auto ret = odd[steps_[0].second >> 1];
+    for (size_t k = 1; k < steps_.size(); ++k) {
+      for (uint32_t j = 0; j < steps_[k].first; ++j) {
+        ret = ret * ret;
+      }
+      if (steps_[k].second != 0) {
+        ret = ret * odd[steps_[k].second >> 1];
+      }
+    }
+    return ret;
+  }
+
+ private:
+  static constexpr size_t kWindow = 5;
+  // (number of squarings, odd window digit), from the most significant bit
+  std::vector<std::pair<uint32_t, uint32_t>> steps_;
+};
+
+// Prime256 = 3 (mod 4) --> sqrt(x) = x^{(p+1)/4}, 1/sqrt(x) = x^{(p-3)/4}
+const FixedPow256 &SqrtPow256() {
+  static const FixedPow256 pow((Prime256 + 1) >> 2);
+  return pow;
+}
+
+const FixedPow256 &InvSqrtPow256() {
+  static const FixedPow256 pow((Prime256 - 3) >> 2);
+  return pow;
+}
+
+}  // namespace
+
 void op256::Sqrt(absl::Span<const kFp256> in, absl::Span<kFp256> out) {
   YACL_ENFORCE(in.size() == out.size());
-  auto mp_mod = ToMPInt(Prime256);
+  const auto &pow = SqrtPow256();
 
   yacl::parallel_for(0, in.size(), [&](uint64_t bg, uint64_t ed) {
-    std::transform(in.cbegin() + bg, in.cbegin() + ed, out.begin() + bg,
-                   [&](const kFp256 &val) {
-                     auto tmp = yacl::math::MPInt(0);
-                     auto mp_val = ToMPInt(val.GetVal());
-                     yacl::math::MPInt::SqrtModPrime(mp_val, mp_mod, &tmp);
-                     // uint256_t ret256 = uint256_t(tmp.Get<uint128_t>()) +
-                     //                    (uint256_t((tmp >>
-                     //                    128).Get<uint128_t>()) << 128);
-                     return kFp256(uint256((tmp >> 128).Get<uint128_t>(),
-                                           tmp.Get<uint128_t>()));
-                   });
+    for (auto i = bg; i < ed; ++i) {
+      auto root = pow(in[i]);
+      YACL_ENFORCE(root * root == in[i], "no square root");
+      out[i] = root;
+    }
   });
+}
 
-  // std::transform(in.cbegin(), in.cend(), out.begin(), [&](const kFp256 &val)
-  // {
-  //   auto tmp = yacl::math::MPInt(0);
-  //   yacl::math::MPInt::PowMod(yacl::math::MPInt(val.GetVal()), power, mod,
-  //                             &tmp);
-  //   return kFp256(tmp.Get<uint256_t>());
-  // });
+void op256::InvSqrt(absl::Span<const kFp256> in, absl::Span<kFp256> out) {
+  YACL_ENFORCE(in.size() == out.size());
+  const auto &pow = InvSqrtPow256();
+
+  yacl::parallel_for(0, in.size(), [&](uint64_t bg, uint64_t ed) {
+    for (auto i = bg; i < ed; ++i) {
+      auto inv_root = pow(in[i]);
+      YACL_ENFORCE(inv_root * inv_root * in[i] == kFp256::One(),
+                   "no square root");
+      out[i] = inv_root;
+    }
+  });
 }
 
 template <size_t N>
@@ -552,43 +619,11 @@ void op256::Zeros(absl::Span<kFp256> out) {
 }
 
 void op256::Rand(absl::Span<kFp256> out) {
-  const uint256_t prime = kFp256::GetPrime();
-  const size_t size = out.size();
-
-  auto out128 =
-      absl::MakeSpan(reinterpret_cast<uint128_t *>(out.data()), size * 2);
-  auto prg = yacl::crypto::Prg<uint8_t>(yacl::crypto::SecureRandU128());
-  prg.Fill(out128);
-
-  auto out256 = absl::MakeSpan(reinterpret_cast<uint256_t *>(out.data()), size);
-  yacl::parallel_for(0, size, 4096, [&](uint64_t bg, uint64_t ed) {
-    std::for_each(out256.begin() + bg, out256.begin() + ed,
-                  [&prime](uint256_t &val) { val %= prime; });
-  });
-
-  // for (auto &e : out128) {
-  //   e %= prime;
-  // }
+  sampler::Rand(yacl::crypto::SecureRandU128(), out);
 }
 
 void op256::Rand(yacl::crypto::Prg<uint8_t> &prg, absl::Span<kFp256> out) {
-  const uint256_t prime = kFp256::GetPrime();
-  const size_t size = out.size();
-
-  auto out128 =
-      absl::MakeSpan(reinterpret_cast<uint128_t *>(out.data()), size * 2);
-  prg.Fill(out128);
-
-  auto out256 = absl::MakeSpan(reinterpret_cast<uint256_t *>(out.data()), size);
-
-  yacl::parallel_for(0, size, 4096, [&](uint64_t bg, uint64_t ed) {
-    std::for_each(out256.begin() + bg, out256.begin() + ed,
-                  [&prime](uint256_t &val) { val %= prime; });
-  });
-
-  // for (auto &e : out128) {
-  //   e %= prime;
-  // }
+  sampler::Rand(DrawSeed(prg), out);
 }
 
 std::vector<size_t> GenPerm(uint32_t num) {
@@ -157,11 +157,16 @@ class op64 {
                             absl::Span<const kFp64> rhs) {
     YACL_ENFORCE(lhs.size() == rhs.size());
     const size_t size = lhs.size();
-    kFp64 ret = kFp64::Zero();
-    for (uint32_t i = 0; i < size; ++i) {
-      ret = ret + (lhs[i] * rhs[i]);
+    // lazy reduction, a product is < p^2 < 2^123, so 32 of them never
+    // overflow 128 bits
+    uint128_t acc = 0;
+    for (size_t i = 0; i < size; ++i) {
+      acc += static_cast<uint128_t>(lhs[i].GetVal()) * rhs[i].GetVal();
+      if ((i & 31) == 31) {
+        acc = reduce::Mod64(acc);
+      }
     }
-    return ret;
+    return kFp64(acc);
   }
 };  // namespace vec64
 
@@ -329,11 +334,22 @@ class op128 {
         std::function<kFp128(const kFp128&, const kFp128&)>>(
         0, size, 4096,
         [&](uint64_t bg, uint64_t ed) {
-          kFp128 ret = kFp128::Zero();
+          // lazy reduction, a product is < p^2 < 2^252, so 8 of them never
+          // overflow 256 bits
+          uint128_t hi = 0;
+          uint128_t lo = 0;
           for (auto i = bg; i < ed; ++i) {
-            ret = ret + (lhs[i] * rhs[i]);
+            uint128_t p_hi = 0;
+            uint128_t p_lo = 0;
+            reduce::MulWide(lhs[i].GetVal(), rhs[i].GetVal(), p_hi, p_lo);
+            lo += p_lo;
+            hi += p_hi + (lo < p_lo);
+            if (((i - bg) & 7) == 7) {
+              lo = reduce::Mod128(hi, lo);
+              hi = 0;
+            }
           }
-          return ret;
+          return kFp128(reduce::Mod128(hi, lo));
         },
         kFp128::Add);
   }
@@ -360,8 +376,12 @@ class op256 {
 
   static void Neg(absl::Span<const kFp256> in, absl::Span<kFp256> out);
 
+  // fixed-exponent (sliding window) power, since Prime256 = 3 (mod 4)
   static void Sqrt(absl::Span<const kFp256> in, absl::Span<kFp256> out);
 
+  // Implement : Inv(Sqrt(in)) = in^{(p-3)/4}, for quadratic residues
+  static void InvSqrt(absl::Span<const kFp256> in, absl::Span<kFp256> out);
+
   static void inline AddInplace(absl::Span<kFp256> lhs,
                                 absl::Span<const kFp256> rhs) {
     YACL_ENFORCE(lhs.size() == rhs.size());
@@ -456,6 +476,13 @@ class op256 {
     return ret;
   }
 
+  static std::vector<kFp256> inline InvSqrt(absl::Span<const kFp256> in) {
+    const size_t size = in.size();
+    std::vector<kFp256> ret(size);
+    InvSqrt(in, absl::MakeSpan(ret));
+    return ret;
+  }
+
   static void inline NegInplace(absl::Span<kFp256> in) { Neg(in, in); }
 
   static std::vector<kFp256> inline Inv(absl::Span<const kFp256> in) {
@@ -504,11 +531,19 @@ class op256 {
         std::function<kFp256(const kFp256&, const kFp256&)>>(
         0, size, 4096,
         [&](uint64_t bg, uint64_t ed) {
-          kFp256 ret = kFp256::Zero();
+          // lazy reduction, a product is < p^2 < 2^492, so 2^16 of them
+          // never overflow 512 bits
+          limb::Limbs<8> acc{};
           for (auto i = bg; i < ed; ++i) {
-            ret = ret + (lhs[i] * rhs[i]);
+            limb::Add(acc,
+                      limb::Mul(Uint256ToLimbs(lhs[i].GetVal()),
+                                Uint256ToLimbs(rhs[i].GetVal())),
+                      acc);
+            if (((i - bg) & 0xffff) == 0xffff) {
+              acc = uint512_t(reduce::Mod256(acc)).limbs();
+            }
           }
-          return ret;
+          return kFp256(uint512_t(acc));
         },
         kFp256::Add);
   }
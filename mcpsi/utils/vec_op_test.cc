@@ -336,6 +336,24 @@ TEST(kFp256Test, SqrtWork) {
   }
 }
 
+TEST(kFp256Test, InvSqrtWork) {
+  size_t num = 10000;
+  auto in = op256::Rand(num);
+  // square
+  auto res = op256::Mul(absl::MakeSpan(in), absl::MakeSpan(in));
+  // find inverse root, in * inv_root = 1 or -1
+  auto inv_root = op256::InvSqrt(absl::MakeSpan(res));
+  auto ret = op256::Mul(absl::MakeSpan(in), absl::MakeSpan(inv_root));
+
+  for (size_t i = 0; i < num; ++i) {
+    EXPECT_TRUE(ret[i] == kFp256::One() ||
+                ret[i] == kFp256::Neg(kFp256::One()));
+  }
+  // non-residue, -1 is not a square since p = 3 (mod 4)
+  auto neg_one = std::vector<kFp256>{kFp256::Neg(kFp256::One())};
+  EXPECT_ANY_THROW(op256::InvSqrt(absl::MakeSpan(neg_one)));
+}
+
 TEST(kFp256Test, OneZeroWork) {
   size_t num = 10000;
 